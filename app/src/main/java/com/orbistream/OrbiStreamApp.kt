@@ -6,6 +6,7 @@ import com.orbistream.bondix.BondixManager
 import com.orbistream.bondix.NetworkRegistry
 import com.orbistream.data.SettingsRepository
 import com.orbistream.streaming.NativeStreamer
+import kotlin.concurrent.thread
 
 /**
  * OrbiStreamApp is the Application class that initializes core components:
@@ -64,6 +65,12 @@ class OrbiStreamApp : Application() {
             // Now initialize the native streaming engine
             if (NativeStreamer.initialize()) {
                 Log.i(TAG, "NativeStreamer engine initialized successfully")
+                NativeStreamer.getStartupReport()?.let { report ->
+                    Log.i(TAG, "GStreamer startup ${report.totalUs / 1000} ms " +
+                        "(registry ${if (report.registryCacheHit) "cached" else "rebuilt"}): " +
+                        report.phaseUs.entries.joinToString { "${it.key.name.lowercase()}=${it.value / 1000}ms" })
+                }
+                startEncoderCalibration()
             } else {
                 Log.e(TAG, "NativeStreamer engine initialization failed")
             }
@@ -72,6 +79,27 @@ class OrbiStreamApp : Application() {
         }
     }
 
+    /**
+     * Calibrate the software encoder for the configured output in the
+     * background. Cached per build, so after the first launch this only
+     * reads the cache file.
+     */
+    private fun startEncoderCalibration() {
+        val (width, height) = settingsRepository.getResolutionSize()
+        val frameRate = settingsRepository.frameRate
+        val bitrate = settingsRepository.videoBitrateKbps * 1000
+        thread(name = "EncoderCalibration", isDaemon = true) {
+            NativeStreamer.calibrate(
+                cacheDir = cacheDir,
+                buildId = BuildConfig.VERSION_CODE.toString(),
+                targetFps = frameRate,
+                maxWidth = width,
+                maxHeight = height,
+                videoBitrate = bitrate
+            )
+        }
+    }
+
     private fun initializeNetworkTracking() {
         Log.d(TAG, "Starting NetworkRegistry")
         NetworkRegistry.start(this)
@@ -156,6 +156,19 @@ object NetworkRegistry {
         }
     }
 
+    /**
+     * First IPv4 address of the network identified by the given ID, for
+     * binding a native socket to it by source address (SRT groups).
+     */
+    fun getLocalAddress(id: String): String? {
+        val nw = findNetwork(id) ?: return null
+        val lp = cm.getLinkProperties(nw) ?: return null
+        return lp.linkAddresses
+            .map { it.address }
+            .firstOrNull { it is java.net.Inet4Address && !it.isLoopbackAddress }
+            ?.hostAddress
+    }
+
     /**
      * Check if WiFi network is available.
      */
@@ -2,6 +2,7 @@ package com.orbistream.bondix
 
 import android.os.ParcelFileDescriptor
 import android.util.Log
+import java.net.DatagramSocket
 
 /**
  * SocketBinder provides the callback implementation for Bondix to bind
@@ -56,5 +57,34 @@ object SocketBinder {
             }
         }
     }
-}
 
+    /**
+     * Open a UDP socket bound to the network identified by `id` and hand
+     * over its native FD (used by the native multi-link sender).
+     *
+     * @param id The interface identifier (e.g., "WIFI", "CELLULAR")
+     * @return the detached FD, owned by the caller, or -1 on failure
+     */
+    @JvmStatic
+    fun openBoundUdpSocket(id: String): Int {
+        val nw = NetworkRegistry.findNetwork(id)
+        if (nw == null) {
+            Log.w(TAG, "No network found for id: $id")
+            return -1
+        }
+
+        val socket = DatagramSocket()
+        return try {
+            nw.bindSocket(socket)
+            val fd = ParcelFileDescriptor.fromDatagramSocket(socket).detachFd()
+            Log.d(TAG, "Opened UDP socket FD $fd on network $id")
+            fd
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to open UDP socket on network $id: ${e.message}")
+            -1
+        } finally {
+            // The detached FD is a dup; the Java socket is no longer needed
+            socket.close()
+        }
+    }
+}
@@ -3,6 +3,7 @@ package com.orbistream.data
 import android.content.Context
 import android.content.SharedPreferences
 import com.orbistream.streaming.EncoderPreset
+import com.orbistream.streaming.SrtGroupMode
 import com.orbistream.streaming.StreamConfig
 import com.orbistream.streaming.TransportMode
 
@@ -15,7 +16,8 @@ class SettingsRepository(context: Context) {
         private const val PREFS_NAME = "orbistream_settings"
         
         // Transport settings
-        private const val KEY_TRANSPORT_MODE = "transport_mode"  // "udp" or "srt"
+        private const val KEY_TRANSPORT_MODE = "transport_mode"  // "udp", "srt", "multilink", "arq", "srt_direct" or "srt_bonded"
+        private const val KEY_SRT_GROUP_MODE = "srt_group_mode"  // SrtGroupMode value (srt_bonded)
         
         // SRT/UDP target settings
         private const val KEY_SRT_HOST = "srt_host"
@@ -86,13 +88,31 @@ class SettingsRepository(context: Context) {
     var transportMode: TransportMode
         get() {
             val mode = prefs.getString(KEY_TRANSPORT_MODE, "srt") ?: "srt"
-            return if (mode == "srt") TransportMode.SRT else TransportMode.UDP
+            return when (mode) {
+                "srt" -> TransportMode.SRT
+                "srt_direct" -> TransportMode.SRT_DIRECT
+                "srt_bonded" -> TransportMode.SRT_BONDED
+                "multilink" -> TransportMode.MULTILINK_UDP
+                "arq" -> TransportMode.ARQ_UDP
+                else -> TransportMode.UDP
+            }
         }
         set(value) {
-            val mode = if (value == TransportMode.SRT) "srt" else "udp"
+            val mode = when (value) {
+                TransportMode.SRT -> "srt"
+                TransportMode.SRT_DIRECT -> "srt_direct"
+                TransportMode.SRT_BONDED -> "srt_bonded"
+                TransportMode.MULTILINK_UDP -> "multilink"
+                TransportMode.ARQ_UDP -> "arq"
+                TransportMode.UDP -> "udp"
+            }
             prefs.edit().putString(KEY_TRANSPORT_MODE, mode).apply()
         }
 
+    var srtGroupMode: SrtGroupMode
+        get() = SrtGroupMode.fromValue(prefs.getInt(KEY_SRT_GROUP_MODE, SrtGroupMode.BROADCAST.value))
+        set(value) = prefs.edit().putInt(KEY_SRT_GROUP_MODE, value.value).apply()
+
     // Target Settings (used for both UDP and SRT)
     var srtHost: String
         get() = prefs.getString(KEY_SRT_HOST, DEFAULT_SRT_HOST) ?: DEFAULT_SRT_HOST
@@ -228,6 +248,7 @@ class SettingsRepository(context: Context) {
         val (width, height) = getResolutionSize()
         return StreamConfig(
             transport = transportMode,
+            srtGroupMode = srtGroupMode,
             srtHost = srtHost,
             srtPort = srtPort,
             streamId = streamId.takeIf { it.isNotBlank() },
@@ -2,12 +2,16 @@ package com.orbistream.streaming
 
 import android.content.Context
 import android.util.Log
+import java.io.Closeable
+import java.io.File
+import java.io.Serializable
 
 /**
  * NativeStreamer provides the Kotlin interface to the native GStreamer SRT streaming pipeline.
  * 
  * This class handles:
  * - Native library loading
+ * - Streaming sessions (see Session); the methods here drive a default one
  * - Pipeline creation and lifecycle
  * - Pushing video frames and audio samples
  * - Streaming statistics
@@ -26,6 +30,14 @@ object NativeStreamer {
         fun onStateChanged(running: Boolean, message: String)
         fun onStatsUpdated(bitrate: Double, bytesSent: Long, packetsLost: Long, rtt: Double, streamTimeMs: Long)
         fun onError(error: String)
+
+        /**
+         * Connection state as native code sees it (SrtConnectionState
+         * ordinal): BROKEN as soon as a pipeline fault is detected, CONNECTED
+         * once data flows again. onError follows only if in-place recovery
+         * gives up.
+         */
+        fun onConnectionStateChanged(state: Int, reason: String)
     }
 
     /**
@@ -80,12 +92,67 @@ object NativeStreamer {
         }
     }
 
+    /**
+     * Open an independent streaming session: its own pipeline, callback,
+     * sockets and stats. Sessions share GStreamer and one native main-loop
+     * thread. Close it when done.
+     *
+     * @return null if not initialized
+     */
+    fun createSession(): Session? {
+        if (!initialized) {
+            Log.e(TAG, "Cannot create session: not initialized")
+            return null
+        }
+        return Session(nativeCreateSession())
+    }
+
+    /**
+     * Session used by the NativeStreamer methods below, created by initialize().
+     */
+    private var defaultSession: Session? = null
+
+    private fun session(): Session? {
+        if (defaultSession == null && initialized) {
+            defaultSession = createSession()
+        }
+        return defaultSession
+    }
+
+    /**
+     * Hand the sockets for TransportMode.MULTILINK_UDP to native code before
+     * createPipeline(). Native code takes ownership of the FDs and closes the
+     * previous set.
+     *
+     * @param links interface name ("WIFI", "CELLULAR", ...) to bound UDP socket FD
+     */
+    fun setUdpLinks(links: List<Pair<String, Int>>) {
+        val session = session()
+        if (session == null) {
+            Log.e(TAG, "Cannot set UDP links: not initialized")
+            return
+        }
+        session.setUdpLinks(links)
+    }
+
+    /**
+     * Set the member links for TransportMode.SRT_BONDED before
+     * createPipeline(); replaces the previous set.
+     */
+    fun setSrtLinks(links: List<SrtLink>) {
+        val session = session()
+        if (session == null) {
+            Log.e(TAG, "Cannot set SRT links: not initialized")
+            return
+        }
+        session.setSrtLinks(links)
+    }
+
     /**
      * Set the callback for streaming events.
      */
     fun setCallback(callback: StreamCallback?) {
-        if (!libraryLoaded) return
-        nativeSetCallback(callback)
+        session()?.setCallback(callback)
     }
 
     /**
@@ -95,80 +162,37 @@ object NativeStreamer {
      * @return true if pipeline was created successfully
      */
     fun createPipeline(config: StreamConfig): Boolean {
-        if (!initialized) {
+        val session = session()
+        if (session == null) {
             Log.e(TAG, "Cannot create pipeline: not initialized")
             return false
         }
-
-        val transportName = if (config.transport == TransportMode.UDP) "UDP" else "SRT"
-        val protocol = if (config.transport == TransportMode.UDP) "udp" else "srt"
-        
-        Log.i(TAG, "=== Creating $transportName Pipeline ===")
-        Log.i(TAG, "Target: $protocol://${config.srtHost}:${config.srtPort}")
-        Log.i(TAG, "Stream ID: ${config.streamId ?: "(none)"}")
-        Log.i(TAG, "Video: ${config.videoWidth}x${config.videoHeight} @ ${config.frameRate}fps, ${config.videoBitrate/1000}kbps")
-        Log.i(TAG, "Audio: ${config.sampleRate}Hz, ${config.audioBitrate/1000}kbps")
-        if (config.transport == TransportMode.UDP && config.useProxy) {
-            Log.i(TAG, "Bondix: Enabled - reliability via bonded tunnel")
-        }
-
-        return nativeCreatePipeline(
-            config.srtHost,
-            config.srtPort,
-            config.streamId,
-            config.passphrase,
-            config.videoWidth,
-            config.videoHeight,
-            config.videoBitrate,
-            config.frameRate,
-            config.audioBitrate,
-            config.sampleRate,
-            config.proxyHost,
-            config.proxyPort,
-            config.useProxy,
-            config.transport.value,
-            config.encoderPreset.value,
-            config.keyframeInterval,
-            config.bFrames,
-            config.useHardwareEncoder
-        )
+        return session.createPipeline(config)
     }
 
     /**
      * Start streaming.
      */
     fun start(): Boolean {
-        if (!initialized) {
+        val session = session()
+        if (session == null) {
             Log.e(TAG, "Cannot start: not initialized")
             return false
         }
-        Log.i(TAG, "=== Starting SRT Stream ===")
-        val result = nativeStart()
-        if (result) {
-            Log.i(TAG, "Stream started successfully")
-        } else {
-            Log.e(TAG, "!!! Stream failed to start !!!")
-        }
-        return result
+        return session.start()
     }
 
     /**
      * Stop streaming.
      */
     fun stop() {
-        if (initialized) {
-            Log.i(TAG, "=== Stopping SRT Stream ===")
-            nativeStop()
-            Log.i(TAG, "Stream stopped")
-        }
+        defaultSession?.stop()
     }
 
     /**
      * Check if currently streaming.
      */
-    fun isStreaming(): Boolean {
-        return initialized && nativeIsStreaming()
-    }
+    fun isStreaming(): Boolean = defaultSession?.isStreaming() ?: false
 
     /**
      * Push a video frame to the streaming pipeline.
@@ -177,13 +201,29 @@ object NativeStreamer {
      * @param width Frame width
      * @param height Frame height
      * @param timestampNs Frame timestamp in nanoseconds
+     * @return false if the frame was refused because the encoder is behind
      */
-    fun pushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long) {
-        if (isStreaming()) {
-            nativePushVideoFrame(data, width, height, timestampNs)
-        }
+    fun pushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long): Boolean {
+        return defaultSession?.pushVideoFrame(data, width, height, timestampNs) ?: false
     }
 
+    /**
+     * Encode these parts of the frame at a different quality (e.g. a tracked
+     * face) from the next frame on. Needs StreamConfig.enableRoi and x264;
+     * the other encoders ignore them.
+     */
+    fun setRegionsOfInterest(regions: List<RoiRegion>) {
+        defaultSession?.setRegionsOfInterest(regions)
+    }
+
+    /**
+     * Ask the encoder for a keyframe now rather than at the next keyframe
+     * interval (e.g. a receiver joined). Reconnects do this by themselves.
+     *
+     * @return false if not streaming or streaming a file
+     */
+    fun requestKeyframe(): Boolean = defaultSession?.requestKeyframe() ?: false
+
     /**
      * Push audio samples to the streaming pipeline.
      * 
@@ -193,9 +233,7 @@ object NativeStreamer {
      * @param timestampNs Timestamp in nanoseconds
      */
     fun pushAudioSamples(data: ByteArray, sampleRate: Int, channels: Int, timestampNs: Long) {
-        if (isStreaming()) {
-            nativePushAudioSamples(data, sampleRate, channels, timestampNs)
-        }
+        defaultSession?.pushAudioSamples(data, sampleRate, channels, timestampNs)
     }
 
     /**
@@ -203,37 +241,106 @@ object NativeStreamer {
      * 
      * @return StreamStats or null if not streaming
      */
-    fun getStats(): StreamStats? {
-        if (!initialized) return null
-        
-        val stats = nativeGetStats() ?: return null
-        if (stats.size < 13) return null
-        
-        return StreamStats(
-            currentBitrate = stats[0],
-            bytesSent = stats[1].toLong(),
-            packetsLost = stats[2].toLong(),
-            rtt = stats[3],
-            streamTimeMs = stats[4].toLong(),
-            packetsRetransmitted = stats[5].toLong(),
-            packetsDropped = stats[6].toLong(),
-            bandwidth = stats[7].toLong(),
-            connectionState = SrtConnectionState.fromOrdinal(stats[8].toInt()),
-            inputFps = stats[9],
-            outputFps = stats[10],
-            framesDropped = stats[11].toLong(),
-            hardwareEncoderActive = stats[12] > 0.5
+    fun getStats(): StreamStats? = defaultSession?.getStats()
+
+    /**
+     * Write the per-second metrics history of the current or last stream
+     * (bitrate, RTT, loss, fps, queues, ABR decisions) to a compact binary
+     * file. tools/metrics_decode converts it to CSV.
+     *
+     * @return false if there is no history or the file can't be written
+     */
+    fun dumpMetricsHistory(file: File): Boolean {
+        return defaultSession?.dumpMetricsHistory(file) ?: false
+    }
+
+    /**
+     * Set a native log level at runtime. category is a native log tag
+     * ("SrtStreamer", "PacketPacer", ...), "*" for every tag without its own
+     * level, "gst" for GStreamer's default threshold or "gst:<name>" for one
+     * GStreamer debug category (e.g. "gst:x264enc"). Native logging is
+     * asynchronous; the default is INFO, GStreamer WARN.
+     */
+    fun setLogLevel(category: String, level: LogLevel) {
+        if (!libraryLoaded) return
+        nativeSetLogLevel(category, level.value)
+    }
+
+    /**
+     * Time spent in each GStreamer init phase of this process, and whether
+     * the plugin registry came from the cache kept in the app's cache dir.
+     * The hardware probe is filled in once a pipeline has asked for it.
+     */
+    fun getStartupReport(): StartupReport? {
+        if (!libraryLoaded) return null
+        val values = nativeGetStartupReport()
+        return StartupReport(
+            registryCacheHit = values[0] != 0L,
+            phaseUs = StartupPhase.entries.associateWith { values[1 + it.ordinal] }
+        )
+    }
+
+    /**
+     * Start or stop timeline tracing of the native pipeline (frames through
+     * the encoder, mux and send threads, stats and ABR). Starting clears
+     * what was captured before. Covers all sessions.
+     */
+    fun setTracing(enabled: Boolean) {
+        if (!libraryLoaded) return
+        Log.i(TAG, "Tracing ${if (enabled) "started" else "stopped"}")
+        nativeSetTracing(enabled)
+    }
+
+    /**
+     * Write the captured trace as Chrome trace JSON (open it in
+     * ui.perfetto.dev or chrome://tracing). Capture may still be running.
+     */
+    fun writeTrace(file: File): Boolean {
+        if (!libraryLoaded) return false
+        return nativeWriteTrace(file.absolutePath)
+    }
+
+    /**
+     * Find the best x264 operating point (preset, resolution, threads) that
+     * keeps up with targetFps on this device. The result is cached in
+     * cacheDir per build, so only the first launch after an install or
+     * update pays the few seconds it takes. Pipelines created afterwards
+     * with StreamConfig.useCalibration start from it. Blocks: call it off
+     * the main thread. Skipped (invalid result) while a session streams;
+     * a stream started meanwhile waits for it to finish.
+     */
+    fun calibrate(
+        cacheDir: File,
+        buildId: String,
+        targetFps: Int = 30,
+        maxWidth: Int = 1920,
+        maxHeight: Int = 1080,
+        videoBitrate: Int = 4_000_000
+    ): CalibrationResult? {
+        if (!libraryLoaded) return null
+        val v = nativeCalibrate(cacheDir.absolutePath, buildId, targetFps, maxWidth, maxHeight, videoBitrate)
+        val result = CalibrationResult(
+            valid = v[0] != 0.0,
+            fromCache = v[1] != 0.0,
+            preset = EncoderPreset.fromValue(v[2].toInt()),
+            width = v[3].toInt(),
+            height = v[4].toInt(),
+            encoderThreads = v[5].toInt(),
+            measuredFps = v[6],
+            trials = v[7].toInt(),
+            durationMs = v[8].toLong()
         )
+        Log.i(TAG, "Calibration: $result")
+        return result
     }
 
     /**
-     * Destroy the native streamer and free resources.
+     * Destroy the default session and free its resources. Sessions from
+     * createSession() are closed by their owners.
      */
     fun destroy() {
-        if (initialized) {
-            nativeDestroy()
-            initialized = false
-        }
+        defaultSession?.close()
+        defaultSession = null
     }
 
     /**
@@ -241,10 +348,318 @@ object NativeStreamer {
      */
     fun isAvailable(): Boolean = libraryLoaded
 
+    /**
+     * One native streamer. Stats, callbacks and sockets are per session;
+     * calls after close() are ignored.
+     */
+    class Session internal constructor(private var handle: Long) : Closeable {
+        val isOpen: Boolean get() = handle != 0L
+
+        // Links last passed to setSrtLinks; native link stats come in the same order
+        private var srtLinks: List<SrtLink> = emptyList()
+
+        fun setUdpLinks(links: List<Pair<String, Int>>) {
+            if (!isOpen) return
+            Log.i(TAG, "Multi-link UDP: ${links.joinToString { "${it.first} (fd ${it.second})" }}")
+            nativeSetUdpLinks(
+                handle,
+                links.map { it.second }.toIntArray(),
+                links.map { it.first }.toTypedArray()
+            )
+        }
+
+        fun setSrtLinks(links: List<SrtLink>) {
+            if (!isOpen) return
+            srtLinks = links
+            Log.i(TAG, "SRT group: ${links.joinToString { "${it.localAddress.ifEmpty { "any" }} -> ${it.host ?: "default"}" }}")
+            nativeSetSrtLinks(
+                handle,
+                links.map { it.localAddress }.toTypedArray(),
+                links.map { it.host ?: "" }.toTypedArray(),
+                links.map { it.port }.toIntArray(),
+                links.map { it.weight }.toIntArray()
+            )
+        }
+
+        fun setCallback(callback: StreamCallback?) {
+            if (isOpen) nativeSetCallback(handle, callback)
+        }
+
+        fun createPipeline(config: StreamConfig): Boolean {
+            if (!isOpen) return false
+
+            val transportName = when (config.transport) {
+                TransportMode.UDP -> "UDP"
+                TransportMode.SRT -> "SRT"
+                TransportMode.MULTILINK_UDP -> "Multi-link UDP"
+                TransportMode.ARQ_UDP -> "UDP with ARQ"
+                TransportMode.SRT_DIRECT -> "SRT (libsrt)"
+                TransportMode.SRT_BONDED -> "SRT bonded"
+            }
+            val protocol = if (config.transport.isSrt) "srt" else "udp"
+            
+            Log.i(TAG, "=== Creating $transportName Pipeline (session $handle) ===")
+            Log.i(TAG, "Target: $protocol://${config.srtHost}:${config.srtPort}")
+            Log.i(TAG, "Stream ID: ${config.streamId ?: "(none)"}")
+            config.sourceFile?.let {
+                Log.i(TAG, "Source: $it (passthrough${if (config.loopSource) ", looping" else ""})")
+            }
+            Log.i(TAG, "Video: ${config.videoWidth}x${config.videoHeight} @ ${config.frameRate}fps, ${config.videoBitrate/1000}kbps")
+            Log.i(TAG, "Audio: ${config.sampleRate}Hz, ${config.audioBitrate/1000}kbps")
+            if (config.transport == TransportMode.UDP && config.useProxy) {
+                Log.i(TAG, "Bondix: Enabled - reliability via bonded tunnel")
+            }
+
+            return nativeCreatePipeline(
+                handle,
+                config.srtHost,
+                config.srtPort,
+                config.streamId,
+                config.passphrase,
+                config.videoWidth,
+                config.videoHeight,
+                config.videoBitrate,
+                config.frameRate,
+                config.audioBitrate,
+                config.sampleRate,
+                config.proxyHost,
+                config.proxyPort,
+                config.useProxy,
+                config.transport.value,
+                config.encoderPreset.value,
+                config.keyframeInterval,
+                config.bFrames,
+                config.useHardwareEncoder,
+                config.rateControl.value,
+                config.vbvBufferMs,
+                config.crfQuality,
+                config.enableRoi,
+                config.sourceFile,
+                config.sourceAudio,
+                config.loopSource,
+                config.memoryBudgetBytes,
+                config.enableGovernor,
+                config.encoder.value,
+                config.muxer.value,
+                config.enablePacing,
+                config.pacingMultiplier,
+                config.pacingBurstPackets,
+                config.pacingMaxDelayMs,
+                config.useCalibration,
+                config.srtLatencyMs,
+                config.srtMaxBw,
+                config.srtInputBw,
+                config.srtOverheadPercent,
+                config.srtPayloadSize,
+                config.srtSendBufferBytes,
+                config.srtGroupMode.value
+            )
+        }
+
+        fun start(): Boolean {
+            if (!isOpen) return false
+            Log.i(TAG, "=== Starting Stream (session $handle) ===")
+            val result = nativeStart(handle)
+            if (result) {
+                Log.i(TAG, "Stream started successfully")
+            } else {
+                Log.e(TAG, "!!! Stream failed to start !!!")
+            }
+            return result
+        }
+
+        fun stop() {
+            if (isOpen) {
+                Log.i(TAG, "=== Stopping Stream (session $handle) ===")
+                nativeStop(handle)
+                Log.i(TAG, "Stream stopped")
+            }
+        }
+
+        fun isStreaming(): Boolean = isOpen && nativeIsStreaming(handle)
+
+        /** @return false if the frame was refused because the encoder is behind */
+        fun pushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long): Boolean {
+            return isOpen && nativePushVideoFrame(handle, data, width, height, timestampNs)
+        }
+
+        /** Regions for every following frame until replaced; empty clears them. */
+        fun setRegionsOfInterest(regions: List<RoiRegion>) {
+            if (!isOpen) return
+            val values = FloatArray(regions.size * 5)
+            regions.forEachIndexed { i, r ->
+                values[i * 5] = r.x
+                values[i * 5 + 1] = r.y
+                values[i * 5 + 2] = r.width
+                values[i * 5 + 3] = r.height
+                values[i * 5 + 4] = r.qpOffset.toFloat()
+            }
+            nativeSetRegionsOfInterest(handle, values)
+        }
+
+        fun requestKeyframe(): Boolean = isOpen && nativeRequestKeyframe(handle)
+
+        fun pushAudioSamples(data: ByteArray, sampleRate: Int, channels: Int, timestampNs: Long) {
+            if (isOpen) {
+                nativePushAudioSamples(handle, data, sampleRate, channels, timestampNs)
+            }
+        }
+
+        fun getStats(): StreamStats? {
+            if (!isOpen) return null
+            
+            val stats = nativeGetStats(handle) ?: return null
+            if (stats.size < 44) return null
+            
+            return StreamStats(
+                currentBitrate = stats[0],
+                bytesSent = stats[1].toLong(),
+                packetsLost = stats[2].toLong(),
+                rtt = stats[3],
+                streamTimeMs = stats[4].toLong(),
+                packetsRetransmitted = stats[5].toLong(),
+                packetsDropped = stats[6].toLong(),
+                bandwidth = stats[7].toLong(),
+                connectionState = SrtConnectionState.fromOrdinal(stats[8].toInt()),
+                inputFps = stats[9],
+                outputFps = stats[10],
+                framesDropped = stats[11].toLong(),
+                hardwareEncoderActive = stats[12] > 0.5,
+                faults = stats[13].toLong(),
+                recoveries = stats[14].toLong(),
+                lastDetectMs = stats[15],
+                lastRecoverMs = stats[16],
+                frameSizeMeanBytes = stats[17],
+                frameSizeStdDevBytes = stats[18],
+                frameSizeMaxBytes = stats[19].toLong(),
+                memoryBytes = stats[20].toLong(),
+                memoryPeakBytes = stats[21].toLong(),
+                budgetDrops = stats[22].toLong(),
+                memory = getMemoryUsage(),
+                packetsSent = stats[23].toLong(),
+                muxOverhead = stats[24],
+                transportOverhead = stats[25],
+                wireOverhead = stats[26],
+                byteLayers = getByteLayers(),
+                governorLevel = stats[27].toInt(),
+                governorMaxLevel = stats[28].toInt(),
+                operatingPoint = OperatingPoint(
+                    width = stats[29].toInt(),
+                    height = stats[30].toInt(),
+                    frameRate = stats[31].toInt(),
+                    presetSteps = stats[32].toInt()
+                ),
+                hottestC = stats[33],
+                thermalHeadroomC = stats[34],
+                freqCapRatio = stats[35],
+                encodeHeadroom = stats[36],
+                encoder = EncoderKind.fromValue(stats[37].toInt()),
+                encodeFrameMs = stats[38],
+                encodeFrameMaxMs = stats[39],
+                pacerQueueDepth = stats[40].toLong(),
+                pacerDelayMs = stats[41],
+                pacerMaxDelayMs = stats[42],
+                pacerDropped = stats[43].toLong(),
+                governorDecisions = getGovernorDecisions(),
+                srtLinks = getSrtLinks()
+            )
+        }
+
+        /** Buffered bytes per pipeline component, with limits when memoryBudgetBytes is set. */
+        fun getMemoryUsage(): List<MemoryUsage> {
+            if (!isOpen) return emptyList()
+            val values = nativeGetMemoryUsage(handle) ?: return emptyList()
+            return (0 until values.size / 4).map { i ->
+                MemoryUsage(
+                    component = MemoryComponent.fromValue(values[i * 4].toInt()),
+                    limitBytes = values[i * 4 + 1],
+                    currentBytes = values[i * 4 + 2],
+                    peakBytes = values[i * 4 + 3]
+                )
+            }
+        }
+
+        /** Bytes, packets and rates per layer, encoder output to wire. */
+        fun getByteLayers(): List<LayerBytes> {
+            if (!isOpen) return emptyList()
+            val values = nativeGetByteLayers(handle) ?: return emptyList()
+            return (0 until values.size / 5).map { i ->
+                LayerBytes(
+                    layer = ByteLayer.fromValue(values[i * 5].toInt()),
+                    bytes = values[i * 5 + 1].toLong(),
+                    packets = values[i * 5 + 2].toLong(),
+                    bitrate = values[i * 5 + 3],
+                    packetRate = values[i * 5 + 4]
+                )
+            }
+        }
+
+        /** Per-member state of an SRT_BONDED group, in setSrtLinks() order. */
+        fun getSrtLinks(): List<SrtLinkStats> {
+            if (!isOpen) return emptyList()
+            val values = nativeGetSrtLinks(handle) ?: return emptyList()
+            val links = srtLinks
+            return (0 until minOf(values.size / 7, links.size)).map { i ->
+                val v = i * 7
+                SrtLinkStats(
+                    link = links[i],
+                    weight = values[v].toInt(),
+                    state = SrtLinkState.fromValue(values[v + 1].toInt()),
+                    rttMs = values[v + 2],
+                    sendRateMbps = values[v + 3],
+                    packetsSent = values[v + 4].toLong(),
+                    packetsLost = values[v + 5].toLong(),
+                    packetsRetransmitted = values[v + 6].toLong()
+                )
+            }
+        }
+
+        /** Latest operating-point changes of the sustained-performance governor, oldest first. */
+        fun getGovernorDecisions(): List<GovernorDecision> {
+            if (!isOpen) return emptyList()
+            val values = nativeGetGovernorDecisions(handle) ?: return emptyList()
+            return (0 until values.size / 12).map { i ->
+                val v = i * 12
+                GovernorDecision(
+                    streamTimeMs = values[v].toLong(),
+                    fromLevel = values[v + 1].toInt(),
+                    toLevel = values[v + 2].toInt(),
+                    reason = GovernorReason.fromValue(values[v + 3].toInt()),
+                    point = OperatingPoint(
+                        width = values[v + 4].toInt(),
+                        height = values[v + 5].toInt(),
+                        frameRate = values[v + 6].toInt(),
+                        presetSteps = values[v + 7].toInt()
+                    ),
+                    hottestC = values[v + 8],
+                    thermalHeadroomC = values[v + 9],
+                    freqCapRatio = values[v + 10],
+                    encodeHeadroom = values[v + 11]
+                )
+            }
+        }
+
+        fun dumpMetricsHistory(file: File): Boolean {
+            return isOpen && nativeDumpMetrics(handle, file.absolutePath)
+        }
+
+        /** Stop streaming and free the native session. */
+        override fun close() {
+            if (isOpen) {
+                nativeDestroySession(handle)
+                handle = 0L
+            }
+        }
+    }
+
     // Native methods
     private external fun nativeInit()
-    private external fun nativeSetCallback(callback: StreamCallback?)
+    private external fun nativeCreateSession(): Long
+    private external fun nativeDestroySession(handle: Long)
+    private external fun nativeSetCallback(handle: Long, callback: StreamCallback?)
+    private external fun nativeSetUdpLinks(handle: Long, fds: IntArray, names: Array<String>)
     private external fun nativeCreatePipeline(
+        handle: Long,
         srtHost: String,
         srtPort: Int,
         streamId: String?,
@@ -258,19 +673,61 @@ object NativeStreamer {
         proxyHost: String?,
         proxyPort: Int,
         useProxy: Boolean,
-        transportMode: Int,       // 0 = UDP, 1 = SRT
+        transportMode: Int,       // 0 = UDP, 1 = SRT, 2 = multi-link UDP, 3 = UDP with ARQ
         encoderPreset: Int,       // 0 = ultrafast ... 8 = veryslow
         keyframeInterval: Int,    // Keyframe every N seconds
         bFrames: Int,             // B-frames (0 for low latency)
-        useHardwareEncoder: Boolean  // Use hardware encoder if available
+        useHardwareEncoder: Boolean,  // Use hardware encoder if available
+        rateControl: Int,         // 0 = CBR, 1 = capped VBR, 2 = constant quality
+        vbvBufferMs: Int,         // 0 = profile default
+        crfQuality: Int,
+        enableRoi: Boolean,
+        sourceFile: String?,      // Stream this file instead of camera/microphone
+        sourceAudio: Boolean,
+        loopSource: Boolean,
+        memoryBudgetBytes: Long,  // 0 = queues bounded by count only
+        enableGovernor: Boolean,  // Step fps/resolution/preset down when the device throttles
+        encoderKind: Int,         // 0 = auto, 1 = x264, 2 = MediaCodec, 3 = openh264
+        muxerMode: Int,           // 0 = mpegtsmux, 1 = native TsMuxer
+        enablePacing: Boolean,
+        pacingMultiplier: Double,
+        pacingBurstPackets: Int,
+        pacingMaxDelayMs: Int,
+        useCalibration: Boolean,  // Start from the calibrated operating point (x264)
+        srtLatencyMs: Int,
+        srtMaxBw: Long,
+        srtInputBw: Long,
+        srtOverheadPercent: Int,
+        srtPayloadSize: Int,
+        srtSendBufferBytes: Int,
+        srtGroupMode: Int         // 0 = broadcast, 1 = backup
     ): Boolean
-    private external fun nativeStart(): Boolean
-    private external fun nativeStop()
-    private external fun nativeIsStreaming(): Boolean
-    private external fun nativePushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long)
-    private external fun nativePushAudioSamples(data: ByteArray, sampleRate: Int, channels: Int, timestampNs: Long)
-    private external fun nativeGetStats(): DoubleArray?
-    private external fun nativeDestroy()
+    private external fun nativeStart(handle: Long): Boolean
+    private external fun nativeStop(handle: Long)
+    private external fun nativeIsStreaming(handle: Long): Boolean
+    private external fun nativePushVideoFrame(handle: Long, data: ByteArray, width: Int, height: Int, timestampNs: Long): Boolean
+    private external fun nativePushAudioSamples(handle: Long, data: ByteArray, sampleRate: Int, channels: Int, timestampNs: Long)
+    private external fun nativeGetStats(handle: Long): DoubleArray?
+    private external fun nativeGetMemoryUsage(handle: Long): LongArray?
+    private external fun nativeGetByteLayers(handle: Long): DoubleArray?
+    private external fun nativeGetGovernorDecisions(handle: Long): DoubleArray?
+    private external fun nativeSetSrtLinks(handle: Long, localAddresses: Array<String>, hosts: Array<String>, ports: IntArray, weights: IntArray)
+    private external fun nativeGetSrtLinks(handle: Long): DoubleArray?
+    private external fun nativeSetRegionsOfInterest(handle: Long, regions: FloatArray?)
+    private external fun nativeRequestKeyframe(handle: Long): Boolean
+    private external fun nativeDumpMetrics(handle: Long, path: String): Boolean
+    private external fun nativeSetLogLevel(category: String, level: Int)
+    private external fun nativeGetStartupReport(): LongArray
+    private external fun nativeSetTracing(enabled: Boolean)
+    private external fun nativeWriteTrace(path: String): Boolean
+    private external fun nativeCalibrate(
+        cacheDir: String,
+        buildId: String,
+        targetFps: Int,
+        maxWidth: Int,
+        maxHeight: Int,
+        videoBitrate: Int
+    ): DoubleArray
 }
 
 /**
@@ -278,10 +735,42 @@ object NativeStreamer {
  * 
  * - UDP: Plain UDP MPEG-TS (use with Bondix - Bondix provides reliability)
  * - SRT: SRT protocol with built-in retransmission (use when NOT using Bondix)
+ * - MULTILINK_UDP: native per-packet scheduling over one socket per network
+ *   (see NativeStreamer.setUdpLinks), reordered by tools/multilink_receiver
+ * - ARQ_UDP: sequenced UDP with selective retransmission within a latency
+ *   budget, received by tools/arq_receiver
  */
 enum class TransportMode(val value: Int) {
     UDP(0),  // Plain UDP - relies on Bondix for reliability
-    SRT(1)   // SRT protocol - has its own retransmission
+    SRT(1),  // SRT protocol - has its own retransmission
+    MULTILINK_UDP(2),  // Native multi-link UDP, no Bondix
+    ARQ_UDP(3),        // UDP with NAK-driven resends, no Bondix
+    SRT_DIRECT(4),     // SRT through libsrt directly (srt* options below), no srtsink
+    SRT_BONDED(5);     // SRT socket group over the links from setSrtLinks()
+
+    /** Any of the SRT transports (srt:// target). */
+    val isSrt: Boolean get() = this == SRT || this == SRT_DIRECT || this == SRT_BONDED
+
+    companion object {
+        fun fromValue(value: Int): TransportMode =
+            entries.firstOrNull { it.value == value } ?: UDP
+    }
+}
+
+/**
+ * MPEG-TS muxer.
+ *
+ * - MPEGTSMUX: GStreamer mpegtsmux (interleaves audio and video, adds buffering)
+ * - NATIVE: native packetizer, each access unit leaves as soon as it is encoded
+ */
+enum class MuxerMode(val value: Int) {
+    MPEGTSMUX(0),
+    NATIVE(1);
+
+    companion object {
+        fun fromValue(value: Int): MuxerMode =
+            entries.firstOrNull { it.value == value } ?: MPEGTSMUX
+    }
 }
 
 /**
@@ -305,7 +794,261 @@ enum class EncoderPreset(val value: Int) {
 }
 
 /**
- * Streaming configuration.
+ * Video encoder (same order as the native EncoderKind).
+ *
+ * - AUTO: MediaCodec when useHardwareEncoder is set and the device has one, else x264
+ * - X264: software; presets, VBV, constant quality and regions of interest
+ * - MEDIACODEC: hardware; bitrate and keyframe interval only
+ * - OPENH264: software Baseline encoder
+ *
+ * The app's native build links only x264: MEDIACODEC and OPENH264 fall back
+ * to x264 (logged), and AUTO always resolves to x264, whatever
+ * useHardwareEncoder says. They need the androidmedia / openh264 GStreamer
+ * plugins added to Android.mk.
+ */
+enum class EncoderKind(val value: Int) {
+    AUTO(0),
+    X264(1),
+    MEDIACODEC(2),
+    OPENH264(3);
+
+    companion object {
+        fun fromValue(value: Int): EncoderKind =
+            entries.firstOrNull { it.value == value } ?: AUTO
+    }
+}
+
+/**
+ * Encoder rate control profile (x264; the other encoders only take the bitrate).
+ *
+ * - CBR: every frame sized to the bitrate, VBV of one frame interval
+ * - CAPPED_VBR: bitrate as average and peak over the VBV, frames may borrow
+ * - CONSTANT_QUALITY: CRF at crfQuality, bitrate as a ceiling
+ */
+enum class RateControl(val value: Int) {
+    CBR(0),
+    CAPPED_VBR(1),
+    CONSTANT_QUALITY(2);
+
+    companion object {
+        fun fromValue(value: Int): RateControl =
+            entries.firstOrNull { it.value == value } ?: CAPPED_VBR
+    }
+}
+
+/**
+ * Part of the frame to encode at a different quality. Coordinates are
+ * fractions of the frame (0..1); qpOffset is added to the encoder's QP,
+ * negative for sharper, positive for softer.
+ */
+data class RoiRegion(
+    val x: Float,
+    val y: Float,
+    val width: Float,
+    val height: Float,
+    val qpOffset: Int
+)
+
+/**
+ * Pipeline stage holding buffered data (same order as the native MemoryComponent).
+ */
+enum class MemoryComponent(val value: Int) {
+    VIDEO_INGEST(0),   // Raw frames not yet encoded
+    AUDIO_INGEST(1),   // PCM waiting for the encoder
+    VIDEO_QUEUE(2),    // Encoded video before the muxer
+    AUDIO_QUEUE(3),    // Encoded audio before the muxer
+    TS_QUEUE(4),       // TS datagrams before the sink
+    PACER(5),          // Paced datagrams
+    RETRANSMIT(6);     // ARQ ring or SRT send buffers
+
+    companion object {
+        fun fromValue(value: Int): MemoryComponent =
+            entries.firstOrNull { it.value == value } ?: VIDEO_INGEST
+    }
+}
+
+/**
+ * Bytes one component holds; limitBytes is 0 without a memory budget.
+ */
+data class MemoryUsage(
+    val component: MemoryComponent,
+    val limitBytes: Long,
+    val currentBytes: Long,
+    val peakBytes: Long
+)
+
+/**
+ * Layer a stream byte passes through (same order as the native ByteLayer).
+ */
+enum class ByteLayer(val value: Int) {
+    VIDEO_ES(0),     // Encoder output; packets = access units
+    AUDIO_ES(1),     // AAC output; packets = AAC frames
+    TS(2),           // Muxer output; packets = 188-byte TS packets
+    TRANSPORT(3),    // Handed to sockets: protocol headers, resends, SOCKS5; packets = datagrams
+    WIRE(4);         // TRANSPORT plus IP and UDP headers
+
+    companion object {
+        fun fromValue(value: Int): ByteLayer =
+            entries.firstOrNull { it.value == value } ?: VIDEO_ES
+    }
+}
+
+/**
+ * Totals since start and rates over the last second for one layer.
+ */
+data class LayerBytes(
+    val layer: ByteLayer,
+    val bytes: Long,
+    val packets: Long,
+    val bitrate: Double,       // bps
+    val packetRate: Double     // Packets per second
+)
+
+/**
+ * Encoder operating point; presetSteps counts x264 presets faster than the configured one.
+ */
+data class OperatingPoint(
+    val width: Int = 0,
+    val height: Int = 0,
+    val frameRate: Int = 0,
+    val presetSteps: Int = 0
+)
+
+/**
+ * Why the governor changed the operating point (same order as the native GovernorReason).
+ */
+enum class GovernorReason(val value: Int) {
+    NONE(0),
+    THERMAL(1),          // A thermal zone near its passive trip point
+    CPU_FREQ_CAP(2),     // Kernel capped CPU frequencies
+    ENCODE_HEADROOM(3),  // Encoder close to missing frames
+    RECOVERED(4);        // Calm for the hold time: one step back up
+
+    companion object {
+        fun fromValue(value: Int): GovernorReason =
+            entries.firstOrNull { it.value == value } ?: NONE
+    }
+}
+
+/**
+ * One governor level change, with the readings that caused it.
+ */
+data class GovernorDecision(
+    val streamTimeMs: Long,
+    val fromLevel: Int,
+    val toLevel: Int,
+    val reason: GovernorReason,
+    val point: OperatingPoint,     // In effect after the change
+    val hottestC: Double,
+    val thermalHeadroomC: Double,  // Closest zone to its step-down limit
+    val freqCapRatio: Double,      // 1 = uncapped
+    val encodeHeadroom: Double     // 0..1
+)
+
+/**
+ * How an SRT_BONDED group uses its links (same values as the native SrtGroupMode).
+ */
+enum class SrtGroupMode(val value: Int) {
+    BROADCAST(0),  // Every packet on every link; the receiver keeps the first copy
+    BACKUP(1);     // One active link, the others on standby (higher weight preferred)
+
+    companion object {
+        fun fromValue(value: Int): SrtGroupMode =
+            entries.firstOrNull { it.value == value } ?: BROADCAST
+    }
+}
+
+/**
+ * One member link of an SRT_BONDED group.
+ */
+data class SrtLink(
+    val localAddress: String = "",  // Source address to bind (selects the network), empty = any
+    val host: String? = null,       // null = StreamConfig.srtHost
+    val port: Int = 0,              // 0 = StreamConfig.srtPort
+    val weight: Int = 0             // BACKUP: priority, higher is preferred
+)
+
+/**
+ * State of one bonded link (same order as the native SrtLinkState).
+ */
+enum class SrtLinkState(val value: Int) {
+    PENDING(0),  // Connecting
+    IDLE(1),     // Connected, standby (BACKUP)
+    ACTIVE(2),   // Connected and sending
+    BROKEN(3);   // Down; reconnect pending
+
+    companion object {
+        fun fromValue(value: Int): SrtLinkState =
+            entries.firstOrNull { it.value == value } ?: BROKEN
+    }
+}
+
+/**
+ * Stats of one bonded link; counters restart when the link reconnects.
+ */
+data class SrtLinkStats(
+    val link: SrtLink,
+    val weight: Int,
+    val state: SrtLinkState,
+    val rttMs: Double,
+    val sendRateMbps: Double,
+    val packetsSent: Long,
+    val packetsLost: Long,
+    val packetsRetransmitted: Long
+)
+
+/**
+ * Native log level (same values as the native logger::Level).
+ */
+enum class LogLevel(val value: Int) {
+    NONE(0),
+    ERROR(1),
+    WARN(2),
+    INFO(3),
+    DEBUG(4),
+    VERBOSE(5)
+}
+
+/**
+ * GStreamer init phase (same order as the native StartupPhase).
+ */
+enum class StartupPhase {
+    ENVIRONMENT,       // App paths and environment variables
+    REGISTRY_CACHE,    // Registry cache validation
+    GST_INIT,          // gst_init: registry load or rescan
+    PLUGIN_CHECK,      // Required plugins present
+    HARDWARE_PROBE     // Hardware encoder lookup (first pipeline)
+}
+
+/**
+ * Init time per phase in microseconds.
+ */
+data class StartupReport(
+    val registryCacheHit: Boolean,
+    val phaseUs: Map<StartupPhase, Long>
+) {
+    val totalUs: Long get() = phaseUs.values.sum()
+}
+
+/**
+ * Highest x264 operating point that sustained the target fps during
+ * calibration. valid is false if none did (the device keeps its defaults).
+ */
+data class CalibrationResult(
+    val valid: Boolean,
+    val fromCache: Boolean,
+    val preset: EncoderPreset,
+    val width: Int,
+    val height: Int,
+    val encoderThreads: Int,
+    val measuredFps: Double,
+    val trials: Int,
+    val durationMs: Long
+)
+
+/**
+ * Streaming configuration. Serializable so StreamingService receives all of
+ * it in one intent extra.
  */
 data class StreamConfig(
     val transport: TransportMode = TransportMode.UDP,  // Default to UDP for Bondix
@@ -326,8 +1069,42 @@ data class StreamConfig(
     val encoderPreset: EncoderPreset = EncoderPreset.ULTRAFAST,
     val keyframeInterval: Int = 2,  // Keyframe every N seconds
     val bFrames: Int = 0,           // B-frames (0 for low latency)
-    val useHardwareEncoder: Boolean = true  // Use hardware encoder if available
-)
+    val useHardwareEncoder: Boolean = true,  // Use hardware encoder if available
+    // SRT socket options (SRT_DIRECT; srtsink in SRT mode only takes the latency)
+    val srtLatencyMs: Int = 500,         // SRTO_LATENCY
+    val srtMaxBw: Long = 0,              // SRTO_MAXBW bytes/s: 0 = input + overhead, -1 = unlimited
+    val srtInputBw: Long = 0,            // SRTO_INPUTBW bytes/s: 0 = estimated
+    val srtOverheadPercent: Int = 25,    // SRTO_OHEADBW
+    val srtPayloadSize: Int = 1316,      // SRTO_PAYLOADSIZE (7 TS packets)
+    val srtSendBufferBytes: Int = 0,     // SRTO_SNDBUF, 0 = libsrt default
+    val srtGroupMode: SrtGroupMode = SrtGroupMode.BROADCAST,  // SRT_BONDED
+    val encoder: EncoderKind = EncoderKind.AUTO,  // AUTO follows useHardwareEncoder
+    val rateControl: RateControl = RateControl.CAPPED_VBR,
+    val vbvBufferMs: Int = 0,       // 0 = profile default (one frame interval for CBR, 600 ms otherwise)
+    val crfQuality: Int = 23,       // CONSTANT_QUALITY: x264 CRF, lower is better
+    val enableRoi: Boolean = false, // Needed for setRegionsOfInterest with x264 (turns on adaptive quantisation)
+    val muxer: MuxerMode = MuxerMode.MPEGTSMUX,
+    // Output pacing: spread each frame's datagrams over the frame interval at
+    // pacingMultiplier x the ABR target instead of sending them back to back
+    val enablePacing: Boolean = false,
+    val pacingMultiplier: Double = 2.0,
+    val pacingBurstPackets: Int = 4,     // Datagrams allowed back to back
+    val pacingMaxDelayMs: Int = 500,     // Drop datagrams queued longer than this
+    // Pre-encoded source: stream an MP4/TS file's H.264/AAC unchanged instead of
+    // camera and microphone (no encoder, no ABR); videoBitrate should match the file
+    val sourceFile: String? = null,
+    val sourceAudio: Boolean = true,  // File has an AAC track
+    val loopSource: Boolean = true,
+    // Bytes the pipeline may buffer, split over ingest, queues, pacer and
+    // retransmit buffers; 0 = queues bounded by buffer count only
+    val memoryBudgetBytes: Long = 0,
+    // Step fps, resolution and x264 preset down as the phone heats up or
+    // throttles, and back up once it recovers (camera sources only)
+    val enableGovernor: Boolean = true,
+    // Cap x264 preset, resolution and threads at the point found by
+    // NativeStreamer.calibrate() (no effect before it has run)
+    val useCalibration: Boolean = true
+) : Serializable
 
 /**
  * SRT connection state.
@@ -361,7 +1138,46 @@ data class StreamStats(
     val inputFps: Double = 0.0,           // Frames received from camera per second
     val outputFps: Double = 0.0,          // Frames encoded per second  
     val framesDropped: Long = 0,          // Total frames dropped (input - output)
-    val hardwareEncoderActive: Boolean = false  // True if using hardware encoder
+    val hardwareEncoderActive: Boolean = false,  // True if using hardware encoder
+    val encoder: EncoderKind = EncoderKind.AUTO,  // Encoder in use (AUTO: none, file source)
+    val encodeFrameMs: Double = 0.0,      // Time in the encoder per frame, mean over the last second
+    val encodeFrameMaxMs: Double = 0.0,   // ... worst over the last second
+    // Output pacing (StreamConfig.enablePacing)
+    val pacerQueueDepth: Long = 0,        // Datagrams waiting in the pacer
+    val pacerDelayMs: Double = 0.0,       // Average queueing delay added by pacing
+    val pacerMaxDelayMs: Double = 0.0,    // Worst queueing delay since start
+    val pacerDropped: Long = 0,           // Datagrams dropped (overflow or expired)
+    // Fault detection and in-place recovery
+    val faults: Long = 0,                 // Faults detected since the stream started
+    val recoveries: Long = 0,             // Faults recovered without rebuilding the pipeline
+    val lastDetectMs: Double = 0.0,       // Last data out to fault detected
+    val lastRecoverMs: Double = 0.0,      // Fault detected to data flowing again
+    // Encoded frame sizes over the last second (rate-control check)
+    val frameSizeMeanBytes: Double = 0.0,
+    val frameSizeStdDevBytes: Double = 0.0,
+    val frameSizeMaxBytes: Long = 0,
+    // Buffered data (see StreamConfig.memoryBudgetBytes)
+    val memoryBytes: Long = 0,
+    val memoryPeakBytes: Long = 0,
+    val budgetDrops: Long = 0,            // Buffers dropped to stay within the budget
+    val memory: List<MemoryUsage> = emptyList(),
+    // Bytes per layer and the overhead each step adds (bytes out per byte in)
+    val packetsSent: Long = 0,            // Datagrams sent, resends included
+    val muxOverhead: Double = 0.0,        // TS / elementary streams
+    val transportOverhead: Double = 0.0,  // Transport / TS
+    val wireOverhead: Double = 0.0,       // Wire / elementary streams
+    val byteLayers: List<LayerBytes> = emptyList(),
+    // Sustained-performance governor (StreamConfig.enableGovernor)
+    val governorLevel: Int = 0,           // Steps below the configured operating point
+    val governorMaxLevel: Int = 0,
+    val operatingPoint: OperatingPoint = OperatingPoint(),
+    val hottestC: Double = 0.0,
+    val thermalHeadroomC: Double = 0.0,   // Closest zone to its step-down limit
+    val freqCapRatio: Double = 1.0,       // CPU max frequency cap, 1 = uncapped
+    val encodeHeadroom: Double = 1.0,     // 0..1
+    val governorDecisions: List<GovernorDecision> = emptyList(),
+    // SRT_BONDED members
+    val srtLinks: List<SrtLinkStats> = emptyList()
 ) {
     /**
      * Get bitrate in Mbps.
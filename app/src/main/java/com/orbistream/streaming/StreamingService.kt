@@ -15,11 +15,14 @@ import androidx.core.app.NotificationCompat
 import com.orbistream.OrbiStreamApp
 import com.orbistream.R
 import com.orbistream.bondix.BondixManager
+import com.orbistream.bondix.NetworkRegistry
+import com.orbistream.bondix.SocketBinder
 import com.orbistream.bondix.Socks5UdpRelay
 import com.orbistream.ui.StreamingActivity
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
+import java.io.File
 
 /**
  * StreamingService runs as a foreground service to manage the streaming session.
@@ -37,10 +40,16 @@ class StreamingService : Service() {
         private const val MAX_RECONNECT_ATTEMPTS = 10
         private const val INITIAL_RECONNECT_DELAY_MS = 1000L
         private const val MAX_RECONNECT_DELAY_MS = 30000L
+        
+        // Metrics history files kept in filesDir/metrics
+        private const val METRICS_FILES_KEPT = 10
 
         const val ACTION_START = "com.orbistream.action.START"
         const val ACTION_STOP = "com.orbistream.action.STOP"
+        const val ACTION_TRACE_START = "com.orbistream.action.TRACE_START"
+        const val ACTION_TRACE_STOP = "com.orbistream.action.TRACE_STOP"   // Writes filesDir/traces/*.json
         
+        const val EXTRA_CONFIG = "config"           // Whole StreamConfig; the extras below are the fallback
         const val EXTRA_TRANSPORT_MODE = "transport_mode"
         const val EXTRA_SRT_HOST = "srt_host"
         const val EXTRA_SRT_PORT = "srt_port"
@@ -98,6 +107,8 @@ class StreamingService : Service() {
             ACTION_STOP -> {
                 stopStreaming()
             }
+            ACTION_TRACE_START -> NativeStreamer.setTracing(true)
+            ACTION_TRACE_STOP -> writeTrace()
         }
         return START_NOT_STICKY
     }
@@ -111,9 +122,18 @@ class StreamingService : Service() {
     }
 
     private fun extractConfig(intent: Intent): StreamConfig {
-        // Get transport mode - 0 = UDP, 1 = SRT
+        val config = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            intent.getSerializableExtra(EXTRA_CONFIG, StreamConfig::class.java)
+        } else {
+            @Suppress("DEPRECATION")
+            intent.getSerializableExtra(EXTRA_CONFIG) as? StreamConfig
+        }
+        if (config != null) return config
+        
+        // Started without EXTRA_CONFIG (e.g. from adb): basic settings only
+        // Get transport mode - 0 = UDP, 1 = SRT, 2 = multi-link UDP, 3 = UDP with ARQ, 4 = SRT via libsrt, 5 = bonded SRT
         val transportOrdinal = intent.getIntExtra(EXTRA_TRANSPORT_MODE, 0)
-        val transport = if (transportOrdinal == 1) TransportMode.SRT else TransportMode.UDP
+        val transport = TransportMode.fromValue(transportOrdinal)
         
         // Get encoder preset
         val presetOrdinal = intent.getIntExtra(EXTRA_ENCODER_PRESET, 0)
@@ -152,6 +172,9 @@ class StreamingService : Service() {
         // Use transport mode from config (which comes from settings)
         val isUdpMode = config.transport == TransportMode.UDP
         val isSrtMode = config.transport == TransportMode.SRT
+        val isMultiLinkMode = config.transport == TransportMode.MULTILINK_UDP
+        val isArqMode = config.transport == TransportMode.ARQ_UDP
+        val isSrtBondedMode = config.transport == TransportMode.SRT_BONDED
         
         // Check if we should use Bondix relay:
         // - UDP mode always uses Bondix if available
@@ -160,6 +183,9 @@ class StreamingService : Service() {
         val useBondixRelay = bondixAvailable && (isUdpMode || (isSrtMode && bondixForSrt))
         
         val protocol = when {
+            isMultiLinkMode -> "UDP (native multi-link)"
+            isArqMode -> "UDP with ARQ (direct)"
+            isSrtBondedMode -> "SRT (bonded group, ${config.srtGroupMode.name.lowercase()})"
             isUdpMode && bondixAvailable -> "UDP (via Bondix)"
             isUdpMode -> "UDP (direct - Bondix not available)"
             isSrtMode && useBondixRelay -> "SRT (via Bondix)"
@@ -175,7 +201,30 @@ class StreamingService : Service() {
         Log.i(TAG, "Bondix for SRT: ${if (bondixForSrt) "enabled" else "disabled"}")
         Log.i(TAG, "========================================")
         
-        if (useBondixRelay) {
+        if (isMultiLinkMode) {
+            // One socket per network; the native scheduler replaces Bondix
+            val links = NetworkRegistry.getAvailableInterfaceIds().mapNotNull { id ->
+                val fd = SocketBinder.openBoundUdpSocket(id)
+                if (fd >= 0) id to fd else null
+            }
+            if (links.isEmpty()) {
+                Log.e(TAG, "Multi-link UDP selected but no network could be bound")
+            }
+            NativeStreamer.setUdpLinks(links)
+            continueStartStreaming(config)
+        } else if (isSrtBondedMode) {
+            // One group member per network, bound by its source address
+            val links = NetworkRegistry.getAvailableInterfaceIds().mapNotNull { id ->
+                NetworkRegistry.getLocalAddress(id)?.let { address ->
+                    SrtLink(localAddress = address, weight = if (id == "WIFI") 1 else 0)
+                }
+            }
+            if (links.isEmpty()) {
+                Log.e(TAG, "Bonded SRT selected but no network has an address")
+            }
+            NativeStreamer.setSrtLinks(links)
+            continueStartStreaming(config)
+        } else if (useBondixRelay) {
             val transportType = if (isSrtMode) "SRT" else "UDP"
             Log.i(TAG, "Using $transportType transport via Bondix bonded tunnel")
             
@@ -187,6 +236,8 @@ class StreamingService : Service() {
         } else {
             if (isUdpMode) {
                 Log.w(TAG, "UDP mode selected but Bondix not available - streaming UDP directly")
+            } else if (isArqMode) {
+                Log.i(TAG, "ARQ mode selected - streaming directly, retransmissions handled natively")
             } else {
                 Log.i(TAG, "SRT mode selected - streaming directly (Bondix bypass)")
             }
@@ -266,6 +317,12 @@ class StreamingService : Service() {
                 }
             }
 
+            override fun onConnectionStateChanged(state: Int, reason: String) {
+                serviceScope.launch {
+                    onNativeConnectionState(SrtConnectionState.fromOrdinal(state), reason)
+                }
+            }
+
             override fun onError(error: String) {
                 Log.e(TAG, "!!! STREAMING ERROR !!!")
                 Log.e(TAG, "Error: $error")
@@ -307,6 +364,7 @@ class StreamingService : Service() {
     private fun stopStreaming() {
         statsJob?.cancel()
         NativeStreamer.stop()
+        dumpMetricsHistory("stop")
         
         // Stop UDP relay if running
         udpRelay?.let {
@@ -320,6 +378,33 @@ class StreamingService : Service() {
         stopSelf()
     }
 
+    /**
+     * Keep the metrics history of the stream that just ended (the next
+     * createPipeline() starts a new one). The newest METRICS_FILES_KEPT stay.
+     */
+    private fun dumpMetricsHistory(reason: String) {
+        val dir = File(filesDir, "metrics")
+        if (!dir.isDirectory && !dir.mkdirs()) return
+        val file = File(dir, "metrics-${System.currentTimeMillis()}-$reason.osmh")
+        if (NativeStreamer.dumpMetricsHistory(file)) {
+            Log.i(TAG, "Metrics history written to ${file.absolutePath}")
+        }
+        dir.listFiles { f -> f.name.endsWith(".osmh") }
+            ?.sortedByDescending { it.lastModified() }
+            ?.drop(METRICS_FILES_KEPT)
+            ?.forEach { it.delete() }
+    }
+
+    private fun writeTrace() {
+        NativeStreamer.setTracing(false)
+        val dir = File(filesDir, "traces")
+        if (!dir.isDirectory && !dir.mkdirs()) return
+        val file = File(dir, "trace-${System.currentTimeMillis()}.json")
+        if (NativeStreamer.writeTrace(file)) {
+            Log.i(TAG, "Trace written to ${file.absolutePath}")
+        }
+    }
+
     private fun startStatsPolling() {
         statsJob?.cancel()
         statsJob = serviceScope.launch {
@@ -340,12 +425,31 @@ class StreamingService : Service() {
         }
     }
     
-    private fun checkConnectionState(state: SrtConnectionState) {
-        // Detect transition to BROKEN state
-        if (state == SrtConnectionState.BROKEN && lastConnectionState == SrtConnectionState.CONNECTED) {
-            Log.w(TAG, "SRT connection BROKEN - initiating auto-reconnect")
-            triggerReconnect()
+    /**
+     * Pushed by native code as faults happen. Native code restarts the
+     * pipeline itself; a rebuild (triggerReconnect) only follows its onError.
+     */
+    private fun onNativeConnectionState(state: SrtConnectionState, reason: String) {
+        when (state) {
+            SrtConnectionState.BROKEN -> {
+                Log.w(TAG, "Connection BROKEN ($reason) - native recovery running")
+                if (_streamState.value == StreamState.STREAMING) {
+                    _streamState.value = StreamState.RECONNECTING
+                }
+            }
+            SrtConnectionState.CONNECTED -> {
+                Log.i(TAG, "Connection restored: $reason")
+                if (_streamState.value == StreamState.RECONNECTING && !isReconnecting) {
+                    _streamState.value = StreamState.STREAMING
+                }
+            }
+            else -> {}
         }
+        checkConnectionState(state)
+    }
+
+    private fun checkConnectionState(state: SrtConnectionState) {
+        // BROKEN is handled natively (onNativeConnectionState / onError), not by polling
         
         // Reset reconnect attempts on successful connection
         if (state == SrtConnectionState.CONNECTED && lastConnectionState != SrtConnectionState.CONNECTED) {
@@ -416,10 +520,8 @@ class StreamingService : Service() {
             
             // Stop current stream
             Log.i(TAG, "Stopping current stream for reconnect...")
-            NativeStreamer.stop()
-            
-            // Wait a bit for cleanup
-            delay(500)
+            NativeStreamer.stop()   // Synchronous: the pipeline is down when it returns
+            dumpMetricsHistory("reconnect")
             
             // Restart the stream
             Log.i(TAG, "Restarting stream...")
@@ -499,11 +601,12 @@ class StreamingService : Service() {
 
     /**
      * Push a video frame to the stream.
+     *
+     * @return false if the frame was not taken (not streaming, or refused at ingest)
      */
-    fun pushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long) {
-        if (_streamState.value == StreamState.STREAMING) {
+    fun pushVideoFrame(data: ByteArray, width: Int, height: Int, timestampNs: Long): Boolean {
+        return _streamState.value == StreamState.STREAMING &&
             NativeStreamer.pushVideoFrame(data, width, height, timestampNs)
-        }
     }
 
     /**
@@ -9,11 +9,12 @@ import com.orbistream.R
 import com.orbistream.databinding.ActivitySettingsBinding
 import com.orbistream.data.SettingsRepository
 import com.orbistream.streaming.EncoderPreset
+import com.orbistream.streaming.SrtGroupMode
 import com.orbistream.streaming.TransportMode
 
 /**
  * SettingsActivity allows users to configure:
- * - Transport mode (UDP or SRT)
+ * - Transport mode (UDP or SRT, and the variant within each)
  * - Streaming destination
  * - Bondix tunnel credentials
  * - Video and audio encoding settings
@@ -23,6 +24,21 @@ class SettingsActivity : AppCompatActivity() {
     private lateinit var binding: ActivitySettingsBinding
     private lateinit var settings: SettingsRepository
 
+    // Transport variants per protocol; the order matches udpTransports / srtTransports
+    private val udpTransportOptions = listOf("Standard (Bondix if available)", "Native multi-link", "ARQ (direct)")
+    private val srtTransportOptions = listOf("Standard (srtsink)", "Direct libsrt", "Bonded, broadcast", "Bonded, backup")
+    private val udpTransports = listOf(
+        TransportMode.UDP to SrtGroupMode.BROADCAST,
+        TransportMode.MULTILINK_UDP to SrtGroupMode.BROADCAST,
+        TransportMode.ARQ_UDP to SrtGroupMode.BROADCAST
+    )
+    private val srtTransports = listOf(
+        TransportMode.SRT to SrtGroupMode.BROADCAST,
+        TransportMode.SRT_DIRECT to SrtGroupMode.BROADCAST,
+        TransportMode.SRT_BONDED to SrtGroupMode.BROADCAST,
+        TransportMode.SRT_BONDED to SrtGroupMode.BACKUP
+    )
+
     private val resolutionOptions = listOf("480p", "720p", "1080p", "1440p", "4K")
     private val frameRateOptions = listOf("24", "25", "30", "50", "60")
     private val encoderPresetOptions = listOf("Ultrafast", "Superfast", "Veryfast", "Faster", "Fast", "Medium", "Slow", "Slower", "Veryslow")
@@ -74,10 +90,35 @@ class SettingsActivity : AppCompatActivity() {
         binding.toggleTransport.addOnButtonCheckedListener { _, checkedId, isChecked ->
             if (isChecked) {
                 updateTransportDescription(checkedId == R.id.btnUdp)
+                setTransportVariants(checkedId == R.id.btnUdp)
             }
         }
     }
     
+    // Variants of the selected protocol, first one selected
+    private fun setTransportVariants(isUdp: Boolean) {
+        val options = if (isUdp) udpTransportOptions else srtTransportOptions
+        binding.inputTransportVariant.setAdapter(
+            ArrayAdapter(this, android.R.layout.simple_dropdown_item_1line, options))
+        binding.inputTransportVariant.setText(options[0], false)
+    }
+    
+    private fun transportToDisplayName(mode: TransportMode, groupMode: SrtGroupMode): String {
+        val isUdp = !mode.isSrt
+        val transports = if (isUdp) udpTransports else srtTransports
+        val options = if (isUdp) udpTransportOptions else srtTransportOptions
+        val index = transports.indexOfFirst {
+            it.first == mode && (mode != TransportMode.SRT_BONDED || it.second == groupMode)
+        }
+        return options[index.coerceAtLeast(0)]
+    }
+    
+    private fun displayNameToTransport(isUdp: Boolean, name: String): Pair<TransportMode, SrtGroupMode> {
+        val transports = if (isUdp) udpTransports else srtTransports
+        val options = if (isUdp) udpTransportOptions else srtTransportOptions
+        return transports[options.indexOf(name).coerceAtLeast(0)]
+    }
+    
     private fun updateTransportDescription(isUdp: Boolean) {
         binding.transportDescription.text = if (isUdp) {
             "UDP: Use with Bondix (Bondix handles reliability)"
@@ -126,9 +167,12 @@ class SettingsActivity : AppCompatActivity() {
 
     private fun loadSettings() {
         // Transport mode
-        val isUdp = settings.transportMode == TransportMode.UDP
+        val isUdp = !settings.transportMode.isSrt
         binding.toggleTransport.check(if (isUdp) R.id.btnUdp else R.id.btnSrt)
         updateTransportDescription(isUdp)
+        setTransportVariants(isUdp)
+        binding.inputTransportVariant.setText(
+            transportToDisplayName(settings.transportMode, settings.srtGroupMode), false)
         
         // Destination settings
         binding.inputSrtHost.setText(settings.srtHost)
@@ -252,7 +296,10 @@ class SettingsActivity : AppCompatActivity() {
 
         // Save transport mode
         val isUdp = binding.toggleTransport.checkedButtonId == R.id.btnUdp
-        settings.transportMode = if (isUdp) TransportMode.UDP else TransportMode.SRT
+        val (transportMode, groupMode) =
+            displayNameToTransport(isUdp, binding.inputTransportVariant.text.toString())
+        settings.transportMode = transportMode
+        settings.srtGroupMode = groupMode
         
         // Save destination settings
         settings.srtHost = srtHost
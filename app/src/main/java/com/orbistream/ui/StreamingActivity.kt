@@ -130,7 +130,7 @@ class StreamingActivity : AppCompatActivity() {
 
         // Display target
         val settings = OrbiStreamApp.instance.settingsRepository
-        val protocol = if (settings.transportMode == TransportMode.SRT) "srt" else "udp"
+        val protocol = if (settings.transportMode.isSrt) "srt" else "udp"
         val targetUrl = "$protocol://${settings.srtHost}:${settings.srtPort}"
         binding.streamingToText.text = getString(R.string.streaming_to, targetUrl)
         
@@ -226,8 +226,8 @@ class StreamingActivity : AppCompatActivity() {
         val settings = OrbiStreamApp.instance.settingsRepository
         val config = settings.buildStreamConfig()
         
-        val transportName = if (config.transport == TransportMode.SRT) "SRT" else "UDP"
-        val protocol = if (config.transport == TransportMode.SRT) "srt" else "udp"
+        val transportName = if (config.transport.isSrt) "SRT" else "UDP"
+        val protocol = if (config.transport.isSrt) "srt" else "udp"
         
         Log.i(TAG, "========================================")
         Log.i(TAG, "=== STARTING STREAMING SERVICE ===")
@@ -242,21 +242,7 @@ class StreamingActivity : AppCompatActivity() {
         
         val intent = Intent(this, StreamingService::class.java).apply {
             action = StreamingService.ACTION_START
-            putExtra(StreamingService.EXTRA_TRANSPORT_MODE, config.transport.ordinal)
-            putExtra(StreamingService.EXTRA_SRT_HOST, config.srtHost)
-            putExtra(StreamingService.EXTRA_SRT_PORT, config.srtPort)
-            putExtra(StreamingService.EXTRA_STREAM_ID, config.streamId)
-            putExtra(StreamingService.EXTRA_PASSPHRASE, config.passphrase)
-            putExtra(StreamingService.EXTRA_VIDEO_WIDTH, config.videoWidth)
-            putExtra(StreamingService.EXTRA_VIDEO_HEIGHT, config.videoHeight)
-            putExtra(StreamingService.EXTRA_VIDEO_BITRATE, config.videoBitrate)
-            putExtra(StreamingService.EXTRA_FRAME_RATE, config.frameRate)
-            putExtra(StreamingService.EXTRA_AUDIO_BITRATE, config.audioBitrate)
-            putExtra(StreamingService.EXTRA_SAMPLE_RATE, config.sampleRate)
-            putExtra(StreamingService.EXTRA_ENCODER_PRESET, config.encoderPreset.value)
-            putExtra(StreamingService.EXTRA_KEYFRAME_INTERVAL, config.keyframeInterval)
-            putExtra(StreamingService.EXTRA_B_FRAMES, config.bFrames)
-            putExtra(StreamingService.EXTRA_USE_HARDWARE_ENCODER, config.useHardwareEncoder)
+            putExtra(StreamingService.EXTRA_CONFIG, config)
         }
         
         startForegroundService(intent)
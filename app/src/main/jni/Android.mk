@@ -22,35 +22,37 @@ ifndef GSTREAMER_SDK_ROOT_ANDROID
     GSTREAMER_SDK_ROOT_ANDROID := $(GSTREAMER_ROOT)
 endif
 
-# GStreamer plugins we need for SRT streaming
+# GStreamer plugins: only those buildPipelineString() and calibration name
+# elements from (mirrored in gst_startup.cpp, which checks them at init).
+# Every plugin listed is registered by gst_android_init on each launch, so
+# unused ones cost startup time. androidmedia and openh264 are not linked,
+# so x264 is the only video encoder: EncoderKind::MEDIACODEC and OPENH264
+# fall back to it, and AUTO never finds a hardware encoder. Add them here
+# (and to onDemandPlugins() in gst_startup.cpp) to enable them.
 GSTREAMER_PLUGINS := \
     coreelements \
     app \
-    audioconvert \
-    audioresample \
-    audiorate \
     videoconvert \
     videoscale \
     videorate \
-    typefindfunctions \
+    audioconvert \
+    audioresample \
+    audiorate \
     x264 \
     voaacenc \
+    videoparsersbad \
+    audioparsers \
     mpegtsmux \
     srt \
-    audioparsers \
-    videoparsersbad \
-    isomp4 \
-    alaw \
-    mulaw \
-    opus \
-    rawparse \
-    tcp \
     udp \
-    opengl \
-    opensles
+    playback \
+    typefindfunctions \
+    isomp4 \
+    mpegtsdemux \
+    videotestsrc
 
-# Extra dependencies
-GSTREAMER_EXTRA_DEPS := gstreamer-video-1.0 gstreamer-audio-1.0 gstreamer-app-1.0 gstreamer-net-1.0
+# Extra dependencies (srt: libsrt for TransportMode::SRT_DIRECT, also used by the srt plugin)
+GSTREAMER_EXTRA_DEPS := gstreamer-video-1.0 gstreamer-audio-1.0 gstreamer-app-1.0 gstreamer-net-1.0 srt
 
 # Include GStreamer build integration
 include $(GSTREAMER_ROOT)/share/gst-android/ndk-build/gstreamer-1.0.mk
@@ -64,10 +66,28 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := orbistream_native
 LOCAL_SRC_FILES := \
     orbistream_jni.cpp \
-    srt_streamer.cpp
+    srt_streamer.cpp \
+    ts_muxer.cpp \
+    packet_pacer.cpp \
+    thread_placement.cpp \
+    frame_admission.cpp \
+    frame_convert.cpp \
+    srt_transport.cpp \
+    multilink_sender.cpp \
+    arq_sender.cpp \
+    metrics_history.cpp \
+    trace.cpp \
+    main_dispatcher.cpp \
+    roi.cpp \
+    memory_budget.cpp \
+    gst_startup.cpp \
+    logger.cpp \
+    byte_accounting.cpp \
+    thermal_governor.cpp \
+    encoder_backend.cpp
 
 LOCAL_SHARED_LIBRARIES := gstreamer_android
-LOCAL_LDLIBS := -llog -landroid
+LOCAL_LDLIBS := -llog -landroid -ldl
 
 LOCAL_C_INCLUDES := \
     $(GSTREAMER_ROOT)/include/gstreamer-1.0 \
@@ -75,7 +95,7 @@ LOCAL_C_INCLUDES := \
     $(GSTREAMER_ROOT)/lib/glib-2.0/include \
     $(GSTREAMER_ROOT)/include
 
-LOCAL_CPPFLAGS := -std=c++17 -fexceptions -frtti -DGSTREAMER_AVAILABLE=1
-LOCAL_CFLAGS := -DGSTREAMER_AVAILABLE=1
+LOCAL_CPPFLAGS := -std=c++17 -fexceptions -frtti -DGSTREAMER_AVAILABLE=1 -DLIBSRT_AVAILABLE=1
+LOCAL_CFLAGS := -DGSTREAMER_AVAILABLE=1 -DLIBSRT_AVAILABLE=1
 
 include $(BUILD_SHARED_LIBRARY)
@@ -0,0 +1,245 @@
+#include "arq_sender.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_TAG "ArqSender"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+constexpr size_t kNakRangeSize = 6;
+constexpr size_t kAckSize = ArqSender::kHeaderSize + 12;
+constexpr int64_t kMinResendGapNs = 10000000LL;     // Never resend the same datagram faster
+
+void put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint16_t get16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t get32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+}
+
+ArqSender::ArqSender(const ArqConfig& cfg) : config(cfg) {
+    config.ringSlots = std::max<size_t>(64, config.ringSlots);
+}
+
+ArqSender::~ArqSender() {
+    stop();
+}
+
+int64_t ArqSender::nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool ArqSender::start() {
+    if (running) return true;
+
+    struct addrinfo hints = {};
+    struct addrinfo* result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    std::string service = std::to_string(config.port);
+    if (getaddrinfo(config.host.c_str(), service.c_str(), &hints, &result) != 0 || !result) {
+        LOGE("Cannot resolve %s:%d", config.host.c_str(), config.port);
+        return false;
+    }
+    fd = socket(result->ai_family, SOCK_DGRAM, 0);
+    // connect() so only the receiver's NAKs and ACKs reach this socket
+    if (fd < 0 || connect(fd, result->ai_addr, result->ai_addrlen) < 0) {
+        LOGE("Cannot open UDP socket to %s:%d: %s", config.host.c_str(), config.port, strerror(errno));
+        if (fd >= 0) close(fd);
+        fd = -1;
+        freeaddrinfo(result);
+        return false;
+    }
+    freeaddrinfo(result);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ring.assign(config.ringSlots, Slot());
+        sequence = 0;
+        stats = ArqStats();
+        heldBytes = 0;
+        rttSamples = 0;
+    }
+    running = true;
+    worker = std::thread(&ArqSender::run, this);
+    LOGI("Started: %s:%d, latency %d ms, %zu ring slots", config.host.c_str(), config.port,
+         config.latencyMs, config.ringSlots);
+    return true;
+}
+
+void ArqSender::stop() {
+    if (!running) return;
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool ArqSender::send(const uint8_t* data, size_t size) {
+    if (!running || size > kMaxPayload) return false;
+
+    int64_t now = nowNs();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) return false;
+    Slot& slot = ring[sequence % ring.size()];
+    heldBytes -= slot.used ? slot.size : 0;
+    slot.sequence = sequence;
+    slot.used = true;
+    slot.sentNs = now;
+    slot.resentNs = 0;
+    slot.naked = false;
+    slot.size = kHeaderSize + size;
+    slot.data[0] = kMagic;
+    slot.data[1] = kTypeData;
+    put16(slot.data + 2, 0);
+    put32(slot.data + 4, sequence);
+    put32(slot.data + 8, static_cast<uint32_t>(now / 1000));
+    memcpy(slot.data + kHeaderSize, data, size);
+    heldBytes += slot.size;
+    sequence++;
+
+    ssize_t sent = ::send(fd, slot.data, slot.size, MSG_DONTWAIT);
+    if (sent < 0) {
+        // Kept in the ring: a NAK can still recover it
+        LOGD("Send failed (%s)", strerror(errno));
+        return false;
+    }
+    stats.packetsSent++;
+    stats.bytesSent += slot.size;
+    return true;
+}
+
+// Caller holds the mutex
+void ArqSender::resend(uint32_t seq, int64_t now) {
+    Slot& slot = ring[seq % ring.size()];
+    if (!slot.used || slot.sequence != seq) {
+        stats.resendsSkipped++;         // Overwritten: older than the ring
+        return;
+    }
+    if (!slot.naked) {
+        slot.naked = true;
+        stats.packetsNaked++;
+    }
+
+    // Deadline: the copy must land before the receiver plays this datagram out
+    double halfRttNs = stats.rttMs * 1e6 / 2;
+    if (now - slot.sentNs + halfRttNs >= config.latencyMs * 1e6) {
+        stats.resendsSkipped++;
+        return;
+    }
+    // Repeated NAKs within one RTT ask for the copy already on its way
+    int64_t minGapNs = std::max(kMinResendGapNs, static_cast<int64_t>(stats.rttMs * 1e6));
+    if (slot.resentNs > 0 && now - slot.resentNs < minGapNs) {
+        return;
+    }
+
+    slot.data[1] = kTypeRetransmit;
+    if (::send(fd, slot.data, slot.size, MSG_DONTWAIT) >= 0) {
+        slot.resentNs = now;
+        stats.packetsRetransmitted++;
+        stats.bytesSent += slot.size;
+    }
+}
+
+void ArqSender::handleNak(const uint8_t* packet, size_t size, int64_t now) {
+    size_t count = get16(packet + 2);
+    count = std::min(count, (size - kHeaderSize) / kNakRangeSize);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.naksReceived++;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* range = packet + kHeaderSize + i * kNakRangeSize;
+        uint32_t first = get32(range);
+        uint16_t length = get16(range + 4);
+        for (uint32_t n = 0; n < length; n++) {
+            uint32_t seq = first + n;
+            // Ignore anything the sender never sent
+            if (static_cast<int32_t>(seq - sequence) >= 0) break;
+            resend(seq, now);
+        }
+    }
+}
+
+void ArqSender::handleAck(const uint8_t* packet, size_t size, int64_t now) {
+    if (size < kAckSize) return;
+    uint32_t echo = get32(packet + 8);
+    uint32_t holdUs = get32(packet + kHeaderSize);
+    uint32_t elapsedUs = static_cast<uint32_t>(now / 1000) - echo;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.receiverSeen = true;
+    stats.recovered = get32(packet + kHeaderSize + 4);
+    stats.expired = get32(packet + kHeaderSize + 8);
+    if (elapsedUs >= holdUs && elapsedUs - holdUs < 10000000) {
+        double rttMs = (elapsedUs - holdUs) / 1000.0;
+        stats.rttMs = rttSamples++ == 0 ? rttMs : stats.rttMs * 0.875 + rttMs * 0.125;
+    }
+}
+
+void ArqSender::run() {
+    uint8_t buf[1500];
+    while (running) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            if (static_cast<size_t>(n) < kHeaderSize || buf[0] != kMagic) continue;
+            int64_t now = nowNs();
+            if (buf[1] == kTypeNak) {
+                handleNak(buf, static_cast<size_t>(n), now);
+            } else if (buf[1] == kTypeAck) {
+                handleAck(buf, static_cast<size_t>(n), now);
+            }
+        }
+    }
+}
+
+ArqStats ArqSender::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ArqStats result = stats;
+    if (result.packetsSent > 0) {
+        result.retransmitRatio = static_cast<double>(result.packetsRetransmitted) / result.packetsSent;
+    }
+    result.ringBytes = heldBytes;
+    return result;
+}
+
+size_t ArqSender::slotBytes() {
+    return sizeof(Slot);
+}
+
+} // namespace orbistream
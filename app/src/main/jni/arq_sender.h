@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Configuration for ArqSender.
+ */
+struct ArqConfig {
+    std::string host;
+    int port = 9000;
+    int latencyMs = 250;         // Receiver playout delay: nothing older is resent
+    size_t ringSlots = 2048;     // Datagrams kept for resend (~2 s at 10 Mbps)
+};
+
+/**
+ * ARQ statistics (cumulative).
+ */
+struct ArqStats {
+    uint64_t packetsSent = 0;        // Original datagrams
+    uint64_t bytesSent = 0;          // Originals and retransmits, headers included
+    uint64_t packetsRetransmitted = 0;
+    uint64_t packetsNaked = 0;       // Distinct sequence numbers the receiver reported missing
+    uint64_t resendsSkipped = 0;     // NAKed but past the deadline or gone from the ring
+    uint64_t naksReceived = 0;
+    double retransmitRatio = 0.0;    // packetsRetransmitted / packetsSent
+    double rttMs = 0.0;              // Smoothed, from ACK timestamp echoes
+    // Reported by the receiver in its ACKs
+    uint64_t recovered = 0;          // Gaps filled by a retransmit in time
+    uint64_t expired = 0;            // Gaps still open at their playout deadline
+    bool receiverSeen = false;       // At least one ACK arrived
+    
+    uint64_t ringBytes = 0;          // Datagram bytes currently held for resend
+};
+
+/**
+ * ArqSender sends TS datagrams over one UDP socket with a sequence header,
+ * keeps the last ringSlots datagrams and resends the ones the receiver
+ * NAKs (tools/arq_receiver is the reference receiver).
+ *
+ * A resend only happens while it can still arrive before the receiver's
+ * playout deadline: age + RTT/2 < latencyMs. A sequence number is resent at
+ * most once per RTT however often it is NAKed. send() is called from the
+ * streaming thread; a worker thread reads NAKs and ACKs and does the resends.
+ *
+ * Wire format (network byte order):
+ *   u8 magic 'R' | u8 type | u16 count | u32 sequence | u32 send time (us)
+ *   type 1 = data, 2 = retransmit (TS payload follows; send time is the original's)
+ *   type 3 = NAK: count x (u32 first sequence, u16 length) follow
+ *   type 4 = ACK: sequence = next expected; send time = latest data send time
+ *            echoed; + u32 hold (us), u32 recovered, u32 expired
+ */
+class ArqSender {
+public:
+    static constexpr size_t kHeaderSize = 12;
+    static constexpr size_t kMaxPayload = 1400;
+    static constexpr uint8_t kMagic = 0x52;
+    static constexpr uint8_t kTypeData = 1;
+    static constexpr uint8_t kTypeRetransmit = 2;
+    static constexpr uint8_t kTypeNak = 3;
+    static constexpr uint8_t kTypeAck = 4;
+
+    explicit ArqSender(const ArqConfig& config);
+    ~ArqSender();
+
+    bool start();
+    void stop();
+
+    /**
+     * Send one datagram and keep it for resend.
+     * @return false if the socket is not open or refused it
+     */
+    bool send(const uint8_t* data, size_t size);
+
+    ArqStats getStats() const;
+
+    /** Memory one ring slot takes (ring = ringSlots x this, allocated up front). */
+    static size_t slotBytes();
+
+private:
+    struct Slot {
+        uint32_t sequence = 0;
+        bool used = false;
+        int64_t sentNs = 0;          // Original send time
+        int64_t resentNs = 0;        // Latest resend, 0 = never
+        bool naked = false;          // Counted in packetsNaked
+        size_t size = 0;             // Whole datagram, header included
+        uint8_t data[kHeaderSize + kMaxPayload];
+    };
+
+    void run();
+    void handleNak(const uint8_t* packet, size_t size, int64_t now);
+    void handleAck(const uint8_t* packet, size_t size, int64_t now);
+    void resend(uint32_t sequence, int64_t now);
+    static int64_t nowNs();
+
+    ArqConfig config;
+    int fd = -1;
+    std::vector<Slot> ring;
+
+    mutable std::mutex mutex;        // ring, sequence, stats
+    uint32_t sequence = 0;
+    uint64_t heldBytes = 0;          // Sum of used slot sizes
+    ArqStats stats;
+    int rttSamples = 0;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+};
+
+} // namespace orbistream
@@ -0,0 +1,98 @@
+#include "byte_accounting.h"
+
+namespace orbistream {
+
+namespace {
+double ratio(double out, double in) {
+    return out > 0.0 && in > 0.0 ? out / in : 0.0;
+}
+}
+
+const char* byteLayerName(ByteLayer layer) {
+    switch (layer) {
+        case ByteLayer::VIDEO_ES: return "video_es";
+        case ByteLayer::AUDIO_ES: return "audio_es";
+        case ByteLayer::TS: return "ts";
+        case ByteLayer::TRANSPORT: return "transport";
+        case ByteLayer::WIRE: return "wire";
+        default: return "unknown";
+    }
+}
+
+void ByteAccounting::reset(size_t encapsulationBytes) {
+    encapsulation = encapsulationBytes;
+    for (size_t i = 0; i < kCount; i++) {
+        byteCounts[i].store(0, std::memory_order_relaxed);
+        packetCounts[i].store(0, std::memory_order_relaxed);
+        lastBytes[i] = lastPackets[i] = 0;
+        bitrate[i] = packetRate[i] = 0.0;
+    }
+    lastSampleMs = -1;
+    haveRates = false;
+}
+
+void ByteAccounting::addDatagrams(uint64_t bytes, uint64_t datagrams) {
+    uint64_t transportBytes = bytes + datagrams * encapsulation;
+    add(ByteLayer::TRANSPORT, transportBytes, datagrams);
+    add(ByteLayer::WIRE, transportBytes + datagrams * kIpUdpHeaderBytes, datagrams);
+}
+
+void ByteAccounting::storeTransport(uint64_t bytes, uint64_t datagrams, bool ipHeadersIncluded) {
+    uint64_t headers = datagrams * kIpUdpHeaderBytes;
+    uint64_t transportBytes = ipHeadersIncluded ? (bytes > headers ? bytes - headers : 0) : bytes;
+    size_t transport = static_cast<size_t>(ByteLayer::TRANSPORT);
+    size_t wire = static_cast<size_t>(ByteLayer::WIRE);
+    byteCounts[transport].store(transportBytes, std::memory_order_relaxed);
+    packetCounts[transport].store(datagrams, std::memory_order_relaxed);
+    byteCounts[wire].store(transportBytes + headers, std::memory_order_relaxed);
+    packetCounts[wire].store(datagrams, std::memory_order_relaxed);
+}
+
+ByteAccountingStats ByteAccounting::sample(int64_t nowMs, int64_t intervalMs) {
+    uint64_t totalBytes[kCount];
+    uint64_t totalPackets[kCount];
+    for (size_t i = 0; i < kCount; i++) {
+        totalBytes[i] = byteCounts[i].load(std::memory_order_relaxed);
+        totalPackets[i] = packetCounts[i].load(std::memory_order_relaxed);
+    }
+
+    if (lastSampleMs < 0) {
+        lastSampleMs = nowMs;
+    } else if (nowMs - lastSampleMs >= intervalMs) {
+        double seconds = (nowMs - lastSampleMs) / 1000.0;
+        for (size_t i = 0; i < kCount; i++) {
+            // Stored transport totals restart with a reconnect
+            uint64_t byteDiff = totalBytes[i] >= lastBytes[i] ? totalBytes[i] - lastBytes[i] : 0;
+            uint64_t packetDiff = totalPackets[i] >= lastPackets[i] ? totalPackets[i] - lastPackets[i] : 0;
+            bitrate[i] = byteDiff * 8.0 / seconds;
+            packetRate[i] = packetDiff / seconds;
+            lastBytes[i] = totalBytes[i];
+            lastPackets[i] = totalPackets[i];
+        }
+        lastSampleMs = nowMs;
+        haveRates = true;
+    }
+
+    ByteAccountingStats result;
+    result.layers.resize(kCount);
+    for (size_t i = 0; i < kCount; i++) {
+        LayerBytes& entry = result.layers[i];
+        entry.layer = static_cast<ByteLayer>(i);
+        entry.bytes = totalBytes[i];
+        entry.packets = totalPackets[i];
+        entry.bitrate = bitrate[i];
+        entry.packetRate = packetRate[i];
+    }
+
+    auto amount = [&](ByteLayer layer) {
+        size_t i = static_cast<size_t>(layer);
+        return haveRates ? bitrate[i] : static_cast<double>(totalBytes[i]);
+    };
+    double es = amount(ByteLayer::VIDEO_ES) + amount(ByteLayer::AUDIO_ES);
+    result.muxOverhead = ratio(amount(ByteLayer::TS), es);
+    result.transportOverhead = ratio(amount(ByteLayer::TRANSPORT), amount(ByteLayer::TS));
+    result.wireOverhead = ratio(amount(ByteLayer::WIRE), es);
+    return result;
+}
+
+} // namespace orbistream
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Layers a byte of stream data passes through, encoder to network.
+ */
+enum class ByteLayer {
+    VIDEO_ES,       // Encoder (or file parser) output; packets = access units
+    AUDIO_ES,       // aacparse output; packets = AAC frames
+    TS,             // Muxer output: PES and TS headers, PAT/PMT, PCR, stuffing; packets = 188-byte TS packets
+    TRANSPORT,      // Handed to sockets: SRT/ARQ/multi-link headers, resends, SOCKS5 encapsulation; packets = datagrams
+    WIRE,           // TRANSPORT plus IPv4 and UDP headers
+    COUNT
+};
+
+const char* byteLayerName(ByteLayer layer);
+
+/**
+ * Totals and rates of one layer.
+ */
+struct LayerBytes {
+    ByteLayer layer = ByteLayer::VIDEO_ES;
+    uint64_t bytes = 0;             // Since start
+    uint64_t packets = 0;
+    double bitrate = 0.0;           // bps over the last rate interval
+    double packetRate = 0.0;        // Packets per second, same interval
+};
+
+/**
+ * Snapshot of every layer plus the overhead each step adds. A ratio is
+ * bytes out per byte in (1.25 = 25% overhead), over the last rate interval
+ * (totals until the first one completes); 0 while either side is empty.
+ */
+struct ByteAccountingStats {
+    std::vector<LayerBytes> layers;     // ByteLayer order
+    double muxOverhead = 0.0;           // TS / (VIDEO_ES + AUDIO_ES)
+    double transportOverhead = 0.0;     // TRANSPORT / TS
+    double wireOverhead = 0.0;          // WIRE / (VIDEO_ES + AUDIO_ES)
+};
+
+/**
+ * ByteAccounting counts bytes and packets per ByteLayer.
+ *
+ * Pad probes and streaming threads add() with relaxed atomics. Transports
+ * that keep their own totals (libsrt, ArqSender, MultiLinkSender) are
+ * copied in with storeTransport() when stats are polled. sample() turns the
+ * totals into rates at most once per rate interval; it is called from one
+ * thread at a time (the stats mutex).
+ */
+class ByteAccounting {
+public:
+    static constexpr size_t kIpUdpHeaderBytes = 28;     // IPv4 (20) + UDP (8) per datagram
+    static constexpr size_t kTsPacketSize = 188;
+
+    /**
+     * Reset all counters.
+     * @param encapsulationBytes added to each datagram after it leaves the
+     *        sink (the SOCKS5 UDP header when the Bondix relay is in use)
+     */
+    void reset(size_t encapsulationBytes = 0);
+
+    void add(ByteLayer layer, uint64_t bytes, uint64_t packets = 1) {
+        size_t i = static_cast<size_t>(layer);
+        byteCounts[i].fetch_add(bytes, std::memory_order_relaxed);
+        packetCounts[i].fetch_add(packets, std::memory_order_relaxed);
+    }
+
+    /** Datagrams written to a GStreamer sink: TRANSPORT and WIRE at once. */
+    void addDatagrams(uint64_t bytes, uint64_t datagrams);
+
+    /**
+     * Totals kept by the transport itself.
+     * @param ipHeadersIncluded the counts already include IP/UDP headers (libsrt)
+     */
+    void storeTransport(uint64_t bytes, uint64_t datagrams, bool ipHeadersIncluded = false);
+
+    uint64_t bytes(ByteLayer layer) const {
+        return byteCounts[static_cast<size_t>(layer)].load(std::memory_order_relaxed);
+    }
+    uint64_t packets(ByteLayer layer) const {
+        return packetCounts[static_cast<size_t>(layer)].load(std::memory_order_relaxed);
+    }
+
+    /** @return rates recomputed if intervalMs has passed since the last ones */
+    ByteAccountingStats sample(int64_t nowMs, int64_t intervalMs = 1000);
+
+private:
+    static constexpr size_t kCount = static_cast<size_t>(ByteLayer::COUNT);
+
+    size_t encapsulation = 0;
+    std::atomic<uint64_t> byteCounts[kCount] = {};
+    std::atomic<uint64_t> packetCounts[kCount] = {};
+
+    // sample() only
+    int64_t lastSampleMs = -1;
+    uint64_t lastBytes[kCount] = {};
+    uint64_t lastPackets[kCount] = {};
+    double bitrate[kCount] = {};
+    double packetRate[kCount] = {};
+    bool haveRates = false;
+};
+
+} // namespace orbistream
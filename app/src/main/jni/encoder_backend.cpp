@@ -0,0 +1,468 @@
+#include "encoder_backend.h"
+#include "gst_startup.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/video/video.h>
+#endif
+
+#define LOG_TAG "EncoderBackend"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+
+constexpr size_t kKinds = static_cast<size_t>(EncoderKind::OPENH264) + 1;
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if GSTREAMER_AVAILABLE
+// Property specs of a factory's element class (loads the plugin)
+class FactoryClass {
+public:
+    explicit FactoryClass(GstElementFactory* factory) {
+        GstPluginFeature* loaded = gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+        if (!loaded) return;
+        GType type = gst_element_factory_get_element_type(GST_ELEMENT_FACTORY(loaded));
+        if (type) klass = g_type_class_ref(type);
+        gst_object_unref(loaded);
+    }
+    ~FactoryClass() {
+        if (klass) g_type_class_unref(klass);
+    }
+
+    bool has(const char* property) const { return find(property) != nullptr; }
+    bool mutablePlaying(const char* property) const {
+        GParamSpec* spec = find(property);
+        return spec && (spec->flags & GST_PARAM_MUTABLE_PLAYING);
+    }
+
+private:
+    GParamSpec* find(const char* property) const {
+        return klass ? g_object_class_find_property(G_OBJECT_CLASS(klass), property) : nullptr;
+    }
+
+    gpointer klass = nullptr;
+};
+
+// FrameConverter layouts the encoder's sink template accepts. NV21 is a
+// plain copy, NV12 swaps chroma bytes, I420 splits planes.
+std::vector<PixelFormat> sinkFormats(GstElementFactory* factory) {
+    static const PixelFormat kPreference[] = {PixelFormat::NV21, PixelFormat::NV12, PixelFormat::I420};
+    std::vector<PixelFormat> formats;
+    for (PixelFormat candidate : kPreference) {
+        std::string capsStr = std::string("video/x-raw,format=") + pixelFormatName(candidate);
+        GstCaps* wanted = gst_caps_from_string(capsStr.c_str());
+        bool found = false;
+        for (const GList* l = gst_element_factory_get_static_pad_templates(factory); l && !found; l = l->next) {
+            auto* padTemplate = static_cast<GstStaticPadTemplate*>(l->data);
+            if (padTemplate->direction != GST_PAD_SINK) continue;
+            GstCaps* caps = gst_static_pad_template_get_caps(padTemplate);
+            found = gst_caps_can_intersect(caps, wanted);
+            gst_caps_unref(caps);
+        }
+        gst_caps_unref(wanted);
+        if (found) formats.push_back(candidate);
+    }
+    return formats;
+}
+
+// androidmedia registers one amcvidenc-<codec> element per MediaCodec
+// encoder; take the highest-ranked one that produces H.264
+GstElementFactory* findMediaCodecFactory() {
+    if (!GstStartup::hardwareEncoderAvailable()) return nullptr;
+    GList* encoders = gst_element_factory_list_get_elements(
+        GST_ELEMENT_FACTORY_TYPE_ENCODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO, GST_RANK_NONE);
+    GstCaps* h264 = gst_caps_from_string("video/x-h264");
+    GList* matching = gst_element_factory_list_filter(encoders, h264, GST_PAD_SRC, FALSE);
+    matching = g_list_sort(matching, gst_plugin_feature_rank_compare_func);
+    GstElementFactory* found = nullptr;
+    for (GList* l = matching; l && !found; l = l->next) {
+        auto* factory = static_cast<GstElementFactory*>(l->data);
+        if (g_str_has_prefix(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), "amcvidenc-")) {
+            found = GST_ELEMENT_FACTORY(gst_object_ref(factory));
+        }
+    }
+    gst_plugin_feature_list_free(matching);
+    gst_plugin_feature_list_free(encoders);
+    gst_caps_unref(h264);
+    return found;
+}
+#endif
+
+EncoderCapabilities probe(EncoderKind kind) {
+    EncoderCapabilities caps;
+#if GSTREAMER_AVAILABLE
+    int64_t begin = steadyNs();
+    GstElementFactory* factory = nullptr;
+    switch (kind) {
+        case EncoderKind::X264: factory = gst_element_factory_find("x264enc"); break;
+        case EncoderKind::MEDIACODEC: factory = findMediaCodecFactory(); break;
+        case EncoderKind::OPENH264: factory = gst_element_factory_find("openh264enc"); break;
+        default: break;
+    }
+    if (factory) {
+        FactoryClass properties(factory);
+        caps.available = true;
+        caps.hardware = kind == EncoderKind::MEDIACODEC;
+        caps.factory = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+        caps.inputFormats = sinkFormats(factory);
+        caps.liveBitrate = properties.mutablePlaying("bitrate");
+        if (kind == EncoderKind::X264) {
+            caps.presets = properties.has("speed-preset");
+            caps.vbv = properties.has("vbv-buf-capacity");
+            caps.constantQuality = properties.has("quantizer");
+            caps.bFrames = properties.has("bframes");
+            caps.qpOffsets = properties.has("option-string");    // aq-mode for the ROI metas
+        }
+        gst_object_unref(factory);
+    }
+    caps.probeUs = (steadyNs() - begin) / 1000;
+
+    if (!caps.available) {
+        LOGI("Encoder %s: not available (%lld us)", encoderKindName(kind), (long long)caps.probeUs);
+        return caps;
+    }
+    std::string formats;
+    for (PixelFormat format : caps.inputFormats) {
+        formats += formats.empty() ? "" : ",";
+        formats += pixelFormatName(format);
+    }
+    std::string features;
+    auto feature = [&features](bool present, const char* name) {
+        if (!present) return;
+        features += features.empty() ? "" : " ";
+        features += name;
+    };
+    feature(caps.hardware, "hardware");
+    feature(caps.liveBitrate, "live-bitrate");
+    feature(caps.presets, "presets");
+    feature(caps.vbv, "vbv");
+    feature(caps.constantQuality, "constant-quality");
+    feature(caps.bFrames, "b-frames");
+    feature(caps.qpOffsets, "qp-offsets");
+    LOGI("Encoder %s: %s, input %s, [%s] (%lld us)", encoderKindName(kind), caps.factory.c_str(),
+         formats.empty() ? "other" : formats.c_str(), features.c_str(), (long long)caps.probeUs);
+#else
+    (void)kind;
+#endif
+    return caps;
+}
+
+std::mutex cacheMutex;
+bool probed[kKinds] = {};
+EncoderCapabilities cached[kKinds];
+
+// x264enc: kbps; rebuilds its VBV from bitrate and capacity in one
+// reconfigure, so both always go in the same call
+class X264Backend : public EncoderBackend {
+public:
+    EncoderKind kind() const override { return EncoderKind::X264; }
+
+    bool setBitrate(int kbps) override {
+#if GSTREAMER_AVAILABLE
+        if (!element) return false;
+        current.bitrateKbps = kbps;
+        if (capabilities().vbv) {
+            g_object_set(element, "bitrate", kbps, "vbv-buf-capacity", current.vbvBufferMs, nullptr);
+        } else {
+            g_object_set(element, "bitrate", kbps, nullptr);
+        }
+        return true;
+#else
+        (void)kbps;
+        return false;
+#endif
+    }
+
+    bool setVbv(int bufferMs) override {
+        current.vbvBufferMs = bufferMs;
+        return capabilities().vbv && setBitrate(current.bitrateKbps);
+    }
+
+    bool setPreset(EncoderPreset preset) override {
+#if GSTREAMER_AVAILABLE
+        if (!element || !capabilities().presets) return false;
+        current.preset = preset;
+        gst_util_set_object_arg(G_OBJECT(element), "speed-preset", encoderPresetName(preset));
+        return true;
+#else
+        (void)preset;
+        return false;
+#endif
+    }
+
+protected:
+    std::string elementString(const EncoderSettings& settings, const char* elementName) const override {
+        std::stringstream ss;
+        ss << "x264enc name=" << elementName << " tune=zerolatency speed-preset=" << encoderPresetName(settings.preset)
+           << " bitrate=" << settings.bitrateKbps
+           << " key-int-max=" << settings.keyframeFrames
+           << " bframes=" << settings.bFrames
+           << " threads=" << settings.threads;
+        // Peak rate equals the bitrate; CBR and capped VBR differ in VBV size
+        if (settings.rateControl == RateControl::CONSTANT_QUALITY) {
+            ss << " pass=qual quantizer=" << settings.crfQuality;
+        } else {
+            ss << " pass=cbr";
+        }
+        ss << " vbv-buf-capacity=" << settings.vbvBufferMs;
+        if (settings.roi) {
+            // x264 ignores QP offsets without AQ, and the fast presets turn it off
+            ss << " option-string=\"aq-mode=1\"";
+        }
+        return ss.str();
+    }
+};
+
+// amcvidenc: bps, keyframe interval in whole seconds
+class MediaCodecBackend : public EncoderBackend {
+public:
+    EncoderKind kind() const override { return EncoderKind::MEDIACODEC; }
+
+    bool setBitrate(int kbps) override {
+#if GSTREAMER_AVAILABLE
+        if (!element || !capabilities().liveBitrate) return false;
+        current.bitrateKbps = kbps;
+        g_object_set(element, "bitrate", kbps * 1000, nullptr);
+        return true;
+#else
+        (void)kbps;
+        return false;
+#endif
+    }
+
+protected:
+    std::string elementString(const EncoderSettings& settings, const char* elementName) const override {
+        const std::string& factory = capabilities().factory;
+        int intervalS = std::max(1, static_cast<int>(std::lround(
+            static_cast<double>(settings.keyframeFrames) / std::max(1, settings.frameRate))));
+        std::stringstream ss;
+        ss << (factory.empty() ? "amcvidenc" : factory.c_str()) << " name=" << elementName
+           << " bitrate=" << settings.bitrateKbps * 1000
+           << " i-frame-interval=" << intervalS;
+        return ss.str();
+    }
+};
+
+// openh264enc: bps, Baseline (no B-frames), I420 only; the preset picks
+// its complexity level
+class OpenH264Backend : public EncoderBackend {
+public:
+    EncoderKind kind() const override { return EncoderKind::OPENH264; }
+
+    bool setBitrate(int kbps) override {
+#if GSTREAMER_AVAILABLE
+        if (!element || !capabilities().liveBitrate) return false;
+        current.bitrateKbps = kbps;
+        g_object_set(element, "bitrate", static_cast<guint>(kbps) * 1000u, nullptr);
+        return true;
+#else
+        (void)kbps;
+        return false;
+#endif
+    }
+
+protected:
+    std::string elementString(const EncoderSettings& settings, const char* elementName) const override {
+        const char* complexity = settings.preset <= EncoderPreset::VERYFAST ? "low"
+                               : settings.preset <= EncoderPreset::MEDIUM ? "medium" : "high";
+        std::stringstream ss;
+        ss << "openh264enc name=" << elementName
+           << " bitrate=" << settings.bitrateKbps * 1000
+           << " gop-size=" << settings.keyframeFrames
+           << " rate-control=bitrate complexity=" << complexity;
+        if (settings.threads > 0) {
+            ss << " multi-thread=" << settings.threads;
+        }
+        return ss.str();
+    }
+};
+
+} // namespace
+
+// Frames in the encoder, keyed by PTS: entered at the sink pad, matched at
+// the src pad. Sized for lookahead, B-frames and MediaCodec's input queue.
+struct EncoderBackend::Timing {
+    static constexpr size_t kPending = 32;
+
+    std::mutex mutex;
+    uint64_t pts[kPending] = {};
+    int64_t enteredNs[kPending] = {};      // 0 = free
+    size_t next = 0;
+    uint64_t frames = 0;
+    int64_t totalNs = 0;
+    int64_t maxNs = 0;
+
+    void frameIn(uint64_t framePts, int64_t nowNs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pts[next] = framePts;
+        enteredNs[next] = nowNs;
+        next = (next + 1) % kPending;
+    }
+
+    void frameOut(uint64_t framePts, int64_t nowNs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < kPending; i++) {
+            if (enteredNs[i] == 0 || pts[i] != framePts) continue;
+            int64_t elapsed = nowNs - enteredNs[i];
+            enteredNs[i] = 0;
+            frames++;
+            totalNs += elapsed;
+            maxNs = std::max(maxNs, elapsed);
+            return;
+        }
+    }
+};
+
+const char* encoderPresetName(EncoderPreset preset) {
+    switch (preset) {
+        case EncoderPreset::ULTRAFAST: return "ultrafast";
+        case EncoderPreset::SUPERFAST: return "superfast";
+        case EncoderPreset::VERYFAST: return "veryfast";
+        case EncoderPreset::FASTER: return "faster";
+        case EncoderPreset::FAST: return "fast";
+        case EncoderPreset::MEDIUM: return "medium";
+        case EncoderPreset::SLOW: return "slow";
+        case EncoderPreset::SLOWER: return "slower";
+        case EncoderPreset::VERYSLOW: return "veryslow";
+        default: return "ultrafast";
+    }
+}
+
+const char* encoderKindName(EncoderKind kind) {
+    switch (kind) {
+        case EncoderKind::X264: return "x264";
+        case EncoderKind::MEDIACODEC: return "mediacodec";
+        case EncoderKind::OPENH264: return "openh264";
+        default: return "auto";
+    }
+}
+
+std::unique_ptr<EncoderBackend> EncoderBackend::create(EncoderKind kind) {
+    switch (kind) {
+        case EncoderKind::X264: return std::make_unique<X264Backend>();
+        case EncoderKind::MEDIACODEC: return std::make_unique<MediaCodecBackend>();
+        case EncoderKind::OPENH264: return std::make_unique<OpenH264Backend>();
+        default: return nullptr;
+    }
+}
+
+EncoderKind EncoderBackend::resolve(EncoderKind requested, bool preferHardware) {
+    if (requested == EncoderKind::AUTO) {
+        return preferHardware && capabilities(EncoderKind::MEDIACODEC).available
+            ? EncoderKind::MEDIACODEC : EncoderKind::X264;
+    }
+    if (requested != EncoderKind::X264 && !capabilities(requested).available) {
+        LOGE("Encoder %s requested but not available, using x264", encoderKindName(requested));
+        return EncoderKind::X264;
+    }
+    return requested;
+}
+
+// Entries are written once, under the lock, and never change afterwards
+const EncoderCapabilities& EncoderBackend::capabilities(EncoderKind kind) {
+    size_t index = std::min(static_cast<size_t>(kind), kKinds - 1);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!probed[index]) {
+        cached[index] = probe(static_cast<EncoderKind>(index));
+        probed[index] = true;
+    }
+    return cached[index];
+}
+
+EncoderBackend::~EncoderBackend() = default;
+
+std::string EncoderBackend::build(const EncoderSettings& settings, const char* elementName) {
+    current = settings;
+    return elementString(settings, elementName);
+}
+
+#if GSTREAMER_AVAILABLE
+void EncoderBackend::attach(GstElement* encoderElement) {
+    element = encoderElement;
+    timing = std::make_shared<Timing>();
+    if (!element) return;
+
+    auto addProbe = [this](const char* padName, GstPadProbeCallback callback) {
+        GstPad* pad = gst_element_get_static_pad(element, padName);
+        if (!pad) return;
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback,
+                          new std::shared_ptr<Timing>(timing),
+                          [](gpointer data) { delete static_cast<std::shared_ptr<Timing>*>(data); });
+        gst_object_unref(pad);
+    };
+    addProbe("sink", [](GstPad*, GstPadProbeInfo* info, gpointer data) -> GstPadProbeReturn {
+        GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (buf && GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buf))) {
+            (*static_cast<std::shared_ptr<Timing>*>(data))->frameIn(GST_BUFFER_PTS(buf), steadyNs());
+        }
+        return GST_PAD_PROBE_OK;
+    });
+    addProbe("src", [](GstPad*, GstPadProbeInfo* info, gpointer data) -> GstPadProbeReturn {
+        GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+        if (buf && GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buf))) {
+            (*static_cast<std::shared_ptr<Timing>*>(data))->frameOut(GST_BUFFER_PTS(buf), steadyNs());
+        }
+        return GST_PAD_PROBE_OK;
+    });
+}
+#endif
+
+void EncoderBackend::detach() {
+#if GSTREAMER_AVAILABLE
+    element = nullptr;
+#endif
+}
+
+bool EncoderBackend::setVbv(int bufferMs) {
+    (void)bufferMs;
+    return false;
+}
+
+bool EncoderBackend::setPreset(EncoderPreset preset) {
+    (void)preset;
+    return false;
+}
+
+// GstVideoEncoder handles the event on its src pad for every backend
+bool EncoderBackend::forceKeyframe() {
+#if GSTREAMER_AVAILABLE
+    if (!element) return false;
+    GstPad* pad = gst_element_get_static_pad(element, "src");
+    if (!pad) return false;
+    bool sent = gst_pad_send_event(pad, gst_video_event_new_upstream_force_key_unit(
+        GST_CLOCK_TIME_NONE, TRUE, 0));
+    gst_object_unref(pad);
+    return sent;
+#else
+    return false;
+#endif
+}
+
+EncodeTiming EncoderBackend::drainTiming() {
+    EncodeTiming result;
+    if (!timing) return result;
+    std::lock_guard<std::mutex> lock(timing->mutex);
+    result.frames = timing->frames;
+    if (timing->frames > 0) {
+        result.meanMs = timing->totalNs / 1e6 / timing->frames;
+        result.maxMs = timing->maxNs / 1e6;
+    }
+    timing->frames = 0;
+    timing->totalNs = 0;
+    timing->maxNs = 0;
+    return result;
+}
+
+} // namespace orbistream
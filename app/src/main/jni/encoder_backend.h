@@ -0,0 +1,180 @@
+#pragma once
+
+#include "frame_convert.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+namespace orbistream {
+
+/**
+ * Encoder presets (maps to x264 speed-preset).
+ */
+enum class EncoderPreset {
+    ULTRAFAST,  // Fastest, lowest quality
+    SUPERFAST,
+    VERYFAST,
+    FASTER,
+    FAST,
+    MEDIUM,     // Default balance
+    SLOW,
+    SLOWER,
+    VERYSLOW    // Slowest, highest quality
+};
+
+const char* encoderPresetName(EncoderPreset preset);
+
+/**
+ * Encoder rate control profile.
+ *
+ * - CBR: every frame sized to the bitrate, VBV of one frame interval; keyframes
+ *   lose quality but nothing bursts past the link or the encoder queue
+ * - CAPPED_VBR: average and peak at the bitrate over a VBV of vbvBufferMs, so
+ *   keyframes and motion borrow from the frames around them
+ * - CONSTANT_QUALITY: x264 CRF at crfQuality, the bitrate is only a ceiling
+ *   (over vbvBufferMs); quiet scenes send less
+ *
+ * amcvidenc and openh264enc only expose a bitrate, so they run their default
+ * mode at videoBitrate for every profile.
+ */
+enum class RateControl {
+    CBR,
+    CAPPED_VBR,
+    CONSTANT_QUALITY
+};
+
+/**
+ * Video encoder implementation.
+ *
+ * - AUTO: MEDIACODEC when useHardwareEncoder is set and one is present, else X264
+ * - X264: x264enc; presets, VBV, constant quality and ROI QP offsets
+ * - MEDIACODEC: amcvidenc-* (Android hardware); bitrate and keyframe interval only
+ * - OPENH264: openh264enc (Cisco, Baseline); a second software encoder to
+ *   compare x264 against
+ *
+ * The shipped Android build links neither androidmedia nor openh264 (see
+ * GSTREAMER_PLUGINS in Android.mk): there MEDIACODEC and OPENH264 probe as
+ * unavailable and resolve() falls back to X264, and AUTO is always X264.
+ * Both are usable on the host (tools/encoder_benchmark) or in a build that
+ * adds the plugins.
+ */
+enum class EncoderKind {
+    AUTO,
+    X264,
+    MEDIACODEC,
+    OPENH264
+};
+
+const char* encoderKindName(EncoderKind kind);
+
+/**
+ * What an encoder can do on this device, from its element factory.
+ */
+struct EncoderCapabilities {
+    bool available = false;
+    bool hardware = false;
+    std::string factory;                    // Element the pipeline names
+    std::vector<PixelFormat> inputFormats;  // FrameConverter layouts its sink takes, cheapest first
+    bool liveBitrate = false;               // Bitrate changes take effect while playing
+    bool presets = false;                   // Speed presets (calibration, governor preset steps)
+    bool vbv = false;                       // VBV size can be set
+    bool constantQuality = false;           // RateControl::CONSTANT_QUALITY
+    bool bFrames = false;
+    bool qpOffsets = false;                 // Region-of-interest QP offsets
+    int64_t probeUs = 0;                    // Time the probe took
+};
+
+/**
+ * Encoder settings in the app's units; each backend converts them to its
+ * element's properties (bps vs kbps, frames vs seconds).
+ */
+struct EncoderSettings {
+    int bitrateKbps = 4000;
+    int frameRate = 30;
+    int keyframeFrames = 60;        // GOP length
+    int bFrames = 0;
+    int threads = 0;                // 0 = encoder default
+    EncoderPreset preset = EncoderPreset::ULTRAFAST;
+    RateControl rateControl = RateControl::CAPPED_VBR;
+    int crfQuality = 23;
+    int vbvBufferMs = 600;
+    bool roi = false;               // Turn on what QP offsets need (x264: aq-mode)
+};
+
+/**
+ * Time frames spent inside the encoder element (sink pad to src pad),
+ * since the last drainTiming().
+ */
+struct EncodeTiming {
+    uint64_t frames = 0;
+    double meanMs = 0.0;
+    double maxMs = 0.0;
+};
+
+/**
+ * EncoderBackend is one video encoder element: the pipeline fragment that
+ * creates it and the controls used while streaming.
+ *
+ * build() describes the element for gst_parse_launch; attach() binds the
+ * created element and adds the timing probes. Controls return false when
+ * the encoder lacks them (see capabilities()), so callers need no per-encoder
+ * branches. Capabilities are probed once per kind and cached for the process.
+ */
+class EncoderBackend {
+public:
+    /** nullptr for AUTO; resolve() first. */
+    static std::unique_ptr<EncoderBackend> create(EncoderKind kind);
+
+    /** AUTO and unavailable kinds to the encoder actually used (X264 as the last resort). */
+    static EncoderKind resolve(EncoderKind requested, bool preferHardware);
+
+    /** Probed on first call per kind. Needs GStreamer initialized. */
+    static const EncoderCapabilities& capabilities(EncoderKind kind);
+
+    virtual ~EncoderBackend();
+
+    virtual EncoderKind kind() const = 0;
+    const char* name() const { return encoderKindName(kind()); }
+    const EncoderCapabilities& capabilities() const { return capabilities(kind()); }
+
+    /**
+     * gst-launch description of the element, named elementName. The
+     * settings are kept for later control calls.
+     */
+    std::string build(const EncoderSettings& settings, const char* elementName);
+    const EncoderSettings& settings() const { return current; }
+
+#if GSTREAMER_AVAILABLE
+    /** Bind the element created from build() (not reffed; see detach()). */
+    void attach(GstElement* element);
+#endif
+    void detach();
+
+    virtual bool setBitrate(int kbps) = 0;
+    virtual bool setVbv(int bufferMs);
+    /** Only while the element is stopped: encoders read the preset when they open. */
+    virtual bool setPreset(EncoderPreset preset);
+    /** IDR with SPS/PPS as soon as possible (upstream force-key-unit event). */
+    bool forceKeyframe();
+
+    EncodeTiming drainTiming();
+
+protected:
+    virtual std::string elementString(const EncoderSettings& settings, const char* elementName) const = 0;
+
+    EncoderSettings current;
+#if GSTREAMER_AVAILABLE
+    GstElement* element = nullptr;
+#endif
+
+private:
+    struct Timing;
+    std::shared_ptr<Timing> timing;     // Shared with the pad probes
+};
+
+} // namespace orbistream
@@ -0,0 +1,69 @@
+#include "frame_admission.h"
+#include "logger.h"
+#include <algorithm>
+
+#define LOG_TAG "FrameAdmission"
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+constexpr double kBackoff = 0.8;     // Ratio multiplier per congested frame
+constexpr double kRecovery = 0.02;   // Ratio increase per clear frame (~1.5 s from 0.25 at 30 fps)
+}
+
+FrameAdmission::FrameAdmission(const FrameAdmissionConfig& cfg) : config(cfg) {
+    maxInFlight = config.maxInFlightFrames > 0
+        ? static_cast<uint64_t>(config.maxInFlightFrames)
+        : static_cast<uint64_t>(std::max(2, config.frameRate * config.latencyBudgetMs / 1000));
+    reset();
+}
+
+void FrameAdmission::reset() {
+    credit = 0.0;
+    stats = FrameAdmissionStats{};
+}
+
+bool FrameAdmission::congested(const AdmissionSignals& signals) const {
+    if (signals.inFlightFrames > maxInFlight) return true;
+    // More than one raw frame waiting in appsrc: the convert/encode thread is behind
+    if (signals.frameBytes > 0 && signals.appsrcBytes > signals.frameBytes) return true;
+    if (signals.queueMaxBuffers > 0 && signals.queueBuffers + 1 >= signals.queueMaxBuffers) return true;
+    if (signals.encodeLatencyMs > config.latencyBudgetMs) return true;
+    return false;
+}
+
+bool FrameAdmission::admit(const AdmissionSignals& signals) {
+    stats.offered++;
+
+    // Hard limit: far behind, refuse regardless of spacing
+    if (signals.inFlightFrames > 2 * maxInFlight) {
+        stats.admitRatio = config.minAdmitRatio;
+        stats.refused++;
+        return false;
+    }
+
+    double previous = stats.admitRatio;
+    if (congested(signals)) {
+        stats.admitRatio = std::max(config.minAdmitRatio, stats.admitRatio * kBackoff);
+    } else {
+        stats.admitRatio = std::min(1.0, stats.admitRatio + kRecovery);
+    }
+    if ((previous == 1.0) != (stats.admitRatio == 1.0)) {
+        LOGD("Admit ratio %.2f -> %.2f (in flight %llu, latency %.0f ms)",
+             previous, stats.admitRatio,
+             (unsigned long long)signals.inFlightFrames, signals.encodeLatencyMs);
+    }
+
+    // Error accumulator: a ratio of 0.5 admits every other frame, not 15 then 15 dropped
+    credit += stats.admitRatio;
+    if (credit >= 1.0) {
+        credit -= 1.0;
+        stats.admitted++;
+        return true;
+    }
+    stats.refused++;
+    return false;
+}
+
+} // namespace orbistream
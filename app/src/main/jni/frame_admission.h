@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+namespace orbistream {
+
+/**
+ * Configuration for FrameAdmission.
+ */
+struct FrameAdmissionConfig {
+    int frameRate = 30;
+    int latencyBudgetMs = 200;     // Capture-to-encoded latency before frames are refused
+    int maxInFlightFrames = 0;     // Frames between appsrc and encoder output, 0 = derive from budget
+    double minAdmitRatio = 0.25;   // Never refuse more than 3 of 4 frames
+};
+
+/**
+ * Backlog signals sampled by the caller for each offered frame.
+ */
+struct AdmissionSignals {
+    uint64_t appsrcBytes = 0;      // appsrc current-level-bytes
+    uint64_t frameBytes = 0;       // Size of one raw frame
+    uint64_t inFlightFrames = 0;   // Pushed into appsrc but not yet out of the encoder
+    uint32_t queueBuffers = 0;     // Encoded frames waiting in video_queue
+    uint32_t queueMaxBuffers = 0;
+    double encodeLatencyMs = 0.0;  // Latest capture-to-encoder-output latency
+};
+
+/**
+ * Admission statistics.
+ */
+struct FrameAdmissionStats {
+    uint64_t offered = 0;
+    uint64_t admitted = 0;
+    uint64_t refused = 0;
+    double admitRatio = 1.0;       // Current fraction of frames let through
+};
+
+/**
+ * FrameAdmission decides at ingest whether a camera frame is worth
+ * pushing, so frames that would be dropped later by videorate or the
+ * leaky queue are refused before they are copied, converted or encoded.
+ *
+ * The admit ratio backs off multiplicatively while the encoder is behind
+ * (frames in flight, appsrc backlog, full queue or latency over budget)
+ * and recovers additively once it catches up. Drops are spread evenly
+ * with an error accumulator rather than in bursts.
+ *
+ * Not thread-safe: called from the capture thread only.
+ */
+class FrameAdmission {
+public:
+    explicit FrameAdmission(const FrameAdmissionConfig& config = FrameAdmissionConfig());
+
+    void reset();
+
+    /**
+     * @return true if the frame should be pushed
+     */
+    bool admit(const AdmissionSignals& signals);
+
+    FrameAdmissionStats getStats() const { return stats; }
+
+private:
+    bool congested(const AdmissionSignals& signals) const;
+
+    FrameAdmissionConfig config;
+    uint64_t maxInFlight = 0;
+    double credit = 0.0;
+    FrameAdmissionStats stats;
+};
+
+} // namespace orbistream
@@ -0,0 +1,182 @@
+#include "frame_convert.h"
+#include <algorithm>
+#include <cstring>
+
+namespace orbistream {
+
+const char* pixelFormatName(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::NV21: return "NV21";
+        case PixelFormat::NV12: return "NV12";
+        case PixelFormat::I420: return "I420";
+        default: return "NV21";
+    }
+}
+
+size_t pixelFormatFrameSize(PixelFormat, int width, int height) {
+    // All supported layouts are 4:2:0, 12 bits per pixel
+    return static_cast<size_t>(width) * height * 3 / 2;
+}
+
+void FrameConverter::configure(int sw, int sh, int dw, int dh, PixelFormat format) {
+    if (configured && sw == srcWidth && sh == srcHeight && dw == dstWidth &&
+        dh == dstHeight && format == dstFormat) {
+        return;
+    }
+    configured = true;
+    srcWidth = sw;
+    srcHeight = sh;
+    dstWidth = dw;
+    dstHeight = dh;
+    dstFormat = format;
+
+    lumaX.clear();
+    lumaY.clear();
+    chromaX.clear();
+    chromaY.clear();
+    if (sw != dw || sh != dh) {
+        buildTaps(lumaX, sw, dw);
+        buildTaps(lumaY, sh, dh);
+        buildTaps(chromaX, sw / 2, dw / 2);
+        buildTaps(chromaY, sh / 2, dh / 2);
+    }
+}
+
+// Pixel-center aligned source positions in 8.8 fixed point
+void FrameConverter::buildTaps(std::vector<Tap>& taps, int srcSize, int dstSize) {
+    taps.resize(dstSize);
+    for (int i = 0; i < dstSize; i++) {
+        int64_t pos = ((2LL * i + 1) * srcSize * 256) / (2LL * dstSize) - 128;
+        pos = std::max<int64_t>(pos, 0);
+        int i0 = static_cast<int>(pos >> 8);
+        i0 = std::min(i0, srcSize - 1);
+        taps[i].i0 = i0;
+        taps[i].i1 = std::min(i0 + 1, srcSize - 1);
+        taps[i].weight = static_cast<int>(pos & 0xFF);
+    }
+}
+
+void FrameConverter::convert(const uint8_t* src, uint8_t* dst) const {
+    if (lumaX.empty()) {
+        copyConvert(src, dst);
+    } else {
+        scaleConvert(src, dst);
+    }
+}
+
+void FrameConverter::copyConvert(const uint8_t* src, uint8_t* dst) const {
+    const size_t lumaSize = static_cast<size_t>(srcWidth) * srcHeight;
+    const size_t chromaPairs = lumaSize / 4;
+    const uint8_t* vu = src + lumaSize;
+
+    switch (dstFormat) {
+        case PixelFormat::NV21:
+            memcpy(dst, src, lumaSize + chromaPairs * 2);
+            break;
+        case PixelFormat::NV12: {
+            memcpy(dst, src, lumaSize);
+            uint8_t* uv = dst + lumaSize;
+            for (size_t i = 0; i < chromaPairs; i++) {
+                uv[2 * i] = vu[2 * i + 1];
+                uv[2 * i + 1] = vu[2 * i];
+            }
+            break;
+        }
+        case PixelFormat::I420: {
+            memcpy(dst, src, lumaSize);
+            uint8_t* u = dst + lumaSize;
+            uint8_t* v = u + chromaPairs;
+            for (size_t i = 0; i < chromaPairs; i++) {
+                v[i] = vu[2 * i];
+                u[i] = vu[2 * i + 1];
+            }
+            break;
+        }
+    }
+}
+
+// Horizontal taps over one blended VU row. `firstOffset` selects which source
+// component (V at 0, U at 1) lands in `first`; kStep is 2 for semi-planar output.
+template <int kStep>
+void FrameConverter::chromaRow(const uint16_t* __restrict blended, const Tap* taps, int width,
+                               int firstOffset, uint8_t* __restrict first,
+                               uint8_t* __restrict second) {
+    const int secondOffset = 1 - firstOffset;
+    for (int x = 0; x < width; x++) {
+        const int a = 2 * taps[x].i0;
+        const int b = 2 * taps[x].i1;
+        const int wb = taps[x].weight;
+        const int wa = 256 - wb;
+        first[x * kStep] = static_cast<uint8_t>(
+            (blended[a + firstOffset] * wa + blended[b + firstOffset] * wb + 32768) >> 16);
+        second[x * kStep] = static_cast<uint8_t>(
+            (blended[a + secondOffset] * wa + blended[b + secondOffset] * wb + 32768) >> 16);
+    }
+}
+
+// Separable bilinear: blend the two source rows (vectorizes), then apply the
+// horizontal taps while writing the destination row
+void FrameConverter::scaleConvert(const uint8_t* src, uint8_t* dst) const {
+    // Locals throughout: byte stores may alias members, which would force reloads
+    const int srcWidth = this->srcWidth;
+    const int srcHeight = this->srcHeight;
+    const int dstWidth = this->dstWidth;
+    const int dstHeight = this->dstHeight;
+    const Tap* lumaX = this->lumaX.data();
+    const Tap* lumaY = this->lumaY.data();
+    const Tap* chromaX = this->chromaX.data();
+    const Tap* chromaY = this->chromaY.data();
+    rowBuffer.resize(srcWidth);
+    uint16_t* __restrict blended = rowBuffer.data();
+
+    // Luma
+    for (int y = 0; y < dstHeight; y++) {
+        const Tap& ty = lumaY[y];
+        const uint8_t* r0 = src + static_cast<size_t>(ty.i0) * srcWidth;
+        const uint8_t* r1 = src + static_cast<size_t>(ty.i1) * srcWidth;
+        const int w1 = ty.weight;
+        const int w0 = 256 - w1;
+        for (int x = 0; x < srcWidth; x++) {
+            blended[x] = static_cast<uint16_t>(r0[x] * w0 + r1[x] * w1);
+        }
+        uint8_t* __restrict out = dst + static_cast<size_t>(y) * dstWidth;
+        for (int x = 0; x < dstWidth; x++) {
+            const Tap& tx = lumaX[x];
+            out[x] = static_cast<uint8_t>(
+                (blended[tx.i0] * (256 - tx.weight) + blended[tx.i1] * tx.weight + 32768) >> 16);
+        }
+    }
+
+    // Chroma: blend interleaved VU rows, write the destination layout directly
+    const int dstChromaWidth = dstWidth / 2;
+    const int dstChromaHeight = dstHeight / 2;
+    const uint8_t* vu = src + static_cast<size_t>(srcWidth) * srcHeight;
+    uint8_t* chroma = dst + static_cast<size_t>(dstWidth) * dstHeight;
+    const size_t planeSize = static_cast<size_t>(dstChromaWidth) * dstChromaHeight;
+
+    for (int y = 0; y < dstChromaHeight; y++) {
+        const Tap& ty = chromaY[y];
+        const uint8_t* r0 = vu + static_cast<size_t>(ty.i0) * srcWidth;   // width/2 VU pairs per row
+        const uint8_t* r1 = vu + static_cast<size_t>(ty.i1) * srcWidth;
+        const int w1 = ty.weight;
+        const int w0 = 256 - w1;
+        for (int x = 0; x < srcWidth; x++) {
+            blended[x] = static_cast<uint16_t>(r0[x] * w0 + r1[x] * w1);
+        }
+
+        const size_t row = static_cast<size_t>(y) * dstChromaWidth;
+        switch (dstFormat) {
+            case PixelFormat::NV21:
+                chromaRow<2>(blended, chromaX, dstChromaWidth, 0, chroma + 2 * row, chroma + 2 * row + 1);
+                break;
+            case PixelFormat::NV12:
+                chromaRow<2>(blended, chromaX, dstChromaWidth, 1, chroma + 2 * row, chroma + 2 * row + 1);
+                break;
+            case PixelFormat::I420:
+                chromaRow<1>(blended, chromaX, dstChromaWidth, 1, chroma + row, chroma + planeSize + row);
+                break;
+        }
+    }
+}
+
+} // namespace orbistream
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Raw 4:2:0 layouts the ingest path can produce.
+ */
+enum class PixelFormat {
+    NV21,   // Y, interleaved VU (camera)
+    NV12,   // Y, interleaved UV
+    I420    // Y, U, V planes
+};
+
+const char* pixelFormatName(PixelFormat format);
+size_t pixelFormatFrameSize(PixelFormat format, int width, int height);
+
+/**
+ * FrameConverter turns an NV21 camera frame into the encoder's input
+ * format and size in a single pass over the source, replacing the
+ * videoconvert ! videoscale pair. Same-size conversion is a copy with the
+ * chroma reordered; scaling is bilinear on luma and chroma, done while
+ * writing the destination layout.
+ *
+ * Frames are assumed tightly packed (stride == width), as delivered by
+ * CameraManager. Sizes must be even.
+ */
+class FrameConverter {
+public:
+    /**
+     * Prepare for a source/destination geometry. Cheap when unchanged.
+     */
+    void configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, PixelFormat dstFormat);
+
+    /**
+     * @param src NV21 frame of the configured source size
+     * @param dst pixelFormatFrameSize(dstFormat, dstWidth, dstHeight) bytes
+     */
+    void convert(const uint8_t* src, uint8_t* dst) const;
+
+    int sourceWidth() const { return srcWidth; }
+    int sourceHeight() const { return srcHeight; }
+    int targetWidth() const { return dstWidth; }
+    int targetHeight() const { return dstHeight; }
+
+private:
+    struct Tap {
+        int i0;
+        int i1;
+        int weight;     // Of i1, 0..256
+    };
+
+    static void buildTaps(std::vector<Tap>& taps, int srcSize, int dstSize);
+    void copyConvert(const uint8_t* src, uint8_t* dst) const;
+    void scaleConvert(const uint8_t* src, uint8_t* dst) const;
+    template <int kStep>
+    static void chromaRow(const uint16_t* blended, const Tap* taps, int width,
+                          int firstOffset, uint8_t* first, uint8_t* second);
+
+    bool configured = false;
+    int srcWidth = 0;
+    int srcHeight = 0;
+    int dstWidth = 0;
+    int dstHeight = 0;
+    PixelFormat dstFormat = PixelFormat::NV21;
+
+    // Bilinear taps, precomputed per geometry
+    std::vector<Tap> lumaX, lumaY, chromaX, chromaY;
+    mutable std::vector<uint16_t> rowBuffer;
+};
+
+} // namespace orbistream
@@ -0,0 +1,255 @@
+#include "gst_startup.h"
+#include "logger.h"
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>   // setenv
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+#define LOG_TAG "GstStartup"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+std::mutex startupMutex;
+StartupReport startup;
+
+#if GSTREAMER_AVAILABLE
+bool hardwareProbed = false;
+bool hardwareFound = false;
+
+int64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+std::string joined(const std::vector<std::string>& names) {
+    std::string result;
+    for (const std::string& name : names) {
+        if (!result.empty()) result += ",";
+        result += name;
+    }
+    return result;
+}
+
+// What the cached registry was built from; any change invalidates it
+std::string registryStamp() {
+    std::ostringstream ss;
+    guint major, minor, micro, nano;
+    gst_version(&major, &minor, &micro, &nano);
+    ss << "gstreamer " << major << "." << minor << "." << micro << "." << nano << "\n";
+    Dl_info info;
+    struct stat st;
+    if (dladdr(reinterpret_cast<void*>(&gst_init), &info) && info.dli_fname &&
+        stat(info.dli_fname, &st) == 0) {
+        ss << "library " << info.dli_fname << " " << st.st_size << " " << st.st_mtime << "\n";
+    }
+    ss << "plugins " << joined(livePlugins()) << "," << joined(onDemandPlugins()) << "\n";
+    return ss.str();
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return "";
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+std::vector<std::string> unregistered(const std::vector<std::string>& names) {
+    std::vector<std::string> missing;
+    GstRegistry* registry = gst_registry_get();
+    for (const std::string& name : names) {
+        GstPlugin* plugin = gst_registry_find_plugin(registry, name.c_str());
+        if (plugin) {
+            gst_object_unref(plugin);
+        } else {
+            missing.push_back(name);
+        }
+    }
+    return missing;
+}
+#endif
+}
+
+const char* startupPhaseName(StartupPhase phase) {
+    switch (phase) {
+        case StartupPhase::ENVIRONMENT: return "environment";
+        case StartupPhase::REGISTRY_CACHE: return "registry_cache";
+        case StartupPhase::GST_INIT: return "gst_init";
+        case StartupPhase::PLUGIN_CHECK: return "plugin_check";
+        case StartupPhase::HARDWARE_PROBE: return "hardware_probe";
+        default: return "unknown";
+    }
+}
+
+int64_t StartupReport::totalUs() const {
+    int64_t total = 0;
+    for (int64_t us : phaseUs) total += us;
+    return total;
+}
+
+const std::vector<std::string>& livePlugins() {
+    static const std::vector<std::string> plugins = {
+        "coreelements",     // queue, identity, fakesink, filesrc
+        "app",              // appsrc
+        "videoconvert", "videoscale", "videorate",
+        "audioconvert", "audioresample", "audiorate",
+        "x264", "voaacenc",
+        "videoparsersbad",  // h264parse
+        "audioparsers",     // aacparse
+        "mpegtsmux",
+        "srt",              // srtsink
+        "udp",              // udpsink (SOCKS5 relay, SRT_DIRECT hand-off)
+    };
+    return plugins;
+}
+
+const std::vector<std::string>& onDemandPlugins() {
+    static const std::vector<std::string> plugins = {
+        "playback",         // parsebin (file source)
+        "typefindfunctions",
+        "isomp4",           // qtdemux (.mp4/.mov)
+        "mpegtsdemux",      // tsdemux (.ts)
+        "videotestsrc",     // calibration
+    };
+    return plugins;
+}
+
+bool GstStartup::init(const std::string& cacheDir) {
+#if GSTREAMER_AVAILABLE
+    std::lock_guard<std::mutex> lock(startupMutex);
+    if (startup.initialized) return true;
+
+    auto begin = std::chrono::steady_clock::now();
+    std::string stamp;
+    std::string stampPath;
+    if (!cacheDir.empty()) {
+        startup.registryPath = cacheDir + "/gst-registry.bin";
+        stampPath = cacheDir + "/gst-registry.stamp";
+        stamp = registryStamp();
+        struct stat st;
+        startup.registryCacheHit = stat(startup.registryPath.c_str(), &st) == 0 &&
+                                   readFile(stampPath) == stamp;
+        if (!startup.registryCacheHit) {
+            unlink(startup.registryPath.c_str());
+            unlink(stampPath.c_str());
+        }
+        setenv("GST_REGISTRY", startup.registryPath.c_str(), 1);
+        setenv("GST_REGISTRY_UPDATE", startup.registryCacheHit ? "no" : "yes", 1);
+        // Scan in-process: no plugin-scanner helper to spawn
+        setenv("GST_REGISTRY_FORK", "no", 0);
+    }
+    startup.phaseUs[static_cast<size_t>(StartupPhase::REGISTRY_CACHE)] = elapsedUs(begin);
+
+    begin = std::chrono::steady_clock::now();
+    GError* error = nullptr;
+    if (!gst_init_check(nullptr, nullptr, &error)) {
+        LOGE("GStreamer init failed: %s", error ? error->message : "unknown error");
+        if (error) g_error_free(error);
+        return false;
+    }
+    startup.phaseUs[static_cast<size_t>(StartupPhase::GST_INIT)] = elapsedUs(begin);
+
+    begin = std::chrono::steady_clock::now();
+    std::vector<std::string> missing = unregistered(livePlugins());
+    if (!missing.empty() && startup.registryCacheHit) {
+        LOGI("Cached registry lacks %s, rescanning", joined(missing).c_str());
+        gst_update_registry();
+        missing = unregistered(livePlugins());
+    }
+    std::vector<std::string> optional = unregistered(onDemandPlugins());
+    if (!optional.empty()) {
+        LOGI("Plugins not available (file source / calibration only): %s", joined(optional).c_str());
+    }
+    if (!missing.empty()) {
+        // Don't trust this registry next launch either
+        LOGE("Plugins missing, pipelines will fail: %s", joined(missing).c_str());
+        if (!stampPath.empty()) unlink(stampPath.c_str());
+    } else if (!startup.registryCacheHit && !stampPath.empty()) {
+        struct stat st;
+        if (stat(startup.registryPath.c_str(), &st) == 0) {
+            std::ofstream(stampPath, std::ios::binary | std::ios::trunc) << stamp;
+        }
+    }
+    startup.missingPlugins = missing;
+    startup.missingPlugins.insert(startup.missingPlugins.end(), optional.begin(), optional.end());
+    startup.phaseUs[static_cast<size_t>(StartupPhase::PLUGIN_CHECK)] = elapsedUs(begin);
+
+    startup.initialized = true;
+    LOGI("GStreamer initialized: registry %s, init %lld us (gst_init %lld us)",
+         cacheDir.empty() ? "default" : (startup.registryCacheHit ? "cached" : "rebuilt"),
+         (long long)startup.totalUs(),
+         (long long)startup.phaseUs[static_cast<size_t>(StartupPhase::GST_INIT)]);
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(startupMutex);
+    startup.initialized = true;
+    return true;
+#endif
+}
+
+void GstStartup::recordPhase(StartupPhase phase, int64_t us) {
+    if (phase == StartupPhase::COUNT) return;
+    std::lock_guard<std::mutex> lock(startupMutex);
+    startup.phaseUs[static_cast<size_t>(phase)] = us;
+}
+
+// Check if Android MediaCodec hardware encoder is available
+bool GstStartup::hardwareEncoderAvailable() {
+#if GSTREAMER_AVAILABLE
+    std::lock_guard<std::mutex> lock(startupMutex);
+    if (hardwareProbed) return hardwareFound;
+
+    auto begin = std::chrono::steady_clock::now();
+    // Common element names: amcvidenc-omxgoogleh264encoder, amcvidenc-c2androidavch264encoder, etc.
+    const char* hwEncoders[] = {
+        "amcvidenc-c2androidavch264encoder",      // Android 10+ Codec2
+        "amcvidenc-omxgoogleh264encoder",         // OMX fallback
+        "amcvidenc-omxqaboradeh264encoder",       // Qualcomm
+        "amcvidenc-omxexynosh264enc",             // Samsung Exynos
+        "amcvidenc-omxtikicodesavch264encoder",   // MediaTek
+    };
+    for (const char* name : hwEncoders) {
+        GstElementFactory* factory = gst_element_factory_find(name);
+        if (factory) {
+            LOGI("Hardware encoder available: %s", name);
+            gst_object_unref(factory);
+            hardwareFound = true;
+            break;
+        }
+    }
+    if (!hardwareFound) {
+        // Device-specific codec names: the plugin being registered is enough
+        GstPlugin* plugin = gst_registry_find_plugin(gst_registry_get(), "androidmedia");
+        if (plugin) {
+            LOGI("Found androidmedia plugin - hardware encoding may be available");
+            gst_object_unref(plugin);
+            hardwareFound = true;
+        } else {
+            LOGI("No hardware encoder found - using software encoding");
+        }
+    }
+    hardwareProbed = true;
+    startup.phaseUs[static_cast<size_t>(StartupPhase::HARDWARE_PROBE)] = elapsedUs(begin);
+    return hardwareFound;
+#else
+    return false;
+#endif
+}
+
+StartupReport GstStartup::report() {
+    std::lock_guard<std::mutex> lock(startupMutex);
+    return startup;
+}
+
+} // namespace orbistream
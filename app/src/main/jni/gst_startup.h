@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Init steps between loading the library and the first pipeline, in the
+ * order they run. HARDWARE_PROBE runs on the first pipeline that asks for
+ * the hardware encoder, not at init.
+ */
+enum class StartupPhase {
+    ENVIRONMENT,        // App paths and environment variables (JNI)
+    REGISTRY_CACHE,     // Stamp check, GST_REGISTRY setup
+    GST_INIT,           // gst_init_check: registry load or rescan
+    PLUGIN_CHECK,       // Every plugin the pipelines name is registered
+    HARDWARE_PROBE,     // amcvidenc / androidmedia lookup
+    COUNT
+};
+
+const char* startupPhaseName(StartupPhase phase);
+
+struct StartupReport {
+    int64_t phaseUs[static_cast<size_t>(StartupPhase::COUNT)] = {};
+    bool initialized = false;
+    bool registryCacheHit = false;      // Registry loaded without a rescan
+    std::string registryPath;           // Empty if no cache dir was given
+    std::vector<std::string> missingPlugins;
+
+    int64_t totalUs() const;
+};
+
+/**
+ * Plugins buildPipelineString() and calibration name elements from. Must
+ * match GSTREAMER_PLUGINS in Android.mk; the first list is needed by every
+ * camera pipeline, the second only by the file source and calibration.
+ */
+const std::vector<std::string>& livePlugins();
+const std::vector<std::string>& onDemandPlugins();
+
+/**
+ * GstStartup runs gst_init once per process and keeps the registry in a
+ * cache directory across launches.
+ *
+ * The cache is trusted only while its stamp matches: the GStreamer version,
+ * the size and mtime of the library gst_init lives in (changes with every
+ * app update) and the plugin list above. With a matching stamp the registry
+ * is loaded without rescanning (GST_REGISTRY_UPDATE=no); if a live plugin
+ * is then missing it is rescanned once and the stamp dropped. Any mismatch
+ * deletes the cache and lets gst_init rebuild it.
+ */
+class GstStartup {
+public:
+    /**
+     * @param cacheDir directory for the registry cache, empty = GStreamer's default
+     * @return false if gst_init failed; true on every call after the first success
+     */
+    static bool init(const std::string& cacheDir);
+
+    /** Record a phase timed by the caller (ENVIRONMENT). */
+    static void recordPhase(StartupPhase phase, int64_t us);
+
+    /** Probed once, on first call, and remembered for the process. */
+    static bool hardwareEncoderAvailable();
+
+    static StartupReport report();
+};
+
+} // namespace orbistream
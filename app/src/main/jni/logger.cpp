@@ -0,0 +1,377 @@
+#include "logger.h"
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+namespace orbistream {
+namespace logger {
+
+namespace {
+
+struct Record {
+    int64_t timeNs;
+    const Category* category;
+    Level level;
+    char text[kRecordText];
+};
+
+// One per thread that logged while running; never freed, so a writer can
+// always touch it. Single producer (the owning thread), single consumer
+// (the flusher). A ring whose thread exited is handed to a new thread once
+// it is drained.
+struct ThreadRing {
+    int tid = 0;
+    std::unique_ptr<Record[]> records;
+    size_t capacity = 0;
+    std::atomic<uint64_t> head{0};      // Next slot the writer fills
+    std::atomic<uint64_t> tail{0};      // Next slot the flusher reads
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reportedDrops = 0;         // Flusher only
+    std::atomic<bool> owned{false};
+};
+
+struct CategoryEntry {
+    std::string name;
+    Category category;
+};
+
+std::mutex categoryMutex;               // categories, defaultLevel, ownLevel
+std::vector<std::unique_ptr<CategoryEntry>> categories;
+int defaultLevel = static_cast<int>(Level::INFO);
+
+std::mutex ringMutex;                   // rings, recordsPerThread
+std::vector<std::unique_ptr<ThreadRing>> rings;
+size_t recordsPerThread = kDefaultRecordsPerThread;
+
+std::atomic<bool> active{false};
+std::mutex flusherMutex;                // flusher, stopping
+std::condition_variable flusherWake;
+std::thread* flusher = nullptr;         // Not destroyed at exit: a running thread would terminate()
+bool stopping = false;
+
+constexpr auto kFlushInterval = std::chrono::milliseconds(20);
+
+int androidPriority(Level level) {
+    switch (level) {
+        case Level::ERROR: return ANDROID_LOG_ERROR;
+        case Level::WARN: return ANDROID_LOG_WARN;
+        case Level::INFO: return ANDROID_LOG_INFO;
+        case Level::DEBUG: return ANDROID_LOG_DEBUG;
+        default: return ANDROID_LOG_VERBOSE;
+    }
+}
+
+void logcatSink(Level level, const char* tag, const char* text) {
+    __android_log_write(androidPriority(level), tag, text);
+}
+
+std::atomic<Sink> sink{&logcatSink};
+std::atomic<uint64_t> writtenCount{0};
+std::atomic<uint64_t> droppedCount{0};
+
+struct ThreadSlot {
+    ThreadRing* ring = nullptr;
+    ~ThreadSlot() {
+        if (ring) ring->owned.store(false, std::memory_order_release);
+    }
+};
+thread_local ThreadSlot threadSlot;
+
+int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void formatText(char* text, const char* format, va_list args) {
+    int n = vsnprintf(text, kRecordText, format, args);
+    if (n >= static_cast<int>(kRecordText)) {
+        memcpy(text + kRecordText - 4, "...", 4);
+    }
+}
+
+void emit(Level level, const char* tag, const char* text) {
+    sink.load(std::memory_order_acquire)(level, tag, text);
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+ThreadRing* claimRing() {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ThreadRing* ring = nullptr;
+    for (auto& candidate : rings) {
+        if (!candidate->owned.load(std::memory_order_acquire) &&
+            candidate->head.load(std::memory_order_relaxed) ==
+                candidate->tail.load(std::memory_order_acquire)) {
+            ring = candidate.get();
+            break;
+        }
+    }
+    if (!ring) {
+        rings.push_back(std::make_unique<ThreadRing>());
+        ring = rings.back().get();
+        ring->records = std::make_unique<Record[]>(recordsPerThread);
+        ring->capacity = recordsPerThread;
+    }
+    ring->owned.store(true, std::memory_order_relaxed);
+    ring->tid = static_cast<int>(syscall(SYS_gettid));
+    return ring;
+}
+
+// Flusher thread, or stop() once it has joined it
+void drain() {
+    std::vector<ThreadRing*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        for (auto& ring : rings) snapshot.push_back(ring.get());
+    }
+
+    // Records stay in place until tail moves past them, so sort pointers
+    static std::vector<const Record*> batch;
+    std::vector<uint64_t> ends(snapshot.size());
+    batch.clear();
+    for (size_t i = 0; i < snapshot.size(); i++) {
+        ThreadRing* ring = snapshot[i];
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (uint64_t t = ring->tail.load(std::memory_order_relaxed); t < head; t++) {
+            batch.push_back(&ring->records[t % ring->capacity]);
+        }
+        ends[i] = head;
+    }
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const Record* a, const Record* b) { return a->timeNs < b->timeNs; });
+    for (const Record* record : batch) {
+        emit(record->level, record->category->name, record->text);
+    }
+    for (size_t i = 0; i < snapshot.size(); i++) {
+        snapshot[i]->tail.store(ends[i], std::memory_order_release);
+    }
+
+    for (ThreadRing* ring : snapshot) {
+        uint64_t dropped = ring->dropped.load(std::memory_order_relaxed);
+        if (dropped == ring->reportedDrops) continue;
+        char text[kRecordText];
+        snprintf(text, sizeof(text), "%llu log records dropped on thread %d (ring full)",
+                 (unsigned long long)(dropped - ring->reportedDrops), ring->tid);
+        emit(Level::WARN, "Logger", text);
+        droppedCount.fetch_add(dropped - ring->reportedDrops, std::memory_order_relaxed);
+        ring->reportedDrops = dropped;
+    }
+}
+
+void flushLoop() {
+    prctl(PR_SET_NAME, "orbi-log", 0, 0, 0);
+    std::unique_lock<std::mutex> lock(flusherMutex);
+    while (!stopping) {
+        flusherWake.wait_for(lock, kFlushInterval, [] { return stopping; });
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+#if GSTREAMER_AVAILABLE
+GstDebugLevel toGstLevel(Level level) {
+    switch (level) {
+        case Level::NONE: return GST_LEVEL_NONE;
+        case Level::ERROR: return GST_LEVEL_ERROR;
+        case Level::WARN: return GST_LEVEL_WARNING;
+        case Level::INFO: return GST_LEVEL_INFO;
+        case Level::DEBUG: return GST_LEVEL_DEBUG;
+        default: return GST_LEVEL_LOG;
+    }
+}
+
+Level fromGstLevel(GstDebugLevel level) {
+    if (level <= GST_LEVEL_ERROR) return Level::ERROR;
+    if (level == GST_LEVEL_WARNING) return Level::WARN;
+    if (level == GST_LEVEL_FIXME) return Level::INFO;   // Known shortcuts, not problems
+    if (level == GST_LEVEL_INFO) return Level::INFO;
+    if (level == GST_LEVEL_DEBUG) return Level::DEBUG;
+    return Level::VERBOSE;
+}
+
+// GStreamer has already applied its threshold when this runs
+void gstreamerLog(GstDebugCategory* gstCategory, GstDebugLevel gstLevel, const gchar* file,
+                  const gchar* function, gint line, GObject* object, GstDebugMessage* message,
+                  gpointer) {
+    static Category* const gstreamer = category("GStreamer");
+    Level level = fromGstLevel(gstLevel);
+    if (!gstreamer->enabled(level)) return;
+    const char* base = file ? strrchr(file, '/') : nullptr;
+    const char* objectName = object && GST_IS_OBJECT(object) ? GST_OBJECT_NAME(object) : nullptr;
+    write(gstreamer, level, "%s %s:%d:%s%s%s%s %s",
+          gst_debug_category_get_name(gstCategory), base ? base + 1 : (file ? file : "?"), line,
+          function ? function : "", objectName ? " <" : "", objectName ? objectName : "",
+          objectName ? ">" : "", gst_debug_message_get(message));
+}
+#endif
+
+} // namespace
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::NONE: return "none";
+        case Level::ERROR: return "error";
+        case Level::WARN: return "warn";
+        case Level::INFO: return "info";
+        case Level::DEBUG: return "debug";
+        case Level::VERBOSE: return "verbose";
+        default: return "unknown";
+    }
+}
+
+Category* category(const char* name) {
+    std::lock_guard<std::mutex> lock(categoryMutex);
+    for (auto& entry : categories) {
+        if (entry->name == name) return &entry->category;
+    }
+    categories.push_back(std::make_unique<CategoryEntry>());
+    CategoryEntry* entry = categories.back().get();
+    entry->name = name;
+    entry->category.name = entry->name.c_str();
+    entry->category.level.store(defaultLevel, std::memory_order_relaxed);
+    return &entry->category;
+}
+
+void setLevel(const std::string& name, Level level) {
+    if (name == "gst" || name.compare(0, 4, "gst:") == 0) {
+#if GSTREAMER_AVAILABLE
+        if (name == "gst") {
+            gst_debug_set_default_threshold(toGstLevel(level));
+        } else {
+            gst_debug_set_threshold_for_name(name.c_str() + 4, toGstLevel(level));
+        }
+#endif
+        return;
+    }
+
+    int value = static_cast<int>(level);
+    if (name == "*") {
+        std::lock_guard<std::mutex> lock(categoryMutex);
+        defaultLevel = value;
+        for (auto& entry : categories) {
+            if (!entry->category.ownLevel) entry->category.level.store(value, std::memory_order_relaxed);
+        }
+        return;
+    }
+    Category* target = category(name.c_str());
+    std::lock_guard<std::mutex> lock(categoryMutex);
+    target->ownLevel = true;
+    target->level.store(value, std::memory_order_relaxed);
+}
+
+void start(size_t perThread) {
+    std::lock_guard<std::mutex> lock(flusherMutex);
+    if (flusher) return;
+    {
+        // Rings created from now on; existing ones keep their size
+        std::lock_guard<std::mutex> ringLock(ringMutex);
+        recordsPerThread = std::max<size_t>(perThread, 8);
+    }
+    stopping = false;
+    active.store(true, std::memory_order_release);
+    flusher = new std::thread(flushLoop);
+}
+
+void stop() {
+    std::thread* worker = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(flusherMutex);
+        if (!flusher) return;
+        active.store(false, std::memory_order_release);
+        stopping = true;
+        worker = flusher;
+        flusher = nullptr;
+    }
+    flusherWake.notify_all();
+    worker->join();
+    delete worker;
+    // A writer that saw active just before the store may still land after
+    // this; its record goes out with the next start()
+    drain();
+}
+
+bool running() {
+    return active.load(std::memory_order_acquire);
+}
+
+void setSink(Sink newSink) {
+    sink.store(newSink ? newSink : &logcatSink, std::memory_order_release);
+}
+
+Stats stats() {
+    Stats result;
+    result.written = writtenCount.load(std::memory_order_relaxed);
+    result.dropped = droppedCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+void write(const Category* category, Level level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (!active.load(std::memory_order_acquire)) {
+        char text[kRecordText];
+        formatText(text, format, args);
+        va_end(args);
+        emit(level, category->name, text);
+        return;
+    }
+
+    ThreadRing* ring = threadSlot.ring;
+    if (!ring) {
+        ring = claimRing();
+        threadSlot.ring = ring;
+    }
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= ring->capacity) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        va_end(args);
+        return;
+    }
+    Record& record = ring->records[head % ring->capacity];
+    record.timeNs = nowNs();
+    record.category = category;
+    record.level = level;
+    formatText(record.text, format, args);
+    va_end(args);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void routeGstreamerDebug() {
+#if GSTREAMER_AVAILABLE
+    static std::once_flag routed;
+    std::call_once(routed, [] {
+        // GStreamer filters by its own thresholds; the category passes everything
+        Category* gstreamer = category("GStreamer");
+        {
+            std::lock_guard<std::mutex> lock(categoryMutex);
+            gstreamer->ownLevel = true;
+            gstreamer->level.store(static_cast<int>(Level::VERBOSE), std::memory_order_relaxed);
+        }
+        // Drops the default (stderr) and logcat outputs, both registered without data
+        gst_debug_remove_log_function_by_data(nullptr);
+        gst_debug_add_log_function(&gstreamerLog, nullptr, nullptr);
+        if (!getenv("GST_DEBUG")) gst_debug_set_default_threshold(GST_LEVEL_WARNING);
+    });
+#endif
+}
+
+} // namespace logger
+} // namespace orbistream
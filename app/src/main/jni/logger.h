@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace orbistream {
+namespace logger {
+
+/**
+ * Native logging off the calling thread.
+ *
+ * A log call checks its category's level (one relaxed load), formats into a
+ * fixed record in the calling thread's own ring and returns; it never takes
+ * a lock or makes a syscall. A background flusher drains the rings every
+ * few milliseconds, orders records by time and hands them to the sink
+ * (logcat). A full ring drops the record and counts it; the flusher reports
+ * drops per thread. Before start() and after stop() calls go straight to
+ * the sink.
+ *
+ * Categories are the per-file LOG_TAGs. Each has a level, adjustable at
+ * runtime; categories without their own level follow the default ("*").
+ * GStreamer's debug log is routed into the "GStreamer" category, with its
+ * own thresholds ("gst" and "gst:<category>").
+ */
+
+enum class Level { NONE = 0, ERROR = 1, WARN = 2, INFO = 3, DEBUG = 4, VERBOSE = 5 };
+
+const char* levelName(Level level);
+
+struct Category {
+    const char* name;
+    std::atomic<int> level;
+    bool ownLevel = false;       // Set explicitly, ignores the default
+
+    bool enabled(Level at) const {
+        return static_cast<int>(at) <= level.load(std::memory_order_relaxed);
+    }
+};
+
+/** @return the category for a tag, created on first use; never freed */
+Category* category(const char* name);
+
+/**
+ * Set a level at runtime.
+ * @param name a LOG_TAG, "*" for the default, "gst" for GStreamer's default
+ *             threshold, "gst:<category>" for one GStreamer debug category
+ */
+void setLevel(const std::string& name, Level level);
+
+constexpr size_t kDefaultRecordsPerThread = 128;
+constexpr size_t kRecordText = 232;     // Longer messages are truncated
+
+/** Start the flusher; a no-op while running. */
+void start(size_t recordsPerThread = kDefaultRecordsPerThread);
+
+/** Drain everything queued and stop the flusher. */
+void stop();
+
+bool running();
+
+/** Where flushed records go (default: logcat). Called from the flusher only. */
+using Sink = void (*)(Level level, const char* tag, const char* text);
+void setSink(Sink sink);
+
+struct Stats {
+    uint64_t written = 0;       // Records that reached the sink
+    uint64_t dropped = 0;       // Records lost to a full ring
+};
+Stats stats();
+
+/** Format and queue (or write through, when not running). Use the LOG macros. */
+void write(const Category* category, Level level, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * Replace GStreamer's default debug output with the "GStreamer" category.
+ * Messages keep GStreamer's own threshold filtering (GST_DEBUG or setLevel
+ * "gst..."); without GST_DEBUG the default threshold becomes WARNING.
+ */
+void routeGstreamerDebug();
+
+} // namespace logger
+} // namespace orbistream
+
+// The category is looked up once per call site, then every call is a level check
+#define ORBI_LOG(level, ...) \
+    do { \
+        static ::orbistream::logger::Category* const orbiLogCategory = \
+            ::orbistream::logger::category(LOG_TAG); \
+        if (orbiLogCategory->enabled(::orbistream::logger::Level::level)) \
+            ::orbistream::logger::write(orbiLogCategory, ::orbistream::logger::Level::level, __VA_ARGS__); \
+    } while (0)
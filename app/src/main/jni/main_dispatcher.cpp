@@ -0,0 +1,130 @@
+#include "main_dispatcher.h"
+#include "logger.h"
+#include <condition_variable>
+#include <mutex>
+
+#define LOG_TAG "MainDispatcher"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+std::mutex g_instanceMutex;
+std::weak_ptr<MainDispatcher> g_instance;
+
+#if GSTREAMER_AVAILABLE
+struct SyncCall {
+    const std::function<void()>* fn;
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+};
+
+gboolean runSyncCall(gpointer userData) {
+    auto* call = static_cast<SyncCall*>(userData);
+    (*call->fn)();
+    std::lock_guard<std::mutex> lock(call->mutex);
+    call->finished = true;
+    call->done.notify_one();
+    return G_SOURCE_REMOVE;
+}
+#endif
+}
+
+std::shared_ptr<MainDispatcher> MainDispatcher::acquire() {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    std::shared_ptr<MainDispatcher> dispatcher = g_instance.lock();
+    if (!dispatcher) {
+        dispatcher.reset(new MainDispatcher());
+        g_instance = dispatcher;
+    }
+    return dispatcher;
+}
+
+MainDispatcher::MainDispatcher() {
+#if GSTREAMER_AVAILABLE
+    context = g_main_context_new();
+    loop = g_main_loop_new(context, FALSE);
+    // The thread releases the loop: it may outlive this object (see destructor)
+    thread = std::thread([context = context, loop = loop]() {
+        LOGI("Main loop started");
+        g_main_context_push_thread_default(context);
+        g_main_loop_run(loop);
+        g_main_context_pop_thread_default(context);
+        g_main_loop_unref(loop);
+        g_main_context_unref(context);
+        LOGI("Main loop ended");
+    });
+#endif
+}
+
+MainDispatcher::~MainDispatcher() {
+#if GSTREAMER_AVAILABLE
+    // Quit from inside the loop so a loop that hasn't started running yet
+    // still sees it
+    g_main_context_invoke(context, [](gpointer userData) -> gboolean {
+        g_main_loop_quit(static_cast<GMainLoop*>(userData));
+        return G_SOURCE_REMOVE;
+    }, loop);
+    if (thread.joinable()) {
+        if (isDispatcherThread()) {
+            thread.detach();    // Last reference dropped by a callback: the loop ends after it returns
+        } else {
+            thread.join();
+        }
+    }
+#endif
+}
+
+bool MainDispatcher::isDispatcherThread() const {
+    return thread.get_id() == std::this_thread::get_id();
+}
+
+#if GSTREAMER_AVAILABLE
+guint MainDispatcher::addTimeout(unsigned intervalMs, GSourceFunc func, gpointer data) {
+    GSource* source = g_timeout_source_new(intervalMs);
+    g_source_set_callback(source, func, data, nullptr);
+    guint id = g_source_attach(source, context);
+    g_source_unref(source);
+    return id;
+}
+
+guint MainDispatcher::addBusWatch(GstBus* bus, GstBusFunc func, gpointer data) {
+    GSource* source = gst_bus_create_watch(bus);
+    if (!source) return 0;
+    g_source_set_callback(source, reinterpret_cast<GSourceFunc>(func), data, nullptr);
+    guint id = g_source_attach(source, context);
+    g_source_unref(source);
+    return id;
+}
+
+void MainDispatcher::removeSource(guint sourceId) {
+    if (sourceId == 0) return;
+    GSource* source = g_main_context_find_source_by_id(context, sourceId);
+    if (source) {
+        g_source_destroy(source);
+    }
+    // A dispatch already in progress finishes before this returns
+    invokeSync([]() {});
+}
+#endif
+
+void MainDispatcher::invokeSync(const std::function<void()>& fn) {
+#if GSTREAMER_AVAILABLE
+    if (isDispatcherThread()) {
+        fn();
+        return;
+    }
+    SyncCall call;
+    call.fn = &fn;
+    g_main_context_invoke(context, &runSyncCall, &call);
+    std::unique_lock<std::mutex> lock(call.mutex);
+    call.done.wait(lock, [&call]() { return call.finished; });
+#else
+    fn();
+#endif
+}
+
+} // namespace orbistream
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <thread>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+namespace orbistream {
+
+/**
+ * MainDispatcher is the one GLib main-loop thread shared by all streamer
+ * sessions: metrics timers, bus watches and anything else a session wants
+ * to run off its streaming threads. It uses its own GMainContext (not the
+ * global default one), so several sessions never race to own a context.
+ *
+ * Sessions hold a reference while streaming; the thread starts with the
+ * first acquire() and stops when the last reference is dropped.
+ *
+ * Callbacks run one at a time on the dispatcher thread. removeSource() waits
+ * for a callback already running, so its data can be freed right after.
+ */
+class MainDispatcher {
+public:
+    static std::shared_ptr<MainDispatcher> acquire();
+    ~MainDispatcher();
+
+    MainDispatcher(const MainDispatcher&) = delete;
+    MainDispatcher& operator=(const MainDispatcher&) = delete;
+
+#if GSTREAMER_AVAILABLE
+    /** @return source id for removeSource() */
+    guint addTimeout(unsigned intervalMs, GSourceFunc func, gpointer data);
+    guint addBusWatch(GstBus* bus, GstBusFunc func, gpointer data);
+    void removeSource(guint sourceId);
+#endif
+
+    /** Run fn on the dispatcher thread and wait for it (runs inline if already there). */
+    void invokeSync(const std::function<void()>& fn);
+
+    bool isDispatcherThread() const;
+
+private:
+    MainDispatcher();
+
+#if GSTREAMER_AVAILABLE
+    GMainContext* context = nullptr;
+    GMainLoop* loop = nullptr;
+#endif
+    std::thread thread;
+};
+
+} // namespace orbistream
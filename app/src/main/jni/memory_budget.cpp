@@ -0,0 +1,209 @@
+#include "memory_budget.h"
+#include "logger.h"
+#include <algorithm>
+#include <mutex>
+
+#define LOG_TAG "MemoryBudget"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+// Relative shares, in MemoryComponent order. Raw frames are 100x the size of
+// encoded ones, so ingest gets the most; the retransmit ring is sized by
+// bitrate x latency and comes second.
+constexpr uint64_t kWeights[] = {40, 2, 12, 1, 5, 10, 30};
+static_assert(sizeof(kWeights) / sizeof(kWeights[0]) == static_cast<size_t>(MemoryComponent::COUNT),
+              "one weight per component");
+
+constexpr uint64_t kMinRingSlots = 64;
+
+uint64_t floorBytes(MemoryComponent component, uint64_t videoFrameBytes, uint64_t datagramBytes) {
+    switch (component) {
+        case MemoryComponent::VIDEO_INGEST: return 2 * videoFrameBytes;
+        case MemoryComponent::AUDIO_INGEST: return 32 * 1024;
+        case MemoryComponent::VIDEO_QUEUE: return 64 * 1024;
+        case MemoryComponent::AUDIO_QUEUE: return 16 * 1024;
+        case MemoryComponent::TS_QUEUE: return 64 * 1024;
+        case MemoryComponent::PACER:
+        case MemoryComponent::RETRANSMIT: return kMinRingSlots * datagramBytes;
+        default: return 0;
+    }
+}
+}
+
+const char* memoryComponentName(MemoryComponent component) {
+    switch (component) {
+        case MemoryComponent::VIDEO_INGEST: return "video_ingest";
+        case MemoryComponent::AUDIO_INGEST: return "audio_ingest";
+        case MemoryComponent::VIDEO_QUEUE: return "video_queue";
+        case MemoryComponent::AUDIO_QUEUE: return "audio_queue";
+        case MemoryComponent::TS_QUEUE: return "ts_queue";
+        case MemoryComponent::PACER: return "pacer";
+        case MemoryComponent::RETRANSMIT: return "retransmit";
+        default: return "unknown";
+    }
+}
+
+void MemoryBudget::configure(uint64_t budget, const std::vector<MemoryComponent>& components,
+                             uint64_t videoFrameBytes, uint64_t datagramBytes) {
+    totalBytes = budget;
+    for (size_t i = 0; i < kCount; i++) {
+        present[i] = false;
+        limits[i] = 0;
+        current[i].store(0, std::memory_order_relaxed);
+        peak[i].store(0, std::memory_order_relaxed);
+    }
+    totalPeak.store(0, std::memory_order_relaxed);
+    for (MemoryComponent component : components) {
+        if (component != MemoryComponent::COUNT) present[static_cast<size_t>(component)] = true;
+    }
+    if (totalBytes == 0) return;
+
+    // Shares below their floor are raised to it and the rest split again
+    bool fixed[kCount] = {};
+    uint64_t remaining = totalBytes;
+    uint64_t weightLeft = 0;
+    for (size_t i = 0; i < kCount; i++) {
+        if (present[i]) weightLeft += kWeights[i];
+    }
+    bool changed = true;
+    while (changed && weightLeft > 0) {
+        changed = false;
+        for (size_t i = 0; i < kCount; i++) {
+            if (!present[i] || fixed[i]) continue;
+            uint64_t minimum = floorBytes(static_cast<MemoryComponent>(i), videoFrameBytes, datagramBytes);
+            if (remaining * kWeights[i] / weightLeft >= minimum) continue;
+            limits[i] = minimum;
+            fixed[i] = true;
+            remaining -= std::min(remaining, minimum);
+            weightLeft -= kWeights[i];
+            changed = true;
+        }
+    }
+    uint64_t assigned = 0;
+    for (size_t i = 0; i < kCount; i++) {
+        if (present[i] && !fixed[i]) limits[i] = remaining * kWeights[i] / weightLeft;
+        assigned += limits[i];
+    }
+
+    LOGI("Memory budget %llu KB:", (unsigned long long)(totalBytes / 1024));
+    for (size_t i = 0; i < kCount; i++) {
+        if (!present[i]) continue;
+        LOGI("  %s %llu KB%s", memoryComponentName(static_cast<MemoryComponent>(i)),
+             (unsigned long long)(limits[i] / 1024), fixed[i] ? " (minimum)" : "");
+    }
+    if (assigned > totalBytes) {
+        LOGE("Memory budget %llu KB is below the pipeline's minimum, using %llu KB",
+             (unsigned long long)(totalBytes / 1024), (unsigned long long)(assigned / 1024));
+    }
+}
+
+bool MemoryBudget::has(MemoryComponent component) const {
+    return component != MemoryComponent::COUNT && present[static_cast<size_t>(component)];
+}
+
+uint64_t MemoryBudget::limit(MemoryComponent component) const {
+    return has(component) ? limits[static_cast<size_t>(component)] : 0;
+}
+
+void MemoryBudget::update(MemoryComponent component, uint64_t bytes, uint64_t peakBytes) {
+    if (!has(component)) return;
+    size_t i = static_cast<size_t>(component);
+    current[i].store(bytes, std::memory_order_relaxed);
+    uint64_t high = std::max(bytes, peakBytes);
+    uint64_t seen = peak[i].load(std::memory_order_relaxed);
+    while (high > seen && !peak[i].compare_exchange_weak(seen, high, std::memory_order_relaxed)) {}
+
+    uint64_t total = currentBytes();
+    seen = totalPeak.load(std::memory_order_relaxed);
+    while (total > seen && !totalPeak.compare_exchange_weak(seen, total, std::memory_order_relaxed)) {}
+}
+
+uint64_t MemoryBudget::currentBytes() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kCount; i++) {
+        total += current[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::vector<MemoryUsage> MemoryBudget::usage() const {
+    std::vector<MemoryUsage> result;
+    for (size_t i = 0; i < kCount; i++) {
+        if (!present[i]) continue;
+        MemoryUsage entry;
+        entry.component = static_cast<MemoryComponent>(i);
+        entry.limitBytes = limits[i];
+        entry.currentBytes = current[i].load(std::memory_order_relaxed);
+        entry.peakBytes = peak[i].load(std::memory_order_relaxed);
+        result.push_back(entry);
+    }
+    return result;
+}
+
+struct FramePool::Storage {
+    size_t frameBytes = 0;
+    size_t frames = 0;
+    std::unique_ptr<uint8_t[]> data;    // Not value-initialised: pages are touched on first use
+    std::mutex mutex;
+    std::vector<size_t> freeFrames;
+    std::atomic<size_t> inFlight{0};
+};
+
+struct FramePool::FrameRef {
+    std::shared_ptr<Storage> storage;
+    size_t index;
+};
+
+FramePool::FramePool(size_t frameBytes, size_t frames) : storage(std::make_shared<Storage>()) {
+    storage->frameBytes = frameBytes;
+    storage->frames = frames;
+    storage->data.reset(new uint8_t[frameBytes * frames]);
+    storage->freeFrames.reserve(frames);
+    for (size_t i = frames; i > 0; i--) {
+        storage->freeFrames.push_back(i - 1);
+    }
+}
+
+// Buffer freed: its frame goes back to the free list
+void FramePool::releaseFrame(void* userData) {
+    auto* ref = static_cast<FrameRef*>(userData);
+    {
+        std::lock_guard<std::mutex> lock(ref->storage->mutex);
+        ref->storage->freeFrames.push_back(ref->index);
+    }
+    ref->storage->inFlight.fetch_sub(1, std::memory_order_relaxed);
+    delete ref;
+}
+
+#if GSTREAMER_AVAILABLE
+GstBuffer* FramePool::acquire() {
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(storage->mutex);
+        if (storage->freeFrames.empty()) return nullptr;
+        index = storage->freeFrames.back();
+        storage->freeFrames.pop_back();
+    }
+    storage->inFlight.fetch_add(1, std::memory_order_relaxed);
+    uint8_t* frame = storage->data.get() + index * storage->frameBytes;
+    return gst_buffer_new_wrapped_full(static_cast<GstMemoryFlags>(0), frame, storage->frameBytes,
+                                       0, storage->frameBytes, new FrameRef{storage, index}, &releaseFrame);
+}
+#endif
+
+size_t FramePool::frameBytes() const {
+    return storage->frameBytes;
+}
+
+size_t FramePool::capacity() const {
+    return storage->frames;
+}
+
+size_t FramePool::inFlight() const {
+    return storage->inFlight.load(std::memory_order_relaxed);
+}
+
+} // namespace orbistream
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+namespace orbistream {
+
+/**
+ * Pipeline stages that hold buffered data, in the order they are reported.
+ */
+enum class MemoryComponent {
+    VIDEO_INGEST,   // Raw frames pushed but not yet encoded (ingest buffer pool)
+    AUDIO_INGEST,   // PCM waiting in the audio appsrc
+    VIDEO_QUEUE,    // Encoded video in video_queue
+    AUDIO_QUEUE,    // Encoded audio in audio_queue
+    TS_QUEUE,       // TS datagrams waiting in ts_src
+    PACER,          // PacketPacer ring (preallocated)
+    RETRANSMIT,     // ArqSender ring (preallocated) or libsrt send buffers
+    COUNT
+};
+
+const char* memoryComponentName(MemoryComponent component);
+
+/**
+ * Bytes held by one component.
+ */
+struct MemoryUsage {
+    MemoryComponent component = MemoryComponent::VIDEO_INGEST;
+    uint64_t limitBytes = 0;        // Share of the budget, 0 = unbounded
+    uint64_t currentBytes = 0;      // Latest sample
+    uint64_t peakBytes = 0;         // High-water mark since configure()
+};
+
+/**
+ * MemoryBudget splits StreamConfig::memoryBudgetBytes over the components
+ * a pipeline actually has and keeps their live byte counts and high-water
+ * marks.
+ *
+ * Shares are fixed weights (raw video gets the most), renormalised over the
+ * components present. A share below a component's floor (two raw frames
+ * for video ingest, 64 datagrams for the rings) is raised to the floor and
+ * the rest is split again, so a budget that is too small is overrun
+ * visibly rather than leaving a stage unable to hold a single unit.
+ *
+ * The caller enforces the limits (queue and appsrc byte limits, pool and
+ * ring sizes) and reports levels through update(), which may be called
+ * from any thread. configure() must not run concurrently with it.
+ */
+class MemoryBudget {
+public:
+    /**
+     * @param totalBytes budget, 0 = unbounded (only accounting)
+     * @param present components this pipeline has
+     * @param videoFrameBytes size of one raw frame at ingest
+     * @param datagramBytes memory per ring slot (pacer / ARQ)
+     */
+    void configure(uint64_t totalBytes, const std::vector<MemoryComponent>& present,
+                   uint64_t videoFrameBytes, uint64_t datagramBytes);
+
+    bool bounded() const { return totalBytes > 0; }
+    bool has(MemoryComponent component) const;
+    /** @return the component's share, 0 if unbounded or not present */
+    uint64_t limit(MemoryComponent component) const;
+
+    /** Record the bytes a component holds now (and its own high-water mark, if it keeps one). */
+    void update(MemoryComponent component, uint64_t bytes, uint64_t peakBytes = 0);
+
+    std::vector<MemoryUsage> usage() const;
+    uint64_t budgetBytes() const { return totalBytes; }
+    uint64_t currentBytes() const;
+    uint64_t peakBytes() const { return totalPeak.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kCount = static_cast<size_t>(MemoryComponent::COUNT);
+
+    uint64_t totalBytes = 0;
+    bool present[kCount] = {};
+    uint64_t limits[kCount] = {};
+    std::atomic<uint64_t> current[kCount] = {};
+    std::atomic<uint64_t> peak[kCount] = {};
+    std::atomic<uint64_t> totalPeak{0};
+};
+
+/**
+ * FramePool hands out raw video buffers backed by a fixed number of frames
+ * allocated once. A frame comes back when GStreamer frees the buffer that
+ * wraps it, on whichever thread that happens, so inFlight() counts the raw
+ * frames held anywhere between appsrc and the encoder.
+ *
+ * acquire() never waits: with every frame in flight it returns nullptr and
+ * the caller drops the frame. Buffers may outlive the pool.
+ */
+class FramePool {
+public:
+    FramePool(size_t frameBytes, size_t frames);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+#if GSTREAMER_AVAILABLE
+    GstBuffer* acquire();
+#endif
+
+    size_t frameBytes() const;
+    size_t capacity() const;
+    size_t inFlight() const;
+
+private:
+    struct Storage;
+    struct FrameRef;
+    static void releaseFrame(void* userData);
+
+    std::shared_ptr<Storage> storage;   // Also held by every buffer out of the pool
+};
+
+} // namespace orbistream
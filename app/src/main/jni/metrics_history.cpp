@@ -0,0 +1,154 @@
+#include "metrics_history.h"
+#include "logger.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+
+#define LOG_TAG "MetricsHistory"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+static_assert(std::is_trivially_copyable<MetricsRecord>::value, "records are copied as words");
+static_assert(sizeof(MetricsRecord) % sizeof(uint32_t) == 0, "records are whole words");
+
+constexpr uint32_t kTypeU32 = 0;
+constexpr uint32_t kTypeF32 = 1;
+constexpr size_t kNameSize = 24;
+
+struct FieldInfo {
+    const char* name;
+    uint32_t type;
+};
+
+// Column names for the file header, in MetricsRecord order
+constexpr FieldInfo kFields[] = {
+    {"stream_time_ms", kTypeU32},
+    {"connection_state", kTypeU32},
+    {"bitrate_kbps", kTypeF32},
+    {"encoder_kbps", kTypeF32},
+    {"abr_action", kTypeU32},
+    {"rtt_ms", kTypeF32},
+    {"bandwidth_kbps", kTypeU32},
+    {"packets_lost", kTypeU32},
+    {"packets_retransmitted", kTypeU32},
+    {"packets_dropped", kTypeU32},
+    {"input_fps", kTypeF32},
+    {"output_fps", kTypeF32},
+    {"frames_refused", kTypeU32},
+    {"admit_ratio", kTypeF32},
+    {"encode_latency_ms", kTypeF32},
+    {"video_queue_buffers", kTypeU32},
+    {"pacer_queue_depth", kTypeU32},
+    {"pacer_delay_ms", kTypeF32},
+};
+static_assert(sizeof(kFields) / sizeof(kFields[0]) == sizeof(MetricsRecord) / sizeof(uint32_t),
+              "one column per record field");
+
+int64_t wallClockMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void putLe(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+}
+
+MetricsHistory::MetricsHistory(size_t capacity)
+    : slotCount(capacity > 0 ? capacity : 1),
+      slots(std::make_unique<Slot[]>(slotCount)) {}
+
+void MetricsHistory::push(const MetricsRecord& record) {
+    uint32_t words[kWords];
+    memcpy(words, &record, sizeof(words));
+
+    uint64_t n = written.load(std::memory_order_relaxed);
+    Slot& slot = slots[n % slotCount];
+    // Odd while the words change; readers that see it retry or skip the slot
+    slot.sequence.store(static_cast<uint32_t>(2 * n + 1), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(static_cast<uint32_t>(2 * n + 2), std::memory_order_release);
+    lastWallMs.store(wallClockMs(), std::memory_order_relaxed);
+    written.store(n + 1, std::memory_order_release);
+}
+
+std::vector<MetricsRecord> MetricsHistory::snapshot() const {
+    uint64_t end = written.load(std::memory_order_acquire);
+    uint64_t begin = end > slotCount ? end - slotCount : 0;
+
+    std::vector<MetricsRecord> records;
+    records.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t n = begin; n < end; n++) {
+        const Slot& slot = slots[n % slotCount];
+        const uint32_t expected = static_cast<uint32_t>(2 * n + 2);
+        uint32_t words[kWords];
+        if (slot.sequence.load(std::memory_order_acquire) != expected) continue;
+        for (size_t i = 0; i < kWords; i++) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Overwritten while copying: the writer has lapped this reader
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) continue;
+
+        MetricsRecord record;
+        memcpy(&record, words, sizeof(words));
+        records.push_back(record);
+    }
+    return records;
+}
+
+bool MetricsHistory::dump(const std::string& path, uint32_t intervalMs) const {
+    std::vector<MetricsRecord> records = snapshot();
+    constexpr size_t fieldCount = sizeof(kFields) / sizeof(kFields[0]);
+
+    std::vector<uint8_t> out;
+    out.reserve(32 + fieldCount * (kNameSize + 4) + records.size() * sizeof(MetricsRecord));
+    out.insert(out.end(), {'O', 'S', 'M', 'H'});
+    putLe(out, kVersion, 2);
+    putLe(out, fieldCount, 2);
+    putLe(out, sizeof(MetricsRecord), 4);
+    putLe(out, records.size(), 4);
+    putLe(out, intervalMs, 4);
+    putLe(out, static_cast<uint64_t>(lastWallMs.load(std::memory_order_relaxed)), 8);
+    for (const FieldInfo& field : kFields) {
+        char name[kNameSize] = {};
+        strncpy(name, field.name, kNameSize - 1);
+        out.insert(out.end(), name, name + kNameSize);
+        putLe(out, field.type, 4);
+    }
+    for (const MetricsRecord& record : records) {
+        uint32_t words[kWords];
+        memcpy(words, &record, sizeof(words));
+        for (uint32_t word : words) {
+            putLe(out, word, 4);
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        LOGE("Cannot write %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = fclose(file) == 0 && ok;
+    if (ok) {
+        LOGI("Dumped %zu records (%zu bytes) to %s", records.size(), out.size(), path.c_str());
+    } else {
+        LOGE("Short write to %s", path.c_str());
+    }
+    return ok;
+}
+
+} // namespace orbistream
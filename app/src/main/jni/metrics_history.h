@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * ABR decision taken during a metrics interval (the last one wins).
+ */
+enum class AbrAction : uint32_t {
+    NONE,
+    HOLD,           // Evaluated, change below 5%
+    REDUCE_FAST,    // High loss/RTT: -30%
+    REDUCE_SLOW,    // Moderate loss/RTT: -10%
+    INCREASE,       // Good conditions: +10%
+    BANDWIDTH_CAP   // Capped at 80% of the bandwidth estimate
+};
+
+/**
+ * One interval of stream metrics. Every field is 32 bits so a record is a
+ * plain array of words; counters are deltas over the interval.
+ */
+struct MetricsRecord {
+    uint32_t streamTimeMs = 0;
+    uint32_t connectionState = 0;    // SrtConnectionState
+    float bitrateKbps = 0;           // Measured send rate
+    float encoderKbps = 0;           // Encoder bitrate after ABR
+    uint32_t abrAction = 0;          // AbrAction
+    float rttMs = 0;
+    uint32_t bandwidthKbps = 0;      // Transport estimate, 0 = none
+    uint32_t packetsLost = 0;
+    uint32_t packetsRetransmitted = 0;
+    uint32_t packetsDropped = 0;
+    float inputFps = 0;
+    float outputFps = 0;
+    uint32_t framesRefused = 0;
+    float admitRatio = 0;
+    float encodeLatencyMs = 0;
+    uint32_t videoQueueBuffers = 0;  // Encoded frames waiting for the muxer
+    uint32_t pacerQueueDepth = 0;
+    float pacerDelayMs = 0;
+};
+
+/**
+ * MetricsHistory keeps the last `capacity` MetricsRecords in a fixed ring.
+ *
+ * push() is lock-free and meant for a single writer (the stats sampler).
+ * snapshot() and dump() may run on any thread at the same time: each slot
+ * carries a sequence number that is odd while it is written, and readers
+ * drop slots that changed under them.
+ *
+ * dump() writes a self-describing file (little-endian):
+ *   char magic[4] "OSMH" | u16 version | u16 field count | u32 record size
+ *   u32 record count | u32 interval (ms) | u64 wall clock (ms) of the last record
+ *   field count x { char name[24], u32 type (0 = u32, 1 = f32) }
+ *   record count x record, oldest first
+ * tools/metrics_decode turns it into CSV.
+ */
+class MetricsHistory {
+public:
+    static constexpr uint16_t kVersion = 1;
+
+    explicit MetricsHistory(size_t capacity);
+
+    void push(const MetricsRecord& record);
+
+    /** Records currently held, oldest first. */
+    std::vector<MetricsRecord> snapshot() const;
+
+    /**
+     * Write the history to path.
+     * @param intervalMs Sampling interval, stored in the header
+     */
+    bool dump(const std::string& path, uint32_t intervalMs) const;
+
+    size_t capacity() const { return slotCount; }
+
+private:
+    static constexpr size_t kWords = sizeof(MetricsRecord) / sizeof(uint32_t);
+
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> words[kWords];
+    };
+
+    size_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> written{0};    // Records pushed so far
+    std::atomic<int64_t> lastWallMs{0};
+};
+
+} // namespace orbistream
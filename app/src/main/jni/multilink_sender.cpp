@@ -0,0 +1,345 @@
+#include "multilink_sender.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_TAG "MultiLinkSender"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+constexpr size_t kMaxDatagramSize = 1500;
+constexpr size_t kReplySize = MultiLinkSender::kHeaderSize + 12;
+constexpr double kMinDeliveryBps = 500000.0;   // Rate assumed for a link carrying little traffic
+constexpr double kLossGain = 1.0 / 16;         // EWMA gain per probe outcome
+
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+uint32_t get32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void writeHeader(uint8_t* p, uint8_t type, uint8_t link, uint32_t sequence, int64_t nowNs) {
+    p[0] = MultiLinkSender::kMagic;
+    p[1] = type;
+    p[2] = link;
+    p[3] = 0;
+    put32(p + 4, sequence);
+    put32(p + 8, static_cast<uint32_t>(nowNs / 1000));
+}
+
+bool resolve(const std::string& host, int port, std::vector<uint8_t>& address) {
+    struct addrinfo hints = {};
+    struct addrinfo* result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 || !result) {
+        return false;
+    }
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(result->ai_addr);
+    address.assign(raw, raw + result->ai_addrlen);
+    freeaddrinfo(result);
+    return true;
+}
+}
+
+MultiLinkSender::MultiLinkSender(const MultiLinkConfig& cfg, const std::vector<UdpLinkSocket>& sockets)
+    : config(cfg) {
+    for (const UdpLinkSocket& socket : sockets) {
+        if (links.size() == 255) break;     // Link id is one byte
+        Link link;
+        link.name = socket.name;
+        std::string host = socket.host.empty() ? config.host : socket.host;
+        int port = socket.port > 0 ? socket.port : config.port;
+        if (!resolve(host, port, link.address)) {
+            LOGE("Link %s: cannot resolve %s:%d", socket.name.c_str(), host.c_str(), port);
+            continue;
+        }
+        link.fd = dup(socket.fd);
+        if (link.fd < 0) {
+            LOGE("Link %s: invalid socket fd %d (%s)", socket.name.c_str(), socket.fd, strerror(errno));
+            continue;
+        }
+        links.push_back(std::move(link));
+    }
+}
+
+MultiLinkSender::~MultiLinkSender() {
+    stop();
+    for (Link& link : links) {
+        if (link.fd >= 0) close(link.fd);
+    }
+}
+
+int64_t MultiLinkSender::nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool MultiLinkSender::start() {
+    if (running) return true;
+    if (links.empty()) {
+        LOGE("No usable links");
+        return false;
+    }
+    startNs = nowNs();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sequence = 0;
+        for (Link& link : links) {
+            link.up = true;
+            link.srttMs = 100.0;
+            link.rttSamples = 0;
+            link.lossRate = 0.0;
+            link.deliveryBps = 0.0;
+            link.wrrCurrent = 0.0;
+            link.packetsSent = link.bytesSent = link.ackedBytes = 0;
+            link.lastReplyNs = link.ackedAtNs = 0;
+            link.statsBytes = link.statsPackets = 0;
+            link.statsNs = startNs;
+            std::fill(std::begin(link.probePending), std::end(link.probePending), false);
+        }
+    }
+    totalBytes = 0;
+    totalDatagrams = 0;
+    refused = 0;
+    running = true;
+    thread = std::thread(&MultiLinkSender::run, this);
+    LOGI("Started with %zu links, %s scheduling", links.size(),
+         config.scheduler == LinkScheduler::EARLIEST_DELIVERY ? "earliest-delivery" : "weighted round-robin");
+    return true;
+}
+
+void MultiLinkSender::stop() {
+    if (!running) return;
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// Caller holds the mutex
+MultiLinkSender::Link* MultiLinkSender::pickLink(int64_t now) {
+    Link* best = nullptr;
+    if (config.scheduler == LinkScheduler::WEIGHTED_ROUND_ROBIN) {
+        // Smooth WRR: every link gains its weight, the leader is picked and pays the total
+        double total = 0.0;
+        for (Link& link : links) {
+            if (!link.up) continue;
+            double delivered = 1.0 - link.lossRate;
+            double weight = delivered * delivered / std::max(link.srttMs, 5.0);
+            link.wrrCurrent += weight;
+            total += weight;
+            if (!best || link.wrrCurrent > best->wrrCurrent) best = &link;
+        }
+        if (best) best->wrrCurrent -= total;
+    } else {
+        double bestCost = 0.0;
+        for (Link& link : links) {
+            if (!link.up) continue;
+            // Bytes still in flight: sent minus acknowledged, with the ack
+            // count extrapolated since the last reply at the delivery rate
+            double rate = std::max(link.deliveryBps, kMinDeliveryBps);
+            double acked = static_cast<double>(link.ackedBytes);
+            if (link.ackedAtNs > 0) {
+                acked += link.deliveryBps * (now - link.ackedAtNs) / 8e9;
+            }
+            double inFlight = std::max(0.0, static_cast<double>(link.bytesSent) - acked);
+            double arrivalMs = link.srttMs / 2 + inFlight * 8 * 1000 / rate;
+            double cost = arrivalMs / std::max(0.05, 1.0 - link.lossRate);
+            if (!best || cost < bestCost) {
+                best = &link;
+                bestCost = cost;
+            }
+        }
+    }
+    if (!best) {
+        // Everything looks down: keep sending on the link heard from last
+        for (Link& link : links) {
+            if (!best || link.lastReplyNs > best->lastReplyNs) best = &link;
+        }
+    }
+    return best;
+}
+
+bool MultiLinkSender::send(const uint8_t* data, size_t size) {
+    if (!running || size + kHeaderSize > kMaxDatagramSize) return false;
+
+    uint8_t packet[kMaxDatagramSize];
+    int64_t now = nowNs();
+    Link* link;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        link = pickLink(now);
+        if (!link) {
+            refused.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        writeHeader(packet, kTypeData, static_cast<uint8_t>(link - links.data()), sequence++, now);
+        link->packetsSent++;
+        link->bytesSent += size + kHeaderSize;
+    }
+    memcpy(packet + kHeaderSize, data, size);
+
+    ssize_t sent = sendto(link->fd, packet, size + kHeaderSize, MSG_DONTWAIT,
+                          reinterpret_cast<const sockaddr*>(link->address.data()),
+                          static_cast<socklen_t>(link->address.size()));
+    if (sent < 0) {
+        LOGD("Link %s: send failed (%s)", link->name.c_str(), strerror(errno));
+        refused.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    totalBytes.fetch_add(size + kHeaderSize, std::memory_order_relaxed);
+    totalDatagrams.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void MultiLinkSender::sendProbes(int64_t now) {
+    uint8_t probe[kHeaderSize];
+    for (size_t i = 0; i < links.size(); i++) {
+        Link& link = links[i];
+        uint32_t seq;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            seq = link.nextProbe++;
+            size_t slot = seq % Link::kProbeSlots;
+            link.probeSeq[slot] = seq;
+            link.probeSentNs[slot] = now;
+            link.probePending[slot] = true;
+        }
+        writeHeader(probe, kTypeProbe, static_cast<uint8_t>(i), seq, now);
+        sendto(link.fd, probe, sizeof(probe), MSG_DONTWAIT,
+               reinterpret_cast<const sockaddr*>(link.address.data()),
+               static_cast<socklen_t>(link.address.size()));
+    }
+}
+
+void MultiLinkSender::readReplies(int64_t now) {
+    uint8_t buf[64];
+    for (Link& link : links) {
+        ssize_t n;
+        while ((n = recv(link.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            if (static_cast<size_t>(n) < kReplySize || buf[0] != kMagic || buf[1] != kTypeProbeReply) {
+                continue;
+            }
+            uint32_t seq = get32(buf + 4);
+            uint64_t ackedBytes = (static_cast<uint64_t>(get32(buf + kHeaderSize + 4)) << 32) |
+                                  get32(buf + kHeaderSize + 8);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t slot = seq % Link::kProbeSlots;
+            if (link.probePending[slot] && link.probeSeq[slot] == seq) {
+                link.probePending[slot] = false;
+                double rttMs = (now - link.probeSentNs[slot]) / 1e6;
+                link.srttMs = link.rttSamples++ == 0 ? rttMs : link.srttMs * 0.875 + rttMs * 0.125;
+                link.lossRate += (0.0 - link.lossRate) * kLossGain;
+            }
+            if (link.ackedAtNs > 0 && ackedBytes >= link.ackedBytes && now - link.ackedAtNs >= 50000000LL) {
+                double rate = (ackedBytes - link.ackedBytes) * 8e9 / (now - link.ackedAtNs);
+                link.deliveryBps = link.deliveryBps * 0.75 + rate * 0.25;
+            }
+            if (link.ackedAtNs == 0 || now - link.ackedAtNs >= 50000000LL) {
+                link.ackedBytes = ackedBytes;
+                link.ackedAtNs = now;
+            }
+            if (!link.up) {
+                LOGI("Link %s up (rtt %.1f ms)", link.name.c_str(), link.srttMs);
+            }
+            link.up = true;
+            link.lastReplyNs = now;
+        }
+    }
+}
+
+void MultiLinkSender::expireProbes(int64_t now) {
+    const int64_t timeoutNs = static_cast<int64_t>(config.linkTimeoutMs) * 1000000LL;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Link& link : links) {
+        for (size_t slot = 0; slot < Link::kProbeSlots; slot++) {
+            if (link.probePending[slot] && now - link.probeSentNs[slot] > timeoutNs) {
+                link.probePending[slot] = false;
+                link.lossRate += (1.0 - link.lossRate) * kLossGain;
+            }
+        }
+        int64_t heard = std::max(link.lastReplyNs, startNs);
+        if (link.up && now - heard > timeoutNs) {
+            LOGI("Link %s down (no probe reply for %d ms)", link.name.c_str(), config.linkTimeoutMs);
+            link.up = false;
+            link.deliveryBps = 0.0;
+        }
+    }
+}
+
+void MultiLinkSender::run() {
+    const int64_t intervalNs = static_cast<int64_t>(std::max(10, config.probeIntervalMs)) * 1000000LL;
+    std::vector<pollfd> fds(links.size());
+    for (size_t i = 0; i < links.size(); i++) {
+        fds[i] = {links[i].fd, POLLIN, 0};
+    }
+    int64_t nextProbeNs = nowNs();
+
+    while (running) {
+        int64_t now = nowNs();
+        if (now >= nextProbeNs) {
+            sendProbes(now);
+            expireProbes(now);
+            nextProbeNs = now + intervalNs;
+        }
+        int timeoutMs = static_cast<int>(std::min<int64_t>(20, (nextProbeNs - now) / 1000000 + 1));
+        if (poll(fds.data(), fds.size(), timeoutMs) > 0) {
+            readReplies(nowNs());
+        }
+    }
+}
+
+std::vector<UdpLinkStats> MultiLinkSender::getLinkStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t now = nowNs();
+    uint64_t totalPackets = 0;
+    for (const Link& link : links) {
+        totalPackets += link.packetsSent - link.statsPackets;
+    }
+
+    std::vector<UdpLinkStats> result;
+    result.reserve(links.size());
+    for (Link& link : links) {
+        UdpLinkStats stats;
+        stats.name = link.name;
+        stats.up = link.up;
+        stats.rttMs = link.rttSamples > 0 ? link.srttMs : 0.0;
+        stats.lossRate = link.lossRate;
+        stats.packetsSent = link.packetsSent;
+        stats.bytesSent = link.bytesSent;
+        stats.deliveredBitrate = link.deliveryBps;
+        if (totalPackets > 0) {
+            stats.share = static_cast<double>(link.packetsSent - link.statsPackets) / totalPackets;
+        }
+        if (now > link.statsNs) {
+            stats.sendBitrate = (link.bytesSent - link.statsBytes) * 8e9 / (now - link.statsNs);
+        }
+        link.statsBytes = link.bytesSent;
+        link.statsPackets = link.packetsSent;
+        link.statsNs = now;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+} // namespace orbistream
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * How MultiLinkSender picks the link for each datagram.
+ *
+ * - WEIGHTED_ROUND_ROBIN: smooth WRR, weight = (1 - loss)^2 / RTT
+ * - EARLIEST_DELIVERY: link with the lowest estimated arrival time
+ *   (RTT/2 + bytes in flight / delivery rate), penalized by loss
+ */
+enum class LinkScheduler {
+    WEIGHTED_ROUND_ROBIN,
+    EARLIEST_DELIVERY
+};
+
+/**
+ * A UDP socket already bound to one network (e.g. by SocketBinder).
+ */
+struct UdpLinkSocket {
+    int fd = -1;                 // Duplicated by MultiLinkSender; the caller keeps its own
+    std::string name;            // "WIFI", "CELLULAR", ...
+    std::string host;            // Empty = MultiLinkConfig::host
+    int port = 0;                // 0 = MultiLinkConfig::port
+};
+
+/**
+ * Per-link statistics.
+ */
+struct UdpLinkStats {
+    std::string name;
+    bool up = false;             // Probe answered within linkTimeoutMs
+    double rttMs = 0.0;          // Smoothed probe RTT
+    double lossRate = 0.0;       // Smoothed probe loss, 0..1
+    double share = 0.0;          // Fraction of recent datagrams scheduled on this link
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+    double sendBitrate = 0.0;        // bps since the previous getLinkStats()
+    double deliveredBitrate = 0.0;   // bps acknowledged by the receiver's probe replies
+};
+
+/**
+ * Configuration for MultiLinkSender.
+ */
+struct MultiLinkConfig {
+    std::string host;
+    int port = 9000;
+    LinkScheduler scheduler = LinkScheduler::EARLIEST_DELIVERY;
+    int probeIntervalMs = 100;
+    int linkTimeoutMs = 1000;    // No probe reply for this long = link down
+};
+
+/**
+ * MultiLinkSender spreads TS datagrams over several UDP sockets, each
+ * bound to its own network, towards one receiver (tools/multilink_receiver).
+ *
+ * Every datagram gets a 12-byte header with a global sequence number so
+ * the receiver can restore order. A probe thread sends a small probe on
+ * each link every probeIntervalMs; the receiver echoes it with the bytes
+ * it has received on that link, which gives per-link RTT, loss and
+ * delivery rate. send() is called from the streaming thread and only
+ * picks a link and calls sendto().
+ *
+ * Wire format (network byte order):
+ *   u8 magic 'O' | u8 type | u8 link | u8 flags | u32 sequence | u32 send time (us)
+ *   type 1 = data (TS payload follows), 2 = probe,
+ *   3 = probe reply (+ u32 packets, u64 bytes received on that link)
+ */
+class MultiLinkSender {
+public:
+    static constexpr size_t kHeaderSize = 12;
+    static constexpr uint8_t kMagic = 0x4F;
+    static constexpr uint8_t kTypeData = 1;
+    static constexpr uint8_t kTypeProbe = 2;
+    static constexpr uint8_t kTypeProbeReply = 3;
+
+    MultiLinkSender(const MultiLinkConfig& config, const std::vector<UdpLinkSocket>& links);
+    ~MultiLinkSender();
+
+    bool start();
+    void stop();
+
+    /**
+     * Send one datagram on the link chosen by the scheduler.
+     * @return false if no link is usable or the socket refused it
+     */
+    bool send(const uint8_t* data, size_t size);
+
+    /**
+     * Per-link stats; rates and shares cover the time since the previous call.
+     */
+    std::vector<UdpLinkStats> getLinkStats();
+    uint64_t bytesSent() const { return totalBytes.load(std::memory_order_relaxed); }
+    uint64_t datagramsSent() const { return totalDatagrams.load(std::memory_order_relaxed); }
+    uint64_t datagramsRefused() const { return refused.load(std::memory_order_relaxed); }
+    size_t linkCount() const { return links.size(); }
+
+private:
+    struct Link {
+        int fd = -1;
+        std::string name;
+        std::vector<uint8_t> address;   // sockaddr of the receiver for this link
+
+        // Scheduler state (mutex)
+        bool up = true;                 // Optimistic until the first timeout
+        double srttMs = 100.0;
+        int rttSamples = 0;
+        double lossRate = 0.0;
+        double deliveryBps = 0.0;
+        double wrrCurrent = 0.0;
+        uint64_t packetsSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t ackedBytes = 0;        // Receiver's count from the latest reply
+        int64_t lastReplyNs = 0;
+        int64_t ackedAtNs = 0;
+
+        // Outstanding probes (probe thread)
+        static constexpr size_t kProbeSlots = 32;
+        uint32_t probeSeq[kProbeSlots] = {};
+        int64_t probeSentNs[kProbeSlots] = {};
+        bool probePending[kProbeSlots] = {};
+        uint32_t nextProbe = 0;
+
+        // getLinkStats() deltas
+        uint64_t statsBytes = 0;
+        uint64_t statsPackets = 0;
+        int64_t statsNs = 0;
+    };
+
+    void run();
+    void sendProbes(int64_t now);
+    void readReplies(int64_t now);
+    void expireProbes(int64_t now);
+    Link* pickLink(int64_t now);
+    static int64_t nowNs();
+
+    MultiLinkConfig config;
+    std::vector<Link> links;
+    mutable std::mutex mutex;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> totalBytes{0};    // Data datagrams with headers; probes excluded
+    std::atomic<uint64_t> totalDatagrams{0};
+    std::atomic<uint64_t> refused{0};       // No link or sendto() failed
+    uint32_t sequence = 0;              // Data sequence (mutex)
+    int64_t startNs = 0;
+};
+
+} // namespace orbistream
@@ -1,31 +1,101 @@
 #include <jni.h>
-#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unistd.h>
+#include "gst_startup.h"
+#include "logger.h"
 #include "srt_streamer.h"
+#include "trace.h"
 
 #if GSTREAMER_AVAILABLE
 #include <gst/gst.h>
 #endif
 
 #define LOG_TAG "OrbiStreamJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
 
 using namespace orbistream;
 
-// Global streamer instance
-static std::unique_ptr<SrtStreamer> g_streamer;
 static JavaVM* g_jvm = nullptr;
-static jobject g_callbackObject = nullptr;
-static jmethodID g_onStateChanged = nullptr;
-static jmethodID g_onStatsUpdated = nullptr;
-static jmethodID g_onError = nullptr;
 static bool g_gstreamer_initialized = false;
 
+/**
+ * One streamer session per handle returned by nativeCreateSession. Each has
+ * its own pipeline, Kotlin callback and multi-link sockets; they share only
+ * GStreamer itself and the main-loop thread (MainDispatcher).
+ */
+struct Session {
+    std::recursive_mutex callbackMutex;  // callbackObject vs. streaming threads; Kotlin may re-enter
+    jobject callbackObject = nullptr;
+    jmethodID onStateChanged = nullptr;
+    jmethodID onStatsUpdated = nullptr;
+    jmethodID onError = nullptr;
+    jmethodID onConnectionStateChanged = nullptr;
+    std::vector<UdpLinkSocket> udpLinks; // Owned FDs for MULTILINK_UDP
+    std::vector<SrtLinkConfig> srtLinks; // Members for SRT_BONDED
+    std::atomic<int> statsCalls{0};      // Stats may be polled from several Kotlin threads
+    SrtStreamer streamer;                // Last member: its pipeline is freed first
+
+    ~Session() {
+        // The body runs before any member is destroyed: stop streaming before
+        // the link FDs go (MultiLinkSender holds its own dups)
+        streamer.stop();
+        closeUdpLinks();
+    }
+
+    void closeUdpLinks() {
+        for (const UdpLinkSocket& link : udpLinks) {
+            if (link.fd >= 0) close(link.fd);
+        }
+        udpLinks.clear();
+    }
+};
+
+static std::mutex g_sessionsMutex;
+static std::unordered_map<jlong, std::shared_ptr<Session>> g_sessions;
+static jlong g_nextSessionHandle = 1;
+
+// The session stays alive while the caller holds the result, even if it is destroyed meanwhile
+static std::shared_ptr<Session> findSession(jlong handle) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto it = g_sessions.find(handle);
+    return it != g_sessions.end() ? it->second : nullptr;
+}
+
+// Run fn with a JNIEnv on whatever thread the streamer calls back from
+template <typename Fn>
+static void withJniEnv(Fn fn) {
+    if (!g_jvm) return;
+    JNIEnv* env = nullptr;
+    bool attached = false;
+    if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        if (g_jvm->AttachCurrentThread(&env, nullptr) != JNI_OK) return;
+        attached = true;
+    }
+    fn(env);
+    if (attached) {
+        g_jvm->DetachCurrentThread();
+    }
+}
+
+static std::string toStdString(JNIEnv* env, jstring value) {
+    if (!value) return std::string();
+    const char* chars = env->GetStringUTFChars(value, nullptr);
+    std::string result = chars;
+    env->ReleaseStringUTFChars(value, chars);
+    return result;
+}
+
 extern "C" {
 
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
     g_jvm = vm;
+    logger::start();
     LOGI("JNI_OnLoad: liborbistream_native loaded");
     return JNI_VERSION_1_6;
 }
@@ -44,39 +114,41 @@ Java_org_freedesktop_gstreamer_GStreamer_nativeInit(JNIEnv* env, jclass clazz, j
         return;
     }
     
-    // Get the files directory path from Android context
-    jclass contextClass = env->GetObjectClass(context);
-    jmethodID getFilesDir = env->GetMethodID(contextClass, "getFilesDir", "()Ljava/io/File;");
-    jobject filesDir = env->CallObjectMethod(context, getFilesDir);
+    auto begin = std::chrono::steady_clock::now();
     
+    // Get the files and cache directory paths from Android context
+    jclass contextClass = env->GetObjectClass(context);
     jclass fileClass = env->FindClass("java/io/File");
     jmethodID getAbsolutePath = env->GetMethodID(fileClass, "getAbsolutePath", "()Ljava/lang/String;");
-    jstring pathString = (jstring)env->CallObjectMethod(filesDir, getAbsolutePath);
-    
-    const char* filesPath = env->GetStringUTFChars(pathString, nullptr);
+    auto contextDir = [&](const char* getter) {
+        jmethodID method = env->GetMethodID(contextClass, getter, "()Ljava/io/File;");
+        jobject dir = env->CallObjectMethod(context, method);
+        jstring pathString = (jstring)env->CallObjectMethod(dir, getAbsolutePath);
+        const char* chars = env->GetStringUTFChars(pathString, nullptr);
+        std::string path(chars);
+        env->ReleaseStringUTFChars(pathString, chars);
+        env->DeleteLocalRef(pathString);
+        env->DeleteLocalRef(dir);
+        return path;
+    };
+    std::string filesPath = contextDir("getFilesDir");
+    std::string cachePath = contextDir("getCacheDir");
     
     // Set environment variables for GStreamer
-    std::string fontConfig = std::string(filesPath) + "/fontconfig/fonts.conf";
-    std::string caCerts = std::string(filesPath) + "/ssl/certs/ca-certificates.crt";
+    std::string fontConfig = filesPath + "/fontconfig/fonts.conf";
+    std::string caCerts = filesPath + "/ssl/certs/ca-certificates.crt";
     
     setenv("FONTCONFIG_FILE", fontConfig.c_str(), 1);
     setenv("CA_CERTIFICATES", caCerts.c_str(), 1);
-    setenv("HOME", filesPath, 1);
+    setenv("HOME", filesPath.c_str(), 1);
     
     LOGI("GStreamer paths: FONTCONFIG_FILE=%s", fontConfig.c_str());
     LOGI("GStreamer paths: CA_CERTIFICATES=%s", caCerts.c_str());
+    GstStartup::recordPhase(StartupPhase::ENVIRONMENT, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count());
     
-    env->ReleaseStringUTFChars(pathString, filesPath);
-    
-    // Initialize GStreamer
-    GError* error = nullptr;
-    if (!gst_init_check(nullptr, nullptr, &error)) {
-        if (error) {
-            LOGE("GStreamer init failed: %s", error->message);
-            g_error_free(error);
-        } else {
-            LOGE("GStreamer init failed: unknown error");
-        }
+    // Initialize GStreamer, registry kept in the app cache across launches
+    if (!SrtStreamer::initGStreamer(cachePath)) {
         return;
     }
     
@@ -92,116 +164,187 @@ JNIEXPORT void JNICALL
 Java_com_orbistream_streaming_NativeStreamer_nativeInit(JNIEnv* env, jclass clazz) {
     LOGI("Initializing native streamer");
     SrtStreamer::initGStreamer();
-    g_streamer = std::make_unique<SrtStreamer>();
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeCreateSession(JNIEnv* env, jclass clazz) {
+    auto session = std::make_shared<Session>();
+    Session* raw = session.get();
+    
+    // Callbacks only reach the Kotlin object of their own session
+    raw->streamer.setStateCallback([raw](bool running, const std::string& message) {
+        std::lock_guard<std::recursive_mutex> lock(raw->callbackMutex);
+        if (!raw->callbackObject || !raw->onStateChanged) return;
+        withJniEnv([&](JNIEnv* env) {
+            jstring jMessage = env->NewStringUTF(message.c_str());
+            env->CallVoidMethod(raw->callbackObject, raw->onStateChanged, running, jMessage);
+            env->DeleteLocalRef(jMessage);
+        });
+    });
     
-    // Set up callbacks
-    g_streamer->setStateCallback([](bool running, const std::string& message) {
-        if (!g_jvm || !g_callbackObject || !g_onStateChanged) return;
-        
-        JNIEnv* env = nullptr;
-        bool attached = false;
-        
-        if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
-            if (g_jvm->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-                attached = true;
-            } else {
-                return;
-            }
-        }
-        
-        jstring jMessage = env->NewStringUTF(message.c_str());
-        env->CallVoidMethod(g_callbackObject, g_onStateChanged, running, jMessage);
-        env->DeleteLocalRef(jMessage);
-        
-        if (attached) {
-            g_jvm->DetachCurrentThread();
-        }
+    raw->streamer.setErrorCallback([raw](const std::string& error) {
+        std::lock_guard<std::recursive_mutex> lock(raw->callbackMutex);
+        if (!raw->callbackObject || !raw->onError) return;
+        withJniEnv([&](JNIEnv* env) {
+            jstring jError = env->NewStringUTF(error.c_str());
+            env->CallVoidMethod(raw->callbackObject, raw->onError, jError);
+            env->DeleteLocalRef(jError);
+        });
     });
     
-    g_streamer->setErrorCallback([](const std::string& error) {
-        if (!g_jvm || !g_callbackObject || !g_onError) return;
-        
-        JNIEnv* env = nullptr;
-        bool attached = false;
-        
-        if (g_jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
-            if (g_jvm->AttachCurrentThread(&env, nullptr) == JNI_OK) {
-                attached = true;
-            } else {
-                return;
-            }
-        }
-        
-        jstring jError = env->NewStringUTF(error.c_str());
-        env->CallVoidMethod(g_callbackObject, g_onError, jError);
-        env->DeleteLocalRef(jError);
-        
-        if (attached) {
-            g_jvm->DetachCurrentThread();
-        }
+    raw->streamer.setConnectionCallback([raw](SrtConnectionState state, const std::string& reason) {
+        std::lock_guard<std::recursive_mutex> lock(raw->callbackMutex);
+        if (!raw->callbackObject || !raw->onConnectionStateChanged) return;
+        withJniEnv([&](JNIEnv* env) {
+            jstring jReason = env->NewStringUTF(reason.c_str());
+            env->CallVoidMethod(raw->callbackObject, raw->onConnectionStateChanged,
+                                static_cast<jint>(state), jReason);
+            env->DeleteLocalRef(jReason);
+        });
     });
+    
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    jlong handle = g_nextSessionHandle++;
+    g_sessions[handle] = std::move(session);
+    LOGI("Session %lld created (%zu open)", (long long)handle, g_sessions.size());
+    return handle;
 }
 
 JNIEXPORT void JNICALL
 Java_com_orbistream_streaming_NativeStreamer_nativeSetCallback(
-        JNIEnv* env, jclass clazz, jobject callback) {
+        JNIEnv* env, jclass clazz, jlong handle, jobject callback) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) return;
+    
+    std::lock_guard<std::recursive_mutex> lock(session->callbackMutex);
     // Clean up previous callback
-    if (g_callbackObject) {
-        env->DeleteGlobalRef(g_callbackObject);
-        g_callbackObject = nullptr;
+    if (session->callbackObject) {
+        env->DeleteGlobalRef(session->callbackObject);
+        session->callbackObject = nullptr;
     }
     
     if (callback) {
-        g_callbackObject = env->NewGlobalRef(callback);
+        session->callbackObject = env->NewGlobalRef(callback);
         
         jclass callbackClass = env->GetObjectClass(callback);
-        g_onStateChanged = env->GetMethodID(callbackClass, "onStateChanged", "(ZLjava/lang/String;)V");
-        g_onStatsUpdated = env->GetMethodID(callbackClass, "onStatsUpdated", "(DJJDJ)V");
-        g_onError = env->GetMethodID(callbackClass, "onError", "(Ljava/lang/String;)V");
+        session->onStateChanged = env->GetMethodID(callbackClass, "onStateChanged", "(ZLjava/lang/String;)V");
+        session->onStatsUpdated = env->GetMethodID(callbackClass, "onStatsUpdated", "(DJJDJ)V");
+        session->onError = env->GetMethodID(callbackClass, "onError", "(Ljava/lang/String;)V");
+        session->onConnectionStateChanged = env->GetMethodID(callbackClass, "onConnectionStateChanged", "(ILjava/lang/String;)V");
+        env->DeleteLocalRef(callbackClass);
         
-        LOGI("Callback set successfully");
+        LOGI("Session %lld: callback set", (long long)handle);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeSetUdpLinks(
+        JNIEnv* env, jclass clazz, jlong handle, jintArray fds, jobjectArray names) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) return;
+    session->closeUdpLinks();
+    
+    jsize count = env->GetArrayLength(fds);
+    std::vector<jint> fdValues(count);
+    env->GetIntArrayRegion(fds, 0, count, fdValues.data());
+    
+    for (jsize i = 0; i < count; i++) {
+        UdpLinkSocket link;
+        link.fd = fdValues[i];
+        jstring name = static_cast<jstring>(env->GetObjectArrayElement(names, i));
+        if (name) {
+            link.name = toStdString(env, name);
+            env->DeleteLocalRef(name);
+        }
+        session->udpLinks.push_back(link);
+    }
+    LOGI("Session %lld: UDP links set: %zu sockets", (long long)handle, session->udpLinks.size());
+}
+
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeSetSrtLinks(
+        JNIEnv* env, jclass clazz, jlong handle, jobjectArray localAddresses, jobjectArray hosts,
+        jintArray ports, jintArray weights) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) return;
+    session->srtLinks.clear();
+    
+    jsize count = env->GetArrayLength(ports);
+    std::vector<jint> portValues(count);
+    std::vector<jint> weightValues(count);
+    env->GetIntArrayRegion(ports, 0, count, portValues.data());
+    env->GetIntArrayRegion(weights, 0, count, weightValues.data());
+    
+    for (jsize i = 0; i < count; i++) {
+        SrtLinkConfig link;
+        jstring local = static_cast<jstring>(env->GetObjectArrayElement(localAddresses, i));
+        link.localAddress = toStdString(env, local);
+        if (local) env->DeleteLocalRef(local);
+        jstring host = static_cast<jstring>(env->GetObjectArrayElement(hosts, i));
+        link.host = toStdString(env, host);
+        if (host) env->DeleteLocalRef(host);
+        link.port = portValues[i];
+        link.weight = weightValues[i];
+        session->srtLinks.push_back(link);
     }
+    LOGI("Session %lld: SRT links set: %zu members", (long long)handle, session->srtLinks.size());
 }
 
 JNIEXPORT jboolean JNICALL
 Java_com_orbistream_streaming_NativeStreamer_nativeCreatePipeline(
-        JNIEnv* env, jclass clazz,
+        JNIEnv* env, jclass clazz, jlong handle,
         jstring srtHost, jint srtPort, jstring streamId, jstring passphrase,
         jint videoWidth, jint videoHeight, jint videoBitrate, jint frameRate,
         jint audioBitrate, jint sampleRate,
         jstring proxyHost, jint proxyPort, jboolean useProxy,
         jint transportMode,
         jint encoderPreset, jint keyframeInterval, jint bFrames,
-        jboolean useHardwareEncoder) {
-    
-    if (!g_streamer) {
-        LOGE("Streamer not initialized");
+        jboolean useHardwareEncoder,
+        jint rateControl, jint vbvBufferMs, jint crfQuality, jboolean enableRoi,
+        jstring sourcePath, jboolean sourceAudio, jboolean loopSource, jlong memoryBudgetBytes,
+        jboolean enableGovernor, jint encoderKind, jint muxerMode,
+        jboolean enablePacing, jdouble pacingMultiplier, jint pacingBurstPackets, jint pacingMaxDelayMs,
+        jboolean useCalibration,
+        jint srtLatencyMs, jlong srtMaxBw, jlong srtInputBw, jint srtOverheadPercent,
+        jint srtPayloadSize, jint srtSendBufferBytes, jint srtGroupMode) {
+    
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        LOGE("No session %lld", (long long)handle);
         return JNI_FALSE;
     }
     
     StreamConfig config;
     
-    // Parse transport mode: 0 = UDP, 1 = SRT
-    config.transport = (transportMode == 0) ? TransportMode::UDP : TransportMode::SRT;
+    // Parse transport mode: 0 = UDP, 1 = SRT, 2 = multi-link UDP, 3 = UDP with ARQ,
+    // 4 = SRT through libsrt, 5 = bonded SRT group
+    switch (transportMode) {
+        case 1: config.transport = TransportMode::SRT; break;
+        case 2:
+            config.transport = TransportMode::MULTILINK_UDP;
+            config.udpLinks = session->udpLinks;   // MultiLinkSender dups the FDs
+            break;
+        case 3: config.transport = TransportMode::ARQ_UDP; break;
+        case 4: config.transport = TransportMode::SRT_DIRECT; break;
+        case 5:
+            config.transport = TransportMode::SRT_BONDED;
+            config.srtLinks = session->srtLinks;
+            break;
+        default: config.transport = TransportMode::UDP; break;
+    }
     
     // Parse strings
-    const char* host = env->GetStringUTFChars(srtHost, nullptr);
-    config.srtHost = host;
-    env->ReleaseStringUTFChars(srtHost, host);
-    
+    config.srtHost = toStdString(env, srtHost);
     config.srtPort = srtPort;
-    
-    if (streamId) {
-        const char* id = env->GetStringUTFChars(streamId, nullptr);
-        config.streamId = id;
-        env->ReleaseStringUTFChars(streamId, id);
-    }
-    
-    if (passphrase) {
-        const char* pass = env->GetStringUTFChars(passphrase, nullptr);
-        config.passphrase = pass;
-        env->ReleaseStringUTFChars(passphrase, pass);
-    }
+    config.streamId = toStdString(env, streamId);
+    config.passphrase = toStdString(env, passphrase);
+    config.srtLatencyMs = srtLatencyMs;
+    config.srtMaxBw = srtMaxBw;
+    config.srtInputBw = srtInputBw;
+    config.srtOverheadPercent = srtOverheadPercent;
+    config.srtPayloadSize = srtPayloadSize;
+    config.srtSendBufferBytes = srtSendBufferBytes;
+    config.srtGroupMode = srtGroupMode == 1 ? SrtGroupMode::BACKUP : SrtGroupMode::BROADCAST;
     
     config.videoWidth = videoWidth;
     config.videoHeight = videoHeight;
@@ -215,73 +358,118 @@ Java_com_orbistream_streaming_NativeStreamer_nativeCreatePipeline(
     config.keyframeInterval = keyframeInterval;
     config.bFrames = bFrames;
     config.useHardwareEncoder = useHardwareEncoder;
+    // Encoder: 0 = auto, 1 = x264, 2 = MediaCodec, 3 = openh264
+    switch (encoderKind) {
+        case 1: config.encoder = EncoderKind::X264; break;
+        case 2: config.encoder = EncoderKind::MEDIACODEC; break;
+        case 3: config.encoder = EncoderKind::OPENH264; break;
+        default: config.encoder = EncoderKind::AUTO; break;
+    }
+    // Rate control: 0 = CBR, 1 = capped VBR, 2 = constant quality
+    switch (rateControl) {
+        case 0: config.rateControl = RateControl::CBR; break;
+        case 2: config.rateControl = RateControl::CONSTANT_QUALITY; break;
+        default: config.rateControl = RateControl::CAPPED_VBR; break;
+    }
+    config.vbvBufferMs = vbvBufferMs;
+    config.crfQuality = crfQuality;
+    config.enableRoi = enableRoi;
+    config.memoryBudgetBytes = memoryBudgetBytes;
+    config.enableGovernor = enableGovernor;
+    // Muxer: 0 = mpegtsmux, 1 = native TsMuxer
+    config.muxer = muxerMode == 1 ? MuxerMode::NATIVE : MuxerMode::MPEGTSMUX;
+    config.enablePacing = enablePacing;
+    config.pacingMultiplier = pacingMultiplier;
+    config.pacingBurstPackets = pacingBurstPackets;
+    config.pacingMaxDelayMs = pacingMaxDelayMs;
+    config.useCalibration = useCalibration;
+    
+    // A source file replaces camera/microphone input (passthrough, no encoder)
+    if (sourcePath) {
+        config.source = SourceMode::FILE;
+        config.sourcePath = toStdString(env, sourcePath);
+        config.sourceAudio = sourceAudio;
+        config.loopSource = loopSource;
+    }
     
     if (proxyHost) {
-        const char* pHost = env->GetStringUTFChars(proxyHost, nullptr);
-        config.proxyHost = pHost;
-        env->ReleaseStringUTFChars(proxyHost, pHost);
+        config.proxyHost = toStdString(env, proxyHost);
     }
     config.proxyPort = proxyPort;
     config.useProxy = useProxy;
     
-    const char* transportStr = (config.transport == TransportMode::UDP) ? "UDP" : "SRT";
-    LOGI("Creating pipeline [%s]: %s:%d, video %dx%d@%d, bitrate %d, preset=%d, keyframe=%d, bframes=%d, hwenc=%d",
-         transportStr, config.srtHost.c_str(), config.srtPort,
+    const char* transportStr = (config.transport == TransportMode::SRT) ? "SRT"
+        : (config.transport == TransportMode::SRT_DIRECT) ? "SRT (libsrt)"
+        : (config.transport == TransportMode::SRT_BONDED) ? "SRT bonded"
+        : (config.transport == TransportMode::MULTILINK_UDP) ? "UDP multi-link"
+        : (config.transport == TransportMode::ARQ_UDP) ? "UDP with ARQ" : "UDP";
+    LOGI("Session %lld: creating pipeline [%s]: %s:%d, video %dx%d@%d, bitrate %d, preset=%d, keyframe=%d, bframes=%d, hwenc=%d, encoder=%s, mux=%s, pacing=%d",
+         (long long)handle, transportStr, config.srtHost.c_str(), config.srtPort,
          config.videoWidth, config.videoHeight, config.frameRate, config.videoBitrate,
-         encoderPreset, keyframeInterval, bFrames, useHardwareEncoder);
+         encoderPreset, keyframeInterval, bFrames, useHardwareEncoder, encoderKindName(config.encoder),
+         config.muxer == MuxerMode::NATIVE ? "native" : "mpegtsmux", enablePacing);
     
-    return g_streamer->createPipeline(config) ? JNI_TRUE : JNI_FALSE;
+    return session->streamer.createPipeline(config) ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT jboolean JNICALL
-Java_com_orbistream_streaming_NativeStreamer_nativeStart(JNIEnv* env, jclass clazz) {
-    if (!g_streamer) {
-        LOGE("Streamer not initialized");
+Java_com_orbistream_streaming_NativeStreamer_nativeStart(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        LOGE("No session %lld", (long long)handle);
         return JNI_FALSE;
     }
-    return g_streamer->start() ? JNI_TRUE : JNI_FALSE;
+    return session->streamer.start() ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
-Java_com_orbistream_streaming_NativeStreamer_nativeStop(JNIEnv* env, jclass clazz) {
-    if (g_streamer) {
-        g_streamer->stop();
+Java_com_orbistream_streaming_NativeStreamer_nativeStop(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (session) {
+        session->streamer.stop();
     }
 }
 
 JNIEXPORT jboolean JNICALL
-Java_com_orbistream_streaming_NativeStreamer_nativeIsStreaming(JNIEnv* env, jclass clazz) {
-    return (g_streamer && g_streamer->isStreaming()) ? JNI_TRUE : JNI_FALSE;
+Java_com_orbistream_streaming_NativeStreamer_nativeIsStreaming(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    return (session && session->streamer.isStreaming()) ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
+JNIEXPORT jboolean JNICALL
 Java_com_orbistream_streaming_NativeStreamer_nativePushVideoFrame(
-        JNIEnv* env, jclass clazz,
+        JNIEnv* env, jclass clazz, jlong handle,
         jbyteArray data, jint width, jint height, jlong timestampNs) {
     
-    if (!g_streamer || !g_streamer->isStreaming()) return;
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session || !session->streamer.isStreaming()) return JNI_FALSE;
+    
+    // Refuse before GetByteArrayElements so a dropped frame costs no copy
+    if (!session->streamer.admitVideoFrame()) return JNI_FALSE;
     
     jbyte* bytes = env->GetByteArrayElements(data, nullptr);
     jsize size = env->GetArrayLength(data);
     
-    g_streamer->pushVideoFrame(
+    bool pushed = session->streamer.pushVideoFrame(
         reinterpret_cast<const uint8_t*>(bytes), size,
         width, height, timestampNs);
     
     env->ReleaseByteArrayElements(data, bytes, JNI_ABORT);
+    return pushed ? JNI_TRUE : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL
 Java_com_orbistream_streaming_NativeStreamer_nativePushAudioSamples(
-        JNIEnv* env, jclass clazz,
+        JNIEnv* env, jclass clazz, jlong handle,
         jbyteArray data, jint sampleRate, jint channels, jlong timestampNs) {
     
-    if (!g_streamer || !g_streamer->isStreaming()) return;
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session || !session->streamer.isStreaming()) return;
     
     jbyte* bytes = env->GetByteArrayElements(data, nullptr);
     jsize size = env->GetArrayLength(data);
     
-    g_streamer->pushAudioSamples(
+    session->streamer.pushAudioSamples(
         reinterpret_cast<const uint8_t*>(bytes), size,
         sampleRate, channels, timestampNs);
     
@@ -289,17 +477,18 @@ Java_com_orbistream_streaming_NativeStreamer_nativePushAudioSamples(
 }
 
 JNIEXPORT jdoubleArray JNICALL
-Java_com_orbistream_streaming_NativeStreamer_nativeGetStats(JNIEnv* env, jclass clazz) {
-    if (!g_streamer) {
+Java_com_orbistream_streaming_NativeStreamer_nativeGetStats(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
         return nullptr;
     }
     
-    StreamStats stats = g_streamer->getStats();
+    StreamStats stats = session->streamer.getStats();
     
     // Log stats periodically for debugging
-    static int logCount = 0;
-    if (++logCount % 5 == 0) {  // Log every 5th call
-        LOGI("Stats: bitrate=%.0f bps, bytes=%llu, rtt=%.0f ms, state=%d, fps=%.1f/%.1f, hwenc=%d", 
+    if (++session->statsCalls % 5 == 0) {  // Log every 5th call
+        LOGI("Session %lld stats: bitrate=%.0f bps, bytes=%llu, rtt=%.0f ms, state=%d, fps=%.1f/%.1f, hwenc=%d", 
+             (long long)handle,
              stats.currentBitrate, 
              (unsigned long long)stats.bytesSent,
              stats.rtt,
@@ -312,9 +501,17 @@ Java_com_orbistream_streaming_NativeStreamer_nativeGetStats(JNIEnv* env, jclass
     // Extended stats array:
     // [0] currentBitrate, [1] bytesSent, [2] packetsLost, [3] rtt, [4] streamTimeMs,
     // [5] packetsRetransmitted, [6] packetsDropped, [7] bandwidth, [8] connectionState,
-    // [9] inputFps, [10] outputFps, [11] framesDropped, [12] hardwareEncoderActive
-    jdoubleArray result = env->NewDoubleArray(13);
-    jdouble values[13] = {
+    // [9] inputFps, [10] outputFps, [11] framesDropped, [12] hardwareEncoderActive,
+    // [13] faults, [14] recoveries, [15] lastDetectMs, [16] lastRecoverMs,
+    // [17] frameSizeMeanBytes, [18] frameSizeStdDevBytes, [19] frameSizeMaxBytes,
+    // [20] memoryBytes, [21] memoryPeakBytes, [22] budgetDrops,
+    // [23] packetsSent, [24] muxOverhead, [25] transportOverhead, [26] wireOverhead,
+    // [27] governorLevel, [28] governorMaxLevel, [29] width, [30] height, [31] frameRate,
+    // [32] presetSteps, [33] hottestC, [34] thermalHeadroomC, [35] freqCapRatio, [36] encodeHeadroom,
+    // [37] encoder (EncoderKind ordinal), [38] encodeFrameMs, [39] encodeFrameMaxMs,
+    // [40] pacerQueueDepth, [41] pacerDelayMs, [42] pacerMaxDelayMs, [43] pacerDropped
+    jdoubleArray result = env->NewDoubleArray(44);
+    jdouble values[44] = {
         stats.currentBitrate,
         static_cast<double>(stats.bytesSent),
         static_cast<double>(stats.packetsLost),
@@ -327,24 +524,286 @@ Java_com_orbistream_streaming_NativeStreamer_nativeGetStats(JNIEnv* env, jclass
         stats.inputFps,
         stats.outputFps,
         static_cast<double>(stats.framesDropped),
-        stats.hardwareEncoderActive ? 1.0 : 0.0
+        stats.hardwareEncoderActive ? 1.0 : 0.0,
+        static_cast<double>(stats.faults),
+        static_cast<double>(stats.recoveries),
+        stats.lastDetectMs,
+        stats.lastRecoverMs,
+        stats.frameSizeMeanBytes,
+        stats.frameSizeStdDevBytes,
+        static_cast<double>(stats.frameSizeMaxBytes),
+        static_cast<double>(stats.memoryBytes),
+        static_cast<double>(stats.memoryPeakBytes),
+        static_cast<double>(stats.budgetDrops),
+        static_cast<double>(stats.packetsSent),
+        stats.muxOverhead,
+        stats.transportOverhead,
+        stats.wireOverhead,
+        static_cast<double>(stats.governorLevel),
+        static_cast<double>(stats.governorMaxLevel),
+        static_cast<double>(stats.operatingPoint.width),
+        static_cast<double>(stats.operatingPoint.height),
+        static_cast<double>(stats.operatingPoint.frameRate),
+        static_cast<double>(stats.operatingPoint.presetSteps),
+        stats.hottestC,
+        stats.thermalHeadroomC,
+        stats.freqCapRatio,
+        stats.encodeHeadroom,
+        static_cast<double>(static_cast<int>(stats.encoder)),
+        stats.encodeFrameMs,
+        stats.encodeFrameMaxMs,
+        static_cast<double>(stats.pacerQueueDepth),
+        stats.pacerDelayMs,
+        stats.pacerMaxDelayMs,
+        static_cast<double>(stats.pacerDropped)
     };
-    env->SetDoubleArrayRegion(result, 0, 13, values);
+    env->SetDoubleArrayRegion(result, 0, 44, values);
     
     return result;
 }
 
-JNIEXPORT void JNICALL
-Java_com_orbistream_streaming_NativeStreamer_nativeDestroy(JNIEnv* env, jclass clazz) {
-    LOGI("Destroying native streamer");
+// Per component: MemoryComponent ordinal, limit, current and peak bytes
+JNIEXPORT jlongArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeGetMemoryUsage(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        return nullptr;
+    }
     
-    if (g_callbackObject) {
-        env->DeleteGlobalRef(g_callbackObject);
-        g_callbackObject = nullptr;
+    std::vector<MemoryUsage> usage = session->streamer.getStats().memory;
+    std::vector<jlong> values;
+    values.reserve(usage.size() * 4);
+    for (const MemoryUsage& entry : usage) {
+        values.push_back(static_cast<jlong>(entry.component));
+        values.push_back(static_cast<jlong>(entry.limitBytes));
+        values.push_back(static_cast<jlong>(entry.currentBytes));
+        values.push_back(static_cast<jlong>(entry.peakBytes));
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+    env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
+}
+
+// Per layer: ByteLayer ordinal, bytes, packets, bitrate (bps), packet rate (per second)
+JNIEXPORT jdoubleArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeGetByteLayers(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        return nullptr;
     }
     
-    g_streamer.reset();
+    std::vector<LayerBytes> layers = session->streamer.getStats().byteLayers;
+    std::vector<jdouble> values;
+    values.reserve(layers.size() * 5);
+    for (const LayerBytes& entry : layers) {
+        values.push_back(static_cast<double>(entry.layer));
+        values.push_back(static_cast<double>(entry.bytes));
+        values.push_back(static_cast<double>(entry.packets));
+        values.push_back(entry.bitrate);
+        values.push_back(entry.packetRate);
+    }
+    jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+    env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
 }
 
-} // extern "C"
+// Per SRT_BONDED member, in configured order: weight, state, rttMs, sendRateMbps,
+// packetsSent, packetsLost, packetsRetransmitted
+JNIEXPORT jdoubleArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeGetSrtLinks(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        return nullptr;
+    }
+    
+    std::vector<SrtLinkStats> links = session->streamer.getStats().srtLinks;
+    std::vector<jdouble> values;
+    values.reserve(links.size() * 7);
+    for (const SrtLinkStats& link : links) {
+        values.push_back(static_cast<double>(link.weight));
+        values.push_back(static_cast<double>(link.state));
+        values.push_back(link.rttMs);
+        values.push_back(link.sendRateMbps);
+        values.push_back(static_cast<double>(link.packetsSent));
+        values.push_back(static_cast<double>(link.packetsLost));
+        values.push_back(static_cast<double>(link.packetsRetransmitted));
+    }
+    jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+    env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
+}
+
+// Per decision, oldest first: stream time (ms), from level, to level, GovernorReason
+// ordinal, width, height, frame rate, preset steps, hottest C, thermal headroom C,
+// CPU cap ratio, encode headroom
+JNIEXPORT jdoubleArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeGetGovernorDecisions(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) {
+        return nullptr;
+    }
+    
+    std::vector<GovernorDecision> decisions = session->streamer.getStats().governorDecisions;
+    std::vector<jdouble> values;
+    values.reserve(decisions.size() * 12);
+    for (const GovernorDecision& decision : decisions) {
+        values.push_back(static_cast<double>(decision.timeMs));
+        values.push_back(static_cast<double>(decision.fromLevel));
+        values.push_back(static_cast<double>(decision.toLevel));
+        values.push_back(static_cast<double>(decision.reason));
+        values.push_back(static_cast<double>(decision.point.width));
+        values.push_back(static_cast<double>(decision.point.height));
+        values.push_back(static_cast<double>(decision.point.frameRate));
+        values.push_back(static_cast<double>(decision.point.presetSteps));
+        values.push_back(decision.hottestC);
+        values.push_back(decision.thermalHeadroomC);
+        values.push_back(decision.freqCapRatio);
+        values.push_back(decision.encodeHeadroom);
+    }
+    jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+    env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
+}
+
+// regions: x, y, width, height (fractions of the frame), qpOffset per region
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeSetRegionsOfInterest(
+        JNIEnv* env, jclass clazz, jlong handle, jfloatArray regions) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session) return;
+    
+    std::vector<RoiRegion> parsed;
+    if (regions) {
+        jsize length = env->GetArrayLength(regions);
+        std::vector<jfloat> values(length);
+        env->GetFloatArrayRegion(regions, 0, length, values.data());
+        for (jsize i = 0; i + 5 <= length; i += 5) {
+            RoiRegion region;
+            region.x = values[i];
+            region.y = values[i + 1];
+            region.width = values[i + 2];
+            region.height = values[i + 3];
+            region.qpOffset = static_cast<int>(values[i + 4]);
+            parsed.push_back(region);
+        }
+    }
+    session->streamer.setRegionsOfInterest(parsed);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeRequestKeyframe(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session = findSession(handle);
+    return (session && session->streamer.requestKeyframe()) ? JNI_TRUE : JNI_FALSE;
+}
 
+JNIEXPORT jboolean JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeDumpMetrics(
+        JNIEnv* env, jclass clazz, jlong handle, jstring path) {
+    std::shared_ptr<Session> session = findSession(handle);
+    if (!session || !path) {
+        return JNI_FALSE;
+    }
+    return session->streamer.dumpMetricsHistory(toStdString(env, path)) ? JNI_TRUE : JNI_FALSE;
+}
+
+// category: a LOG_TAG, "*", "gst" or "gst:<category>"; level: logger::Level
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeSetLogLevel(JNIEnv* env, jclass clazz,
+                                                              jstring category, jint level) {
+    if (!category) return;
+    int clamped = std::max(0, std::min(static_cast<int>(level), static_cast<int>(logger::Level::VERBOSE)));
+    logger::setLevel(toStdString(env, category), static_cast<logger::Level>(clamped));
+}
+
+// registryCacheHit, then microseconds per StartupPhase
+JNIEXPORT jlongArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeGetStartupReport(JNIEnv* env, jclass clazz) {
+    StartupReport report = GstStartup::report();
+    std::vector<jlong> values;
+    values.push_back(report.registryCacheHit ? 1 : 0);
+    for (int64_t us : report.phaseUs) {
+        values.push_back(static_cast<jlong>(us));
+    }
+    jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+    env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+    return result;
+}
+
+// Runs (or loads from cacheDir) the encoder calibration; pipelines created
+// afterwards with useCalibration pick it up. Blocks for a few seconds.
+// Returns valid, fromCache, preset, width, height, threads, measuredFps, trials, durationMs
+JNIEXPORT jdoubleArray JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeCalibrate(
+        JNIEnv* env, jclass clazz, jstring cacheDir, jstring buildId,
+        jint targetFps, jint maxWidth, jint maxHeight, jint videoBitrate) {
+    CalibrationOptions options;
+    options.targetFps = targetFps;
+    options.maxWidth = maxWidth;
+    options.maxHeight = maxHeight;
+    options.videoBitrate = videoBitrate;
+    if (cacheDir) {
+        options.cachePath = toStdString(env, cacheDir) + "/encoder-calibration";
+    }
+    options.buildId = toStdString(env, buildId);
+    
+    // The result is process-wide, so a throwaway streamer is enough
+    SrtStreamer streamer;
+    CalibrationResult result = streamer.calibrate(options);
+    
+    jdouble values[] = {
+        result.valid ? 1.0 : 0.0,
+        result.fromCache ? 1.0 : 0.0,
+        static_cast<jdouble>(static_cast<int>(result.preset)),
+        static_cast<jdouble>(result.width),
+        static_cast<jdouble>(result.height),
+        static_cast<jdouble>(result.encoderThreads),
+        result.measuredFps,
+        static_cast<jdouble>(result.trials),
+        static_cast<jdouble>(result.durationMs)
+    };
+    const jsize count = sizeof(values) / sizeof(values[0]);
+    jdoubleArray array = env->NewDoubleArray(count);
+    env->SetDoubleArrayRegion(array, 0, count, values);
+    return array;
+}
+
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeSetTracing(JNIEnv* env, jclass clazz, jboolean enabled) {
+    if (enabled) {
+        trace::start();
+    } else {
+        trace::stop();
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeWriteTrace(JNIEnv* env, jclass clazz, jstring path) {
+    if (!path) return JNI_FALSE;
+    return trace::writeChromeJson(toStdString(env, path)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_orbistream_streaming_NativeStreamer_nativeDestroySession(JNIEnv* env, jclass clazz, jlong handle) {
+    std::shared_ptr<Session> session;
+    {
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        auto it = g_sessions.find(handle);
+        if (it == g_sessions.end()) return;
+        session = std::move(it->second);
+        g_sessions.erase(it);
+        LOGI("Destroying session %lld (%zu left)", (long long)handle, g_sessions.size());
+    }
+    
+    // Stop first: the state callback still reaches Kotlin
+    session->streamer.stop();
+    {
+        std::lock_guard<std::recursive_mutex> lock(session->callbackMutex);
+        if (session->callbackObject) {
+            env->DeleteGlobalRef(session->callbackObject);
+            session->callbackObject = nullptr;
+        }
+    }
+    // Freed here, or by a push/stats call still holding it
+}
+
+} // extern "C"
@@ -0,0 +1,186 @@
+#include "packet_pacer.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+
+#define LOG_TAG "PacketPacer"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+// Upper bound for one sleep so stop() and rate changes are picked up quickly
+constexpr int64_t kMaxSleepNs = 10 * 1000000LL;
+}
+
+PacketPacer::PacketPacer(const PacerConfig& config, SendCallback callback)
+    : config(config), callback(std::move(callback)),
+      slots(std::max<size_t>(config.queueCapacity, 16)) {
+    rateBps = config.rateBps;
+}
+
+PacketPacer::~PacketPacer() {
+    stop();
+}
+
+int64_t PacketPacer::nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void PacketPacer::sleepUntil(int64_t deadlineNs) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadlineNs / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(deadlineNs % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+void PacketPacer::setThreadInitHook(ThreadInitHook hook) {
+    threadInitHook = std::move(hook);
+}
+
+void PacketPacer::start() {
+    if (running) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        head = 0;
+        count = 0;
+        queuedBytes = 0;
+        stats = PacerStats{};
+    }
+    tokens = static_cast<double>(config.burstBytes);
+    lastRefillNs = nowNs();
+
+    running = true;
+    thread = std::thread(&PacketPacer::run, this);
+    LOGI("Pacer started: rate=%lld bps, burst=%zu bytes, slots=%zu",
+         (long long)rateBps.load(), config.burstBytes, slots.size());
+}
+
+void PacketPacer::stop() {
+    if (!running) return;
+
+    running = false;
+    cv.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    LOGI("Pacer stopped: sent=%llu dropped=%llu maxDepth=%llu maxDelay=%.1fms",
+         (unsigned long long)stats.packetsSent,
+         (unsigned long long)stats.packetsDropped,
+         (unsigned long long)stats.maxQueueDepth,
+         stats.maxDelayMs);
+    head = 0;
+    count = 0;
+    queuedBytes = 0;
+}
+
+bool PacketPacer::enqueue(const uint8_t* data, size_t size) {
+    if (size == 0 || size > kMaxDatagramSize) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == slots.size()) {
+            stats.packetsDropped++;
+            return false;
+        }
+        Slot& slot = slots[(head + count) % slots.size()];
+        memcpy(slot.data, data, size);
+        slot.size = size;
+        slot.enqueuedNs = nowNs();
+        count++;
+        queuedBytes += size;
+        stats.maxQueueDepth = std::max<uint64_t>(stats.maxQueueDepth, count);
+        stats.maxQueueBytes = std::max<uint64_t>(stats.maxQueueBytes, queuedBytes);
+    }
+    cv.notify_one();
+    return true;
+}
+
+void PacketPacer::setRate(int64_t newRateBps) {
+    rateBps = std::max<int64_t>(newRateBps, 0);
+}
+
+PacerStats PacketPacer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PacerStats result = stats;
+    result.queueDepth = count;
+    result.queueBytes = queuedBytes;
+    result.rateBps = rateBps.load(std::memory_order_relaxed);
+    return result;
+}
+
+size_t PacketPacer::slotBytes() {
+    return sizeof(Slot);
+}
+
+void PacketPacer::run() {
+    uint8_t sendBuffer[kMaxDatagramSize];
+    const int64_t maxDelayNs = static_cast<int64_t>(config.maxQueueDelayMs) * 1000000LL;
+    const double burst = static_cast<double>(config.burstBytes);
+
+    if (threadInitHook) {
+        threadInitHook();
+    }
+
+    while (running) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return count > 0 || !running; });
+        if (!running) break;
+
+        int64_t now = nowNs();
+        int64_t rate = rateBps.load(std::memory_order_relaxed);
+
+        // Refill the bucket
+        tokens = std::min(burst, tokens + (now - lastRefillNs) * (rate / 8e9));
+        lastRefillNs = now;
+
+        Slot& slot = slots[head];
+        int64_t queuedNs = now - slot.enqueuedNs;
+
+        if (maxDelayNs > 0 && queuedNs > maxDelayNs) {
+            // Too old to be useful at the receiver - drop rather than add latency
+            queuedBytes -= slot.size;
+            head = (head + 1) % slots.size();
+            count--;
+            stats.packetsDropped++;
+            continue;
+        }
+
+        if (rate <= 0 || tokens >= static_cast<double>(slot.size)) {
+            size_t size = slot.size;
+            memcpy(sendBuffer, slot.data, size);
+            tokens -= static_cast<double>(size);
+            queuedBytes -= size;
+            head = (head + 1) % slots.size();
+            count--;
+
+            double delayMs = queuedNs / 1e6;
+            stats.avgDelayMs += (delayMs - stats.avgDelayMs) / 16.0;
+            stats.maxDelayMs = std::max(stats.maxDelayMs, delayMs);
+            stats.packetsSent++;
+            lock.unlock();
+
+            if (callback) {
+                callback(sendBuffer, size);
+            }
+            continue;
+        }
+
+        // Sleep until the bucket holds enough tokens for the head datagram
+        double deficit = static_cast<double>(slot.size) - tokens;
+        int64_t waitNs = static_cast<int64_t>(deficit * 8e9 / rate);
+        lock.unlock();
+        sleepUntil(now + std::min(std::max<int64_t>(waitNs, 1000), kMaxSleepNs));
+    }
+}
+
+} // namespace orbistream
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Configuration for PacketPacer.
+ */
+struct PacerConfig {
+    int64_t rateBps = 4000000;      // Initial pacing rate (already includes the multiplier)
+    size_t burstBytes = 1316 * 4;   // Token bucket depth - datagrams allowed back to back
+    size_t queueCapacity = 1024;    // Preallocated datagram slots
+    int maxQueueDelayMs = 500;      // Datagrams older than this are dropped instead of sent
+};
+
+/**
+ * Pacer metrics.
+ */
+struct PacerStats {
+    uint64_t queueDepth = 0;        // Datagrams currently queued
+    uint64_t queueBytes = 0;        // Bytes currently queued
+    uint64_t maxQueueDepth = 0;     // High-water mark since start
+    uint64_t maxQueueBytes = 0;     // High-water mark since start
+    double avgDelayMs = 0.0;        // EWMA of enqueue -> send delay
+    double maxDelayMs = 0.0;        // Largest enqueue -> send delay since start
+    uint64_t packetsSent = 0;
+    uint64_t packetsDropped = 0;    // Queue overflow or expired
+    int64_t rateBps = 0;            // Current pacing rate
+};
+
+/**
+ * PacketPacer spreads datagrams over time with a token bucket so an
+ * encoded frame does not leave as one microburst.
+ *
+ * Producers enqueue() into a ring of preallocated slots; a dedicated
+ * timer thread (clock_nanosleep on CLOCK_MONOTONIC) releases datagrams
+ * to the send callback whenever the bucket holds enough tokens. The rate
+ * is updated from ABR via setRate(); the bucket depth bounds how much may
+ * still go out back to back.
+ */
+class PacketPacer {
+public:
+    static constexpr size_t kMaxDatagramSize = 1500;
+
+    using SendCallback = std::function<void(const uint8_t* data, size_t size)>;
+    using ThreadInitHook = std::function<void()>;
+
+    PacketPacer(const PacerConfig& config, SendCallback callback);
+    ~PacketPacer();
+
+    /**
+     * Run `hook` on the timer thread when it starts (e.g. to set its
+     * priority). Must be set before start().
+     */
+    void setThreadInitHook(ThreadInitHook hook);
+
+    void start();
+    void stop();
+
+    /**
+     * Queue a datagram for paced sending. Copies the data.
+     * @return false if the queue is full (the datagram is dropped)
+     */
+    bool enqueue(const uint8_t* data, size_t size);
+
+    /**
+     * Update the pacing rate in bits per second.
+     */
+    void setRate(int64_t rateBps);
+
+    PacerStats getStats() const;
+
+    /** Memory one slot takes (queueCapacity x this, allocated up front). */
+    static size_t slotBytes();
+
+private:
+    struct Slot {
+        uint8_t data[kMaxDatagramSize];
+        size_t size = 0;
+        int64_t enqueuedNs = 0;
+    };
+
+    void run();
+    static int64_t nowNs();
+    static void sleepUntil(int64_t deadlineNs);
+
+    PacerConfig config;
+    SendCallback callback;
+    ThreadInitHook threadInitHook;
+
+    std::vector<Slot> slots;
+    size_t head = 0;                // Next slot to send
+    size_t count = 0;               // Slots in use
+    size_t queuedBytes = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<int64_t> rateBps{0};
+
+    // Owned by the timer thread
+    double tokens = 0.0;
+    int64_t lastRefillNs = 0;
+
+    PacerStats stats;
+};
+
+} // namespace orbistream
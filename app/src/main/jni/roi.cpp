@@ -0,0 +1,41 @@
+#include "roi.h"
+#include <algorithm>
+#include <cmath>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/video/video.h>
+#endif
+
+namespace orbistream {
+
+#if GSTREAMER_AVAILABLE
+namespace {
+// Fraction of the frame to a pixel edge, clamped to the frame
+int toPixels(float fraction, int size) {
+    return std::max(0, std::min(size, static_cast<int>(std::lround(fraction * size))));
+}
+}
+
+int attachRoiMetas(GstBuffer* buffer, int frameWidth, int frameHeight,
+                   const std::vector<RoiRegion>& regions) {
+    int attached = 0;
+    for (const RoiRegion& region : regions) {
+        int left = toPixels(region.x, frameWidth);
+        int top = toPixels(region.y, frameHeight);
+        int right = toPixels(region.x + region.width, frameWidth);
+        int bottom = toPixels(region.y + region.height, frameHeight);
+        if (right <= left || bottom <= top || region.qpOffset == 0) continue;
+
+        GstVideoRegionOfInterestMeta* meta = gst_buffer_add_video_region_of_interest_meta(
+            buffer, "roi", left, top, right - left, bottom - top);
+        if (!meta) continue;
+        double deltaQp = std::max(-51, std::min(51, region.qpOffset));
+        gst_video_region_of_interest_meta_add_param(meta,
+            gst_structure_new("roi/x264enc", "delta-qp", G_TYPE_DOUBLE, deltaQp, nullptr));
+        attached++;
+    }
+    return attached;
+}
+#endif
+
+} // namespace orbistream
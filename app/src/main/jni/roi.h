@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#if GSTREAMER_AVAILABLE
+#include <gst/gst.h>
+#endif
+
+namespace orbistream {
+
+/**
+ * Part of the frame to encode at a different quality than the rest.
+ *
+ * Coordinates are fractions of the frame (0..1), so one region holds for
+ * the camera frame, the scaled encoded frame and a different capture size.
+ * qpOffset is added to the encoder's QP for the macroblocks inside: negative
+ * spends more bits there, positive fewer. Under a bitrate target the rate
+ * control takes the difference from the rest of the frame.
+ */
+struct RoiRegion {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    int qpOffset = 0;    // -51..51
+};
+
+#if GSTREAMER_AVAILABLE
+/**
+ * Attach one GstVideoRegionOfInterestMeta per region to a frame of the given
+ * size, carrying qpOffset as the "roi/x264enc" delta-qp param. x264 only
+ * applies it with adaptive quantisation on (aq-mode > 0).
+ * @return regions attached; empty, out-of-frame and zero-offset regions are skipped
+ */
+int attachRoiMetas(GstBuffer* buffer, int frameWidth, int frameHeight,
+                   const std::vector<RoiRegion>& regions);
+#endif
+
+} // namespace orbistream
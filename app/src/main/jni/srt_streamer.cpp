@@ -1,53 +1,187 @@
 #include "srt_streamer.h"
-#include <android/log.h>
+#include "frame_admission.h"
+#include "frame_convert.h"
+#include "gst_startup.h"
+#include "logger.h"
+#include "main_dispatcher.h"
+#include "packet_pacer.h"
+#include "srt_transport.h"
+#include "trace.h"
+#include "ts_muxer.h"
+#include <sys/system_properties.h>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>   // setenv
+#include <cstring>
+#include <ctime>
+#include <fstream>
 #include <iomanip>
+#include <limits>
 #include <mutex>
 #include <sstream>
 #include <thread>
 #include <atomic>
 
 #define LOG_TAG "SrtStreamer"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
 
 #if GSTREAMER_AVAILABLE
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
+#include <gst/app/gstappsink.h>
 #endif
 
 namespace orbistream {
 
+namespace {
+constexpr size_t kGovernorDecisions = 16;   // Kept in StreamStats
+
+// Calibration and live streams compete for the CPU, so they never overlap:
+// a calibration run holds the mutex throughout and refuses to start while any
+// session streams; start() and calibrated pipelines wait for a run to finish.
+std::mutex g_calibrationRunMutex;
+std::atomic<int> g_activeStreams{0};
+
+// CPU time of the calling thread
+int64_t threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* faultName(PipelineFault fault) {
+    switch (fault) {
+        case PipelineFault::SINK_DISCONNECTED: return "sink disconnected";
+        case PipelineFault::ENCODER_ERROR: return "encoder error";
+        case PipelineFault::CAPS_NEGOTIATION: return "caps negotiation";
+        case PipelineFault::CLOCK_LOST: return "clock lost";
+        case PipelineFault::UNEXPECTED_EOS: return "unexpected EOS";
+        case PipelineFault::PIPELINE_ERROR: return "pipeline error";
+        default: return "none";
+    }
+}
+
+const char* rateControlName(RateControl mode) {
+    switch (mode) {
+        case RateControl::CBR: return "CBR";
+        case RateControl::CONSTANT_QUALITY: return "constant quality";
+        default: return "capped VBR";
+    }
+}
+
+// Encoded frame sizes for one stats interval, added from the encoder's
+// streaming thread and drained by getStats()
+struct FrameSizeAccumulator {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> sumSquares{0};
+    std::atomic<uint64_t> max{0};
+
+    void add(uint64_t bytes) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(bytes, std::memory_order_relaxed);
+        sumSquares.fetch_add(bytes * bytes, std::memory_order_relaxed);
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (bytes > seen && !max.compare_exchange_weak(seen, bytes, std::memory_order_relaxed)) {}
+    }
+};
+}
+
 class SrtStreamer::Impl {
 public:
     Impl() = default;
     ~Impl() { cleanup(); }
 
+    CalibrationResult calibrate(const CalibrationOptions& options);
     bool createPipeline(const StreamConfig& config);
     bool start();
     void stop();
+    void stopLocked(const char* reason = "Streaming stopped");
     bool isStreaming() const { return streaming; }
     StreamStats getStats() const;
-    
-    void pushVideoFrame(const uint8_t* data, size_t size, 
-                        int width, int height, int64_t timestampNs);
+    bool dumpMetricsHistory(const std::string& path) const;
+    
+    bool admitVideoFrame();
+    bool pushConvertedVideoFrame(const uint8_t* data, size_t size, int width, int height,
+                                 const std::vector<RoiRegion>* frameRegions);
+    bool pushVideoFrame(const uint8_t* data, size_t size, 
+                        int width, int height, int64_t timestampNs,
+                        const std::vector<RoiRegion>* frameRegions = nullptr);
+    void setRegionsOfInterest(const std::vector<RoiRegion>& regions);
+    bool requestKeyframe();
     void pushAudioSamples(const uint8_t* data, size_t size,
                           int sampleRate, int channels, int64_t timestampNs);
 
     StateCallback stateCallback;
     StatsCallback statsCallback;
     ErrorCallback errorCallback;
+    ConnectionCallback connectionCallback;
 
 private:
     void cleanup();
     std::string buildPipelineString(const StreamConfig& config);
     void updateSrtStats();
     void updateAdaptiveBitrate();
-    static const char* presetToString(EncoderPreset preset);
+    static int resolveVbvBufferMs(const StreamConfig& config);
+    double runCalibrationTrial(EncoderPreset preset, int width, int height, int threads,
+                               const CalibrationOptions& options, int64_t timeoutMs);
+    void applyCalibration(StreamConfig& config);
+    void recordIngestCost(int64_t cpuNs);
+    void sendTsDatagram(const uint8_t* data, size_t size);
+    void pushTsDatagram(const uint8_t* data, size_t size);
+    void onConnectionEvent(SrtConnectionState state, const std::string& reason);
+    void updateDirectSrtStats();
+    void updateMultiLinkStats();
+    void updateArqStats();
+    int64_t pacingRateBps(int videoKbps) const;
+    void sampleMetrics();
+    void configureMemoryBudget(const StreamConfig& config);
+    std::string queueByteLimit(MemoryComponent component) const;
+    void sampleMemory();
+    void configureGovernor();
+    void runGovernor();
+    void applyOperatingPoint(const OperatingPoint& from, const OperatingPoint& to);
+    EncoderPreset governedPreset(int presetSteps) const;
+    void restartEncoder();
+    
+    // Fault handling: detect (bus, transport) -> restart in place -> data flows again
+    enum class Health { HEALTHY, RECOVERING, FAILED };
+    Health beginFault(PipelineFault fault, const std::string& reason);
+    void completeRecovery();
+    void failRecovery(const std::string& reason);
+    void markDataFlow();
     
 #if GSTREAMER_AVAILABLE
+    static gboolean onMetricsTick(gpointer userData);
+    static gboolean onGovernorTick(gpointer userData);
+    static GstFlowReturn onTsSample(GstAppSink* sink, gpointer userData);
+    static GstFlowReturn onVideoEsSample(GstAppSink* sink, gpointer userData);
+    static GstFlowReturn onAudioEsSample(GstAppSink* sink, gpointer userData);
+    void addPlacementProbe(GstElement* element, const char* padName, ThreadRole role);
+    enum class TraceProbe { FRAME_END, SINK_BUFFER };
+    void addTraceProbe(GstElement* element, const char* padName, TraceProbe kind);
+    void addFlowProbe(GstElement* element, const char* padName);
+    void addByteProbe(GstElement* element, const char* padName, ByteLayer layer);
+    void addFileSourceProbe();
+    void attachFrameRois(GstBuffer* buffer, int width, int height,
+                         const std::vector<RoiRegion>* frameRegions);
+    GstBuffer* allocateVideoBuffer(size_t size);
+    bool seekFileSource(bool flush);
+    void prepareFileSource();
+    static gboolean onBusMessage(GstBus* bus, GstMessage* message, gpointer userData);
+    static gboolean onRecoveryTimer(gpointer userData);
+    PipelineFault classifyError(GstMessage* message, const GError* error, const char* debug) const;
+    void handleFault(PipelineFault fault, const std::string& reason);
+    void scheduleRecovery();
+    void restartPipeline();
+
     GstElement* pipeline = nullptr;
     GstElement* videoAppSrc = nullptr;
     GstElement* audioAppSrc = nullptr;
@@ -55,23 +189,64 @@ private:
     GstElement* udpSink = nullptr;
     GstElement* muxer = nullptr;
     GstElement* videoEncoder = nullptr;
-    GMainLoop* mainLoop = nullptr;
-    std::thread mainLoopThread;
+    GstElement* videoQueue = nullptr;    // Encoded-frame backlog for admission
+    GstElement* audioQueue = nullptr;
+    GstElement* videoEsSink = nullptr;   // NATIVE muxer: encoded video out of GStreamer
+    GstElement* audioEsSink = nullptr;   // NATIVE muxer: encoded audio out of GStreamer
+    GstElement* tsAppSink = nullptr;     // Pacing with mpegtsmux: TS out of GStreamer
+    GstElement* tsAppSrc = nullptr;      // Native output: TS datagrams back into the sink
+    GstBufferPool* tsPool = nullptr;     // Preallocated datagram buffers for ts_src
+    GstElement* videoRate = nullptr;     // Governor: max-rate
+    GstElement* videoCaps = nullptr;     // Governor: scaled size (videoscale path)
+    std::shared_ptr<MainDispatcher> dispatcher;   // Shared main loop, held while streaming
+    guint metricsSourceId = 0;           // Metrics sampler timeout on the dispatcher
+    guint governorSourceId = 0;          // Governor timeout on the dispatcher
+    guint busWatchId = 0;
+    guint recoverySourceId = 0;          // Pending restart (dispatcher thread only)
+    int recoveryAttempt = 0;             // Restarts for the current fault (dispatcher thread only)
     bool videoCapsSet = false;
     int lastVideoWidth = 0;
     int lastVideoHeight = 0;
+    int ingestCapsWidth = 0;             // Native ingest: size in the appsrc caps (capture thread)
+    int ingestCapsHeight = 0;
 #endif
 
     StreamConfig currentConfig;
+    std::unique_ptr<TsMuxer> tsMuxer;
+    std::unique_ptr<PacketPacer> pacer;
+    std::unique_ptr<SrtTransport> srtTransport;   // SRT_DIRECT / SRT_BONDED output
+    std::unique_ptr<MultiLinkSender> multiLink;   // MULTILINK_UDP output
+    std::unique_ptr<ArqSender> arqSender;         // ARQ_UDP output
+    ThreadPlacer threadPlacer;
+    
+    // Early frame admission (capture thread; stats read under the mutex)
+    mutable std::mutex admissionMutex;
+    FrameAdmission admission;
+    bool frameAdmitted = false;       // admitVideoFrame() already ran for the next push
+    size_t lastVideoFrameBytes = 0;
+    std::atomic<uint64_t> encoderInputCount{0};   // Frames into the encoder
+    std::atomic<int64_t> encodeLatencyNs{0};      // Capture to encoder output, latest frame
+    
+    // Format-negotiation fast path: convert/scale in the ingest copy
+    bool nativeIngest = false;
+    PixelFormat ingestFormat = PixelFormat::NV21;
+    FrameConverter frameConverter;                // Capture thread only
+    std::string elidedElements;
+    std::atomic<int64_t> ingestCpuNs{0};          // CPU per frame for convert/scale (EWMA)
+    std::atomic<int64_t> convertStartNs{0};       // Fallback path: videoconvert entry
+    std::atomic<uint32_t> ingestSize{0};          // Native ingest output, width << 16 | height (governor)
+    int encoderThreads = 2;           // x264 threads, resolved from config/topology
     std::atomic<bool> streaming{false};
+    bool countedActive = false;       // In g_activeStreams (start() to stop(), app threads)
+    std::mutex stopMutex;             // stop() from the app vs. end of a file source (dispatcher)
     mutable std::mutex statsMutex;
     StreamStats stats;
     std::chrono::steady_clock::time_point startTime;
     int64_t lastBytesSent = 0;
     std::chrono::steady_clock::time_point lastBitrateTime;
     
-    // Byte counting from encoder (since muxer needs both audio+video to flow)
-    std::atomic<uint64_t> muxerBytesSent{0};
+    // Bytes per layer: ES and TS from pad probes, transport totals when stats are polled
+    ByteAccounting byteAccounting;
     
     // Frame rate tracking
     std::atomic<uint64_t> inputFrameCount{0};    // Frames pushed to video appsrc
@@ -82,8 +257,37 @@ private:
     double calculatedInputFps = 0.0;
     double calculatedOutputFps = 0.0;
     
-    // Hardware encoder state
-    bool usingHardwareEncoder = false;
+    // Encoded frame size spread, rolled up with the fps once a second
+    FrameSizeAccumulator frameSizes;
+    double frameSizeMeanBytes = 0.0;
+    double frameSizeStdDevBytes = 0.0;
+    uint64_t frameSizeMaxBytes = 0;
+    int vbvBufferMs = 0;              // x264 VBV; re-applied with every bitrate change
+    
+    // Memory budget: limits applied when the pipeline is built, levels
+    // sampled with the stats. The frame pool is replaced on the capture thread.
+    MemoryBudget memoryBudget;
+    std::mutex poolMutex;
+    std::unique_ptr<FramePool> videoPool;
+    std::atomic<uint64_t> budgetDrops{0};
+    
+    // Sustained-performance governor (dispatcher thread; its stats under
+    // statsMutex). The level survives stop/start: the device is still hot.
+    ThermalMonitor thermalMonitor;
+    ThermalGovernor governor;
+    bool governorActive = false;
+    std::atomic<int> pendingPresetSteps{0};          // Preset for the encoder restart below
+    std::atomic<bool> encoderRestartPending{false};  // Idle probe installed, not run yet
+    
+    // Regions of interest: the persistent set, replaced from any thread
+    std::mutex roiMutex;
+    std::vector<RoiRegion> roiRegions;
+    std::atomic<bool> hasRoiRegions{false};
+    
+    // Video encoder backend, chosen by buildPipelineString (null for a file source)
+    std::unique_ptr<EncoderBackend> encoder;
+    double encodeFrameMs = 0.0;       // Per-frame encode time, rolled up with the fps
+    double encodeFrameMaxMs = 0.0;
     
     // Adaptive bitrate
     int currentEncoderBitrate = 0;    // Current encoder bitrate in kbps
@@ -91,185 +295,296 @@ private:
     int minBitrate = 500;             // Minimum bitrate in kbps
     int maxBitrate = 0;               // Maximum bitrate in kbps (from config)
     std::chrono::steady_clock::time_point lastBitrateAdjustTime;
-    
-    // Hardware encoder detection
-    static bool isHardwareEncoderAvailable();
+    std::atomic<uint32_t> abrAction{0};   // AbrAction of the current metrics interval
+    
+    // Metrics history: written by the sampler on the main loop, kept after stop()
+    mutable std::mutex metricsMutex;      // Replacing metricsHistory vs dumping it
+    std::unique_ptr<MetricsHistory> metricsHistory;
+    StreamStats lastMetricsStats;         // Sampler only: base for the interval deltas
+    
+    // Fault handling (health and faultDetectedNs under statsMutex)
+    Health health = Health::HEALTHY;
+    int64_t faultDetectedNs = 0;
+    std::atomic<int64_t> lastDataNs{0};        // Last buffer into the sink / datagram handed to a transport
+    std::atomic<bool> awaitingFlow{false};     // Restarted; the next data out completes recovery
 };
 
-// Helper to convert EncoderPreset to x264 string
-const char* SrtStreamer::Impl::presetToString(EncoderPreset preset) {
-    switch (preset) {
-        case EncoderPreset::ULTRAFAST: return "ultrafast";
-        case EncoderPreset::SUPERFAST: return "superfast";
-        case EncoderPreset::VERYFAST: return "veryfast";
-        case EncoderPreset::FASTER: return "faster";
-        case EncoderPreset::FAST: return "fast";
-        case EncoderPreset::MEDIUM: return "medium";
-        case EncoderPreset::SLOW: return "slow";
-        case EncoderPreset::SLOWER: return "slower";
-        case EncoderPreset::VERYSLOW: return "veryslow";
-        default: return "ultrafast";
-    }
-}
-
-// Check if Android MediaCodec hardware encoder is available
-bool SrtStreamer::Impl::isHardwareEncoderAvailable() {
-#if GSTREAMER_AVAILABLE
-    // Try to find amcvidenc (Android Media Codec) H.264 encoder
-    // Common element names: amcvidenc-omxgoogleh264encoder, amcvidenc-c2androidavch264encoder, etc.
-    GstElementFactory* factory = nullptr;
-    
-    // Try various known Android hardware encoder element names
-    const char* hwEncoders[] = {
-        "amcvidenc-c2androidavch264encoder",      // Android 10+ Codec2
-        "amcvidenc-omxgoogleh264encoder",         // OMX fallback
-        "amcvidenc-omxqaboradeh264encoder",       // Qualcomm
-        "amcvidenc-omxexynosh264enc",             // Samsung Exynos
-        "amcvidenc-omxtikicodesavch264encoder",   // MediaTek
-        nullptr
-    };
-    
-    for (int i = 0; hwEncoders[i] != nullptr; i++) {
-        factory = gst_element_factory_find(hwEncoders[i]);
-        if (factory) {
-            LOGI("Hardware encoder available: %s", hwEncoders[i]);
-            gst_object_unref(factory);
-            return true;
-        }
-    }
-    
-    // Try to find any amcvidenc element by creating a registry query
-    GstRegistry* registry = gst_registry_get();
-    GList* plugins = gst_registry_get_plugin_list(registry);
-    
-    for (GList* p = plugins; p; p = p->next) {
-        GstPlugin* plugin = GST_PLUGIN(p->data);
-        const gchar* name = gst_plugin_get_name(plugin);
-        if (g_str_has_prefix(name, "androidmedia")) {
-            LOGI("Found androidmedia plugin - hardware encoding may be available");
-            gst_plugin_list_free(plugins);
-            return true;
-        }
-    }
-    gst_plugin_list_free(plugins);
-    
-    LOGI("No hardware encoder found - using software encoding");
-    return false;
-#else
-    return false;
-#endif
-}
-
 // Static GStreamer initialization
-bool SrtStreamer::initGStreamer() {
+bool SrtStreamer::initGStreamer(const std::string& registryCacheDir) {
 #if GSTREAMER_AVAILABLE
-    static bool initialized = false;
-    if (!initialized) {
-        // Verbose debug for video path to inspect SPS/PPS/IDR behavior
-        setenv("GST_DEBUG", "x264enc:5,h264parse:5,mpegtsmux:4,appsrc:4,queue:3,srtsink:4,udpsink:4", 1);
-        setenv("GST_DEBUG_NO_COLOR", "1", 1);
-        gst_init(nullptr, nullptr);
-        initialized = true;
-        LOGI("GStreamer initialized");
-    }
+    // GStreamer debug output goes through the async logger at WARNING; raise
+    // it per category with logger::setLevel("gst:x264enc", ...) when needed
+    setenv("GST_DEBUG_NO_COLOR", "1", 1);
+    if (!GstStartup::init(registryCacheDir)) return false;
+    logger::routeGstreamerDebug();
     return true;
 #else
     LOGI("GStreamer not available - using stub implementation");
-    return true;
+    return GstStartup::init(registryCacheDir);
 #endif
 }
 
+int SrtStreamer::Impl::resolveVbvBufferMs(const StreamConfig& config) {
+    if (config.vbvBufferMs > 0) return config.vbvBufferMs;
+    if (config.rateControl == RateControl::CBR) {
+        return std::max(1, 1000 / std::max(1, config.frameRate));
+    }
+    return 600;    // x264enc's own default
+}
+
 std::string SrtStreamer::Impl::buildPipelineString(const StreamConfig& config) {
     // Build the GStreamer pipeline string for streaming
     // 
     // The pipeline uses appsrc for both video and audio so we can push
     // frames from the Android camera and microphone.
     //
-    // Video path: appsrc -> videoconvert -> (hw or sw encoder) -> queue
+    // Video path: appsrc -> videoconvert -> encoder (EncoderBackend) -> queue
     // Audio path: appsrc -> audioconvert -> voaacenc -> aacparse
     // Both paths mux into mpegtsmux -> (srtsink or udpsink)
+    //
+    // With MuxerMode::NATIVE both paths end in an appsink instead, TsMuxer
+    // packetizes in native code and pushes datagrams into ts_src -> sink.
+    // With pacing, mpegtsmux output also leaves through ts_sink and goes
+    // through PacketPacer before re-entering at ts_src.
+    //
+    // With SourceMode::FILE both appsrc chains (and the encoders) are replaced
+    // by filesrc ! parsebin; identity sync=true releases buffers at their PTS.
+    //
+    // With TransportMode::SRT_DIRECT / SRT_BONDED there is no sink element:
+    // TS leaves through ts_sink (or TsMuxer) and SrtTransport sends it over libsrt.
+    // MULTILINK_UDP and ARQ_UDP work the same way with MultiLinkSender / ArqSender
+    // as the output.
 
-    const char* transportStr = (config.transport == TransportMode::UDP) ? "UDP" : "SRT";
-    
-    const char* presetStr = presetToString(config.preset);
+    bool bondedSrt = config.transport == TransportMode::SRT_BONDED;
+    bool directSrt = config.transport == TransportMode::SRT_DIRECT || bondedSrt;
+    bool multiLinkUdp = config.transport == TransportMode::MULTILINK_UDP;
+    bool arqUdp = config.transport == TransportMode::ARQ_UDP;
+    bool nativeOutput = directSrt || multiLinkUdp || arqUdp;
+    const char* transportStr = (config.transport == TransportMode::UDP) ? "UDP"
+        : multiLinkUdp ? "UDP multi-link (native scheduler)"
+        : arqUdp ? "UDP with ARQ"
+        : bondedSrt ? "SRT bonded (libsrt group)" : directSrt ? "SRT (libsrt)" : "SRT";
+    
+    const char* presetStr = encoderPresetName(config.preset);
     int gopSize = config.frameRate * config.keyframeInterval;
     
-    // Check for hardware encoder
-    bool hwAvailable = isHardwareEncoderAvailable();
-    usingHardwareEncoder = config.useHardwareEncoder && hwAvailable;
+    bool fileSource = config.source == SourceMode::FILE;
+    bool fileAudio = !fileSource || config.sourceAudio;
+    
+    // Encoder backend: AUTO takes MediaCodec when it is wanted and present
+    encoder = fileSource ? nullptr
+        : EncoderBackend::create(EncoderBackend::resolve(config.encoder, config.useHardwareEncoder));
+    const EncoderCapabilities* encoderCaps = encoder ? &encoder->capabilities() : nullptr;
+    vbvBufferMs = encoderCaps && encoderCaps->vbv ? resolveVbvBufferMs(config) : 0;
     
     LOGI("=== STREAMING CONFIG ===");
     LOGI("Transport: %s", transportStr);
     LOGI("Target: %s:%d", config.srtHost.c_str(), config.srtPort);
-    LOGI("Video: %dx%d @ %d fps, bitrate %d bps", 
-         config.videoWidth, config.videoHeight, config.frameRate, config.videoBitrate);
-    LOGI("Encoder: %s (hw=%s, requested=%s)", 
-         usingHardwareEncoder ? "HARDWARE (MediaCodec)" : "SOFTWARE (x264)",
-         hwAvailable ? "available" : "not available",
-         config.useHardwareEncoder ? "yes" : "no");
-    if (!usingHardwareEncoder) {
-        LOGI("Encoder settings: preset=%s, keyframe=%ds (GOP=%d), bframes=%d",
-             presetStr, config.keyframeInterval, gopSize, config.bFrames);
-    }
-    LOGI("Audio: %d Hz, bitrate %d bps", config.sampleRate, config.audioBitrate);
+    if (fileSource) {
+        LOGI("Source: file passthrough %s (audio %s, %s), no encoder/ABR",
+             config.sourcePath.c_str(), config.sourceAudio ? "yes" : "no",
+             config.loopSource ? "looping" : "once");
+    } else {
+        LOGI("Video: %dx%d @ %d fps, bitrate %d bps", 
+             config.videoWidth, config.videoHeight, config.frameRate, config.videoBitrate);
+        LOGI("Encoder: %s (%s%s, requested %s, hw %s)", encoder->name(), encoderCaps->factory.c_str(),
+             encoderCaps->hardware ? ", hardware" : "", encoderKindName(config.encoder),
+             config.useHardwareEncoder ? "preferred" : "off");
+        if (encoderCaps->presets) {
+            LOGI("Encoder settings: preset=%s, keyframe=%ds (GOP=%d), bframes=%d, threads=%d",
+                 presetStr, config.keyframeInterval, gopSize, config.bFrames, encoderThreads);
+        }
+        if (config.enableRoi) {
+            if (encoderCaps->qpOffsets) {
+                LOGI("ROI: QP offsets via x264 adaptive quantisation");
+            } else {
+                LOGI("ROI: %s has no per-region QP, regions are ignored", encoderCaps->factory.c_str());
+            }
+        }
+        if (encoderCaps->constantQuality && config.rateControl == RateControl::CONSTANT_QUALITY) {
+            LOGI("Rate control: %s (CRF %d), VBV %d ms", rateControlName(config.rateControl),
+                 config.crfQuality, vbvBufferMs);
+        } else if (encoderCaps->vbv) {
+            LOGI("Rate control: %s, VBV %d ms", rateControlName(config.rateControl), vbvBufferMs);
+        } else {
+            LOGI("Rate control: encoder default at the bitrate%s",
+                 encoderCaps->liveBitrate ? "" : ", fixed while playing (no ABR)");
+        }
+        LOGI("Audio: %d Hz, bitrate %d bps", config.sampleRate, config.audioBitrate);
+    }
+    LOGI("Muxer: %s", config.muxer == MuxerMode::NATIVE ? "native TsMuxer" : "mpegtsmux");
+    if (config.transport != TransportMode::UDP && !multiLinkUdp && !arqUdp) {
+        LOGI("SRT: latency %d ms, maxbw %lld, inputbw %lld, overhead %d%%, payload %d, sndbuf %d",
+             config.srtLatencyMs, (long long)config.srtMaxBw, (long long)config.srtInputBw,
+             config.srtOverheadPercent, config.srtPayloadSize, config.srtSendBufferBytes);
+    }
+    if (bondedSrt) {
+        LOGI("SRT group: %s, %zu links",
+             config.srtGroupMode == SrtGroupMode::BACKUP ? "backup" : "broadcast",
+             config.srtLinks.size());
+        for (const SrtLinkConfig& link : config.srtLinks) {
+            LOGI("  link %s -> %s:%d weight %d",
+                 link.localAddress.empty() ? "(any)" : link.localAddress.c_str(),
+                 link.host.empty() ? config.srtHost.c_str() : link.host.c_str(),
+                 link.port > 0 ? link.port : config.srtPort, link.weight);
+        }
+    }
+    if (multiLinkUdp) {
+        LOGI("Multi-link: %s, probe every %d ms, %zu links",
+             config.linkScheduler == LinkScheduler::WEIGHTED_ROUND_ROBIN ? "weighted round-robin" : "earliest delivery",
+             config.linkProbeIntervalMs, config.udpLinks.size());
+        for (const UdpLinkSocket& link : config.udpLinks) {
+            LOGI("  link %s fd %d -> %s:%d", link.name.c_str(), link.fd,
+                 link.host.empty() ? config.srtHost.c_str() : link.host.c_str(),
+                 link.port > 0 ? link.port : config.srtPort);
+        }
+    }
+    if (config.enablePacing) {
+        LOGI("Pacing: %.1fx target bitrate, burst %d packets, max delay %d ms",
+             config.pacingMultiplier, config.pacingBurstPackets, config.pacingMaxDelayMs);
+    }
     if (config.useProxy && config.transport == TransportMode::UDP) {
         LOGI("Bondix: Enabled - reliability handled by tunnel");
     }
     LOGI("========================");
 
+    // Fast path: if the encoder takes a layout FrameConverter can write,
+    // pushVideoFrame converts and scales during the copy it already makes
+    // and videoconvert/videoscale are left out of the pipeline
+    nativeIngest = encoderCaps && config.negotiateFormats && !encoderCaps->inputFormats.empty();
+    if (nativeIngest) {
+        ingestFormat = encoderCaps->inputFormats.front();
+    }
+    elidedElements = nativeIngest ? "videoconvert,videoscale" : "";
+    if (fileSource) {
+        // Nothing is ingested
+    } else if (nativeIngest) {
+        LOGI("Video ingest: native %s (elided %s)", pixelFormatName(ingestFormat),
+             elidedElements.c_str());
+    } else {
+        LOGI("Video ingest: videoconvert ! videoscale");
+    }
+
     std::stringstream ss;
     
-    // Video source from app
-    // - do-timestamp=true: GStreamer assigns timestamps from pipeline clock
-    // - is-live=true: Source provides data in real-time
-    // - format=time: Timestamps are in nanoseconds
-    ss << "appsrc name=video_src format=time is-live=true do-timestamp=true "
-       << "caps=\"video/x-raw,format=NV21,width=" << config.videoWidth 
-       << ",height=" << config.videoHeight << ",framerate=" << config.frameRate << "/1\" ! ";
-    
-    // Video processing chain:
-    // - videorate: ensures consistent frame timing (critical for camera input!)
-    // - videoconvert -> videoscale -> caps to target WxH  
-    // - encoder (hardware MediaCodec or software x264)
-    // - queue with leaky downstream (drops frames if CPU can't keep up)
-    ss << "videorate drop-only=true skip-to-first=true ! "
-       << "videoconvert ! "
-       << "videoscale ! video/x-raw,width=" << config.videoWidth << ",height=" << config.videoHeight << " ! ";
-    
-    if (usingHardwareEncoder) {
-        // Hardware encoder (Android MediaCodec via amcvidenc)
-        // Note: amcvidenc auto-selects best available H.264 hardware encoder
-        ss << "amcvidenc name=video_enc "
-           << "bitrate=" << config.videoBitrate << " "
-           << "i-frame-interval=" << (config.keyframeInterval * 1000) << " ! ";  // milliseconds
+    if (fileSource) {
+        // Demux and parse only: the file's H.264 goes out as it is
+        ss << "filesrc location=\"" << config.sourcePath << "\" ! parsebin name=file_demux "
+           << "file_demux. ! video/x-h264 ! h264parse name=video_parse config-interval=-1 ! "
+           << "identity name=video_pace sync=true ! ";
     } else {
-        // Software encoder (x264enc)
-        ss << "x264enc name=video_enc tune=zerolatency speed-preset=" << presetStr
-           << " bitrate=" << (config.videoBitrate / 1000)
-           << " key-int-max=" << gopSize
-           << " bframes=" << config.bFrames
-           << " threads=2 ! ";
+        // Video source from app
+        // - do-timestamp=true: GStreamer assigns timestamps from pipeline clock
+        // - is-live=true: Source provides data in real-time
+        // - format=time: Timestamps are in nanoseconds
+        ss << "appsrc name=video_src format=time is-live=true do-timestamp=true "
+           << "caps=\"video/x-raw,format=" << (nativeIngest ? pixelFormatName(ingestFormat) : "NV21")
+           << ",width=" << config.videoWidth 
+           << ",height=" << config.videoHeight << ",framerate=" << config.frameRate << "/1\" ! ";
+    
+        // Video processing chain:
+        // - videorate: ensures consistent frame timing (critical for camera input!);
+        //   the governor lowers its max-rate
+        // - videoconvert -> videoscale -> caps to target WxH (unless done at ingest)
+        // - encoder (EncoderBackend: x264, MediaCodec or openh264)
+        // - queue with leaky downstream (drops frames if CPU can't keep up)
+        ss << "videorate name=video_rate drop-only=true skip-to-first=true ! ";
+        if (!nativeIngest) {
+            ss << "videoconvert name=video_convert ! "
+               << "videoscale name=video_scale ! capsfilter name=video_caps "
+               << "caps=\"video/x-raw,width=" << config.videoWidth << ",height=" << config.videoHeight << "\" ! ";
+        }
+    
+        EncoderSettings settings;
+        settings.bitrateKbps = config.videoBitrate / 1000;
+        settings.frameRate = config.frameRate;
+        settings.keyframeFrames = gopSize;
+        settings.bFrames = config.bFrames;
+        settings.threads = encoderThreads;
+        settings.preset = config.preset;
+        settings.rateControl = config.rateControl;
+        settings.crfQuality = config.crfQuality;
+        settings.vbvBufferMs = vbvBufferMs;
+        settings.roi = config.enableRoi;
+        ss << encoder->build(settings, "video_enc") << " ! ";
     }
     
-    ss << "queue name=video_queue max-size-buffers=3 leaky=downstream ! mux. ";
+    bool nativeMux = config.muxer == MuxerMode::NATIVE;
+    
+    if (nativeMux) {
+        // TsMuxer needs Annex B access units with in-band SPS/PPS
+        ss << "h264parse config-interval=-1 ! "
+           << "video/x-h264,stream-format=byte-stream,alignment=au ! "
+           << "queue name=video_queue max-size-buffers=3" << queueByteLimit(MemoryComponent::VIDEO_QUEUE)
+           << " leaky=downstream ! "
+           << "appsink name=video_es_sink sync=false async=false ";
+    } else {
+        ss << "queue name=video_queue max-size-buffers=3" << queueByteLimit(MemoryComponent::VIDEO_QUEUE)
+           << " leaky=downstream ! mux. ";
+    }
     
     // Audio processing chain (matching video pattern with rate element):
     // - audiorate: ensures consistent audio timing (like videorate for video)
     // - audioconvert + audioresample: format conversion
     // - voaacenc: AAC encoding
     // - leaky queue: drops old samples if backed up
-    ss << "appsrc name=audio_src format=time is-live=true do-timestamp=true "
-       << "caps=\"audio/x-raw,format=S16LE,layout=interleaved,rate=" << config.sampleRate 
-       << ",channels=" << config.audioChannels << "\" ! "
-       << "audiorate skip-to-first=true ! "
-       << "audioconvert ! "
-       << "audioresample ! "
-       << "voaacenc bitrate=" << config.audioBitrate << " ! "
-       << "aacparse ! "
-       << "queue name=audio_queue max-size-buffers=3 leaky=downstream ! mux. ";
-    
-    // Muxer - alignment=7 aligns to MPEG-TS packet boundaries (like MCRBox)
-    ss << "mpegtsmux name=mux alignment=7 ! ";
+    if (fileSource) {
+        if (fileAudio) {
+            ss << "file_demux. ! audio/mpeg ! aacparse name=audio_parse ! identity name=audio_pace sync=true ! ";
+        }
+    } else {
+        ss << "appsrc name=audio_src format=time is-live=true do-timestamp=true "
+           << "caps=\"audio/x-raw,format=S16LE,layout=interleaved,rate=" << config.sampleRate 
+           << ",channels=" << config.audioChannels << "\" ! "
+           << "audiorate skip-to-first=true ! "
+           << "audioconvert ! "
+           << "audioresample ! "
+           << "voaacenc bitrate=" << config.audioBitrate << " ! "
+           << "aacparse name=audio_parse ! ";
+    }
+    
+    if (nativeMux) {
+        if (fileAudio) {
+            ss << "audio/mpeg,stream-format=adts ! "
+               << "queue name=audio_queue max-size-buffers=3" << queueByteLimit(MemoryComponent::AUDIO_QUEUE)
+               << " leaky=downstream ! "
+               << "appsink name=audio_es_sink sync=false async=false ";
+        }
+    } else {
+        if (fileAudio) {
+            ss << "queue name=audio_queue max-size-buffers=3" << queueByteLimit(MemoryComponent::AUDIO_QUEUE)
+               << " leaky=downstream ! mux. ";
+        }
+        
+        // Muxer - alignment=7 aligns to MPEG-TS packet boundaries (like MCRBox)
+        ss << "mpegtsmux name=mux alignment=7 ! ";
+        if (config.enablePacing || nativeOutput) {
+            ss << "appsink name=ts_sink sync=false async=false ";
+        }
+    }
+    
+    if (directSrt) {
+        // SrtTransport is the output; nothing re-enters the pipeline
+        LOGI("SRT output: libsrt caller to %s:%d", config.srtHost.c_str(), config.srtPort);
+        return ss.str();
+    }
+    if (multiLinkUdp) {
+        // MultiLinkSender is the output
+        LOGI("Multi-link output: %s:%d", config.srtHost.c_str(), config.srtPort);
+        return ss.str();
+    }
+    if (arqUdp) {
+        // ArqSender is the output
+        LOGI("ARQ output: %s:%d, latency %d ms, %d ring slots", config.srtHost.c_str(),
+             config.srtPort, config.arqLatencyMs, config.arqRingSlots);
+        return ss.str();
+    }
+    
+    if (nativeMux || config.enablePacing) {
+        // TS datagrams from TsMuxer / PacketPacer re-enter the pipeline here
+        ss << "appsrc name=ts_src format=time is-live=true do-timestamp=true "
+           << "caps=\"video/mpegts,systemstream=(boolean)true,packetsize=(int)188\" ! ";
+    }
     
     // Output sink based on transport mode
     if (config.transport == TransportMode::UDP) {
@@ -286,7 +601,8 @@ std::string SrtStreamer::Impl::buildPipelineString(const StreamConfig& config) {
             srtUri += "?streamid=" + config.streamId;
         }
         
-        std::string srtSinkProps = "uri=\"" + srtUri + "\" mode=caller latency=500 wait-for-connection=false";
+        std::string srtSinkProps = "uri=\"" + srtUri + "\" mode=caller latency=" +
+            std::to_string(config.srtLatencyMs) + " wait-for-connection=false";
         
         if (!config.streamId.empty()) {
             srtSinkProps += " streamid=\"" + config.streamId + "\"";
@@ -307,7 +623,22 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
     cleanup();
     
     currentConfig = config;
-    std::string pipelineStr = buildPipelineString(config);
+    applyCalibration(currentConfig);
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        metricsHistory = config.metricsHistorySlots > 0
+            ? std::make_unique<MetricsHistory>(static_cast<size_t>(config.metricsHistorySlots))
+            : nullptr;
+    }
+    
+    // Thread count and placement follow the SoC layout (big.LITTLE vs symmetric)
+    CpuTopology topology = CpuTopology::read();
+    threadPlacer.configure(config.threadPolicy, topology);
+    encoderThreads = currentConfig.encoderThreads > 0
+        ? currentConfig.encoderThreads : topology.recommendedEncoderThreads();
+    configureMemoryBudget(currentConfig);
+    
+    std::string pipelineStr = buildPipelineString(currentConfig);
     
     LOGI("=== CREATING GSTREAMER PIPELINE ===");
     LOGI("Pipeline string length: %zu chars", pipelineStr.length());
@@ -342,6 +673,7 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
     videoEncoder = gst_bin_get_by_name(GST_BIN(pipeline), "video_enc");
     if (videoEncoder) {
         LOGI("Got video encoder for adaptive bitrate");
+        encoder->attach(videoEncoder);
         // Initialize adaptive bitrate settings
         currentEncoderBitrate = config.videoBitrate / 1000;  // kbps
         targetBitrate = currentEncoderBitrate;
@@ -349,6 +681,22 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
         minBitrate = std::max(500, maxBitrate / 10);  // Min 500kbps or 10% of max
     }
     
+    videoQueue = gst_bin_get_by_name(GST_BIN(pipeline), "video_queue");
+    audioQueue = gst_bin_get_by_name(GST_BIN(pipeline), "audio_queue");
+    if (audioAppSrc && memoryBudget.bounded()) {
+        // Enforced in pushAudioSamples; appsrc only signals enough-data at it
+        gst_app_src_set_max_bytes(GST_APP_SRC(audioAppSrc), memoryBudget.limit(MemoryComponent::AUDIO_INGEST));
+    }
+    
+    FrameAdmissionConfig admissionConfig;
+    admissionConfig.frameRate = config.frameRate;
+    admissionConfig.latencyBudgetMs = config.latencyBudgetMs;
+    admission = FrameAdmission(admissionConfig);
+    
+    videoRate = gst_bin_get_by_name(GST_BIN(pipeline), "video_rate");
+    videoCaps = gst_bin_get_by_name(GST_BIN(pipeline), "video_caps");
+    configureGovernor();
+    
     // Get sink elements for stats
     if (config.transport == TransportMode::SRT) {
         srtSink = gst_bin_get_by_name(GST_BIN(pipeline), "srt_sink");
@@ -370,36 +718,208 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
         LOGI("Got muxer element");
     }
     
-    if (!videoAppSrc || !audioAppSrc) {
+    bool directSrt = config.transport == TransportMode::SRT_DIRECT ||
+                     config.transport == TransportMode::SRT_BONDED;
+    bool multiLinkUdp = config.transport == TransportMode::MULTILINK_UDP;
+    bool arqUdp = config.transport == TransportMode::ARQ_UDP;
+    if (directSrt) {
+        SrtTransportConfig srtConfig;
+        srtConfig.host = config.srtHost;
+        srtConfig.port = config.srtPort;
+        srtConfig.streamId = config.streamId;
+        srtConfig.passphrase = config.passphrase;
+        srtConfig.latencyMs = config.srtLatencyMs;
+        srtConfig.maxBw = config.srtMaxBw;
+        srtConfig.inputBw = config.srtInputBw;
+        srtConfig.overheadPercent = config.srtOverheadPercent;
+        srtConfig.payloadSize = config.srtPayloadSize;
+        srtConfig.sendBufferBytes = config.srtSendBufferBytes;
+        srtConfig.bonded = config.transport == TransportMode::SRT_BONDED;
+        srtConfig.groupMode = config.srtGroupMode;
+        srtConfig.links = config.srtLinks;
+        if (memoryBudget.bounded()) {
+            // Each bonded member has its own send buffer
+            size_t links = srtConfig.bonded ? std::max<size_t>(1, srtConfig.links.size()) : 1;
+            int share = static_cast<int>(std::min<uint64_t>(std::numeric_limits<int>::max(),
+                memoryBudget.limit(MemoryComponent::RETRANSMIT) / links));
+            srtConfig.sendBufferBytes = srtConfig.sendBufferBytes > 0
+                ? std::min(srtConfig.sendBufferBytes, share) : share;
+            int64_t coverMs = static_cast<int64_t>(srtConfig.sendBufferBytes) * 8000 /
+                              std::max(1, config.videoBitrate + config.audioBitrate);
+            LOGI("SRT send buffer %d bytes per link from the memory budget (~%lld ms)",
+                 srtConfig.sendBufferBytes, (long long)coverMs);
+            if (coverMs < config.srtLatencyMs) {
+                LOGE("SRT send buffer covers %lld ms, less than the %d ms latency: late resends will be dropped",
+                     (long long)coverMs, config.srtLatencyMs);
+            }
+        }
+        srtTransport = std::make_unique<SrtTransport>(srtConfig,
+            [this](SrtConnectionState state, const std::string& reason) {
+                onConnectionEvent(state, reason);
+            });
+        if (!SrtTransport::isAvailable()) {
+            LOGE("libsrt transport requested but libsrt support is not compiled in");
+        }
+    } else if (multiLinkUdp) {
+        MultiLinkConfig linkConfig;
+        linkConfig.host = config.srtHost;
+        linkConfig.port = config.srtPort;
+        linkConfig.scheduler = config.linkScheduler;
+        linkConfig.probeIntervalMs = config.linkProbeIntervalMs;
+        multiLink = std::make_unique<MultiLinkSender>(linkConfig, config.udpLinks);
+        if (multiLink->linkCount() == 0) {
+            LOGE("Multi-link UDP requested but no usable link sockets were given");
+            cleanup();
+            return false;
+        }
+    } else if (arqUdp) {
+        ArqConfig arqConfig;
+        arqConfig.host = config.srtHost;
+        arqConfig.port = config.srtPort;
+        arqConfig.latencyMs = config.arqLatencyMs;
+        arqConfig.ringSlots = static_cast<size_t>(std::max(64, config.arqRingSlots));
+        if (memoryBudget.bounded()) {
+            size_t budgetSlots = memoryBudget.limit(MemoryComponent::RETRANSMIT) / ArqSender::slotBytes();
+            arqConfig.ringSlots = std::max<size_t>(64, std::min(arqConfig.ringSlots, budgetSlots));
+            int64_t coverMs = static_cast<int64_t>(arqConfig.ringSlots) * TsMuxer::kDatagramSize * 8000 /
+                              std::max(1, config.videoBitrate + config.audioBitrate);
+            if (coverMs < config.arqLatencyMs) {
+                LOGE("ARQ ring of %zu slots covers %lld ms, less than the %d ms latency",
+                     arqConfig.ringSlots, (long long)coverMs, config.arqLatencyMs);
+            }
+        }
+        arqSender = std::make_unique<ArqSender>(arqConfig);
+    } else if (config.muxer == MuxerMode::NATIVE || config.enablePacing) {
+        tsAppSrc = gst_bin_get_by_name(GST_BIN(pipeline), "ts_src");
+        if (!tsAppSrc) {
+            LOGE("Failed to get ts_src element");
+            cleanup();
+            return false;
+        }
+        g_object_set(tsAppSrc,
+            "stream-type", 0,
+            "format", GST_FORMAT_TIME,
+            nullptr);
+        if (memoryBudget.bounded()) {
+            gst_app_src_set_max_bytes(GST_APP_SRC(tsAppSrc), memoryBudget.limit(MemoryComponent::TS_QUEUE));
+        }
+        
+        // Datagram buffers come back to the pool once the sink has sent them,
+        // so steady state pushes without allocating. No upper bound: the TS
+        // budget check in pushTsDatagram drops before the queue grows.
+        guint preallocated = 64;
+        if (memoryBudget.bounded()) {
+            preallocated = static_cast<guint>(std::max<uint64_t>(8, std::min<uint64_t>(preallocated,
+                memoryBudget.limit(MemoryComponent::TS_QUEUE) / TsMuxer::kDatagramSize)));
+        }
+        tsPool = gst_buffer_pool_new();
+        GstStructure* poolConfig = gst_buffer_pool_get_config(tsPool);
+        gst_buffer_pool_config_set_params(poolConfig, nullptr, TsMuxer::kDatagramSize, preallocated, 0);
+        if (!gst_buffer_pool_set_config(tsPool, poolConfig) || !gst_buffer_pool_set_active(tsPool, TRUE)) {
+            LOGE("Failed to activate TS buffer pool, allocating per datagram");
+            gst_object_unref(tsPool);
+            tsPool = nullptr;
+        }
+    }
+    
+    bool fileSource = config.source == SourceMode::FILE;
+    bool hasAudio = !fileSource || config.sourceAudio;
+    
+    if (config.muxer == MuxerMode::NATIVE) {
+        videoEsSink = gst_bin_get_by_name(GST_BIN(pipeline), "video_es_sink");
+        audioEsSink = gst_bin_get_by_name(GST_BIN(pipeline), "audio_es_sink");
+        if (!videoEsSink || (hasAudio && !audioEsSink)) {
+            LOGE("Failed to get native muxer elements (video=%p, audio=%p)",
+                 videoEsSink, audioEsSink);
+            cleanup();
+            return false;
+        }
+        
+        TsMuxerConfig muxConfig;
+        muxConfig.videoCodec = VideoCodec::H264;
+        muxConfig.audioCodec = AudioCodec::AAC;
+        muxConfig.hasAudio = hasAudio;
+        muxConfig.audioChannels = config.audioChannels;
+        muxConfig.pcrDelayMs = config.tsPcrDelayMs;
+        muxConfig.psiIntervalMs = config.tsPsiIntervalMs;
+        tsMuxer = std::make_unique<TsMuxer>(muxConfig,
+            [this](const uint8_t* data, size_t size) {
+                byteAccounting.add(ByteLayer::TS, size, size / ByteAccounting::kTsPacketSize);
+                sendTsDatagram(data, size);
+            });
+        
+        GstAppSinkCallbacks videoCallbacks = {};
+        videoCallbacks.new_sample = &Impl::onVideoEsSample;
+        gst_app_sink_set_callbacks(GST_APP_SINK(videoEsSink), &videoCallbacks, this, nullptr);
+        
+        if (audioEsSink) {
+            GstAppSinkCallbacks audioCallbacks = {};
+            audioCallbacks.new_sample = &Impl::onAudioEsSample;
+            gst_app_sink_set_callbacks(GST_APP_SINK(audioEsSink), &audioCallbacks, this, nullptr);
+        }
+        
+        LOGI("Native TS muxer attached");
+    } else if (config.enablePacing || directSrt || multiLinkUdp || arqUdp) {
+        tsAppSink = gst_bin_get_by_name(GST_BIN(pipeline), "ts_sink");
+        if (!tsAppSink) {
+            LOGE("Failed to get ts_sink element");
+            cleanup();
+            return false;
+        }
+        GstAppSinkCallbacks tsCallbacks = {};
+        tsCallbacks.new_sample = &Impl::onTsSample;
+        gst_app_sink_set_callbacks(GST_APP_SINK(tsAppSink), &tsCallbacks, this, nullptr);
+    }
+    
+    if (config.enablePacing) {
+        PacerConfig pacerConfig;
+        pacerConfig.rateBps = pacingRateBps(config.videoBitrate / 1000);
+        pacerConfig.burstBytes = static_cast<size_t>(std::max(1, config.pacingBurstPackets)) *
+                                 TsMuxer::kDatagramSize;
+        pacerConfig.maxQueueDelayMs = config.pacingMaxDelayMs;
+        if (memoryBudget.bounded()) {
+            size_t budgetSlots = memoryBudget.limit(MemoryComponent::PACER) / PacketPacer::slotBytes();
+            pacerConfig.queueCapacity = std::max<size_t>(64, std::min(pacerConfig.queueCapacity, budgetSlots));
+        }
+        pacer = std::make_unique<PacketPacer>(pacerConfig,
+            [this](const uint8_t* data, size_t size) { pushTsDatagram(data, size); });
+        pacer->setThreadInitHook([this]() { threadPlacer.applyOnce(ThreadRole::SEND); });
+        LOGI("Packet pacer attached");
+    }
+    
+    if (fileSource) {
+        addFileSourceProbe();
+    } else if (!videoAppSrc || !audioAppSrc) {
         LOGE("Failed to get appsrc elements (video=%p, audio=%p)", videoAppSrc, audioAppSrc);
         cleanup();
         return false;
+    } else {
+        // Configure video appsrc for streaming
+        g_object_set(videoAppSrc,
+            "stream-type", 0,  // GST_APP_STREAM_TYPE_STREAM
+            "format", GST_FORMAT_TIME,
+            nullptr);
+        
+        // Configure audio appsrc for streaming
+        g_object_set(audioAppSrc,
+            "stream-type", 0,
+            "format", GST_FORMAT_TIME,
+            nullptr);
     }
-    
-    // Configure video appsrc for streaming
-    g_object_set(videoAppSrc,
-        "stream-type", 0,  // GST_APP_STREAM_TYPE_STREAM
-        "format", GST_FORMAT_TIME,
-        nullptr);
-    
-    // Configure audio appsrc for streaming
-    g_object_set(audioAppSrc,
-        "stream-type", 0,
-        "format", GST_FORMAT_TIME,
-        nullptr);
 
     // Pad probe on encoder src to:
-    // 1. Count encoded video bytes for bitrate calculation
+    // 1. Count encoded video bytes (VIDEO_ES layer)
     // 2. Count output frames for fps stats
     // 3. Inspect NAL headers for SPS/PPS/IDR presence (debug)
     if (videoEncoder) {
         // Store pointers to both counters in a struct for the lambda
         struct EncoderProbeData {
-            std::atomic<uint64_t>* byteCounter;
+            ByteAccounting* bytes;
             std::atomic<uint64_t>* frameCounter;
+            FrameSizeAccumulator* frameSizes;
         };
         // Note: This leaks a small struct but it's needed for the probe lifetime
-        auto* probeData = new EncoderProbeData{&muxerBytesSent, &outputFrameCount};
+        auto* probeData = new EncoderProbeData{&byteAccounting, &outputFrameCount, &frameSizes};
         
         GstPad* encSrc = gst_element_get_static_pad(videoEncoder, "src");
         if (encSrc) {
@@ -411,14 +931,13 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
                     
                     // Count encoded bytes
                     gsize bufSize = gst_buffer_get_size(buf);
-                    if (data->byteCounter) {
-                        data->byteCounter->fetch_add(bufSize, std::memory_order_relaxed);
-                    }
+                    data->bytes->add(ByteLayer::VIDEO_ES, bufSize);
                     
                     // Count output frames
                     if (data->frameCounter) {
                         data->frameCounter->fetch_add(1, std::memory_order_relaxed);
                     }
+                    data->frameSizes->add(bufSize);
                     
                     // Debug logging for first 10 buffers
                     static int logged = 0;
@@ -458,7 +977,7 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
                     
                     LOGI("h264probe buf=%zu nal_types=[%s] IDR=%d SPS=%d PPS=%d bytes=%llu frames=%llu", 
                          map.size, nalList.str().c_str(), hasIDR, hasSPS, hasPPS,
-                         data->byteCounter ? (unsigned long long)data->byteCounter->load() : 0ULL,
+                         (unsigned long long)data->bytes->bytes(ByteLayer::VIDEO_ES),
                          data->frameCounter ? (unsigned long long)data->frameCounter->load() : 0ULL);
                     
                     gst_buffer_unmap(buf, &map);
@@ -469,6 +988,53 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
             gst_object_unref(encSrc);
             LOGI("Added byte/frame counting probe on video encoder");
         }
+        
+        // Frames entering the encoder, for the in-flight count used by admission
+        GstPad* encSink = gst_element_get_static_pad(videoEncoder, "sink");
+        if (encSink) {
+            gst_pad_add_probe(encSink, GST_PAD_PROBE_TYPE_BUFFER,
+                [](GstPad*, GstPadProbeInfo* info, gpointer user_data) -> GstPadProbeReturn {
+                    static_cast<std::atomic<uint64_t>*>(user_data)->fetch_add(1, std::memory_order_relaxed);
+                    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+                    // One async row per frame from here to the muxer, keyed by PTS
+                    // (videorate restamps, so not from appsrc)
+                    if (buf) TRACE_ASYNC_BEGIN("frame", GST_BUFFER_PTS(buf));
+                    return GST_PAD_PROBE_OK;
+                },
+                &encoderInputCount, nullptr);
+            gst_object_unref(encSink);
+        }
+        
+        // Capture-to-encoded latency: appsrc stamps PTS with the running time
+        // at push (do-timestamp), so the difference to the running time now
+        // is the time spent in convert/scale/encode
+        struct LatencyProbeData {
+            GstElement* pipeline;
+            std::atomic<int64_t>* latencyNs;
+        };
+        encSrc = gst_element_get_static_pad(videoEncoder, "src");
+        if (encSrc) {
+            gst_pad_add_probe(encSrc, GST_PAD_PROBE_TYPE_BUFFER,
+                [](GstPad*, GstPadProbeInfo* info, gpointer user_data) -> GstPadProbeReturn {
+                    auto* data = static_cast<LatencyProbeData*>(user_data);
+                    GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+                    if (!buf || !GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buf))) return GST_PAD_PROBE_OK;
+                    TRACE_ASYNC_STEP("frame", GST_BUFFER_PTS(buf), "encoded");
+                    GstClock* clock = gst_element_get_clock(data->pipeline);
+                    if (!clock) return GST_PAD_PROBE_OK;
+                    GstClockTime runningTime = gst_clock_get_time(clock) -
+                                               gst_element_get_base_time(data->pipeline);
+                    gst_object_unref(clock);
+                    if (runningTime > GST_BUFFER_PTS(buf)) {
+                        data->latencyNs->store(static_cast<int64_t>(runningTime - GST_BUFFER_PTS(buf)),
+                                               std::memory_order_relaxed);
+                    }
+                    return GST_PAD_PROBE_OK;
+                },
+                new LatencyProbeData{pipeline, &encodeLatencyNs},
+                [](gpointer user_data) { delete static_cast<LatencyProbeData*>(user_data); });
+            gst_object_unref(encSrc);
+        }
         // Note: videoEncoder is unreffed in cleanup()
     }
 
@@ -482,6 +1048,7 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
                     GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
                     if (buf && counter) {
                         counter->fetch_add(1, std::memory_order_relaxed);
+                        TRACE_INSTANT("videoSrcBuffer", static_cast<int64_t>(counter->load()));
                         
                         // Debug logging for first 5 frames
                         static int vlogged = 0;
@@ -500,6 +1067,60 @@ bool SrtStreamer::Impl::createPipeline(const StreamConfig& config) {
         }
     }
     
+    // Fallback path: CPU spent in videoconvert + videoscale, for comparison
+    // with the native ingest conversion (same streaming thread end to end)
+    if (!nativeIngest) {
+        GstElement* convert = gst_bin_get_by_name(GST_BIN(pipeline), "video_convert");
+        GstElement* scale = gst_bin_get_by_name(GST_BIN(pipeline), "video_scale");
+        GstPad* convertSink = convert ? gst_element_get_static_pad(convert, "sink") : nullptr;
+        GstPad* scaleSrc = scale ? gst_element_get_static_pad(scale, "src") : nullptr;
+        if (convertSink && scaleSrc) {
+            gst_pad_add_probe(convertSink, GST_PAD_PROBE_TYPE_BUFFER,
+                [](GstPad*, GstPadProbeInfo*, gpointer user_data) -> GstPadProbeReturn {
+                    auto* self = static_cast<Impl*>(user_data);
+                    self->convertStartNs.store(threadCpuNs(), std::memory_order_relaxed);
+                    return GST_PAD_PROBE_OK;
+                },
+                this, nullptr);
+            gst_pad_add_probe(scaleSrc, GST_PAD_PROBE_TYPE_BUFFER,
+                [](GstPad*, GstPadProbeInfo*, gpointer user_data) -> GstPadProbeReturn {
+                    auto* self = static_cast<Impl*>(user_data);
+                    int64_t start = self->convertStartNs.exchange(0, std::memory_order_relaxed);
+                    if (start > 0) self->recordIngestCost(threadCpuNs() - start);
+                    return GST_PAD_PROBE_OK;
+                },
+                this, nullptr);
+        }
+        if (convertSink) gst_object_unref(convertSink);
+        if (scaleSrc) gst_object_unref(scaleSrc);
+        if (convert) gst_object_unref(convert);
+        if (scale) gst_object_unref(scale);
+    }
+    
+    // Trace: the frame row ends when the muxer takes the frame; GStreamer
+    // sinks mark each buffer they are handed
+    addTraceProbe(videoQueue, "src", TraceProbe::FRAME_END);
+    addTraceProbe(srtSink ? srtSink : udpSink, "sink", TraceProbe::SINK_BUFFER);
+    
+    // Data reaching the network sink ends a recovery
+    addFlowProbe(srtSink ? srtSink : udpSink, "sink");
+    
+    // Byte accounting: audio ES and mpegtsmux output here (video ES in the
+    // encoder probe, TsMuxer output in its callback); datagrams into udpsink
+    // are the transport layer, srtsink reports its own
+    GstElement* audioParse = gst_bin_get_by_name(GST_BIN(pipeline), "audio_parse");
+    addByteProbe(audioParse, "src", ByteLayer::AUDIO_ES);
+    if (audioParse) gst_object_unref(audioParse);
+    GstElement* mux = gst_bin_get_by_name(GST_BIN(pipeline), "mux");
+    addByteProbe(mux, "src", ByteLayer::TS);
+    if (mux) gst_object_unref(mux);
+    addByteProbe(udpSink, "sink", ByteLayer::TRANSPORT);
+    
+    // Register streaming threads with the placer as they first carry data
+    addPlacementProbe(videoEncoder, "sink", ThreadRole::ENCODE);
+    addPlacementProbe(audioAppSrc, "src", ThreadRole::AUDIO);
+    addPlacementProbe(srtSink ? srtSink : udpSink, "sink", ThreadRole::SEND);
+    
     LOGI("Pipeline created successfully");
     return true;
 #else
@@ -515,6 +1136,12 @@ bool SrtStreamer::Impl::start() {
         LOGE("!!! No pipeline to start !!!");
         return false;
     }
+    bool counted = false;
+    if (!countedActive) {
+        std::lock_guard<std::mutex> run(g_calibrationRunMutex);
+        g_activeStreams.fetch_add(1);
+        countedActive = counted = true;
+    }
     
     LOGI("=== STARTING SRT STREAM ===");
     LOGI("Setting pipeline to PLAYING state...");
@@ -524,6 +1151,41 @@ bool SrtStreamer::Impl::start() {
     lastVideoWidth = 0;
     lastVideoHeight = 0;
     
+    if (tsMuxer) {
+        tsMuxer->reset();
+    }
+    if (pacer) {
+        pacer->setRate(pacingRateBps(currentConfig.videoBitrate / 1000));
+        pacer->start();
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.connectionState = SrtConnectionState::CONNECTING;
+        stats.faults = 0;
+        stats.recoveries = 0;
+        stats.lastFault = PipelineFault::NONE;
+        stats.lastDetectMs = 0.0;
+        stats.lastRecoverMs = 0.0;
+        health = Health::HEALTHY;
+        // Before any data flows. The Bondix relay wraps each datagram in a
+        // SOCKS5 UDP header (10 bytes, 22 for an IPv6 target).
+        byteAccounting.reset(currentConfig.useProxy && currentConfig.transport == TransportMode::UDP
+                             ? (currentConfig.srtHost.find(':') != std::string::npos ? 22 : 10) : 0);
+    }
+    lastDataNs = steadyNs();
+    awaitingFlow = false;
+    recoveryAttempt = 0;
+    if (srtTransport) {
+        srtTransport->start();
+    }
+    if (multiLink && !multiLink->start()) {
+        LOGE("Multi-link sender failed to start");
+    }
+    if (arqSender && !arqSender->start()) {
+        LOGE("ARQ sender failed to start");
+    }
+    
+    prepareFileSource();
     GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
     
     const char* stateChangeStr;
@@ -537,6 +1199,22 @@ bool SrtStreamer::Impl::start() {
     LOGI("State change result: %s", stateChangeStr);
     
     if (ret == GST_STATE_CHANGE_FAILURE) {
+        if (pacer) {
+            pacer->stop();
+        }
+        if (srtTransport) {
+            srtTransport->stop();
+        }
+        if (multiLink) {
+            multiLink->stop();
+        }
+        if (arqSender) {
+            arqSender->stop();
+        }
+        if (counted) {
+            g_activeStreams.fetch_sub(1);
+            countedActive = false;
+        }
         LOGE("!!! FAILED TO START PIPELINE !!!");
         LOGE("SRT connection may have failed - check host/port");
         if (errorCallback) {
@@ -551,27 +1229,53 @@ bool SrtStreamer::Impl::start() {
     lastBitrateAdjustTime = startTime;
     lastFpsCalcTime = startTime;
     lastBytesSent = 0;
-    muxerBytesSent = 0;
     inputFrameCount = 0;
     outputFrameCount = 0;
+    encoderInputCount = 0;
+    encodeLatencyNs = 0;
+    ingestCpuNs = 0;
+    convertStartNs = 0;
+    frameAdmitted = false;
+    lastVideoFrameBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(admissionMutex);
+        admission.reset();
+    }
     lastInputFrameCount = 0;
     lastOutputFrameCount = 0;
     calculatedInputFps = 0.0;
     calculatedOutputFps = 0.0;
-    
-    // Set initial connection state
-    {
-        std::lock_guard<std::mutex> lock(statsMutex);
-        stats.connectionState = SrtConnectionState::CONNECTING;
+    frameSizes.count = 0;
+    frameSizes.sum = 0;
+    frameSizes.sumSquares = 0;
+    frameSizes.max = 0;
+    frameSizeMeanBytes = 0.0;
+    frameSizeStdDevBytes = 0.0;
+    frameSizeMaxBytes = 0;
+    if (encoder) {
+        encoder->drainTiming();
     }
+    encodeFrameMs = 0.0;
+    encodeFrameMaxMs = 0.0;
+    abrAction = 0;
+    lastMetricsStats = StreamStats();
     
-    // Start main loop in separate thread for bus messages
-    mainLoop = g_main_loop_new(nullptr, FALSE);
-    mainLoopThread = std::thread([this]() {
-        LOGI("GStreamer main loop started");
-        g_main_loop_run(mainLoop);
-        LOGI("GStreamer main loop ended");
-    });
+
+    // Timers and bus watches run on the main loop shared by all sessions
+    dispatcher = MainDispatcher::acquire();
+    dispatcher->invokeSync([this]() { threadPlacer.applyOnce(ThreadRole::MAIN_LOOP); });
+    if (metricsHistory) {
+        metricsSourceId = dispatcher->addTimeout(std::max(100, currentConfig.metricsIntervalMs),
+                                                 &Impl::onMetricsTick, this);
+    }
+    if (governorActive) {
+        governorSourceId = dispatcher->addTimeout(std::max(100, currentConfig.governor.intervalMs),
+                                                  &Impl::onGovernorTick, this);
+    }
+    // Errors posted while going to PLAYING are still queued on the bus
+    GstBus* bus = gst_element_get_bus(pipeline);
+    busWatchId = dispatcher->addBusWatch(bus, &Impl::onBusMessage, this);
+    gst_object_unref(bus);
     
     LOGI("=== SRT STREAM STARTED ===");
     LOGI("Streaming to: %s:%d", currentConfig.srtHost.c_str(), currentConfig.srtPort);
@@ -592,6 +1296,11 @@ bool SrtStreamer::Impl::start() {
 }
 
 void SrtStreamer::Impl::stop() {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    stopLocked();
+}
+
+void SrtStreamer::Impl::stopLocked(const char* reason) {
 #if GSTREAMER_AVAILABLE
     if (!streaming) {
         LOGD("Stop called but not streaming");
@@ -600,36 +1309,127 @@ void SrtStreamer::Impl::stop() {
     
     LOGI("=== STOPPING SRT STREAM ===");
     streaming = false;
+    if (countedActive) {
+        g_activeStreams.fetch_sub(1);
+        countedActive = false;
+    }
+    
+    if (dispatcher) {
+        // No restart may race the shutdown below; a recovery already running
+        // sees streaming == false and doesn't reschedule
+        dispatcher->removeSource(busWatchId);
+        busWatchId = 0;
+        dispatcher->removeSource(recoverySourceId);
+        recoverySourceId = 0;
+        dispatcher->removeSource(governorSourceId);    // Preset steps cycle the encoder
+        governorSourceId = 0;
+    }
+    
+    if (pacer) {
+        pacer->stop();
+    }
     
     if (pipeline) {
         LOGI("Setting pipeline to NULL state...");
         gst_element_set_state(pipeline, GST_STATE_NULL);
     }
-    
-    if (mainLoop) {
-        LOGI("Stopping GStreamer main loop...");
-        g_main_loop_quit(mainLoop);
-        if (mainLoopThread.joinable()) {
-            mainLoopThread.join();
+    encoderRestartPending = false;      // An idle probe left on a stopped pad never runs
+    
+    if (srtTransport) {
+        SrtTransportStats srtStats = srtTransport->getStats();
+        srtTransport->stop();
+        LOGI("libsrt: %llu connects, %lld packets (%lld lost, %lld retransmitted, %lld dropped), %lld refused locally",
+             (unsigned long long)srtStats.connects, (long long)srtStats.packetsSent,
+             (long long)srtStats.packetsLost, (long long)srtStats.packetsRetransmitted,
+             (long long)srtStats.packetsDropped, (long long)srtStats.localDrops);
+        for (const SrtLinkStats& link : srtStats.links) {
+            LOGI("  link %s -> %s: %llu packets, %llu lost, %llu retransmitted, rtt %.1f ms",
+                 link.localAddress.c_str(), link.remoteAddress.c_str(),
+                 (unsigned long long)link.packetsSent, (unsigned long long)link.packetsLost,
+                 (unsigned long long)link.packetsRetransmitted, link.rttMs);
+        }
+    }
+    if (multiLink) {
+        std::vector<UdpLinkStats> linkStats = multiLink->getLinkStats();
+        multiLink->stop();
+        LOGI("Multi-link: %llu bytes sent, %llu datagrams refused",
+             (unsigned long long)multiLink->bytesSent(),
+             (unsigned long long)multiLink->datagramsRefused());
+        for (const UdpLinkStats& link : linkStats) {
+            LOGI("  link %s: %llu packets, %llu bytes, rtt %.1f ms, loss %.1f%%",
+                 link.name.c_str(), (unsigned long long)link.packetsSent,
+                 (unsigned long long)link.bytesSent, link.rttMs, link.lossRate * 100.0);
         }
-        g_main_loop_unref(mainLoop);
-        mainLoop = nullptr;
+    }
+    if (arqSender) {
+        ArqStats arqStats = arqSender->getStats();
+        arqSender->stop();
+        LOGI("ARQ: %llu datagrams, %llu retransmitted (%.2f%%), %llu NAKed, %llu resends skipped, "
+             "%llu recovered, %llu expired",
+             (unsigned long long)arqStats.packetsSent, (unsigned long long)arqStats.packetsRetransmitted,
+             arqStats.retransmitRatio * 100.0, (unsigned long long)arqStats.packetsNaked,
+             (unsigned long long)arqStats.resendsSkipped, (unsigned long long)arqStats.recovered,
+             (unsigned long long)arqStats.expired);
+    }
+    
+    if (dispatcher) {
+        // Waits for a tick already running; the loop itself stops with the last session
+        dispatcher->removeSource(metricsSourceId);
+        metricsSourceId = 0;
+        dispatcher.reset();
     }
     
     // Log final stats
     LOGI("=== STREAM ENDED ===");
     LOGI("Total bytes sent (SRT): %llu", (unsigned long long)stats.bytesSent);
-    LOGI("Total bytes sent (muxer): %llu", (unsigned long long)muxerBytesSent.load());
+    for (size_t i = 0; i < static_cast<size_t>(ByteLayer::COUNT); i++) {
+        ByteLayer layer = static_cast<ByteLayer>(i);
+        LOGI("Total bytes (%s): %llu in %llu packets", byteLayerName(layer),
+             (unsigned long long)byteAccounting.bytes(layer),
+             (unsigned long long)byteAccounting.packets(layer));
+    }
+    LOGI("Video ingest: %s, %.0f us CPU/frame for convert+scale",
+         nativeIngest ? "native conversion" : "videoconvert ! videoscale",
+         ingestCpuNs.load() / 1e3);
+    if (tsMuxer) {
+        TsMuxerStats muxStats = tsMuxer->getStats();
+        LOGI("Native mux: %llu datagrams, %llu TS packets (%llu PSI), %llu PCRs, %llu/%llu video/audio AUs",
+             (unsigned long long)muxStats.datagrams,
+             (unsigned long long)muxStats.tsPackets,
+             (unsigned long long)muxStats.psiPackets,
+             (unsigned long long)muxStats.pcrCount,
+             (unsigned long long)muxStats.videoAccessUnits,
+             (unsigned long long)muxStats.audioAccessUnits);
+    }
+    LOGI("Memory: peak %llu KB buffered (budget %llu KB), %llu buffers dropped for the budget",
+         (unsigned long long)(memoryBudget.peakBytes() / 1024),
+         (unsigned long long)(memoryBudget.budgetBytes() / 1024),
+         (unsigned long long)budgetDrops.load());
+    for (const MemoryUsage& usage : memoryBudget.usage()) {
+        if (usage.limitBytes > 0) {
+            LOGI("  %s: peak %llu KB of %llu KB", memoryComponentName(usage.component),
+                 (unsigned long long)(usage.peakBytes / 1024), (unsigned long long)(usage.limitBytes / 1024));
+        } else {
+            LOGI("  %s: peak %llu KB", memoryComponentName(usage.component),
+                 (unsigned long long)(usage.peakBytes / 1024));
+        }
+    }
+    if (governorActive) {
+        const OperatingPoint& point = governor.current();
+        LOGI("Governor: ended at level %d/%d (%dx%d @ %d fps, preset %s) after %zu recent changes",
+             governor.level(), governor.maxLevel(), point.width, point.height, point.frameRate,
+             encoderPresetName(governedPreset(point.presetSteps)), stats.governorDecisions.size());
+    }
     LOGI("Stream duration: %llu ms", (unsigned long long)stats.streamTimeMs);
     
     if (stateCallback) {
-        stateCallback(false, "Streaming stopped");
+        stateCallback(false, reason);
     }
 #else
     streaming = false;
     LOGI("Stub streaming stopped");
     if (stateCallback) {
-        stateCallback(false, "Streaming stopped");
+        stateCallback(false, reason);
     }
 #endif
 }
@@ -659,9 +1459,47 @@ void SrtStreamer::Impl::cleanup() {
         muxer = nullptr;
     }
     if (videoEncoder) {
+        encoder->detach();
         gst_object_unref(videoEncoder);
         videoEncoder = nullptr;
     }
+    if (videoQueue) {
+        gst_object_unref(videoQueue);
+        videoQueue = nullptr;
+    }
+    if (audioQueue) {
+        gst_object_unref(audioQueue);
+        audioQueue = nullptr;
+    }
+    if (videoEsSink) {
+        gst_object_unref(videoEsSink);
+        videoEsSink = nullptr;
+    }
+    if (audioEsSink) {
+        gst_object_unref(audioEsSink);
+        audioEsSink = nullptr;
+    }
+    if (tsAppSink) {
+        gst_object_unref(tsAppSink);
+        tsAppSink = nullptr;
+    }
+    if (tsAppSrc) {
+        gst_object_unref(tsAppSrc);
+        tsAppSrc = nullptr;
+    }
+    if (tsPool) {
+        gst_buffer_pool_set_active(tsPool, FALSE);
+        gst_object_unref(tsPool);
+        tsPool = nullptr;
+    }
+    if (videoRate) {
+        gst_object_unref(videoRate);
+        videoRate = nullptr;
+    }
+    if (videoCaps) {
+        gst_object_unref(videoCaps);
+        videoCaps = nullptr;
+    }
     if (pipeline) {
         gst_object_unref(pipeline);
         pipeline = nullptr;
@@ -672,17 +1510,32 @@ void SrtStreamer::Impl::cleanup() {
     lastVideoWidth = 0;
     lastVideoHeight = 0;
 #endif
+    pacer.reset();
+    srtTransport.reset();
+    multiLink.reset();
+    arqSender.reset();
+    threadPlacer.reset();
+    tsMuxer.reset();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    videoPool.reset();
 }
 
 void SrtStreamer::Impl::updateSrtStats() {
 #if GSTREAMER_AVAILABLE
     if (!streaming) return;
+    TRACE_SCOPE("updateSrtStats");
     
     std::lock_guard<std::mutex> lock(statsMutex);
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastBitrateTime).count();
     
-    if (srtSink) {
+    if (srtTransport) {
+        updateDirectSrtStats();
+    } else if (multiLink) {
+        updateMultiLinkStats();
+    } else if (arqSender) {
+        updateArqStats();
+    } else if (srtSink) {
         // SRT mode: Query actual statistics from srtsink
         GstStructure* srtStats = nullptr;
         g_object_get(srtSink, "stats", &srtStats, nullptr);
@@ -749,18 +1602,19 @@ void SrtStreamer::Impl::updateSrtStats() {
                 gst_structure_get_int64(srtStats, "mbpsBandwidth", &mbpsBandwidth);
             }
             
+            stats.packetsSent = static_cast<uint64_t>(pktSentTotal);
             stats.packetsLost = static_cast<uint64_t>(pktSentLoss);
             stats.packetsRetransmitted = static_cast<uint64_t>(pktRetrans);
             stats.packetsDropped = static_cast<uint64_t>(pktSndDrop);
             stats.rtt = msRTT;
             stats.bandwidth = mbpsBandwidth * 1000000;  // Convert Mbps to bps
             
-            // Update bytesSent - prefer SRT stats, fallback to muxer count
+            // Update bytesSent - prefer SRT stats, fallback to muxer output
             if (byteSentTotal > 0) {
                 stats.bytesSent = static_cast<uint64_t>(byteSentTotal);
+                byteAccounting.storeTransport(stats.bytesSent, stats.packetsSent, true);
             } else {
-                // Fallback to muxer byte counting
-                stats.bytesSent = muxerBytesSent.load(std::memory_order_relaxed);
+                stats.bytesSent = byteAccounting.bytes(ByteLayer::TS);
             }
             
             // Calculate bitrate from bytes sent over time
@@ -793,8 +1647,9 @@ void SrtStreamer::Impl::updateSrtStats() {
             LOGD("SRT sink has no stats available yet");
         }
     } else {
-        // UDP mode: Use muxer byte counting for actual transmitted data
-        stats.bytesSent = muxerBytesSent.load(std::memory_order_relaxed);
+        // UDP mode: datagrams into udpsink, SOCKS5 encapsulation included
+        stats.bytesSent = byteAccounting.bytes(ByteLayer::TRANSPORT);
+        stats.packetsSent = byteAccounting.packets(ByteLayer::TRANSPORT);
         
         // Calculate bitrate from bytes sent over time
         if (elapsed >= 1000 && stats.bytesSent > 0) {
@@ -820,60 +1675,249 @@ void SrtStreamer::Impl::updateSrtStats() {
 #endif
 }
 
-void SrtStreamer::Impl::updateAdaptiveBitrate() {
-#if GSTREAMER_AVAILABLE
-    if (!videoEncoder || !streaming) return;
-    
+// SRT_DIRECT / SRT_BONDED: typed counters from srt_bstats (statsMutex held by the caller).
+// connectionState is not touched here; it follows onConnectionEvent.
+void SrtStreamer::Impl::updateDirectSrtStats() {
+    SrtTransportStats srtStats = srtTransport->getStats();
     auto now = std::chrono::steady_clock::now();
-    auto timeSinceLastAdjust = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - lastBitrateAdjustTime).count();
-    
-    // Only adjust every 2 seconds to avoid oscillation
-    if (timeSinceLastAdjust < 2000) return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastBitrateTime).count();
     
-    // Get current stats (already locked by caller)
-    double lossRate = 0.0;
-    if (stats.bytesSent > 0) {
-        // Calculate loss rate as percentage
-        // Using packets sent estimate (bytes / 1316 typical SRT packet size)
-        uint64_t estPacketsSent = stats.bytesSent / 1316;
-        if (estPacketsSent > 0) {
-            lossRate = (stats.packetsLost * 100.0) / (estPacketsSent + stats.packetsLost);
-        }
+    stats.packetsLost = static_cast<uint64_t>(srtStats.packetsLost);
+    stats.packetsRetransmitted = static_cast<uint64_t>(srtStats.packetsRetransmitted);
+    stats.packetsDropped = static_cast<uint64_t>(srtStats.packetsDropped + srtStats.localDrops);
+    stats.rtt = srtStats.rttMs;
+    stats.bandwidth = static_cast<int64_t>(srtStats.bandwidthMbps * 1000000.0);
+    stats.bytesSent = static_cast<uint64_t>(srtStats.bytesSent);
+    stats.packetsSent = static_cast<uint64_t>(srtStats.wirePacketsSent);
+    byteAccounting.storeTransport(static_cast<uint64_t>(srtStats.wireBytesSent),
+                                  static_cast<uint64_t>(srtStats.wirePacketsSent), true);
+    stats.srtLinks = std::move(srtStats.links);
+    memoryBudget.update(MemoryComponent::RETRANSMIT, static_cast<uint64_t>(srtStats.sendBufferBytes));
+    
+    if (elapsed >= 1000) {
+        int64_t byteDiff = static_cast<int64_t>(stats.bytesSent) - lastBytesSent;
+        stats.currentBitrate = byteDiff > 0 ? (byteDiff * 8.0 * 1000.0) / elapsed : 0.0;
+        lastBytesSent = stats.bytesSent;
+        lastBitrateTime = now;
     }
     
-    // Adaptive bitrate logic:
-    // 1. High loss (>5%) or high RTT (>500ms) -> reduce bitrate aggressively
-    // 2. Moderate loss (1-5%) -> reduce bitrate slowly
-    // 3. Low loss (<1%) and low RTT -> increase bitrate slowly toward max
+    if (srtTransport->getState() == SrtConnectionState::CONNECTED) {
+        updateAdaptiveBitrate();
+    }
+}
+
+// MULTILINK_UDP: per-link probe stats (statsMutex held by the caller).
+// No adaptive bitrate: the delivered rate per link is what was offered,
+// not what the link could carry, so it is no capacity signal.
+void SrtStreamer::Impl::updateMultiLinkStats() {
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastBitrateTime).count();
+    if (elapsed < 1000) return;     // getLinkStats() rates cover the time between calls
+    
+    stats.udpLinks = multiLink->getLinkStats();
+    stats.bytesSent = multiLink->bytesSent();
+    stats.packetsSent = multiLink->datagramsSent();
+    stats.packetsDropped = multiLink->datagramsRefused();
+    byteAccounting.storeTransport(stats.bytesSent, stats.packetsSent);
+    
+    double rtt = 0.0;
+    bool anyUp = false;
+    for (const UdpLinkStats& link : stats.udpLinks) {
+        if (!link.up) continue;
+        rtt = anyUp ? std::min(rtt, link.rttMs) : link.rttMs;
+        anyUp = true;
+    }
+    stats.rtt = rtt;
+    stats.connectionState = anyUp ? SrtConnectionState::CONNECTED : SrtConnectionState::BROKEN;
     
-    int newBitrate = currentEncoderBitrate;
+    int64_t byteDiff = static_cast<int64_t>(stats.bytesSent) - lastBytesSent;
+    stats.currentBitrate = byteDiff > 0 ? (byteDiff * 8.0 * 1000.0) / elapsed : 0.0;
+    lastBytesSent = stats.bytesSent;
+    lastBitrateTime = now;
+}
+
+// ARQ_UDP: sender counters plus the receiver's ACK report (statsMutex held by the caller).
+// NAKed datagrams count as lost, like SRT's pktSndLossTotal, so ABR sees wire loss
+// even when every gap was recovered.
+void SrtStreamer::Impl::updateArqStats() {
+    ArqStats arqStats = arqSender->getStats();
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastBitrateTime).count();
     
-    if (lossRate > 5.0 || stats.rtt > 500.0) {
-        // Aggressive reduction: drop by 30%
-        newBitrate = currentEncoderBitrate * 70 / 100;
-        LOGI("ABR: High loss/RTT (loss=%.1f%%, rtt=%.0fms) -> reduce to %d kbps", 
-             lossRate, stats.rtt, newBitrate);
-    } else if (lossRate > 1.0 || stats.rtt > 200.0) {
-        // Slow reduction: drop by 10%
-        newBitrate = currentEncoderBitrate * 90 / 100;
-        LOGI("ABR: Moderate loss/RTT (loss=%.1f%%, rtt=%.0fms) -> reduce to %d kbps", 
-             lossRate, stats.rtt, newBitrate);
-    } else if (lossRate < 0.5 && stats.rtt < 100.0 && currentEncoderBitrate < maxBitrate) {
-        // Network is good, increase by 10% toward max
-        newBitrate = std::min(maxBitrate, currentEncoderBitrate * 110 / 100);
-        LOGI("ABR: Good conditions (loss=%.1f%%, rtt=%.0fms) -> increase to %d kbps", 
-             lossRate, stats.rtt, newBitrate);
+    stats.bytesSent = arqStats.bytesSent;
+    stats.packetsSent = arqStats.packetsSent + arqStats.packetsRetransmitted;
+    byteAccounting.storeTransport(stats.bytesSent, stats.packetsSent);
+    stats.packetsLost = arqStats.packetsNaked;
+    stats.packetsRetransmitted = arqStats.packetsRetransmitted;
+    stats.packetsDropped = arqStats.resendsSkipped;
+    stats.rtt = arqStats.rttMs;
+    stats.retransmitRatio = arqStats.retransmitRatio;
+    stats.packetsRecovered = arqStats.recovered;
+    stats.packetsExpired = arqStats.expired;
+    memoryBudget.update(MemoryComponent::RETRANSMIT, arqStats.ringBytes);
+    stats.connectionState = arqStats.receiverSeen ? SrtConnectionState::CONNECTED
+                                                  : SrtConnectionState::CONNECTING;
+    
+    if (elapsed >= 1000) {
+        int64_t byteDiff = static_cast<int64_t>(stats.bytesSent) - lastBytesSent;
+        stats.currentBitrate = byteDiff > 0 ? (byteDiff * 8.0 * 1000.0) / elapsed : 0.0;
+        lastBytesSent = stats.bytesSent;
+        lastBitrateTime = now;
     }
     
-    // Also consider SRT's bandwidth estimate if available
-    if (stats.bandwidth > 0) {
-        int bwBitrate = static_cast<int>(stats.bandwidth / 1000);  // bps to kbps
-        // Use 80% of estimated bandwidth as ceiling
-        int bwCeiling = bwBitrate * 80 / 100;
-        if (bwCeiling < newBitrate) {
-            newBitrate = bwCeiling;
-            LOGI("ABR: Bandwidth limited to %d kbps (SRT estimate: %d kbps)", 
+    if (arqStats.receiverSeen) {
+        updateAdaptiveBitrate();
+    }
+}
+
+// libsrt reconnects by itself, so a broken SRT link is a fault that
+// recovers without a pipeline restart
+void SrtStreamer::Impl::onConnectionEvent(SrtConnectionState state, const std::string& reason) {
+    if (state == SrtConnectionState::BROKEN && streaming) {
+        beginFault(PipelineFault::SINK_DISCONNECTED, reason);
+        return;
+    }
+    if (state == SrtConnectionState::CONNECTED) {
+        completeRecovery();
+        // The receiver can decode from the next frame instead of the next GOP
+        if (streaming && requestKeyframe()) {
+            LOGI("Keyframe requested for the new connection");
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.connectionState = state;
+    }
+    if (connectionCallback) {
+        connectionCallback(state, reason);
+    }
+}
+
+// Returns the health before the fault: only a HEALTHY stream starts a new
+// fault (counted, timed and reported); later ones join the recovery under way
+SrtStreamer::Impl::Health SrtStreamer::Impl::beginFault(PipelineFault fault, const std::string& reason) {
+    int64_t now = steadyNs();
+    double detectMs;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (health != Health::HEALTHY) return health;
+        health = Health::RECOVERING;
+        faultDetectedNs = now;
+        detectMs = (now - lastDataNs.load(std::memory_order_relaxed)) / 1e6;
+        stats.faults++;
+        stats.lastFault = fault;
+        stats.lastDetectMs = detectMs;
+        stats.connectionState = SrtConnectionState::BROKEN;
+    }
+    LOGE("Fault: %s (%s), %.0f ms after the last data out", faultName(fault), reason.c_str(), detectMs);
+    TRACE_INSTANT("fault", static_cast<int64_t>(fault));
+    if (connectionCallback) {
+        connectionCallback(SrtConnectionState::BROKEN, reason);
+    }
+    return Health::HEALTHY;
+}
+
+void SrtStreamer::Impl::completeRecovery() {
+    double recoverMs;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (health != Health::RECOVERING) return;
+        health = Health::HEALTHY;
+        recoverMs = (steadyNs() - faultDetectedNs) / 1e6;
+        stats.recoveries++;
+        stats.lastRecoverMs = recoverMs;
+        stats.connectionState = SrtConnectionState::CONNECTED;
+    }
+    LOGI("Recovered in %.0f ms", recoverMs);
+    TRACE_INSTANT("recovered", static_cast<int64_t>(recoverMs));
+    if (connectionCallback) {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "Recovered in %.0f ms", recoverMs);
+        connectionCallback(SrtConnectionState::CONNECTED, reason);
+    }
+}
+
+// In-place recovery gave up: the app decides (rebuild or report)
+void SrtStreamer::Impl::failRecovery(const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        health = Health::FAILED;
+    }
+    awaitingFlow = false;
+    LOGE("Stream broken, not recovered: %s", reason.c_str());
+    if (errorCallback) {
+        errorCallback("Stream broken: " + reason);
+    }
+}
+
+// Streaming threads: called for every buffer/datagram out
+void SrtStreamer::Impl::markDataFlow() {
+    lastDataNs.store(steadyNs(), std::memory_order_relaxed);
+    if (awaitingFlow.load(std::memory_order_relaxed) && awaitingFlow.exchange(false)) {
+        completeRecovery();
+    }
+}
+
+void SrtStreamer::Impl::updateAdaptiveBitrate() {
+#if GSTREAMER_AVAILABLE
+    if (!videoEncoder || !streaming || !encoder->capabilities().liveBitrate) return;
+    
+    auto now = std::chrono::steady_clock::now();
+    auto timeSinceLastAdjust = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - lastBitrateAdjustTime).count();
+    
+    // Only adjust every 2 seconds to avoid oscillation
+    if (timeSinceLastAdjust < 2000) return;
+    
+    // Get current stats (already locked by caller)
+    // Loss as a percentage of the datagrams the transport actually sent
+    double lossRate = 0.0;
+    if (stats.packetsSent > 0) {
+        lossRate = std::min(100.0, (stats.packetsLost * 100.0) / stats.packetsSent);
+    }
+    
+    // Adaptive bitrate logic:
+    // 1. High loss (>5%) or high RTT (>500ms) -> reduce bitrate aggressively
+    // 2. Moderate loss (1-5%) -> reduce bitrate slowly
+    // 3. Low loss (<1%) and low RTT -> increase bitrate slowly toward max
+    
+    int newBitrate = currentEncoderBitrate;
+    AbrAction action = AbrAction::HOLD;
+    
+    if (lossRate > 5.0 || stats.rtt > 500.0) {
+        // Aggressive reduction: drop by 30%
+        newBitrate = currentEncoderBitrate * 70 / 100;
+        action = AbrAction::REDUCE_FAST;
+        LOGI("ABR: High loss/RTT (loss=%.1f%%, rtt=%.0fms) -> reduce to %d kbps", 
+             lossRate, stats.rtt, newBitrate);
+    } else if (lossRate > 1.0 || stats.rtt > 200.0) {
+        // Slow reduction: drop by 10%
+        newBitrate = currentEncoderBitrate * 90 / 100;
+        action = AbrAction::REDUCE_SLOW;
+        LOGI("ABR: Moderate loss/RTT (loss=%.1f%%, rtt=%.0fms) -> reduce to %d kbps", 
+             lossRate, stats.rtt, newBitrate);
+    } else if (lossRate < 0.5 && stats.rtt < 100.0 && currentEncoderBitrate < maxBitrate) {
+        // Network is good, increase by 10% toward max
+        newBitrate = std::min(maxBitrate, currentEncoderBitrate * 110 / 100);
+        action = AbrAction::INCREASE;
+        LOGI("ABR: Good conditions (loss=%.1f%%, rtt=%.0fms) -> increase to %d kbps", 
+             lossRate, stats.rtt, newBitrate);
+    }
+    
+    // Also consider SRT's bandwidth estimate if available
+    if (stats.bandwidth > 0) {
+        int bwBitrate = static_cast<int>(stats.bandwidth / 1000);  // bps to kbps
+        // Use 80% of estimated bandwidth as ceiling, less the share that
+        // audio, muxing and transport overhead take on the wire
+        uint64_t videoBytes = byteAccounting.bytes(ByteLayer::VIDEO_ES);
+        uint64_t wireBytes = byteAccounting.bytes(ByteLayer::WIRE);
+        double videoShare = videoBytes > 0 && wireBytes > videoBytes
+            ? static_cast<double>(videoBytes) / wireBytes : 1.0;
+        int bwCeiling = static_cast<int>(bwBitrate * 0.8 * videoShare);
+        if (bwCeiling < newBitrate) {
+            newBitrate = bwCeiling;
+            action = AbrAction::BANDWIDTH_CAP;
+            LOGI("ABR: Bandwidth limited to %d kbps (SRT estimate: %d kbps)", 
                  newBitrate, bwBitrate);
         }
     }
@@ -885,9 +1929,24 @@ void SrtStreamer::Impl::updateAdaptiveBitrate() {
     int diff = abs(newBitrate - currentEncoderBitrate);
     if (diff > currentEncoderBitrate / 20) {
         LOGI("ABR: Adjusting bitrate: %d -> %d kbps", currentEncoderBitrate, newBitrate);
-        g_object_set(videoEncoder, "bitrate", newBitrate, nullptr);
+        TRACE_INSTANT("abrAdjust", static_cast<int64_t>(action));
+        TRACE_COUNTER("encoderKbps", newBitrate);
+        encoder->setBitrate(newBitrate);
         currentEncoderBitrate = newBitrate;
+        if (pacer) {
+            pacer->setRate(pacingRateBps(newBitrate));
+        }
         lastBitrateAdjustTime = now;
+    } else {
+        action = AbrAction::HOLD;
+    }
+    // A hold never hides a change made earlier in the same metrics interval
+    if (action == AbrAction::HOLD) {
+        uint32_t none = static_cast<uint32_t>(AbrAction::NONE);
+        abrAction.compare_exchange_strong(none, static_cast<uint32_t>(action),
+                                          std::memory_order_relaxed);
+    } else {
+        abrAction.store(static_cast<uint32_t>(action), std::memory_order_relaxed);
     }
 #endif
 }
@@ -899,6 +1958,10 @@ StreamStats SrtStreamer::Impl::getStats() const {
     
     std::lock_guard<std::mutex> lock(statsMutex);
     StreamStats currentStats = stats;
+    if (health != Health::HEALTHY) {
+        // Polled sink stats may still look connected while recovering
+        currentStats.connectionState = SrtConnectionState::BROKEN;
+    }
     
     if (streaming) {
         auto now = std::chrono::steady_clock::now();
@@ -921,21 +1984,525 @@ StreamStats SrtStreamer::Impl::getStats() const {
             mutableThis->lastInputFrameCount = currentInputFrames;
             mutableThis->lastOutputFrameCount = currentOutputFrames;
             mutableThis->lastFpsCalcTime = now;
+            
+            FrameSizeAccumulator& sizes = mutableThis->frameSizes;
+            uint64_t count = sizes.count.exchange(0, std::memory_order_relaxed);
+            double sum = static_cast<double>(sizes.sum.exchange(0, std::memory_order_relaxed));
+            double sumSquares = static_cast<double>(sizes.sumSquares.exchange(0, std::memory_order_relaxed));
+            uint64_t maxBytes = sizes.max.exchange(0, std::memory_order_relaxed);
+            if (count > 0) {
+                double mean = sum / count;
+                mutableThis->frameSizeMeanBytes = mean;
+                mutableThis->frameSizeStdDevBytes = std::sqrt(std::max(0.0, sumSquares / count - mean * mean));
+                mutableThis->frameSizeMaxBytes = maxBytes;
+            }
+            EncodeTiming timing = encoder ? encoder->drainTiming() : EncodeTiming();
+            if (timing.frames > 0) {
+                mutableThis->encodeFrameMs = timing.meanMs;
+                mutableThis->encodeFrameMaxMs = timing.maxMs;
+            }
         }
         
         currentStats.inputFps = mutableThis->calculatedInputFps;
         currentStats.outputFps = mutableThis->calculatedOutputFps;
+        currentStats.frameSizeMeanBytes = frameSizeMeanBytes;
+        currentStats.frameSizeStdDevBytes = frameSizeStdDevBytes;
+        currentStats.frameSizeMaxBytes = frameSizeMaxBytes;
+        currentStats.vbvBufferMs = vbvBufferMs;
         currentStats.framesDropped = inputFrameCount.load() - outputFrameCount.load();
-        currentStats.hardwareEncoderActive = usingHardwareEncoder;
+        currentStats.hardwareEncoderActive = encoder && encoder->capabilities().hardware;
+        currentStats.encoder = encoder ? encoder->kind() : EncoderKind::AUTO;
+        
+        if (pacer) {
+            PacerStats pacerStats = pacer->getStats();
+            currentStats.pacerQueueDepth = pacerStats.queueDepth;
+            currentStats.pacerDelayMs = pacerStats.avgDelayMs;
+            currentStats.pacerMaxDelayMs = pacerStats.maxDelayMs;
+            currentStats.pacerDropped = pacerStats.packetsDropped;
+            mutableThis->memoryBudget.update(MemoryComponent::PACER, pacerStats.queueBytes,
+                                             pacerStats.maxQueueBytes);
+        }
+        
+        mutableThis->sampleMemory();
+        currentStats.memory = memoryBudget.usage();
+        currentStats.memoryBytes = memoryBudget.currentBytes();
+        currentStats.memoryPeakBytes = memoryBudget.peakBytes();
+        currentStats.budgetDrops = budgetDrops.load(std::memory_order_relaxed);
+        
+        ByteAccountingStats layers = mutableThis->byteAccounting.sample(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+        currentStats.byteLayers = std::move(layers.layers);
+        currentStats.muxOverhead = layers.muxOverhead;
+        currentStats.transportOverhead = layers.transportOverhead;
+        currentStats.wireOverhead = layers.wireOverhead;
+        
+        currentStats.threadCpuTimes = threadPlacer.sampleCpuTimes();
+        
+        {
+            std::lock_guard<std::mutex> lock(admissionMutex);
+            FrameAdmissionStats admissionStats = admission.getStats();
+            currentStats.framesRefused = admissionStats.refused;
+            currentStats.admitRatio = admissionStats.admitRatio;
+        }
+        currentStats.encodeLatencyMs = encodeLatencyNs.load(std::memory_order_relaxed) / 1e6;
+        currentStats.encodeFrameMs = encodeFrameMs;
+        currentStats.encodeFrameMaxMs = encodeFrameMaxMs;
+        currentStats.elidedElements = elidedElements;
+        currentStats.ingestConvertUs = ingestCpuNs.load(std::memory_order_relaxed) / 1e3;
     }
     
     return currentStats;
 }
 
-void SrtStreamer::Impl::pushVideoFrame(const uint8_t* data, size_t size,
-                                        int width, int height, int64_t timestampNs) {
+namespace {
+uint32_t counterDelta(uint64_t now, uint64_t before) {
+    return static_cast<uint32_t>(now >= before ? now - before : now);
+}
+}
+
+// One MetricsRecord per interval, on the main loop thread (the history's only writer)
+void SrtStreamer::Impl::sampleMetrics() {
+    if (!metricsHistory || !streaming) return;
+    
+    StreamStats current = getStats();
+    MetricsRecord record;
+    record.streamTimeMs = static_cast<uint32_t>(current.streamTimeMs);
+    record.connectionState = static_cast<uint32_t>(current.connectionState);
+    record.bitrateKbps = static_cast<float>(current.currentBitrate / 1000.0);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        record.encoderKbps = static_cast<float>(currentEncoderBitrate);
+    }
+    record.abrAction = abrAction.exchange(static_cast<uint32_t>(AbrAction::NONE),
+                                          std::memory_order_relaxed);
+    record.rttMs = static_cast<float>(current.rtt);
+    record.bandwidthKbps = static_cast<uint32_t>(std::max<int64_t>(0, current.bandwidth / 1000));
+    record.packetsLost = counterDelta(current.packetsLost, lastMetricsStats.packetsLost);
+    record.packetsRetransmitted = counterDelta(current.packetsRetransmitted,
+                                               lastMetricsStats.packetsRetransmitted);
+    record.packetsDropped = counterDelta(current.packetsDropped, lastMetricsStats.packetsDropped);
+    record.inputFps = static_cast<float>(current.inputFps);
+    record.outputFps = static_cast<float>(current.outputFps);
+    record.framesRefused = counterDelta(current.framesRefused, lastMetricsStats.framesRefused);
+    record.admitRatio = static_cast<float>(current.admitRatio);
+    record.encodeLatencyMs = static_cast<float>(current.encodeLatencyMs);
+#if GSTREAMER_AVAILABLE
+    if (videoQueue) {
+        guint queueBuffers = 0;
+        g_object_get(videoQueue, "current-level-buffers", &queueBuffers, nullptr);
+        record.videoQueueBuffers = queueBuffers;
+    }
+#endif
+    record.pacerQueueDepth = static_cast<uint32_t>(current.pacerQueueDepth);
+    record.pacerDelayMs = static_cast<float>(current.pacerDelayMs);
+    
+    metricsHistory->push(record);
+    lastMetricsStats = current;
+    TRACE_COUNTER("bitrateKbps", static_cast<int64_t>(record.bitrateKbps));
+    TRACE_COUNTER("rttMs", static_cast<int64_t>(record.rttMs));
+}
+
+bool SrtStreamer::Impl::dumpMetricsHistory(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    if (!metricsHistory) {
+        LOGE("Metrics history is off");
+        return false;
+    }
+    return metricsHistory->dump(path, static_cast<uint32_t>(std::max(100, currentConfig.metricsIntervalMs)));
+}
+
+// Budget shares for the components this pipeline will have
+void SrtStreamer::Impl::configureMemoryBudget(const StreamConfig& config) {
+    bool capture = config.source != SourceMode::FILE;
+    bool directSrt = config.transport == TransportMode::SRT_DIRECT ||
+                     config.transport == TransportMode::SRT_BONDED;
+    bool arqUdp = config.transport == TransportMode::ARQ_UDP;
+    bool nativeOutput = directSrt || arqUdp || config.transport == TransportMode::MULTILINK_UDP;
+    
+    std::vector<MemoryComponent> components = {MemoryComponent::VIDEO_QUEUE};
+    if (capture) {
+        components.push_back(MemoryComponent::VIDEO_INGEST);
+        components.push_back(MemoryComponent::AUDIO_INGEST);
+    }
+    if (capture || config.sourceAudio) components.push_back(MemoryComponent::AUDIO_QUEUE);
+    if (!nativeOutput && (config.muxer == MuxerMode::NATIVE || config.enablePacing)) {
+        components.push_back(MemoryComponent::TS_QUEUE);
+    }
+    if (config.enablePacing) components.push_back(MemoryComponent::PACER);
+    if (directSrt || arqUdp) components.push_back(MemoryComponent::RETRANSMIT);
+    
+    // Every ingest layout is 12 bits per pixel, so NV21 at the output size is the frame
+    uint64_t frameBytes = pixelFormatFrameSize(PixelFormat::NV21, config.videoWidth, config.videoHeight);
+    memoryBudget.configure(static_cast<uint64_t>(std::max<int64_t>(0, config.memoryBudgetBytes)),
+                           components, frameBytes,
+                           std::max(PacketPacer::slotBytes(), ArqSender::slotBytes()));
+    budgetDrops = 0;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    videoPool.reset();
+}
+
+// Byte limit for a leaky queue; without a budget it stays bounded by count
+std::string SrtStreamer::Impl::queueByteLimit(MemoryComponent component) const {
+    uint64_t limit = memoryBudget.limit(component);
+    if (limit == 0) return "";
+    return " max-size-bytes=" + std::to_string(std::min<uint64_t>(limit, std::numeric_limits<unsigned>::max()));
+}
+
+// Levels of the GStreamer-side components; the pacer and the transports
+// report theirs where their stats are read
+void SrtStreamer::Impl::sampleMemory() {
+#if GSTREAMER_AVAILABLE
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (videoPool) {
+            memoryBudget.update(MemoryComponent::VIDEO_INGEST, videoPool->inFlight() * videoPool->frameBytes());
+        } else if (videoAppSrc) {
+            memoryBudget.update(MemoryComponent::VIDEO_INGEST,
+                                gst_app_src_get_current_level_bytes(GST_APP_SRC(videoAppSrc)));
+        }
+    }
+    if (audioAppSrc) {
+        memoryBudget.update(MemoryComponent::AUDIO_INGEST,
+                            gst_app_src_get_current_level_bytes(GST_APP_SRC(audioAppSrc)));
+    }
+    guint queueBytes = 0;
+    if (videoQueue) {
+        g_object_get(videoQueue, "current-level-bytes", &queueBytes, nullptr);
+        memoryBudget.update(MemoryComponent::VIDEO_QUEUE, queueBytes);
+    }
+    if (audioQueue) {
+        g_object_get(audioQueue, "current-level-bytes", &queueBytes, nullptr);
+        memoryBudget.update(MemoryComponent::AUDIO_QUEUE, queueBytes);
+    }
+    if (tsAppSrc) {
+        memoryBudget.update(MemoryComponent::TS_QUEUE,
+                            gst_app_src_get_current_level_bytes(GST_APP_SRC(tsAppSrc)));
+    }
+#endif
+}
+
+// Level 0 is the operating point the pipeline was built with (after calibration)
+void SrtStreamer::Impl::configureGovernor() {
+    governorActive = currentConfig.enableGovernor && currentConfig.source == SourceMode::CAPTURE;
+    thermalMonitor = ThermalMonitor(currentConfig.thermalRoot, currentConfig.cpuRoot);
+    OperatingPoint top;
+    top.width = currentConfig.videoWidth;
+    top.height = currentConfig.videoHeight;
+    top.frameRate = currentConfig.frameRate;
+    // Only x264 has presets; other encoders step fps and size only
+    int presetRoom = encoder && encoder->capabilities().presets ? static_cast<int>(currentConfig.preset) : 0;
+    governor.configure(currentConfig.governor, top, governorActive ? presetRoom : 0);
+    ingestSize.store(static_cast<uint32_t>(top.width) << 16 | static_cast<uint32_t>(top.height),
+                     std::memory_order_relaxed);
+#if GSTREAMER_AVAILABLE
+    ingestCapsWidth = top.width;
+    ingestCapsHeight = top.height;
+#endif
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.governorLevel = 0;
+        stats.governorMaxLevel = governor.maxLevel();
+        stats.operatingPoint = top;
+        stats.governorDecisions.clear();
+    }
+    if (!governorActive) return;
+    
+    LOGI("Governor: %d levels below %dx%d @ %d fps, preset %s", governor.maxLevel(),
+         top.width, top.height, top.frameRate, encoderPresetName(currentConfig.preset));
+    ThermalReading reading = thermalMonitor.read();
+    if (!reading.available) {
+        LOGI("Governor: no thermal zones or cpufreq under %s, %s - encode headroom only",
+             currentConfig.thermalRoot.c_str(), currentConfig.cpuRoot.c_str());
+    } else {
+        LOGI("Governor: %zu thermal zones, hottest %.1f C, CPU cap %.2f",
+             reading.zones.size(), reading.hottestC, reading.freqCapRatio);
+    }
+}
+
+EncoderPreset SrtStreamer::Impl::governedPreset(int presetSteps) const {
+    return static_cast<EncoderPreset>(std::max(0, static_cast<int>(currentConfig.preset) - presetSteps));
+}
+
+// Dispatcher thread, every governor interval: sample, decide, apply
+void SrtStreamer::Impl::runGovernor() {
+    if (!streaming) return;
+    ThermalReading reading = thermalMonitor.read();
+    
+    double admitRatio;
+    {
+        std::lock_guard<std::mutex> lock(admissionMutex);
+        admitRatio = admission.getStats().admitRatio;
+    }
+    // The software encoders run without lookahead (x264 tune=zerolatency),
+    // so capture to output is about one frame's encode and must fit the frame
+    // interval. MediaCodec pipelines several frames; it only has to stay
+    // inside the latency budget.
+    bool hardware = encoder && encoder->capabilities().hardware;
+    double budgetMs = hardware ? currentConfig.latencyBudgetMs
+                               : 1000.0 / std::max(1, governor.current().frameRate);
+    double headroom = encodeHeadroom(encodeLatencyNs.load(std::memory_order_relaxed) / 1e6,
+                                     budgetMs, admitRatio);
+    
+    uint64_t streamTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    Health currentHealth;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        currentHealth = health;
+        stats.hottestC = reading.hottestC;
+        stats.thermalHeadroomC = governor.thermalHeadroomC(reading);
+        stats.freqCapRatio = reading.freqCapRatio;
+        stats.encodeHeadroom = headroom;
+    }
+    // A restart stalls the encoder; judge it once data flows again
+    if (currentHealth != Health::HEALTHY) return;
+    
+    // Steady clock: hold times carry over a stop/start
+    OperatingPoint from = governor.current();
+    GovernorDecision decision;
+    if (!governor.evaluate(steadyNs() / 1000000, reading, headroom, decision)) return;
+    decision.timeMs = static_cast<int64_t>(streamTimeMs);
+    
+    const OperatingPoint& to = decision.point;
+    LOGI("Governor: level %d -> %d (%s): %dx%d @ %d fps, preset %s; %.1f C (%.1f C to limit), "
+         "CPU cap %.2f, encode headroom %.2f",
+         decision.fromLevel, decision.toLevel, governorReasonName(decision.reason),
+         to.width, to.height, to.frameRate, encoderPresetName(governedPreset(to.presetSteps)),
+         decision.hottestC, decision.thermalHeadroomC, decision.freqCapRatio, decision.encodeHeadroom);
+    TRACE_INSTANT("governor", decision.toLevel);
+    applyOperatingPoint(from, to);
+    
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.governorLevel = decision.toLevel;
+    stats.operatingPoint = to;
+    stats.governorDecisions.push_back(decision);
+    if (stats.governorDecisions.size() > kGovernorDecisions) {
+        stats.governorDecisions.erase(stats.governorDecisions.begin());
+    }
+}
+
+// Dispatcher thread. Frame rate and size change while playing: videorate
+// and the caps after it renegotiate, and the encoder reopens on new caps
+// (a keyframe with new SPS/PPS). x264 reads its preset only when it opens,
+// so a preset step takes a NULL -> PLAYING cycle like a recovery restart.
+void SrtStreamer::Impl::applyOperatingPoint(const OperatingPoint& from, const OperatingPoint& to) {
+#if GSTREAMER_AVAILABLE
+    if (to.frameRate != from.frameRate && videoRate) {
+        g_object_set(videoRate, "max-rate", to.frameRate, nullptr);
+    }
+    if (to.width != from.width || to.height != from.height) {
+        if (nativeIngest) {
+            // The capture thread sets the appsrc caps with the next frame
+            ingestSize.store(static_cast<uint32_t>(to.width) << 16 | static_cast<uint32_t>(to.height),
+                             std::memory_order_relaxed);
+        } else if (videoCaps) {
+            GstCaps* caps = gst_caps_new_simple("video/x-raw",
+                "width", G_TYPE_INT, to.width,
+                "height", G_TYPE_INT, to.height,
+                nullptr);
+            g_object_set(videoCaps, "caps", caps, nullptr);
+            gst_caps_unref(caps);
+        }
+    }
+    if (to.presetSteps != from.presetSteps && videoEncoder && encoder->capabilities().presets) {
+        pendingPresetSteps.store(to.presetSteps);
+        if (!encoderRestartPending.exchange(true)) {
+            restartEncoder();
+        }
+    }
+#else
+    (void)from;
+    (void)to;
+#endif
+}
+
+// x264 only takes a new speed-preset in NULL. Cycle just the encoder, from an
+// idle probe on the pad feeding it: capture blocks for the restart instead of
+// seeing FLUSHING, and the sink, muxer and pacer keep running (the new
+// stream starts with an IDR, so the mux and pacer need no reset).
+void SrtStreamer::Impl::restartEncoder() {
+#if GSTREAMER_AVAILABLE
+    GstPad* encSink = gst_element_get_static_pad(videoEncoder, "sink");
+    GstPad* upstream = encSink ? gst_pad_get_peer(encSink) : nullptr;
+    if (encSink) gst_object_unref(encSink);
+    if (!upstream) {
+        encoderRestartPending = false;
+        return;
+    }
+    gst_pad_add_probe(upstream, GST_PAD_PROBE_TYPE_IDLE,
+        [](GstPad* pad, GstPadProbeInfo*, gpointer user_data) -> GstPadProbeReturn {
+            auto* self = static_cast<SrtStreamer::Impl*>(user_data);
+            self->encoderRestartPending = false;
+            if (!self->streaming) return GST_PAD_PROBE_REMOVE;
+            TRACE_SCOPE("governorRestart");
+            
+            GstPad* encSink = gst_element_get_static_pad(self->videoEncoder, "sink");
+            gst_pad_unlink(pad, encSink);
+            gst_element_set_locked_state(self->videoEncoder, TRUE);
+            gst_element_set_state(self->videoEncoder, GST_STATE_NULL);
+            self->encoder->setPreset(self->governedPreset(self->pendingPresetSteps.load()));
+            gst_element_set_locked_state(self->videoEncoder, FALSE);
+            bool restarted = gst_element_sync_state_with_parent(self->videoEncoder);
+            // Relinking re-sends the sticky events (caps, segment) to the fresh encoder
+            gst_pad_link(pad, encSink);
+            gst_object_unref(encSink);
+            if (!restarted) {
+                // Reaches handleFault through the bus on the dispatcher thread
+                GST_ELEMENT_ERROR(self->videoEncoder, STREAM, ENCODE,
+                                  ("Restart for a preset change failed"), (nullptr));
+            }
+            return GST_PAD_PROBE_REMOVE;
+        },
+        this, nullptr);
+    gst_object_unref(upstream);
+#endif
+}
+
+// Any thread: the event travels upstream from the encoder's src pad
+bool SrtStreamer::Impl::requestKeyframe() {
+    if (!streaming || !encoder) return false;
+    TRACE_INSTANT("forceKeyframe", 0);
+    return encoder->forceKeyframe();
+}
+
+// Decide at ingest whether the next frame is worth pushing. Frames refused
+// here cost nothing; later they would be copied, converted and encoded
+// before videorate or the leaky queue dropped them.
+bool SrtStreamer::Impl::admitVideoFrame() {
 #if GSTREAMER_AVAILABLE
-    if (!streaming || !videoAppSrc) return;
+    if (!streaming || !videoAppSrc) return false;
+    
+    if (!currentConfig.earlyFrameDrop) {
+        frameAdmitted = true;
+        return true;
+    }
+    
+    AdmissionSignals signals;
+    guint64 appsrcBytes = 0;
+    g_object_get(videoAppSrc, "current-level-bytes", &appsrcBytes, nullptr);
+    signals.appsrcBytes = appsrcBytes;
+    signals.frameBytes = lastVideoFrameBytes;
+    
+    uint64_t encoderIn = encoderInputCount.load(std::memory_order_relaxed);
+    uint64_t encoderOut = outputFrameCount.load(std::memory_order_relaxed);
+    signals.inFlightFrames = encoderIn > encoderOut ? encoderIn - encoderOut : 0;
+    
+    if (videoQueue) {
+        guint queueBuffers = 0;
+        guint queueMaxBuffers = 0;
+        g_object_get(videoQueue,
+            "current-level-buffers", &queueBuffers,
+            "max-size-buffers", &queueMaxBuffers,
+            nullptr);
+        signals.queueBuffers = queueBuffers;
+        signals.queueMaxBuffers = queueMaxBuffers;
+    }
+    signals.encodeLatencyMs = encodeLatencyNs.load(std::memory_order_relaxed) / 1e6;
+    
+    std::lock_guard<std::mutex> lock(admissionMutex);
+    frameAdmitted = admission.admit(signals);
+    if (!frameAdmitted) TRACE_INSTANT("frameRefused", 0);
+    return frameAdmitted;
+#else
+    return streaming;
+#endif
+}
+
+// Per-frame CPU of convert/scale, from whichever path does it
+void SrtStreamer::Impl::recordIngestCost(int64_t cpuNs) {
+    int64_t avg = ingestCpuNs.load(std::memory_order_relaxed);
+    avg = avg == 0 ? cpuNs : avg + (cpuNs - avg) / 16;
+    ingestCpuNs.store(avg, std::memory_order_relaxed);
+}
+
+// Fast path: convert (and scale) the NV21 camera frame straight into the
+// buffer the encoder reads, in the encoder's format and size
+bool SrtStreamer::Impl::pushConvertedVideoFrame(const uint8_t* data, size_t size,
+                                                 int width, int height,
+                                                 const std::vector<RoiRegion>* frameRegions) {
+#if GSTREAMER_AVAILABLE
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1) ||
+        size < pixelFormatFrameSize(PixelFormat::NV21, width, height)) {
+        LOGE("Unexpected video frame %dx%d (%zu bytes)", width, height, size);
+        return false;
+    }
+    
+    uint32_t packedSize = ingestSize.load(std::memory_order_relaxed);
+    int outWidth = static_cast<int>(packedSize >> 16);
+    int outHeight = static_cast<int>(packedSize & 0xffff);
+    if (outWidth != ingestCapsWidth || outHeight != ingestCapsHeight) {
+        // Governor resize: the caps event goes downstream ahead of the first frame at the new size
+        GstCaps* caps = gst_caps_new_simple("video/x-raw",
+            "format", G_TYPE_STRING, pixelFormatName(ingestFormat),
+            "width", G_TYPE_INT, outWidth,
+            "height", G_TYPE_INT, outHeight,
+            "framerate", GST_TYPE_FRACTION, currentConfig.frameRate, 1,
+            nullptr);
+        g_object_set(videoAppSrc, "caps", caps, nullptr);
+        gst_caps_unref(caps);
+        ingestCapsWidth = outWidth;
+        ingestCapsHeight = outHeight;
+    }
+    if (width != frameConverter.sourceWidth() || height != frameConverter.sourceHeight() ||
+        outWidth != frameConverter.targetWidth() || outHeight != frameConverter.targetHeight()) {
+        LOGI("Video ingest: %dx%d NV21 -> %dx%d %s", width, height, outWidth, outHeight,
+             pixelFormatName(ingestFormat));
+    }
+    frameConverter.configure(width, height, outWidth, outHeight, ingestFormat);
+    
+    size_t outSize = pixelFormatFrameSize(ingestFormat, outWidth, outHeight);
+    GstBuffer* buffer = allocateVideoBuffer(outSize);
+    if (!buffer) return false;
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+        gst_buffer_unref(buffer);
+        return false;
+    }
+    int64_t cpuStart = threadCpuNs();
+    frameConverter.convert(data, map.data);
+    recordIngestCost(threadCpuNs() - cpuStart);
+    gst_buffer_unmap(buffer, &map);
+    lastVideoFrameBytes = outSize;
+    attachFrameRois(buffer, outWidth, outHeight, frameRegions);
+    
+    GST_BUFFER_PTS(buffer) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DTS(buffer) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DURATION(buffer) = GST_SECOND / currentConfig.frameRate;
+    
+    GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(videoAppSrc), buffer);
+    if (ret != GST_FLOW_OK) {
+        LOGE("Failed to push video frame: %d", ret);
+        return false;
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)width;
+    (void)height;
+    (void)frameRegions;
+    return false;
+#endif
+}
+
+bool SrtStreamer::Impl::pushVideoFrame(const uint8_t* data, size_t size,
+                                        int width, int height, int64_t timestampNs,
+                                        const std::vector<RoiRegion>* frameRegions) {
+#if GSTREAMER_AVAILABLE
+    if (!streaming || !videoAppSrc) return false;
+    TRACE_SCOPE("pushVideoFrame");
+    
+    threadPlacer.applyOnce(ThreadRole::CAPTURE);
+    
+    // The JNI layer admits before touching the Java array; direct callers don't
+    bool admitted = frameAdmitted || admitVideoFrame();
+    frameAdmitted = false;
+    if (!admitted) return false;
+    
+    if (nativeIngest) {
+        return pushConvertedVideoFrame(data, size, width, height, frameRegions);
+    }
+    lastVideoFrameBytes = size;
     
     // Set caps dynamically on first frame or if resolution changes
     if (!videoCapsSet || width != lastVideoWidth || height != lastVideoHeight) {
@@ -956,13 +2523,12 @@ void SrtStreamer::Impl::pushVideoFrame(const uint8_t* data, size_t size,
         videoCapsSet = true;
     }
     
-    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
-    if (!buffer) {
-        LOGE("Failed to allocate video buffer");
-        return;
-    }
+    GstBuffer* buffer = allocateVideoBuffer(size);
+    if (!buffer) return false;
     
     gst_buffer_fill(buffer, 0, data, size);
+    // videoscale scales the regions along with the frame
+    attachFrameRois(buffer, width, height, frameRegions);
     // Let GStreamer assign timestamps via do-timestamp=true on appsrc
     // This ensures audio and video use the same pipeline clock
     GST_BUFFER_PTS(buffer) = GST_CLOCK_TIME_NONE;
@@ -972,17 +2538,81 @@ void SrtStreamer::Impl::pushVideoFrame(const uint8_t* data, size_t size,
     GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(videoAppSrc), buffer);
     if (ret != GST_FLOW_OK) {
         LOGE("Failed to push video frame: %d", ret);
+        return false;
     }
     
     // Note: Don't count raw frame bytes here - they're uncompressed.
     // Actual bytes sent are tracked via sink stats (SRT) or estimated from bitrate.
+    return true;
+#else
+    return streaming;
 #endif
 }
 
+void SrtStreamer::Impl::setRegionsOfInterest(const std::vector<RoiRegion>& regions) {
+    std::lock_guard<std::mutex> lock(roiMutex);
+    roiRegions = regions;
+    hasRoiRegions.store(!roiRegions.empty(), std::memory_order_release);
+    LOGI("Regions of interest: %zu", roiRegions.size());
+}
+
+#if GSTREAMER_AVAILABLE
+// Regions passed with the frame replace the persistent ones for that frame
+void SrtStreamer::Impl::attachFrameRois(GstBuffer* buffer, int width, int height,
+                                        const std::vector<RoiRegion>* frameRegions) {
+    if (frameRegions) {
+        attachRoiMetas(buffer, width, height, *frameRegions);
+    } else if (hasRoiRegions.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(roiMutex);
+        attachRoiMetas(buffer, width, height, roiRegions);
+    }
+}
+
+// Raw frame buffer for appsrc. With a budget it comes from a pool holding
+// the ingest share; a frame that finds the pool empty is dropped here
+// rather than queued behind the encoder.
+GstBuffer* SrtStreamer::Impl::allocateVideoBuffer(size_t size) {
+    uint64_t limit = memoryBudget.limit(MemoryComponent::VIDEO_INGEST);
+    if (limit == 0) {
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+        if (!buffer) LOGE("Failed to allocate video buffer");
+        return buffer;
+    }
+    if (!videoPool || videoPool->frameBytes() != size) {
+        size_t frames = std::max<size_t>(2, limit / size);
+        LOGI("Video ingest pool: %zu frames of %zu bytes", frames, size);
+        auto pool = std::make_unique<FramePool>(size, frames);
+        std::lock_guard<std::mutex> lock(poolMutex);
+        videoPool = std::move(pool);
+    }
+    GstBuffer* buffer = videoPool->acquire();
+    if (!buffer) {
+        budgetDrops.fetch_add(1, std::memory_order_relaxed);
+        TRACE_INSTANT("budgetDrop", 0);
+        return nullptr;
+    }
+    memoryBudget.update(MemoryComponent::VIDEO_INGEST, videoPool->inFlight() * size);
+    return buffer;
+}
+#endif
+
 void SrtStreamer::Impl::pushAudioSamples(const uint8_t* data, size_t size,
                                           int sampleRate, int channels, int64_t timestampNs) {
 #if GSTREAMER_AVAILABLE
     if (!streaming || !audioAppSrc) return;
+    TRACE_SCOPE("pushAudioSamples");
+    
+    threadPlacer.applyOnce(ThreadRole::AUDIO);
+    
+    uint64_t audioLimit = memoryBudget.limit(MemoryComponent::AUDIO_INGEST);
+    if (audioLimit > 0) {
+        uint64_t queued = gst_app_src_get_current_level_bytes(GST_APP_SRC(audioAppSrc));
+        memoryBudget.update(MemoryComponent::AUDIO_INGEST, queued);
+        if (queued + size > audioLimit) {
+            budgetDrops.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
     
     GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
     if (!buffer) {
@@ -1010,10 +2640,805 @@ void SrtStreamer::Impl::pushAudioSamples(const uint8_t* data, size_t size,
 #endif
 }
 
+// TS datagram leaving the muxer: through the pacer if enabled, else straight out
+void SrtStreamer::Impl::sendTsDatagram(const uint8_t* data, size_t size) {
+    if (pacer) {
+        pacer->enqueue(data, size);
+    } else {
+        pushTsDatagram(data, size);
+    }
+}
+
+// Pacing rate for a video bitrate in kbps (audio and TS overhead ride on the multiplier)
+int64_t SrtStreamer::Impl::pacingRateBps(int videoKbps) const {
+    int64_t totalBps = static_cast<int64_t>(videoKbps) * 1000 + currentConfig.audioBitrate;
+    return static_cast<int64_t>(totalBps * currentConfig.pacingMultiplier);
+}
+
+void SrtStreamer::Impl::pushTsDatagram(const uint8_t* data, size_t size) {
+#if GSTREAMER_AVAILABLE
+    TRACE_SCOPE_VALUE("sendDatagram", static_cast<int64_t>(size));
+    if (srtTransport) {
+        // Refusals are counted by the transport (localDrops)
+        if (streaming && srtTransport->send(data, size)) markDataFlow();
+        return;
+    }
+    if (multiLink) {
+        if (streaming && multiLink->send(data, size)) markDataFlow();
+        return;
+    }
+    if (arqSender) {
+        if (streaming && arqSender->send(data, size)) markDataFlow();
+        return;
+    }
+    if (!streaming || !tsAppSrc) return;
+    
+    uint64_t tsLimit = memoryBudget.limit(MemoryComponent::TS_QUEUE);
+    if (tsLimit > 0) {
+        uint64_t queued = gst_app_src_get_current_level_bytes(GST_APP_SRC(tsAppSrc));
+        if (queued + size > tsLimit) {
+            budgetDrops.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    
+    GstBuffer* buffer = nullptr;
+    if (tsPool && size <= TsMuxer::kDatagramSize) {
+        if (gst_buffer_pool_acquire_buffer(tsPool, &buffer, nullptr) != GST_FLOW_OK) buffer = nullptr;
+    }
+    if (buffer) {
+        gst_buffer_fill(buffer, 0, data, size);
+        gst_buffer_set_size(buffer, size);    // The pool restores the full size on release
+    } else {
+        buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+        if (!buffer) {
+            LOGE("Failed to allocate TS buffer");
+            return;
+        }
+        gst_buffer_fill(buffer, 0, data, size);
+    }
+    
+    GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(tsAppSrc), buffer);
+    if (ret != GST_FLOW_OK) {
+        LOGE("Failed to push TS datagram: %d", ret);
+    }
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+#if GSTREAMER_AVAILABLE
+namespace {
+struct PlacementProbeData {
+    ThreadPlacer* placer;
+    ThreadRole role;
+};
+}
+
+// Apply thread placement to whichever streaming thread carries data through the pad
+void SrtStreamer::Impl::addPlacementProbe(GstElement* element, const char* padName,
+                                          ThreadRole role) {
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    if (!pad) return;
+    
+    // Caps events arrive before the first buffer, so x264 workers spawned
+    // on caps already inherit the encode thread's placement
+    gst_pad_add_probe(pad,
+        static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+        [](GstPad*, GstPadProbeInfo*, gpointer userData) -> GstPadProbeReturn {
+            auto* data = static_cast<PlacementProbeData*>(userData);
+            data->placer->applyOnce(data->role);
+            return GST_PAD_PROBE_OK;
+        },
+        new PlacementProbeData{&threadPlacer, role},
+        [](gpointer userData) { delete static_cast<PlacementProbeData*>(userData); });
+    gst_object_unref(pad);
+}
+
+// Trace points on pads of elements the app doesn't otherwise hook
+void SrtStreamer::Impl::addTraceProbe(GstElement* element, const char* padName, TraceProbe kind) {
+#if ORBISTREAM_TRACING
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    if (!pad) return;
+    
+    GstPadProbeCallback callback;
+    if (kind == TraceProbe::FRAME_END) {
+        callback = [](GstPad*, GstPadProbeInfo* info, gpointer) -> GstPadProbeReturn {
+            GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+            if (buf) TRACE_ASYNC_END("frame", GST_BUFFER_PTS(buf));
+            return GST_PAD_PROBE_OK;
+        };
+    } else {
+        callback = [](GstPad*, GstPadProbeInfo* info, gpointer) -> GstPadProbeReturn {
+            GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+            if (buf) TRACE_INSTANT("sinkBuffer", static_cast<int64_t>(gst_buffer_get_size(buf)));
+            return GST_PAD_PROBE_OK;
+        };
+    }
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, callback, nullptr, nullptr);
+    gst_object_unref(pad);
+#endif
+}
+
+gboolean SrtStreamer::Impl::onMetricsTick(gpointer userData) {
+    static_cast<SrtStreamer::Impl*>(userData)->sampleMetrics();
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean SrtStreamer::Impl::onGovernorTick(gpointer userData) {
+    static_cast<SrtStreamer::Impl*>(userData)->runGovernor();
+    return G_SOURCE_CONTINUE;
+}
+
+void SrtStreamer::Impl::addFlowProbe(GstElement* element, const char* padName) {
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    if (!pad) return;
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+        [](GstPad*, GstPadProbeInfo*, gpointer userData) -> GstPadProbeReturn {
+            static_cast<SrtStreamer::Impl*>(userData)->markDataFlow();
+            return GST_PAD_PROBE_OK;
+        }, this, nullptr);
+    gst_object_unref(pad);
+}
+
+namespace {
+struct ByteProbeData {
+    ByteAccounting* accounting;
+    ByteLayer layer;
+};
+
+void countBytes(const ByteProbeData* data, uint64_t bytes, uint64_t buffers) {
+    switch (data->layer) {
+        case ByteLayer::TS:
+            data->accounting->add(ByteLayer::TS, bytes, bytes / ByteAccounting::kTsPacketSize);
+            break;
+        case ByteLayer::TRANSPORT:
+            // udpsink sends each buffer as one datagram
+            data->accounting->addDatagrams(bytes, buffers);
+            break;
+        default:
+            data->accounting->add(data->layer, bytes, buffers);
+            break;
+    }
+}
+}
+
+// Count what passes a pad into one accounting layer; mpegtsmux and udpsink
+// may pass buffer lists
+void SrtStreamer::Impl::addByteProbe(GstElement* element, const char* padName, ByteLayer layer) {
+    if (!element) return;
+    GstPad* pad = gst_element_get_static_pad(element, padName);
+    if (!pad) return;
+    gst_pad_add_probe(pad,
+        static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+        [](GstPad*, GstPadProbeInfo* info, gpointer userData) -> GstPadProbeReturn {
+            auto* data = static_cast<ByteProbeData*>(userData);
+            if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+                GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+                if (list) countBytes(data, gst_buffer_list_calculate_size(list), gst_buffer_list_length(list));
+            } else if (GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info)) {
+                countBytes(data, gst_buffer_get_size(buf), 1);
+            }
+            return GST_PAD_PROBE_OK;
+        },
+        new ByteProbeData{&byteAccounting, layer},
+        [](gpointer userData) { delete static_cast<ByteProbeData*>(userData); });
+    gst_object_unref(pad);
+}
+
+// FILE source: the parsed video stands in for encoder output in the
+// VIDEO_ES and frame counters, so bitrate and fps stats work unchanged
+void SrtStreamer::Impl::addFileSourceProbe() {
+    GstElement* parser = gst_bin_get_by_name(GST_BIN(pipeline), "video_parse");
+    if (!parser) return;
+    GstPad* pad = gst_element_get_static_pad(parser, "src");
+    gst_object_unref(parser);
+    if (!pad) return;
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+        [](GstPad*, GstPadProbeInfo* info, gpointer userData) -> GstPadProbeReturn {
+            auto* self = static_cast<SrtStreamer::Impl*>(userData);
+            GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+            if (!buf) return GST_PAD_PROBE_OK;
+            gsize size = gst_buffer_get_size(buf);
+            self->byteAccounting.add(ByteLayer::VIDEO_ES, size);
+            self->frameSizes.add(size);
+            self->inputFrameCount.fetch_add(1, std::memory_order_relaxed);
+            self->outputFrameCount.fetch_add(1, std::memory_order_relaxed);
+            return GST_PAD_PROBE_OK;
+        }, this, nullptr);
+    gst_object_unref(pad);
+    LOGI("Added byte/frame counting probe on file source");
+}
+
+// Segment seeks make the demuxer post SEGMENT_DONE instead of EOS at the end
+bool SrtStreamer::Impl::seekFileSource(bool flush) {
+    int flags = GST_SEEK_FLAG_SEGMENT | (flush ? GST_SEEK_FLAG_FLUSH : 0);
+    return gst_element_seek(pipeline, 1.0, GST_FORMAT_TIME, static_cast<GstSeekFlags>(flags),
+                            GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_NONE, -1);
+}
+
+// Before each NULL -> PLAYING: a looping file source starts with a segment
+// seek, which needs the demuxer prerolled
+void SrtStreamer::Impl::prepareFileSource() {
+    if (currentConfig.source != SourceMode::FILE || !currentConfig.loopSource) return;
+    gst_element_set_state(pipeline, GST_STATE_PAUSED);
+    gst_element_get_state(pipeline, nullptr, nullptr, 5 * GST_SECOND);
+    if (!seekFileSource(true)) {
+        LOGE("Source segment seek failed; %s will play once", currentConfig.sourcePath.c_str());
+    }
+}
+
+// Dispatcher thread. Messages arrive as they are posted, so a fault is
+// acted on without waiting for the next stats poll.
+gboolean SrtStreamer::Impl::onBusMessage(GstBus*, GstMessage* message, gpointer userData) {
+    auto* self = static_cast<SrtStreamer::Impl*>(userData);
+    GstObject* src = GST_MESSAGE_SRC(message);
+    const char* srcName = src ? GST_OBJECT_NAME(src) : "pipeline";
+    
+    switch (GST_MESSAGE_TYPE(message)) {
+        case GST_MESSAGE_ERROR: {
+            GError* error = nullptr;
+            gchar* debug = nullptr;
+            gst_message_parse_error(message, &error, &debug);
+            PipelineFault fault = self->classifyError(message, error, debug);
+            std::string reason = std::string(srcName) + ": " + (error ? error->message : "error");
+            LOGE("Bus error [%s] %s", faultName(fault), reason.c_str());
+            if (debug) LOGD("Debug info: %s", debug);
+            g_clear_error(&error);
+            g_free(debug);
+            self->handleFault(fault, reason);
+            break;
+        }
+        case GST_MESSAGE_SEGMENT_DONE:
+            // Looping file source: queue the next pass without flushing, so
+            // running time (and the output timestamps) carry on
+            if (self->streaming && !self->seekFileSource(false)) {
+                LOGE("Source loop seek failed");
+            }
+            break;
+        case GST_MESSAGE_EOS:
+            if (self->currentConfig.source == SourceMode::FILE && !self->currentConfig.loopSource) {
+                LOGI("Source file finished");
+                // End the session here, reporting the EOS as the stop reason. An
+                // app stop() already in progress waits for this callback, so
+                // leave the teardown (and its state change) to it.
+                std::unique_lock<std::mutex> lock(self->stopMutex, std::try_to_lock);
+                if (lock.owns_lock()) {
+                    self->stopLocked("Source file finished");
+                    return G_SOURCE_REMOVE;     // stop() removed this watch
+                }
+                break;
+            }
+            // stop() goes straight to NULL, so EOS while streaming means a source gave up
+            self->handleFault(PipelineFault::UNEXPECTED_EOS, std::string(srcName) + ": end of stream");
+            break;
+        case GST_MESSAGE_WARNING: {
+            GError* warning = nullptr;
+            gchar* debug = nullptr;
+            gst_message_parse_warning(message, &warning, &debug);
+            LOGI("Bus warning from %s: %s", srcName, warning ? warning->message : "?");
+            g_clear_error(&warning);
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_CLOCK_LOST:
+            self->handleFault(PipelineFault::CLOCK_LOST, "pipeline clock lost");
+            break;
+        case GST_MESSAGE_LATENCY:
+            gst_bin_recalculate_latency(GST_BIN(self->pipeline));
+            break;
+        default:
+            break;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+PipelineFault SrtStreamer::Impl::classifyError(GstMessage* message, const GError* error,
+                                               const char* debug) const {
+    GstObject* src = GST_MESSAGE_SRC(message);
+    auto from = [src](GstElement* element) {
+        return element && src && (src == GST_OBJECT(element) ||
+                                  gst_object_has_as_ancestor(src, GST_OBJECT(element)));
+    };
+    if (from(srtSink) || from(udpSink)) {
+        return PipelineFault::SINK_DISCONNECTED;
+    }
+    // Sources report not-negotiated as a generic flow error; the reason is in the debug text
+    if (error && (g_error_matches(error, GST_STREAM_ERROR, GST_STREAM_ERROR_FORMAT) ||
+                  g_error_matches(error, GST_CORE_ERROR, GST_CORE_ERROR_NEGOTIATION))) {
+        return PipelineFault::CAPS_NEGOTIATION;
+    }
+    if (debug && strstr(debug, "not-negotiated")) {
+        return PipelineFault::CAPS_NEGOTIATION;
+    }
+    if (from(videoEncoder) || (error && g_error_matches(error, GST_STREAM_ERROR, GST_STREAM_ERROR_ENCODE))) {
+        return PipelineFault::ENCODER_ERROR;
+    }
+    if (error && (g_error_matches(error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_WRITE) ||
+                  g_error_matches(error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_OPEN_WRITE) ||
+                  g_error_matches(error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_OPEN_READ_WRITE))) {
+        return PipelineFault::SINK_DISCONNECTED;
+    }
+    return PipelineFault::PIPELINE_ERROR;
+}
+
+// Dispatcher thread
+void SrtStreamer::Impl::handleFault(PipelineFault fault, const std::string& reason) {
+    if (!streaming) return;
+    Health previous = beginFault(fault, reason);
+    if (previous == Health::FAILED) return;
+    if (previous == Health::HEALTHY) {
+        recoveryAttempt = 0;
+    } else if (recoverySourceId) {
+        return;     // Follow-up error of the same fault; a restart is already pending
+    }
+    
+    if (!currentConfig.autoRecover) {
+        failRecovery(reason);
+        return;
+    }
+    if (fault == PipelineFault::CLOCK_LOST) {
+        // Selecting a new clock only needs a PAUSED -> PLAYING cycle
+        awaitingFlow = true;
+        gst_element_set_state(pipeline, GST_STATE_PAUSED);
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        return;
+    }
+    scheduleRecovery();
+}
+
+// Dispatcher thread. Backoff doubles per attempt, capped at 2 s.
+void SrtStreamer::Impl::scheduleRecovery() {
+    if (recoveryAttempt >= currentConfig.recoveryAttempts) {
+        std::string reason;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            reason = faultName(stats.lastFault);
+        }
+        failRecovery(reason + ", " + std::to_string(recoveryAttempt) + " restarts failed");
+        return;
+    }
+    int delayMs = std::min(2000, std::max(0, currentConfig.recoveryBackoffMs) << std::min(recoveryAttempt, 5));
+    recoverySourceId = dispatcher->addTimeout(static_cast<unsigned>(delayMs), &Impl::onRecoveryTimer, this);
+}
+
+gboolean SrtStreamer::Impl::onRecoveryTimer(gpointer userData) {
+    auto* self = static_cast<SrtStreamer::Impl*>(userData);
+    self->recoverySourceId = 0;
+    self->restartPipeline();
+    return G_SOURCE_REMOVE;
+}
+
+// Dispatcher thread. NULL -> PLAYING reconnects network sinks and resets the
+// encoders; appsrc timestamps restart with the new base time. Capture keeps
+// pushing meanwhile and is refused with FLUSHING.
+void SrtStreamer::Impl::restartPipeline() {
+    if (!streaming) return;
+    TRACE_SCOPE("restartPipeline");
+    recoveryAttempt++;
+    LOGI("Recovery attempt %d/%d: restarting pipeline", recoveryAttempt, currentConfig.recoveryAttempts);
+    
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    if (tsMuxer) {
+        tsMuxer->reset();   // Streaming threads are stopped; PSI goes out first again
+    }
+    awaitingFlow = true;
+    prepareFileSource();
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        LOGE("Restart failed to reach PLAYING");
+        scheduleRecovery();
+    }
+    // Otherwise: data out completes the recovery, a new error schedules the next attempt
+}
+
+// mpegtsmux output when pacing is enabled (streaming thread)
+GstFlowReturn SrtStreamer::Impl::onTsSample(GstAppSink* sink, gpointer userData) {
+    auto* self = static_cast<SrtStreamer::Impl*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    TRACE_SCOPE("tsSample");
+    
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        // alignment=7 normally yields 1316-byte buffers; split anything larger
+        for (size_t offset = 0; offset < map.size; offset += TsMuxer::kDatagramSize) {
+            size_t chunk = std::min(TsMuxer::kDatagramSize, map.size - offset);
+            self->sendTsDatagram(map.data + offset, chunk);
+        }
+        gst_buffer_unmap(buf, &map);
+    }
+    
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+// Encoded video access unit from the NATIVE muxer path (streaming thread)
+GstFlowReturn SrtStreamer::Impl::onVideoEsSample(GstAppSink* sink, gpointer userData) {
+    auto* self = static_cast<SrtStreamer::Impl*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    
+    TRACE_SCOPE("muxVideo");
+    
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && self->tsMuxer && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        GstClockTime pts = GST_BUFFER_PTS(buf);
+        GstClockTime dts = GST_BUFFER_DTS(buf);
+        bool keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+        self->tsMuxer->writeVideo(map.data, map.size,
+            GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts) : 0,
+            GST_CLOCK_TIME_IS_VALID(dts) ? static_cast<int64_t>(dts) : -1,
+            keyframe);
+        gst_buffer_unmap(buf, &map);
+    }
+    
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+// Encoded audio frame from the NATIVE muxer path (streaming thread)
+GstFlowReturn SrtStreamer::Impl::onAudioEsSample(GstAppSink* sink, gpointer userData) {
+    auto* self = static_cast<SrtStreamer::Impl*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    
+    TRACE_SCOPE("muxAudio");
+    
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && self->tsMuxer && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        GstClockTime pts = GST_BUFFER_PTS(buf);
+        self->tsMuxer->writeAudio(map.data, map.size,
+            GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts) : 0);
+        gst_buffer_unmap(buf, &map);
+    }
+    
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Encoder calibration
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Calibrated operating point, shared by all streamer instances (it is per device)
+std::mutex g_calibrationMutex;
+CalibrationResult g_calibration;
+
+std::string calibrationCacheKey(const CalibrationOptions& options) {
+    char fingerprint[PROP_VALUE_MAX] = {0};
+    __system_property_get("ro.build.fingerprint", fingerprint);
+    std::stringstream key;
+    key << (fingerprint[0] ? fingerprint : "unknown") << "|" << options.buildId << "|";
+#if GSTREAMER_AVAILABLE
+    gchar* gstVersion = gst_version_string();
+    key << gstVersion << "|";
+    g_free(gstVersion);
+#endif
+    key << options.maxWidth << "x" << options.maxHeight << "@" << options.targetFps
+        << "|" << options.videoBitrate << "|" << static_cast<int>(options.slowestPreset);
+    return key.str();
+}
+
+bool loadCalibrationCache(const std::string& path, const std::string& key,
+                          CalibrationResult& result) {
+    std::ifstream in(path);
+    if (!in) return false;
+    
+    std::string line;
+    bool keyMatches = false;
+    CalibrationResult cached;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string name = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        if (name == "key") keyMatches = value == key;
+        else if (name == "preset") cached.preset = static_cast<EncoderPreset>(atoi(value.c_str()));
+        else if (name == "width") cached.width = atoi(value.c_str());
+        else if (name == "height") cached.height = atoi(value.c_str());
+        else if (name == "threads") cached.encoderThreads = atoi(value.c_str());
+        else if (name == "fps") cached.measuredFps = atof(value.c_str());
+    }
+    if (!keyMatches || cached.width <= 0 || cached.height <= 0) return false;
+    
+    cached.valid = true;
+    cached.fromCache = true;
+    result = cached;
+    return true;
+}
+
+void saveCalibrationCache(const std::string& path, const std::string& key,
+                          const CalibrationResult& result) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        LOGE("Cannot write calibration cache %s", path.c_str());
+        return;
+    }
+    out << "key=" << key << "\n"
+        << "preset=" << static_cast<int>(result.preset) << "\n"
+        << "width=" << result.width << "\n"
+        << "height=" << result.height << "\n"
+        << "threads=" << result.encoderThreads << "\n"
+        << "fps=" << result.measuredFps << "\n";
+}
+
+// Candidate resolutions from the maximum down, keeping its aspect ratio
+std::vector<std::pair<int, int>> calibrationResolutions(int maxWidth, int maxHeight) {
+    static const int kHeights[] = {1080, 720, 540, 360};
+    std::vector<std::pair<int, int>> result;
+    result.emplace_back(maxWidth & ~1, maxHeight & ~1);
+    for (int height : kHeights) {
+        if (height >= maxHeight) continue;
+        int width = static_cast<int>(static_cast<int64_t>(maxWidth) * height / maxHeight);
+        result.emplace_back(width & ~1, height);
+    }
+    return result;
+}
+
+} // namespace
+
+// Encode speed in fps for one candidate, measured between the first and last
+// encoded frame so pipeline startup and encoder init don't count.
+double SrtStreamer::Impl::runCalibrationTrial(EncoderPreset preset, int width, int height,
+                                              int threads, const CalibrationOptions& options,
+                                              int64_t timeoutMs) {
+#if GSTREAMER_AVAILABLE
+    // Same convert/scale/encode chain as the streaming pipeline; the moving
+    // test pattern keeps x264 from skipping every macroblock
+    EncoderSettings settings;
+    settings.bitrateKbps = options.videoBitrate / 1000;
+    settings.frameRate = options.targetFps;
+    settings.keyframeFrames = options.targetFps * 2;
+    settings.threads = threads;
+    settings.preset = preset;
+    std::unique_ptr<EncoderBackend> x264 = EncoderBackend::create(EncoderKind::X264);
+    std::stringstream ss;
+    ss << "videotestsrc num-buffers=" << options.trialFrames
+       << " pattern=smpte horizontal-speed=4 is-live=false ! "
+       << "video/x-raw,format=NV21,width=" << width << ",height=" << height
+       << ",framerate=" << options.targetFps << "/1 ! "
+       << "videoconvert ! videoscale ! "
+       << x264->build(settings, "calib_enc") << " ! "
+       << "fakesink name=calib_sink sync=false";
+    
+    GError* error = nullptr;
+    GstElement* trial = gst_parse_launch(ss.str().c_str(), &error);
+    if (error) {
+        LOGE("Calibration pipeline failed: %s", error->message);
+        g_error_free(error);
+        if (trial) gst_object_unref(trial);
+        return 0.0;
+    }
+    
+    struct TrialTiming {
+        int frames = 0;
+        std::chrono::steady_clock::time_point first;
+        std::chrono::steady_clock::time_point last;
+    } timing;
+    
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(trial), "calib_sink");
+    if (sink) {
+        GstPad* pad = gst_element_get_static_pad(sink, "sink");
+        if (pad) {
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                [](GstPad*, GstPadProbeInfo*, gpointer userData) -> GstPadProbeReturn {
+                    auto* t = static_cast<TrialTiming*>(userData);
+                    auto now = std::chrono::steady_clock::now();
+                    if (t->frames == 0) t->first = now;
+                    t->last = now;
+                    t->frames++;
+                    return GST_PAD_PROBE_OK;
+                },
+                &timing, nullptr);
+            gst_object_unref(pad);
+        }
+        gst_object_unref(sink);
+    }
+    
+    gst_element_set_state(trial, GST_STATE_PLAYING);
+    
+    // A candidate that can't finish in time is too slow anyway
+    GstBus* bus = gst_element_get_bus(trial);
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus,
+        static_cast<GstClockTime>(std::max<int64_t>(timeoutMs, 1)) * GST_MSECOND,
+        static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    bool failed = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR;
+    if (msg) gst_message_unref(msg);
+    gst_object_unref(bus);
+    
+    // Setting NULL joins the streaming thread, so timing is stable afterwards
+    gst_element_set_state(trial, GST_STATE_NULL);
+    gst_object_unref(trial);
+    
+    if (failed || timing.frames < 2) return 0.0;
+    double seconds = std::chrono::duration<double>(timing.last - timing.first).count();
+    return seconds > 0.0 ? (timing.frames - 1) / seconds : 0.0;
+#else
+    (void)preset;
+    (void)width;
+    (void)height;
+    (void)threads;
+    (void)options;
+    (void)timeoutMs;
+    return 0.0;
+#endif
+}
+
+CalibrationResult SrtStreamer::Impl::calibrate(const CalibrationOptions& options) {
+    CalibrationResult result;
+    
+    std::lock_guard<std::mutex> run(g_calibrationRunMutex);
+    if (g_activeStreams.load() > 0) {
+        LOGE("Cannot calibrate while a session is streaming");
+        return result;
+    }
+    
+    std::string key = calibrationCacheKey(options);
+    if (!options.force && !options.cachePath.empty() &&
+        loadCalibrationCache(options.cachePath, key, result)) {
+        LOGI("Calibration from cache: %s %dx%d threads=%d (%.1f fps)",
+             encoderPresetName(result.preset), result.width, result.height,
+             result.encoderThreads, result.measuredFps);
+        std::lock_guard<std::mutex> lock(g_calibrationMutex);
+        g_calibration = result;
+        return result;
+    }
+    
+#if GSTREAMER_AVAILABLE
+    SrtStreamer::initGStreamer();
+    
+    auto startTime = std::chrono::steady_clock::now();
+    auto elapsedMs = [&startTime]() -> int64_t {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+    };
+    
+    const double requiredFps = options.targetFps * options.headroom;
+    // A passing trial finishes in trialFrames / requiredFps; allow startup on top
+    const int64_t trialTimeoutMs =
+        static_cast<int64_t>(options.trialFrames * 1000.0 / requiredFps) + 1000;
+    
+    CpuTopology topology = CpuTopology::read();
+    int onlineCpus = static_cast<int>(topology.bigCpus.size() + topology.littleCpus.size());
+    std::vector<int> threadCandidates = {topology.recommendedEncoderThreads()};
+    if (onlineCpus > threadCandidates[0]) {
+        threadCandidates.push_back(onlineCpus);
+    }
+    
+    LOGI("=== ENCODER CALIBRATION: %dx%d max, %d fps x%.2f headroom ===",
+         options.maxWidth, options.maxHeight, options.targetFps, options.headroom);
+    
+    for (const auto& resolution : calibrationResolutions(options.maxWidth, options.maxHeight)) {
+        int width = resolution.first;
+        int height = resolution.second;
+        
+        // Fastest preset first: if it can't keep up, the resolution is too high.
+        // Only try more threads when the recommended count falls short.
+        int bestThreads = 0;
+        double bestFps = 0.0;
+        for (int threads : threadCandidates) {
+            int64_t remaining = options.maxDurationMs - elapsedMs();
+            if (remaining <= 0) break;
+            double fps = runCalibrationTrial(EncoderPreset::ULTRAFAST, width, height, threads,
+                                             options, std::min(trialTimeoutMs, remaining));
+            result.trials++;
+            LOGI("Calibration %dx%d ultrafast threads=%d: %.1f fps", width, height, threads, fps);
+            if (fps > bestFps) {
+                bestFps = fps;
+                bestThreads = threads;
+            }
+            if (bestFps >= requiredFps) break;
+        }
+        if (bestFps < requiredFps) {
+            if (elapsedMs() >= options.maxDurationMs) break;
+            continue;
+        }
+        
+        result.valid = true;
+        result.preset = EncoderPreset::ULTRAFAST;
+        result.width = width;
+        result.height = height;
+        result.encoderThreads = bestThreads;
+        result.measuredFps = bestFps;
+        
+        // Climb towards slower (better) presets while the target still holds
+        for (int p = static_cast<int>(EncoderPreset::ULTRAFAST) + 1;
+             p <= static_cast<int>(options.slowestPreset); p++) {
+            int64_t remaining = options.maxDurationMs - elapsedMs();
+            if (remaining <= 0) break;
+            auto preset = static_cast<EncoderPreset>(p);
+            double fps = runCalibrationTrial(preset, width, height, bestThreads,
+                                             options, std::min(trialTimeoutMs, remaining));
+            result.trials++;
+            LOGI("Calibration %dx%d %s threads=%d: %.1f fps",
+                 width, height, encoderPresetName(preset), bestThreads, fps);
+            if (fps < requiredFps) break;
+            result.preset = preset;
+            result.measuredFps = fps;
+        }
+        break;
+    }
+    result.durationMs = elapsedMs();
+    
+    if (result.valid) {
+        LOGI("=== CALIBRATED: %s %dx%d threads=%d (%.1f fps, %d trials, %lld ms) ===",
+             encoderPresetName(result.preset), result.width, result.height,
+             result.encoderThreads, result.measuredFps, result.trials,
+             (long long)result.durationMs);
+        if (!options.cachePath.empty()) {
+            saveCalibrationCache(options.cachePath, key, result);
+        }
+    } else {
+        LOGE("Calibration: no candidate sustains %.1f fps (%d trials, %lld ms)",
+             requiredFps, result.trials, (long long)result.durationMs);
+    }
+    
+    std::lock_guard<std::mutex> lock(g_calibrationMutex);
+    g_calibration = result;
+#else
+    LOGI("Calibration skipped (GStreamer not available)");
+#endif
+    return result;
+}
+
+// Clamp the configured operating point to what calibration found sustainable.
+// Calibration measures x264 only, so other encoders are left alone.
+void SrtStreamer::Impl::applyCalibration(StreamConfig& config) {
+    if (!config.useCalibration) return;
+    {
+        // A run in progress (started at app launch) finishes first, so this
+        // stream gets its result
+        std::lock_guard<std::mutex> run(g_calibrationRunMutex);
+    }
+    
+    CalibrationResult calibration;
+    {
+        std::lock_guard<std::mutex> lock(g_calibrationMutex);
+        calibration = g_calibration;
+    }
+    if (!calibration.valid) return;
+    if (EncoderBackend::resolve(config.encoder, config.useHardwareEncoder) != EncoderKind::X264) return;
+    
+    if (config.preset > calibration.preset) {
+        config.preset = calibration.preset;
+    }
+    
+    int64_t pixels = static_cast<int64_t>(config.videoWidth) * config.videoHeight;
+    int64_t calibratedPixels = static_cast<int64_t>(calibration.width) * calibration.height;
+    if (pixels > calibratedPixels) {
+        // Same pixel budget, configured aspect ratio
+        double scale = std::sqrt(static_cast<double>(calibratedPixels) / pixels);
+        config.videoWidth = static_cast<int>(config.videoWidth * scale) & ~1;
+        config.videoHeight = static_cast<int>(config.videoHeight * scale) & ~1;
+    }
+    
+    if (config.encoderThreads <= 0) {
+        config.encoderThreads = calibration.encoderThreads;
+    }
+    
+    LOGI("Calibrated operating point: preset=%s, %dx%d, threads=%d",
+         encoderPresetName(config.preset), config.videoWidth, config.videoHeight,
+         config.encoderThreads);
+}
+
 // SrtStreamer implementation (delegates to Impl)
 SrtStreamer::SrtStreamer() : pImpl(std::make_unique<Impl>()) {}
 SrtStreamer::~SrtStreamer() = default;
 
+CalibrationResult SrtStreamer::calibrate(const CalibrationOptions& options) {
+    return pImpl->calibrate(options);
+}
+
 bool SrtStreamer::createPipeline(const StreamConfig& config) {
     return pImpl->createPipeline(config);
 }
@@ -1034,9 +3459,30 @@ StreamStats SrtStreamer::getStats() const {
     return pImpl->getStats();
 }
 
-void SrtStreamer::pushVideoFrame(const uint8_t* data, size_t size,
+bool SrtStreamer::dumpMetricsHistory(const std::string& path) const {
+    return pImpl->dumpMetricsHistory(path);
+}
+
+bool SrtStreamer::admitVideoFrame() {
+    return pImpl->admitVideoFrame();
+}
+
+bool SrtStreamer::pushVideoFrame(const uint8_t* data, size_t size,
                                   int width, int height, int64_t timestampNs) {
-    pImpl->pushVideoFrame(data, size, width, height, timestampNs);
+    return pImpl->pushVideoFrame(data, size, width, height, timestampNs);
+}
+
+bool SrtStreamer::pushVideoFrame(const uint8_t* data, size_t size, int width, int height,
+                                  int64_t timestampNs, const std::vector<RoiRegion>& regions) {
+    return pImpl->pushVideoFrame(data, size, width, height, timestampNs, &regions);
+}
+
+void SrtStreamer::setRegionsOfInterest(const std::vector<RoiRegion>& regions) {
+    pImpl->setRegionsOfInterest(regions);
+}
+
+bool SrtStreamer::requestKeyframe() {
+    return pImpl->requestKeyframe();
 }
 
 void SrtStreamer::pushAudioSamples(const uint8_t* data, size_t size,
@@ -1056,5 +3502,9 @@ void SrtStreamer::setErrorCallback(ErrorCallback callback) {
     pImpl->errorCallback = std::move(callback);
 }
 
+void SrtStreamer::setConnectionCallback(ConnectionCallback callback) {
+    pImpl->connectionCallback = std::move(callback);
+}
+
 } // namespace orbistream
 
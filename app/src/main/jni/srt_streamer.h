@@ -1,8 +1,18 @@
 #pragma once
 
+#include "arq_sender.h"
+#include "byte_accounting.h"
+#include "encoder_backend.h"
+#include "memory_budget.h"
+#include "metrics_history.h"
+#include "multilink_sender.h"
+#include "roi.h"
+#include "thermal_governor.h"
+#include "thread_placement.h"
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace orbistream {
 
@@ -11,25 +21,63 @@ namespace orbistream {
  * 
  * - SRT: Uses SRT protocol with built-in retransmission (use when NOT using Bondix)
  * - UDP: Uses plain UDP MPEG-TS (use with Bondix - Bondix provides reliability)
+ * - SRT_DIRECT: SRT through libsrt directly (SrtTransport) instead of srtsink
+ * - SRT_BONDED: libsrt socket group over several links (native multipath, no proxy)
+ * - MULTILINK_UDP: UDP datagrams scheduled over several bound sockets (MultiLinkSender)
+ * - ARQ_UDP: sequenced UDP with NAK-driven resends inside a latency budget (ArqSender)
  */
 enum class TransportMode {
-    SRT,    // SRT protocol - has its own retransmission
-    UDP     // Plain UDP - relies on Bondix for reliability
+    SRT,        // SRT protocol - has its own retransmission
+    UDP,        // Plain UDP - relies on Bondix for reliability
+    SRT_DIRECT, // SRT via libsrt: socket options from StreamConfig, typed stats
+    SRT_BONDED, // SRT connection bonding: srtLinks as members of one group
+    MULTILINK_UDP,  // Per-packet scheduling over udpLinks, reordered by tools/multilink_receiver
+    ARQ_UDP         // Selective retransmission, receiver is tools/arq_receiver
 };
 
 /**
- * Encoder presets (maps to x264 speed-preset).
+ * SRT connection bonding group type (TransportMode::SRT_BONDED).
+ *
+ * - BROADCAST: every packet on every link; the receiver keeps the first copy
+ * - BACKUP: one active link, the others idle until it degrades (higher weight = preferred)
  */
-enum class EncoderPreset {
-    ULTRAFAST,  // Fastest, lowest quality
-    SUPERFAST,
-    VERYFAST,
-    FASTER,
-    FAST,
-    MEDIUM,     // Default balance
-    SLOW,
-    SLOWER,
-    VERYSLOW    // Slowest, highest quality
+enum class SrtGroupMode {
+    BROADCAST,
+    BACKUP
+};
+
+/**
+ * One member link of an SRT group.
+ */
+struct SrtLinkConfig {
+    std::string localAddress;    // Source address to bind (selects the interface), empty = any
+    std::string host;            // Empty = StreamConfig::srtHost
+    int port = 0;                // 0 = StreamConfig::srtPort
+    int weight = 0;              // BACKUP: priority, higher is preferred
+};
+
+/**
+ * MPEG-TS muxer used to combine the encoded audio and video.
+ *
+ * - MPEGTSMUX: GStreamer mpegtsmux (interleaves both streams, adds buffering)
+ * - NATIVE: TsMuxer - emits each access unit as soon as it is encoded
+ */
+enum class MuxerMode {
+    MPEGTSMUX,
+    NATIVE
+};
+
+/**
+ * Where the elementary streams come from.
+ *
+ * - CAPTURE: camera frames and microphone samples pushed by the app, encoded here
+ * - FILE: H.264/AAC demuxed from an MP4 or MPEG-TS file and passed through
+ *   unchanged (no encoder, no ABR), paced in real time by PTS. For slates
+ *   and for measuring the transport without the encoder in the way.
+ */
+enum class SourceMode {
+    CAPTURE,
+    FILE
 };
 
 /**
@@ -45,6 +93,33 @@ struct StreamConfig {
     std::string streamId;
     std::string passphrase;  // Only used for SRT
     
+    // SRT socket options (SRT and SRT_DIRECT; srtsink only takes the latency)
+    int srtLatencyMs = 500;          // SRTO_LATENCY
+    int64_t srtMaxBw = 0;            // SRTO_MAXBW bytes/s: 0 = input + overhead, -1 = unlimited
+    int64_t srtInputBw = 0;          // SRTO_INPUTBW bytes/s: 0 = estimated
+    int srtOverheadPercent = 25;     // SRTO_OHEADBW
+    int srtPayloadSize = 1316;       // SRTO_PAYLOADSIZE (7 TS packets)
+    int srtSendBufferBytes = 0;      // SRTO_SNDBUF, 0 = libsrt default
+    
+    // SRT connection bonding (SRT_BONDED)
+    SrtGroupMode srtGroupMode = SrtGroupMode::BROADCAST;
+    std::vector<SrtLinkConfig> srtLinks;
+    
+    // Multi-link UDP (MULTILINK_UDP): sockets already bound to their networks
+    std::vector<UdpLinkSocket> udpLinks;
+    LinkScheduler linkScheduler = LinkScheduler::EARLIEST_DELIVERY;
+    int linkProbeIntervalMs = 100;
+    
+    // UDP with retransmissions (ARQ_UDP)
+    int arqLatencyMs = 250;          // Receiver playout delay; no resend once it cannot arrive in time
+    int arqRingSlots = 2048;         // Datagrams kept for resend
+    
+    // Source (FILE: pushVideoFrame/pushAudioSamples are ignored)
+    SourceMode source = SourceMode::CAPTURE;
+    std::string sourcePath;          // FILE: .mp4/.mov/.ts with H.264 video; set videoBitrate to its rate (pacer, stats)
+    bool sourceAudio = true;         // FILE: file has an AAC track (false for video-only clips)
+    bool loopSource = true;          // FILE: start over at the end, timestamps keep running
+    
     // Video settings
     int videoWidth = 1920;
     int videoHeight = 1080;
@@ -56,12 +131,60 @@ struct StreamConfig {
     int keyframeInterval = 2;    // Keyframe every N seconds (GOP size = frameRate * keyframeInterval)
     int bFrames = 0;             // Number of B-frames (0 for low latency)
     bool useHardwareEncoder = true;  // Use hardware encoder (MediaCodec) if available
+    EncoderKind encoder = EncoderKind::AUTO;   // AUTO: MediaCodec per useHardwareEncoder, else x264
+    RateControl rateControl = RateControl::CAPPED_VBR;
+    int vbvBufferMs = 0;         // 0 = profile default: one frame interval for CBR, 600 ms otherwise
+    int crfQuality = 23;         // CONSTANT_QUALITY: x264 CRF, lower is better
+    bool enableRoi = false;      // x264: adaptive quantisation on, so region QP offsets apply
+    int encoderThreads = 0;      // Software encoder threads, 0 = derive from CPU topology
+    bool useCalibration = true;  // Cap preset/resolution/threads to the calibrated operating point
+    bool negotiateFormats = true;    // Convert/scale at ingest, skipping videoconvert/videoscale, when the encoder allows
+    
+    // Thread placement (priorities / affinity of capture, encode, send threads)
+    ThreadPolicy threadPolicy = ThreadPolicy::SYSTEM;
     
     // Audio settings
     int audioBitrate = 128000;   // 128 kbps
     int sampleRate = 48000;
     int audioChannels = 2;
     
+    // Muxer settings
+    MuxerMode muxer = MuxerMode::MPEGTSMUX;
+    int tsPcrDelayMs = 80;       // NATIVE only: PTS lead over PCR
+    int tsPsiIntervalMs = 500;   // NATIVE only: PAT/PMT repeat (also sent before keyframes)
+    
+    // Output pacing (spreads each frame's datagrams instead of sending a burst)
+    bool enablePacing = false;
+    double pacingMultiplier = 2.0;   // Pacing rate = ABR target bitrate * multiplier
+    int pacingBurstPackets = 4;      // Datagrams allowed back to back
+    int pacingMaxDelayMs = 500;      // Drop datagrams queued longer than this
+    
+    // Early frame admission (refuse camera frames before copy/convert when the encoder is behind)
+    bool earlyFrameDrop = true;
+    int latencyBudgetMs = 200;       // Capture-to-encoded latency that counts as congested
+    
+    // Sustained-performance governor: steps fps, resolution and x264 preset
+    // down as the device heats up or throttles, back up once it recovers
+    // (see ThermalGovernor). Capture sources only.
+    bool enableGovernor = true;
+    GovernorConfig governor;
+    std::string thermalRoot = "/sys/class/thermal";       // Fixture trees on a host
+    std::string cpuRoot = "/sys/devices/system/cpu";
+    
+    // Metrics history (one MetricsRecord per interval, see dumpMetricsHistory)
+    int metricsIntervalMs = 1000;
+    int metricsHistorySlots = 3600;  // Records kept (1 hour at 1 s); 0 = off
+    
+    // Memory budget for buffered data, split over ingest, queues, pacer and
+    // retransmit buffers (see MemoryBudget); 0 = queues bounded by count only
+    int64_t memoryBudgetBytes = 0;
+    
+    // Pipeline faults from the bus (sink errors, encoder errors, EOS, clock loss):
+    // restart the pipeline in place before reporting an error
+    bool autoRecover = true;
+    int recoveryAttempts = 5;        // Restarts per fault before onError
+    int recoveryBackoffMs = 100;     // Delay before the first restart, doubled per attempt
+    
     // Bondix SOCKS5 proxy (for routing through bonded network)
     std::string proxyHost = "127.0.0.1";
     int proxyPort = 28007;
@@ -78,12 +201,51 @@ enum class SrtConnectionState {
     BROKEN
 };
 
+/**
+ * Why the pipeline stopped delivering, classified from its bus messages.
+ */
+enum class PipelineFault {
+    NONE,
+    SINK_DISCONNECTED,  // Network sink or transport lost its peer
+    ENCODER_ERROR,
+    CAPS_NEGOTIATION,   // Format could not be (re)negotiated
+    CLOCK_LOST,
+    UNEXPECTED_EOS,
+    PIPELINE_ERROR      // Any other element error
+};
+
+/**
+ * State of one bonded link, from the group's member status.
+ */
+enum class SrtLinkState {
+    PENDING,    // Connecting
+    IDLE,       // Connected, not carrying data (BACKUP standby)
+    ACTIVE,     // Connected and sending
+    BROKEN      // Down; reconnect pending
+};
+
+/**
+ * Per-link statistics of an SRT group (counters restart when a link reconnects).
+ */
+struct SrtLinkStats {
+    std::string localAddress;
+    std::string remoteAddress;
+    int weight = 0;
+    SrtLinkState state = SrtLinkState::BROKEN;
+    double rttMs = 0.0;
+    double sendRateMbps = 0.0;
+    uint64_t packetsSent = 0;
+    uint64_t packetsLost = 0;
+    uint64_t packetsRetransmitted = 0;
+};
+
 /**
  * Streaming statistics.
  */
 struct StreamStats {
     double currentBitrate = 0.0;     // Current bitrate in bps
-    uint64_t bytesSent = 0;          // Total bytes sent
+    uint64_t bytesSent = 0;          // Total bytes sent (the transport's own count)
+    uint64_t packetsSent = 0;        // Datagrams handed to the network, resends included
     uint64_t packetsLost = 0;        // Packets lost (SRT stat)
     uint64_t packetsRetransmitted = 0; // Packets retransmitted
     uint64_t packetsDropped = 0;     // Packets dropped
@@ -98,6 +260,107 @@ struct StreamStats {
     double outputFps = 0.0;          // Frames encoded per second
     uint64_t framesDropped = 0;      // Total frames dropped (input - output)
     bool hardwareEncoderActive = false;  // True if using hardware encoder
+    EncoderKind encoder = EncoderKind::AUTO;  // Backend in use (AUTO: none, file source)
+    uint64_t framesRefused = 0;      // Frames refused at ingest (never copied or encoded)
+    double admitRatio = 1.0;         // Fraction of camera frames currently admitted
+    double encodeLatencyMs = 0.0;    // Capture to encoder output, latest frame
+    double encodeFrameMs = 0.0;      // Encoder element sink to src per frame, mean over the last second
+    double encodeFrameMaxMs = 0.0;   // ... worst over the last second
+    std::string elidedElements;      // Pipeline elements replaced by ingest conversion
+    double ingestConvertUs = 0.0;    // CPU per frame for format conversion + scaling
+    
+    // Encoded frame sizes over the last second (checks the rate-control profile)
+    double frameSizeMeanBytes = 0.0;
+    double frameSizeStdDevBytes = 0.0;   // Small under CBR, large with keyframe bursts
+    uint64_t frameSizeMaxBytes = 0;
+    int vbvBufferMs = 0;             // VBV in effect, 0 if the encoder has none (MediaCodec, openh264)
+    
+    // Pacer stats (only when enablePacing)
+    uint64_t pacerQueueDepth = 0;    // Datagrams waiting in the pacer
+    double pacerDelayMs = 0.0;       // Average queueing delay added by pacing
+    double pacerMaxDelayMs = 0.0;    // Worst queueing delay since start
+    uint64_t pacerDropped = 0;       // Datagrams dropped (overflow or expired)
+    
+    // Per-link stats (SRT_BONDED only)
+    std::vector<SrtLinkStats> srtLinks;
+    
+    // Per-link stats (MULTILINK_UDP only)
+    std::vector<UdpLinkStats> udpLinks;
+    
+    // Retransmission stats (ARQ_UDP only; packetsLost = NAKed, packetsRetransmitted = resent)
+    double retransmitRatio = 0.0;    // Resends per original datagram
+    uint64_t packetsRecovered = 0;   // Gaps filled in time (receiver report)
+    uint64_t packetsExpired = 0;     // Gaps still open at playout (receiver report)
+    
+    // Per-thread CPU time of pipeline threads, by role
+    std::vector<ThreadCpuTime> threadCpuTimes;
+    
+    // Fault detection and in-place recovery
+    uint64_t faults = 0;             // Faults detected since start()
+    uint64_t recoveries = 0;         // Faults after which data flowed again without a rebuild
+    PipelineFault lastFault = PipelineFault::NONE;
+    double lastDetectMs = 0.0;       // Last data out to fault detected
+    double lastRecoverMs = 0.0;      // Fault detected to data flowing again
+    
+    // Buffered bytes per component (limits only with memoryBudgetBytes)
+    std::vector<MemoryUsage> memory;
+    uint64_t memoryBytes = 0;        // Sum over the components, latest samples
+    uint64_t memoryPeakBytes = 0;    // High-water mark of the sum
+    uint64_t budgetDrops = 0;        // Buffers dropped at ingest or ts_src to stay within budget
+    
+    // Bytes and packets per layer, encoder output to wire, with the overhead
+    // each step adds (bytes out per byte in over the last second)
+    std::vector<LayerBytes> byteLayers;
+    double muxOverhead = 0.0;        // TS / elementary streams
+    double transportOverhead = 0.0;  // Transport / TS (protocol headers, resends, SOCKS5)
+    double wireOverhead = 0.0;       // Wire / elementary streams
+    
+    // Sustained-performance governor (enableGovernor); the thermal sample
+    // is refreshed every governor interval
+    int governorLevel = 0;           // Steps below the configured operating point
+    int governorMaxLevel = 0;
+    OperatingPoint operatingPoint;   // In effect now (presetSteps faster than configured)
+    double hottestC = 0.0;
+    double thermalHeadroomC = 0.0;   // Closest zone to its step-down limit
+    double freqCapRatio = 1.0;       // CPU max frequency cap, 1 = uncapped
+    double encodeHeadroom = 1.0;     // 0..1, see encodeHeadroom()
+    std::vector<GovernorDecision> governorDecisions;   // Latest changes, oldest first
+};
+
+/**
+ * Options for the startup encoder calibration.
+ */
+struct CalibrationOptions {
+    // Operating point to reach
+    int targetFps = 30;
+    int maxWidth = 1920;
+    int maxHeight = 1080;
+    int videoBitrate = 4000000;
+    EncoderPreset slowestPreset = EncoderPreset::FAST;  // Don't try beyond this
+    
+    double headroom = 1.5;       // Encode speed required over targetFps (synthetic input is easier than camera)
+    int trialFrames = 60;        // Frames encoded per trial
+    int maxDurationMs = 6000;    // Total time budget
+    
+    // Result cache, keyed by device fingerprint, build id and GStreamer version
+    std::string cachePath;       // Empty = don't cache
+    std::string buildId;         // App version; a new build re-runs calibration
+    bool force = false;          // Ignore a cached result
+};
+
+/**
+ * Highest software-encoder operating point that sustains the target fps.
+ */
+struct CalibrationResult {
+    bool valid = false;          // False if no candidate sustained the target
+    bool fromCache = false;
+    EncoderPreset preset = EncoderPreset::ULTRAFAST;
+    int width = 0;
+    int height = 0;
+    int encoderThreads = 0;
+    double measuredFps = 0.0;    // Encode speed of the chosen point
+    int trials = 0;
+    int64_t durationMs = 0;
 };
 
 /**
@@ -106,6 +369,7 @@ struct StreamStats {
 using StateCallback = std::function<void(bool running, const std::string& message)>;
 using StatsCallback = std::function<void(const StreamStats& stats)>;
 using ErrorCallback = std::function<void(const std::string& error)>;
+using ConnectionCallback = std::function<void(SrtConnectionState state, const std::string& reason)>;
 
 /**
  * SrtStreamer handles the GStreamer pipeline for capturing camera/audio
@@ -122,9 +386,24 @@ public:
     ~SrtStreamer();
 
     /**
-     * Initialize GStreamer. Must be called once.
+     * Initialize GStreamer once per process; later calls return the first
+     * result. See GstStartup for the registry cache.
+     * @param registryCacheDir app cache dir to keep the registry in, empty = GStreamer's default
      */
-    static bool initGStreamer();
+    static bool initGStreamer(const std::string& registryCacheDir = "");
+
+    /**
+     * Benchmark the software encoder through the real encode chain
+     * (synthetic source, null sink) across presets, resolutions and
+     * thread counts, and remember the best point that sustains the
+     * target fps with headroom. Pipelines created afterwards with
+     * useCalibration use it as their default operating point.
+     *
+     * Takes a few seconds. Process-wide: refused while any session is
+     * streaming, and start() or a pipeline created with useCalibration
+     * waits for a run in progress to finish.
+     */
+    CalibrationResult calibrate(const CalibrationOptions& options);
 
     /**
      * Create the streaming pipeline with the given configuration.
@@ -151,6 +430,14 @@ public:
      */
     StreamStats getStats() const;
 
+    /**
+     * Cheap check whether the next video frame will be accepted, based on
+     * encoder backlog and the latency budget. Call it before preparing the
+     * frame to skip the copy when it would be refused; pushVideoFrame()
+     * then uses this decision instead of checking again.
+     */
+    bool admitVideoFrame();
+
     /**
      * Push a video frame from the camera.
      * @param data Raw frame data (NV21 or YUV420)
@@ -158,9 +445,34 @@ public:
      * @param width Frame width
      * @param height Frame height
      * @param timestampNs Frame timestamp in nanoseconds
+     * @return false if the frame was refused (or not streaming); the caller
+     *         can release the camera image right away either way
      */
-    void pushVideoFrame(const uint8_t* data, size_t size, 
+    bool pushVideoFrame(const uint8_t* data, size_t size, 
                         int width, int height, int64_t timestampNs);
+    
+    /**
+     * Push a video frame with regions of interest for this frame only,
+     * in place of the persistent ones.
+     */
+    bool pushVideoFrame(const uint8_t* data, size_t size, int width, int height,
+                        int64_t timestampNs, const std::vector<RoiRegion>& regions);
+    
+    /**
+     * Regions of interest for every following frame, until replaced (empty
+     * clears them). Attached to frames as GstVideoRegionOfInterestMeta; x264
+     * maps them to QP offsets when the pipeline was created with enableRoi.
+     * amcvidenc and openh264enc have no per-region QP and ignore them.
+     */
+    void setRegionsOfInterest(const std::vector<RoiRegion>& regions);
+
+    /**
+     * Ask the encoder for an IDR (with SPS/PPS) now instead of at the next
+     * keyframe interval, e.g. when a receiver joins. Also sent by itself
+     * when a libsrt connection is re-established.
+     * @return false if not streaming or there is no encoder (file source)
+     */
+    bool requestKeyframe();
 
     /**
      * Push audio samples from the microphone.
@@ -179,6 +491,22 @@ public:
     void setStateCallback(StateCallback callback);
     void setStatsCallback(StatsCallback callback);
     void setErrorCallback(ErrorCallback callback);
+    
+    /**
+     * Connection state changes, as they happen: BROKEN when a fault is
+     * detected, CONNECTED once data flows again (and libsrt's own state
+     * for SRT_DIRECT / SRT_BONDED). The error callback fires only when
+     * in-place recovery gives up.
+     */
+    void setConnectionCallback(ConnectionCallback callback);
+
+    /**
+     * Write the metrics history of the current (or last) stream to path,
+     * in the MetricsHistory file format. Works while streaming and after
+     * stop(), until the next createPipeline().
+     * @return false if the history is off or the file can't be written
+     */
+    bool dumpMetricsHistory(const std::string& path) const;
 
 private:
     class Impl;
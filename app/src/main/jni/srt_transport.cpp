@@ -0,0 +1,479 @@
+#include "srt_transport.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <netdb.h>
+
+#if LIBSRT_AVAILABLE
+#include <srt/srt.h>
+#endif
+
+#define LOG_TAG "SrtTransport"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+
+const char* stateName(SrtConnectionState state) {
+    switch (state) {
+        case SrtConnectionState::DISCONNECTED: return "DISCONNECTED";
+        case SrtConnectionState::CONNECTING: return "CONNECTING";
+        case SrtConnectionState::CONNECTED: return "CONNECTED";
+        case SrtConnectionState::BROKEN: return "BROKEN";
+        default: return "UNKNOWN";
+    }
+}
+
+#if LIBSRT_AVAILABLE
+bool setOption(SRTSOCKET sock, SRT_SOCKOPT option, const void* value, int size, const char* name) {
+    if (srt_setsockflag(sock, option, value, size) == SRT_ERROR) {
+        LOGE("Failed to set %s: %s", name, srt_getlasterror_str());
+        return false;
+    }
+    return true;
+}
+
+// Resolve host:port into `out`; `family` restricts the lookup (AF_UNSPEC = any)
+bool resolveAddress(const std::string& host, int port, int family, bool numeric,
+                    sockaddr_storage& out, int& length, std::string& error) {
+    struct addrinfo hints = {};
+    struct addrinfo* result = nullptr;
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = numeric ? AI_NUMERICHOST : 0;
+    std::string service = std::to_string(port);
+    int err = getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+    if (err != 0 || !result) {
+        error = "resolve " + host + " failed: " + gai_strerror(err);
+        return false;
+    }
+    memcpy(&out, result->ai_addr, result->ai_addrlen);
+    length = static_cast<int>(result->ai_addrlen);
+    freeaddrinfo(result);
+    return true;
+}
+
+std::string linkRemote(const SrtTransportConfig& config, const SrtLinkConfig& link) {
+    return (link.host.empty() ? config.host : link.host) + ":" +
+           std::to_string(link.port > 0 ? link.port : config.port);
+}
+
+// One group endpoint per configured link; the token is the link index so
+// srt_group_data members map back to their link
+bool prepareEndpoints(const SrtTransportConfig& config,
+                      std::vector<SRT_SOCKGROUPCONFIG>& endpoints, std::string& error) {
+    endpoints.clear();
+    for (size_t i = 0; i < config.links.size(); i++) {
+        const SrtLinkConfig& link = config.links[i];
+        sockaddr_storage local = {};
+        sockaddr_storage remote = {};
+        int localLength = 0;
+        int remoteLength = 0;
+        bool bindLocal = !link.localAddress.empty();
+        if (bindLocal && !resolveAddress(link.localAddress, 0, AF_UNSPEC, true,
+                                         local, localLength, error)) {
+            return false;
+        }
+        if (!resolveAddress(link.host.empty() ? config.host : link.host,
+                            link.port > 0 ? link.port : config.port,
+                            bindLocal ? local.ss_family : AF_UNSPEC, false,
+                            remote, remoteLength, error)) {
+            return false;
+        }
+        SRT_SOCKGROUPCONFIG endpoint = srt_prepare_endpoint(
+            bindLocal ? reinterpret_cast<const sockaddr*>(&local) : nullptr,
+            reinterpret_cast<const sockaddr*>(&remote), remoteLength);
+        endpoint.weight = static_cast<uint16_t>(std::max(0, link.weight));
+        endpoint.token = static_cast<int>(i);
+        endpoints.push_back(endpoint);
+    }
+    return true;
+}
+
+SrtLinkState linkState(SRT_MEMBERSTATUS status) {
+    switch (status) {
+        case SRT_GST_PENDING: return SrtLinkState::PENDING;
+        case SRT_GST_IDLE: return SrtLinkState::IDLE;
+        case SRT_GST_RUNNING: return SrtLinkState::ACTIVE;
+        default: return SrtLinkState::BROKEN;
+    }
+}
+
+// Current members of a group; empty on error
+std::vector<SRT_SOCKGROUPDATA> groupMembers(SRTSOCKET group, size_t expected) {
+    // Broken members linger until closed, so leave room beyond the link count
+    std::vector<SRT_SOCKGROUPDATA> members(expected * 2 + 2);
+    size_t count = members.size();
+    if (srt_group_data(group, members.data(), &count) == SRT_ERROR) {
+        return {};
+    }
+    members.resize(std::min(count, members.size()));
+    return members;
+}
+#endif
+
+} // namespace
+
+SrtTransport::SrtTransport(const SrtTransportConfig& cfg, ConnectionCallback cb)
+    : config(cfg), callback(std::move(cb)) {}
+
+SrtTransport::~SrtTransport() {
+    stop();
+}
+
+bool SrtTransport::isAvailable() {
+#if LIBSRT_AVAILABLE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SrtTransport::start() {
+#if LIBSRT_AVAILABLE
+    if (running) return;
+    srt_startup();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        closedTotals = SrtTransportStats{};
+        lastStats = SrtTransportStats{};
+        connects = 0;
+    }
+    localDrops = 0;
+    running = true;
+    worker = std::thread(&SrtTransport::run, this);
+#else
+    LOGE("Direct SRT output not available (built without LIBSRT_AVAILABLE)");
+    setState(SrtConnectionState::BROKEN, "libsrt not available");
+#endif
+}
+
+void SrtTransport::stop() {
+#if LIBSRT_AVAILABLE
+    if (!running) return;
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    srt_cleanup();
+    setState(SrtConnectionState::DISCONNECTED, "stopped");
+#endif
+}
+
+void SrtTransport::setState(SrtConnectionState newState, const std::string& reason) {
+    SrtConnectionState previous = state.exchange(newState);
+    if (previous == newState) return;
+    LOGI("Connection %s -> %s%s%s", stateName(previous), stateName(newState),
+         reason.empty() ? "" : ": ", reason.c_str());
+    if (callback) {
+        callback(newState, reason);
+    }
+}
+
+// Create and connect a caller socket (or group); returns the socket or -1
+int SrtTransport::openSocket() {
+#if LIBSRT_AVAILABLE
+    std::string error;
+    sockaddr_storage remote = {};
+    int remoteLength = 0;
+    std::vector<SRT_SOCKGROUPCONFIG> endpoints;
+    if (config.bonded) {
+        if (config.links.empty()) {
+            setState(SrtConnectionState::BROKEN, "no links configured for bonding");
+            return -1;
+        }
+        if (!prepareEndpoints(config, endpoints, error)) {
+            setState(SrtConnectionState::BROKEN, error);
+            return -1;
+        }
+    } else if (!resolveAddress(config.host, config.port, AF_UNSPEC, false,
+                               remote, remoteLength, error)) {
+        setState(SrtConnectionState::BROKEN, error);
+        return -1;
+    }
+
+    SRTSOCKET sock = config.bonded
+        ? srt_create_group(config.groupMode == SrtGroupMode::BACKUP ? SRT_GTYPE_BACKUP
+                                                                      : SRT_GTYPE_BROADCAST)
+        : srt_create_socket();
+    if (sock == SRT_INVALID_SOCK) {
+        // Groups also fail here when libsrt was built without ENABLE_BONDING
+        setState(SrtConnectionState::BROKEN, srt_getlasterror_str());
+        return -1;
+    }
+
+    // Options set on a group apply to every member
+    SRT_TRANSTYPE transType = SRTT_LIVE;
+    int latency = config.latencyMs;
+    int64_t maxBw = config.maxBw;
+    int64_t inputBw = config.inputBw;
+    int overhead = config.overheadPercent;
+    int payloadSize = config.payloadSize;
+    int connectTimeout = config.connectTimeoutMs;
+    bool ok = setOption(sock, SRTO_TRANSTYPE, &transType, sizeof(transType), "SRTO_TRANSTYPE") &&
+              setOption(sock, SRTO_LATENCY, &latency, sizeof(latency), "SRTO_LATENCY") &&
+              setOption(sock, SRTO_MAXBW, &maxBw, sizeof(maxBw), "SRTO_MAXBW") &&
+              setOption(sock, SRTO_INPUTBW, &inputBw, sizeof(inputBw), "SRTO_INPUTBW") &&
+              setOption(sock, SRTO_OHEADBW, &overhead, sizeof(overhead), "SRTO_OHEADBW") &&
+              setOption(sock, SRTO_PAYLOADSIZE, &payloadSize, sizeof(payloadSize), "SRTO_PAYLOADSIZE") &&
+              setOption(sock, SRTO_CONNTIMEO, &connectTimeout, sizeof(connectTimeout), "SRTO_CONNTIMEO");
+    if (ok && config.sendBufferBytes > 0) {
+        int sendBuffer = config.sendBufferBytes;
+        ok = setOption(sock, SRTO_SNDBUF, &sendBuffer, sizeof(sendBuffer), "SRTO_SNDBUF");
+    }
+    if (ok && !config.streamId.empty()) {
+        ok = setOption(sock, SRTO_STREAMID, config.streamId.c_str(),
+                       static_cast<int>(config.streamId.size()), "SRTO_STREAMID");
+    }
+    if (ok && !config.passphrase.empty()) {
+        ok = setOption(sock, SRTO_PASSPHRASE, config.passphrase.c_str(),
+                       static_cast<int>(config.passphrase.size()), "SRTO_PASSPHRASE");
+    }
+    if (!ok) {
+        srt_close(sock);
+        setState(SrtConnectionState::BROKEN, "invalid socket options");
+        return -1;
+    }
+
+    setState(SrtConnectionState::CONNECTING, "");
+    // A group connect returns once the first member is up; the rest keep connecting
+    int rc = config.bonded
+        ? srt_connect_group(sock, endpoints.data(), static_cast<int>(endpoints.size()))
+        : srt_connect(sock, reinterpret_cast<const sockaddr*>(&remote), remoteLength);
+    if (rc == SRT_ERROR) {
+        std::string reason = srt_getlasterror_str();
+        srt_close(sock);
+        setState(SrtConnectionState::BROKEN, reason);
+        return -1;
+    }
+
+    // Sends from the streaming thread must never block, nor may re-adding links
+    bool sync = false;
+    srt_setsockflag(sock, SRTO_SNDSYN, &sync, sizeof(sync));
+    if (config.bonded) {
+        srt_setsockflag(sock, SRTO_RCVSYN, &sync, sizeof(sync));
+    }
+    return sock;
+#else
+    return -1;
+#endif
+}
+
+// Re-add links that are missing from the group (dropped members are removed by libsrt)
+void SrtTransport::reconnectLinks(int group) {
+#if LIBSRT_AVAILABLE
+    std::vector<SRT_SOCKGROUPDATA> members = groupMembers(group, config.links.size());
+    std::vector<bool> present(config.links.size(), false);
+    for (const SRT_SOCKGROUPDATA& member : members) {
+        if (member.token >= 0 && member.token < static_cast<int>(present.size()) &&
+            member.memberstate != SRT_GST_BROKEN) {
+            present[member.token] = true;
+        }
+    }
+    if (std::all_of(present.begin(), present.end(), [](bool up) { return up; })) return;
+
+    std::vector<SRT_SOCKGROUPCONFIG> endpoints;
+    std::string error;
+    if (!prepareEndpoints(config, endpoints, error)) {
+        LOGD("Link reconnect skipped: %s", error.c_str());
+        return;
+    }
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        if (present[i]) continue;
+        LOGI("Re-adding link %zu (%s -> %s)", i, config.links[i].localAddress.c_str(),
+             linkRemote(config, config.links[i]).c_str());
+        if (srt_connect_group(group, &endpoints[i], 1) == SRT_ERROR) {
+            LOGD("Link %zu: %s", i, srt_getlasterror_str());
+        }
+    }
+#else
+    (void)group;
+#endif
+}
+
+void SrtTransport::run() {
+#if LIBSRT_AVAILABLE
+    LOGI("Connecting to %s:%d (latency %d ms, maxbw %lld, payload %d%s)",
+         config.host.c_str(), config.port, config.latencyMs,
+         (long long)config.maxBw, config.payloadSize,
+         !config.bonded ? "" : config.groupMode == SrtGroupMode::BACKUP ? ", backup group"
+                                                                        : ", broadcast group");
+
+    while (running) {
+        SRTSOCKET sock = openSocket();
+        if (sock < 0) {
+            for (int waited = 0; running && waited < config.reconnectDelayMs; waited += 100) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            connects++;
+        }
+        socket = sock;
+        setState(SrtConnectionState::CONNECTED, "");
+
+        // Wait for the connection to break (or for stop); a group breaks
+        // only when its last member does
+        int eid = srt_epoll_create();
+        int events = SRT_EPOLL_ERR;
+        srt_epoll_add_usock(eid, sock, &events);
+        std::string reason = "stopped";
+        auto lastLinkCheck = std::chrono::steady_clock::now();
+        while (running) {
+            SRT_EPOLL_EVENT ready[1];
+            int n = srt_epoll_uwait(eid, ready, 1, 200);
+            if (n > 0 || srt_getsockstate(sock) > SRTS_CONNECTED) {
+                reason = "connection lost";
+                break;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (config.bonded && now - lastLinkCheck >= std::chrono::milliseconds(config.reconnectDelayMs)) {
+                reconnectLinks(sock);
+                lastLinkCheck = now;
+            }
+        }
+        srt_epoll_release(eid);
+
+        // Fold this connection's totals in so stats stay cumulative across reconnects
+        socket = -1;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            SrtTransportStats final;
+            if (readStats(sock, final)) {
+                closedTotals.packetsSent += final.packetsSent;
+                closedTotals.bytesSent += final.bytesSent;
+                closedTotals.wirePacketsSent += final.wirePacketsSent;
+                closedTotals.wireBytesSent += final.wireBytesSent;
+                closedTotals.packetsLost += final.packetsLost;
+                closedTotals.packetsRetransmitted += final.packetsRetransmitted;
+                closedTotals.packetsDropped += final.packetsDropped;
+            }
+            for (SrtLinkStats& link : lastStats.links) {
+                link.state = SrtLinkState::BROKEN;
+            }
+        }
+        srt_close(sock);
+
+        if (running) {
+            setState(SrtConnectionState::BROKEN, reason);
+        }
+    }
+#endif
+}
+
+bool SrtTransport::send(const uint8_t* data, size_t size) {
+#if LIBSRT_AVAILABLE
+    int sock = socket.load(std::memory_order_acquire);
+    if (sock < 0) return false;
+    int rc = srt_sendmsg2(sock, reinterpret_cast<const char*>(data), static_cast<int>(size), nullptr);
+    if (rc == SRT_ERROR) {
+        // Full send buffer (SRT_EASYNCSND) or broken link; the worker handles the latter
+        localDrops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+// Counters of the current connection (statsMutex held)
+bool SrtTransport::readStats(int sock, SrtTransportStats& out) const {
+#if LIBSRT_AVAILABLE
+    SRT_TRACEBSTATS perf;
+    if (!config.bonded) {
+        if (srt_bstats(sock, &perf, 0) == SRT_ERROR) return false;
+        out.packetsSent = perf.pktSentTotal;
+        out.bytesSent = static_cast<int64_t>(perf.byteSentTotal);
+        out.wirePacketsSent = out.packetsSent;
+        out.wireBytesSent = out.bytesSent;
+        out.packetsLost = perf.pktSndLossTotal;
+        out.packetsRetransmitted = perf.pktRetransTotal;
+        out.packetsDropped = perf.pktSndDropTotal;
+        out.rttMs = perf.msRTT;
+        out.sendRateMbps = perf.mbpsSendRate;
+        out.bandwidthMbps = perf.mbpsBandwidth;
+        out.flightSize = perf.pktFlightSize;
+        out.sendBufferMs = perf.msSndBuf;
+        out.sendBufferBytes = perf.byteSndBuf;
+        return true;
+    }
+
+    // Group: unique payload from the group, link counters from each member
+    if (srt_bstats(sock, &perf, 0) == SRT_ERROR) return false;
+    out.packetsSent = perf.pktSentUniqueTotal;
+    out.bytesSent = static_cast<int64_t>(perf.byteSentUniqueTotal);
+
+    out.links.assign(config.links.size(), SrtLinkStats{});
+    for (size_t i = 0; i < config.links.size(); i++) {
+        out.links[i].localAddress = config.links[i].localAddress;
+        out.links[i].remoteAddress = linkRemote(config, config.links[i]);
+        out.links[i].weight = config.links[i].weight;
+    }
+    for (const SRT_SOCKGROUPDATA& member : groupMembers(sock, config.links.size())) {
+        if (member.token < 0 || member.token >= static_cast<int>(out.links.size())) continue;
+        SrtLinkStats& link = out.links[member.token];
+        link.state = linkState(member.memberstate);
+        link.weight = member.weight;
+        if (srt_bstats(member.id, &perf, 0) == SRT_ERROR) continue;
+        link.rttMs = perf.msRTT;
+        link.sendRateMbps = perf.mbpsSendRate;
+        link.packetsSent = static_cast<uint64_t>(perf.pktSentTotal);
+        link.packetsLost = static_cast<uint64_t>(perf.pktSndLossTotal);
+        link.packetsRetransmitted = static_cast<uint64_t>(perf.pktRetransTotal);
+
+        out.wirePacketsSent += perf.pktSentTotal;
+        out.wireBytesSent += static_cast<int64_t>(perf.byteSentTotal);
+        out.packetsLost += perf.pktSndLossTotal;
+        out.packetsRetransmitted += perf.pktRetransTotal;
+        out.packetsDropped += perf.pktSndDropTotal;
+        out.sendBufferBytes += perf.byteSndBuf;
+        if (link.state == SrtLinkState::ACTIVE) {
+            // Every active link carries the whole stream, so the weakest bounds the bitrate
+            out.rttMs = out.rttMs > 0.0 ? std::min(out.rttMs, perf.msRTT) : perf.msRTT;
+            out.bandwidthMbps = out.bandwidthMbps > 0.0
+                ? std::min(out.bandwidthMbps, perf.mbpsBandwidth) : perf.mbpsBandwidth;
+            out.sendRateMbps = std::max(out.sendRateMbps, perf.mbpsSendRate);
+            out.flightSize = std::max(out.flightSize, perf.pktFlightSize);
+            out.sendBufferMs = std::max(out.sendBufferMs, perf.msSndBuf);
+        }
+    }
+    return true;
+#else
+    (void)sock;
+    (void)out;
+    return false;
+#endif
+}
+
+SrtTransportStats SrtTransport::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    SrtTransportStats result = lastStats;
+    int sock = socket.load(std::memory_order_acquire);
+    SrtTransportStats current;
+    if (sock >= 0 && readStats(sock, current)) {
+        result = current;
+        result.packetsSent += closedTotals.packetsSent;
+        result.bytesSent += closedTotals.bytesSent;
+        result.wirePacketsSent += closedTotals.wirePacketsSent;
+        result.wireBytesSent += closedTotals.wireBytesSent;
+        result.packetsLost += closedTotals.packetsLost;
+        result.packetsRetransmitted += closedTotals.packetsRetransmitted;
+        result.packetsDropped += closedTotals.packetsDropped;
+        lastStats = result;
+    }
+    result.localDrops = localDrops.load(std::memory_order_relaxed);
+    result.connects = connects;
+    return result;
+}
+
+} // namespace orbistream
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "srt_streamer.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Socket options for the direct libsrt output.
+ */
+struct SrtTransportConfig {
+    std::string host;
+    int port = 9000;
+    std::string streamId;
+    std::string passphrase;
+
+    int latencyMs = 500;            // SRTO_LATENCY
+    int64_t maxBw = 0;              // SRTO_MAXBW bytes/s: 0 = inputBw + overhead, -1 = unlimited
+    int64_t inputBw = 0;            // SRTO_INPUTBW bytes/s: 0 = estimated by libsrt
+    int overheadPercent = 25;       // SRTO_OHEADBW
+    int payloadSize = 1316;         // SRTO_PAYLOADSIZE (7 TS packets)
+    int sendBufferBytes = 0;        // SRTO_SNDBUF, 0 = libsrt default
+    int connectTimeoutMs = 3000;    // SRTO_CONNTIMEO
+    int reconnectDelayMs = 1000;
+    
+    // Connection bonding: one group, one member per link
+    bool bonded = false;
+    SrtGroupMode groupMode = SrtGroupMode::BROADCAST;
+    std::vector<SrtLinkConfig> links;
+};
+
+/**
+ * Sender statistics read from srt_bstats (cumulative unless noted).
+ */
+struct SrtTransportStats {
+    int64_t packetsSent = 0;        // pktSentTotal
+    int64_t bytesSent = 0;          // byteSentTotal
+    int64_t wirePacketsSent = 0;    // Bonded: pktSentTotal summed over the links, else packetsSent
+    int64_t wireBytesSent = 0;      // Same for byteSentTotal (libsrt counts SRT, UDP and IP headers)
+    int64_t packetsLost = 0;        // pktSndLossTotal
+    int64_t packetsRetransmitted = 0;   // pktRetransTotal
+    int64_t packetsDropped = 0;     // pktSndDropTotal (too late to send)
+    double rttMs = 0.0;             // msRTT
+    double sendRateMbps = 0.0;      // mbpsSendRate
+    double bandwidthMbps = 0.0;     // mbpsBandwidth (link capacity estimate)
+    int flightSize = 0;             // pktFlightSize (unacknowledged)
+    int sendBufferMs = 0;           // msSndBuf (queued, in time)
+    int64_t sendBufferBytes = 0;    // byteSndBuf (queued; summed over bonded links)
+    int64_t localDrops = 0;         // Datagrams refused because the send buffer was full
+    uint64_t connects = 0;
+    
+    // Bonded: one entry per configured link. packetsSent/bytesSent above count
+    // each datagram once; loss/retransmit counters are summed over the links,
+    // RTT and bandwidth are those of the best running link
+    std::vector<SrtLinkStats> links;
+};
+
+/**
+ * SrtTransport sends TS datagrams over a libsrt caller socket in live
+ * mode, bypassing srtsink.
+ *
+ * A worker thread owns the connection: it connects (blocking, with
+ * SRTO_CONNTIMEO), watches the socket for errors with srt_epoll and
+ * reconnects after a break. State changes are reported through the
+ * connection callback as they happen. send() is non-blocking and only
+ * sends while connected.
+ *
+ * Bonded, the socket is an SRT group (broadcast or main/backup) with one
+ * member per link, each bound to its own local address. The group counts
+ * as connected while any member is; members that drop are re-added in the
+ * background without interrupting the others.
+ */
+class SrtTransport {
+public:
+    using ConnectionCallback = std::function<void(SrtConnectionState state, const std::string& reason)>;
+
+    SrtTransport(const SrtTransportConfig& config, ConnectionCallback callback);
+    ~SrtTransport();
+
+    /**
+     * Whether libsrt support was compiled in (LIBSRT_AVAILABLE).
+     */
+    static bool isAvailable();
+
+    void start();
+    void stop();
+
+    /**
+     * Send one datagram as one SRT message.
+     * @return false if not connected or the send buffer is full
+     */
+    bool send(const uint8_t* data, size_t size);
+
+    SrtTransportStats getStats() const;
+    SrtConnectionState getState() const { return state.load(); }
+
+private:
+    void run();
+    void setState(SrtConnectionState newState, const std::string& reason);
+    int openSocket();
+    bool readStats(int sock, SrtTransportStats& out) const;
+    void reconnectLinks(int group);
+
+    SrtTransportConfig config;
+    ConnectionCallback callback;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<SrtConnectionState> state{SrtConnectionState::DISCONNECTED};
+    std::atomic<int> socket{-1};            // SRTSOCKET while connected, else -1
+    std::atomic<int64_t> localDrops{0};
+
+    mutable std::mutex statsMutex;
+    uint64_t connects = 0;
+    SrtTransportStats closedTotals;         // Counters of connections already closed
+    mutable SrtTransportStats lastStats;    // Last reading, reported while reconnecting
+};
+
+} // namespace orbistream
@@ -0,0 +1,253 @@
+#include "thermal_governor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+
+namespace orbistream {
+
+namespace {
+
+// Zones report garbage while their sensor is off (-273 C, 0, or huge values)
+constexpr double kMinPlausibleC = 1.0;
+constexpr double kMaxPlausibleC = 150.0;
+// Standard heights for resolution steps, largest first
+constexpr int kStepHeights[] = {1080, 720, 540, 360, 270};
+
+bool readInt64(const std::string& path, int64_t& value) {
+    std::ifstream in(path);
+    if (!in) return false;
+    in >> value;
+    return !in.fail();
+}
+
+std::string readLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Entries named prefixN in dir
+std::vector<std::string> numberedEntries(const std::string& dir, const char* prefix) {
+    std::vector<std::string> names;
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return names;
+    size_t length = strlen(prefix);
+    while (dirent* entry = readdir(handle)) {
+        const char* name = entry->d_name;
+        if (strncmp(name, prefix, length) == 0 && name[length] >= '0' && name[length] <= '9') {
+            names.push_back(name);
+        }
+    }
+    closedir(handle);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Lowest passive trip point in millidegrees, 0 if none
+int64_t passiveTrip(const std::string& zoneDir) {
+    int64_t lowest = 0;
+    for (int i = 0; i < 16; i++) {
+        std::string base = zoneDir + "/trip_point_" + std::to_string(i);
+        std::string type = readLine(base + "_type");
+        if (type.empty()) break;
+        int64_t temp = 0;
+        if (type != "passive" || !readInt64(base + "_temp", temp) || temp <= 0) continue;
+        if (lowest == 0 || temp < lowest) lowest = temp;
+    }
+    return lowest;
+}
+
+int evenRound(double value) {
+    return std::max(2, static_cast<int>(std::lround(value / 2.0)) * 2);
+}
+
+} // namespace
+
+const char* governorReasonName(GovernorReason reason) {
+    switch (reason) {
+        case GovernorReason::THERMAL: return "thermal";
+        case GovernorReason::CPU_FREQ_CAP: return "cpu_freq_cap";
+        case GovernorReason::ENCODE_HEADROOM: return "encode_headroom";
+        case GovernorReason::RECOVERED: return "recovered";
+        default: return "none";
+    }
+}
+
+ThermalMonitor::ThermalMonitor(const std::string& thermalRoot, const std::string& cpuRoot)
+    : thermalRoot(thermalRoot), cpuRoot(cpuRoot) {}
+
+ThermalReading ThermalMonitor::read() const {
+    ThermalReading reading;
+
+    for (const std::string& name : numberedEntries(thermalRoot, "thermal_zone")) {
+        std::string dir = thermalRoot + "/" + name;
+        int64_t milliC = 0;
+        if (!readInt64(dir + "/temp", milliC)) continue;
+        ThermalZone zone;
+        zone.name = name;
+        zone.type = readLine(dir + "/type");
+        zone.tempC = milliC / 1000.0;
+        if (zone.tempC < kMinPlausibleC || zone.tempC > kMaxPlausibleC) continue;
+        zone.tripC = passiveTrip(dir) / 1000.0;
+        reading.hottestC = std::max(reading.hottestC, zone.tempC);
+        reading.zones.push_back(zone);
+    }
+
+    for (const std::string& name : numberedEntries(cpuRoot, "cpu")) {
+        std::string dir = cpuRoot + "/" + name;
+        int64_t online = 1;
+        if (readInt64(dir + "/online", online) && online == 0) continue;   // cpu0 has no file
+        int64_t capKhz = 0;
+        int64_t maxKhz = 0;
+        if (!readInt64(dir + "/cpufreq/scaling_max_freq", capKhz) ||
+            !readInt64(dir + "/cpufreq/cpuinfo_max_freq", maxKhz) || capKhz <= 0 || maxKhz <= 0) {
+            continue;
+        }
+        double ratio = std::min(1.0, static_cast<double>(capKhz) / maxKhz);
+        reading.freqCapRatio = std::min(reading.freqCapRatio, ratio);
+        if (capKhz < maxKhz) reading.cappedCpus++;
+        reading.available = true;
+    }
+
+    reading.available = reading.available || !reading.zones.empty();
+    return reading;
+}
+
+double encodeHeadroom(double encodeLatencyMs, double budgetMs, double admitRatio) {
+    if (admitRatio < 1.0) return 0.0;
+    if (budgetMs <= 0.0 || encodeLatencyMs <= 0.0) return 1.0;
+    return std::max(0.0, std::min(1.0, 1.0 - encodeLatencyMs / budgetMs));
+}
+
+void ThermalGovernor::configure(const GovernorConfig& governorConfig, const OperatingPoint& top,
+                                int presetRoom) {
+    config = governorConfig;
+    ladder.assign(1, top);
+    currentLevel = 0;
+    pressureSinceMs = calmSinceMs = lastChangeMs = lastStepUpMs = -1;
+    upHoldScale = 1;
+
+    // Candidate values per dimension, in the order they are given up
+    std::vector<int> rates;
+    for (int rate : {top.frameRate * 4 / 5, top.frameRate * 2 / 3, top.frameRate / 2}) {
+        int last = rates.empty() ? top.frameRate : rates.back();
+        if (rate < last && rate >= config.minFrameRate) rates.push_back(rate);
+    }
+    std::vector<int> heights;
+    for (int height : kStepHeights) {
+        if (height < top.height && height >= config.minHeight) heights.push_back(height);
+    }
+    std::vector<int> presets;
+    for (int steps = 1; steps <= std::min(presetRoom, config.maxPresetSteps); steps++) {
+        presets.push_back(steps);
+    }
+
+    // One dimension per level, round-robin: fps, resolution, preset
+    size_t rateIndex = 0;
+    size_t heightIndex = 0;
+    size_t presetIndex = 0;
+    OperatingPoint point = top;
+    while (rateIndex < rates.size() || heightIndex < heights.size() || presetIndex < presets.size()) {
+        if (rateIndex < rates.size()) {
+            point.frameRate = rates[rateIndex++];
+            ladder.push_back(point);
+        }
+        if (heightIndex < heights.size()) {
+            point.height = heights[heightIndex++];
+            point.width = evenRound(static_cast<double>(top.width) * point.height / top.height);
+            ladder.push_back(point);
+        }
+        if (presetIndex < presets.size()) {
+            point.presetSteps = presets[presetIndex++];
+            ladder.push_back(point);
+        }
+    }
+}
+
+double ThermalGovernor::thermalHeadroomC(const ThermalReading& reading) const {
+    double headroom = 100.0;
+    for (const ThermalZone& zone : reading.zones) {
+        double limit = zone.tripC > 0.0 ? zone.tripC - config.tripMarginC : config.hotC;
+        headroom = std::min(headroom, limit - zone.tempC);
+    }
+    return headroom;
+}
+
+GovernorReason ThermalGovernor::pressure(const ThermalReading& reading, double headroom) const {
+    if (thermalHeadroomC(reading) <= 0.0) return GovernorReason::THERMAL;
+    if (reading.freqCapRatio < config.freqCapDown && headroom < config.headroomUp) {
+        return GovernorReason::CPU_FREQ_CAP;
+    }
+    if (headroom < config.headroomDown) return GovernorReason::ENCODE_HEADROOM;
+    return GovernorReason::NONE;
+}
+
+bool ThermalGovernor::calm(const ThermalReading& reading, double headroom) const {
+    for (const ThermalZone& zone : reading.zones) {
+        double limit = zone.tripC > 0.0 ? zone.tripC - config.recoverMarginC : config.coolC;
+        if (zone.tempC >= limit) return false;
+    }
+    return reading.freqCapRatio >= config.freqCapUp && headroom >= config.headroomUp;
+}
+
+bool ThermalGovernor::evaluate(int64_t nowMs, const ThermalReading& reading, double headroom,
+                               GovernorDecision& decision) {
+    GovernorReason reason = pressure(reading, headroom);
+    int target = currentLevel;
+
+    if (reason != GovernorReason::NONE) {
+        calmSinceMs = -1;
+        if (pressureSinceMs < 0) pressureSinceMs = nowMs;
+        bool held = nowMs - pressureSinceMs >= config.downHoldMs;
+        bool spaced = lastChangeMs < 0 || nowMs - lastChangeMs >= config.downGapMs;
+        if (held && spaced && currentLevel < maxLevel()) target = currentLevel + 1;
+    } else if (calm(reading, headroom)) {
+        pressureSinceMs = -1;
+        if (calmSinceMs < 0) calmSinceMs = nowMs;
+        int64_t holdMs = static_cast<int64_t>(config.upHoldMs) * upHoldScale;
+        bool held = nowMs - calmSinceMs >= holdMs;
+        bool spaced = lastChangeMs < 0 || nowMs - lastChangeMs >= holdMs;
+        if (held && spaced && currentLevel > 0) {
+            target = currentLevel - 1;
+            reason = GovernorReason::RECOVERED;
+        }
+    } else {
+        // Between the thresholds: hold the level, restart both clocks
+        pressureSinceMs = -1;
+        calmSinceMs = -1;
+    }
+
+    if (target == currentLevel) return false;
+
+    if (target > currentLevel) {
+        // Pressure soon after stepping up: that point was not sustainable
+        if (lastStepUpMs >= 0 && nowMs - lastStepUpMs < config.relapseMs) {
+            upHoldScale = std::min(8, upHoldScale * 2);
+        } else {
+            upHoldScale = 1;
+        }
+    } else {
+        lastStepUpMs = nowMs;
+    }
+
+    decision.timeMs = nowMs;
+    decision.fromLevel = currentLevel;
+    decision.toLevel = target;
+    decision.reason = reason;
+    decision.point = ladder[target];
+    decision.hottestC = reading.hottestC;
+    decision.thermalHeadroomC = thermalHeadroomC(reading);
+    decision.freqCapRatio = reading.freqCapRatio;
+    decision.encodeHeadroom = headroom;
+
+    currentLevel = target;
+    lastChangeMs = nowMs;
+    pressureSinceMs = -1;
+    calmSinceMs = -1;
+    return true;
+}
+
+} // namespace orbistream
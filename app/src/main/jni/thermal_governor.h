@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * One thermal zone from /sys/class/thermal.
+ */
+struct ThermalZone {
+    std::string name;               // thermal_zoneN
+    std::string type;               // "cpu-1-0-usr", "skin-therm", "x86_pkg_temp", ...
+    double tempC = 0.0;
+    double tripC = 0.0;             // Lowest passive trip point, 0 = none
+};
+
+/**
+ * What the kernel says about sustained performance right now.
+ */
+struct ThermalReading {
+    std::vector<ThermalZone> zones;     // Zones with a plausible temperature
+    double hottestC = 0.0;
+    double freqCapRatio = 1.0;          // Min over online CPUs of scaling_max_freq / cpuinfo_max_freq
+    int cappedCpus = 0;                 // CPUs whose max frequency is held below their hardware max
+    bool available = false;             // Any zone or cpufreq file was readable
+};
+
+/**
+ * ThermalMonitor samples thermal zones and cpufreq limits from sysfs.
+ *
+ * Both roots can point at a fixture tree (see tools/thermal_governor_sim)
+ * laid out like the real one: thermalRoot/thermal_zoneN/{type,temp,
+ * trip_point_K_type,trip_point_K_temp} in millidegrees, and
+ * cpuRoot/cpuN/cpufreq/{scaling_max_freq,cpuinfo_max_freq} in kHz.
+ * Unreadable files are skipped, so SELinux-restricted zones just drop out.
+ */
+class ThermalMonitor {
+public:
+    explicit ThermalMonitor(const std::string& thermalRoot = "/sys/class/thermal",
+                            const std::string& cpuRoot = "/sys/devices/system/cpu");
+
+    ThermalReading read() const;
+
+private:
+    std::string thermalRoot;
+    std::string cpuRoot;
+};
+
+/**
+ * Encoder operating point. Preset is counted in steps faster than the
+ * configured x264 preset so the governor stays encoder-agnostic.
+ */
+struct OperatingPoint {
+    int width = 0;
+    int height = 0;
+    int frameRate = 0;
+    int presetSteps = 0;
+
+    bool operator==(const OperatingPoint& other) const {
+        return width == other.width && height == other.height &&
+               frameRate == other.frameRate && presetSteps == other.presetSteps;
+    }
+    bool operator!=(const OperatingPoint& other) const { return !(*this == other); }
+};
+
+/**
+ * Why the governor moved.
+ */
+enum class GovernorReason {
+    NONE,
+    THERMAL,            // A zone is at (or near) its passive trip point
+    CPU_FREQ_CAP,       // The kernel capped CPU frequencies and the encoder has little slack
+    ENCODE_HEADROOM,    // The encoder is close to missing frames
+    RECOVERED           // Everything calm for the hold time: step back up
+};
+
+const char* governorReasonName(GovernorReason reason);
+
+/**
+ * Thresholds and hold times. Stepping down reacts in seconds, stepping up
+ * needs a minute of calm and a much cooler reading, so the level does not
+ * oscillate around a trip point.
+ */
+struct GovernorConfig {
+    int intervalMs = 2000;              // Sampling period (SrtStreamer timer)
+    double tripMarginC = 5.0;           // Pressure within this of a passive trip point
+    double recoverMarginC = 12.0;       // Calm only this far below every trip point
+    double hotC = 75.0;                 // Zones without a trip point: pressure at or above
+    double coolC = 62.0;                // ... calm below
+    double freqCapDown = 0.85;          // Pressure below this cap ratio, unless headroom is at headroomUp
+    double freqCapUp = 0.95;            // Calm at or above
+    double headroomDown = 0.15;         // Pressure below this encode headroom
+    double headroomUp = 0.40;           // Calm at or above
+    int downHoldMs = 4000;              // Pressure must last this long
+    int downGapMs = 20000;              // Between steps down: time for one to show in the temperature
+    int upHoldMs = 60000;               // Calm must last this long (and between steps up)
+    int relapseMs = 300000;             // Pressure this soon after a step up doubles the next up hold
+    int minFrameRate = 15;
+    int minHeight = 360;
+    int maxPresetSteps = 2;
+};
+
+/**
+ * One level change, with the inputs that caused it.
+ */
+struct GovernorDecision {
+    int64_t timeMs = 0;                 // Caller's clock (stream time)
+    int fromLevel = 0;
+    int toLevel = 0;
+    GovernorReason reason = GovernorReason::NONE;
+    OperatingPoint point;               // In effect from now on
+    double hottestC = 0.0;
+    double thermalHeadroomC = 0.0;      // See ThermalGovernor::thermalHeadroomC()
+    double freqCapRatio = 1.0;
+    double encodeHeadroom = 1.0;
+};
+
+/**
+ * Encode-time headroom in 0..1: how far the encoder's capture-to-output
+ * latency is below the time it may take per frame. 0 while frames are
+ * being refused at admission.
+ */
+double encodeHeadroom(double encodeLatencyMs, double budgetMs, double admitRatio);
+
+/**
+ * ThermalGovernor keeps a stream at an operating point the device can
+ * sustain. Level 0 is the configured point; each level below it is one
+ * step of frame rate, resolution or preset, taken in turn (fps first, it
+ * is the cheapest change to apply and to watch). evaluate() moves one
+ * level at a time with hysteresis: down after downHoldMs of pressure (and
+ * downGapMs after the last step), up after upHoldMs of calm. Pressure
+ * within relapseMs of a step up doubles the next up hold (up to 8x, reset
+ * by any other step down), so a point the device can only just not
+ * sustain is not retried every minute. A frequency cap alone is not
+ * pressure while the encoder still has calm-level headroom: the cap is
+ * not caused by the stream, and stepping down would not lift it.
+ *
+ * Not thread-safe; SrtStreamer calls it from its dispatcher timer.
+ */
+class ThermalGovernor {
+public:
+    /**
+     * @param top configured operating point (level 0)
+     * @param presetRoom presets faster than the configured one (0 for the hardware encoder)
+     */
+    void configure(const GovernorConfig& config, const OperatingPoint& top, int presetRoom);
+
+    /**
+     * @param encodeHeadroom see encodeHeadroom()
+     * @return true if the level changed; decision describes the change
+     */
+    bool evaluate(int64_t nowMs, const ThermalReading& reading, double encodeHeadroom,
+                  GovernorDecision& decision);
+
+    /** Degrees between the closest zone and its step-down limit (negative past it). */
+    double thermalHeadroomC(const ThermalReading& reading) const;
+
+    int level() const { return currentLevel; }
+    int maxLevel() const { return static_cast<int>(ladder.size()) - 1; }
+    const OperatingPoint& current() const { return ladder[currentLevel]; }
+    const std::vector<OperatingPoint>& points() const { return ladder; }
+
+private:
+    GovernorReason pressure(const ThermalReading& reading, double headroom) const;
+    bool calm(const ThermalReading& reading, double headroom) const;
+
+    GovernorConfig config;
+    std::vector<OperatingPoint> ladder{OperatingPoint()};
+    int currentLevel = 0;
+    int64_t pressureSinceMs = -1;
+    int64_t calmSinceMs = -1;
+    int64_t lastChangeMs = -1;
+    int64_t lastStepUpMs = -1;
+    int upHoldScale = 1;
+};
+
+} // namespace orbistream
@@ -0,0 +1,281 @@
+#include "thread_placement.h"
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define LOG_TAG "ThreadPlacement"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGW(...) ORBI_LOG(WARN, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+
+std::atomic<uint64_t> g_nextToken{1};
+thread_local uint64_t t_appliedToken = 0;
+
+bool readInt64(const std::string& path, int64_t& value) {
+    std::ifstream in(path);
+    if (!in) return false;
+    in >> value;
+    return !in.fail();
+}
+
+std::string readLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+int currentTid() {
+    return static_cast<int>(syscall(SYS_gettid));
+}
+
+// Android THREAD_PRIORITY_* equivalents (nice values)
+int niceForRole(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::CAPTURE: return -4;    // THREAD_PRIORITY_DISPLAY
+        case ThreadRole::AUDIO: return -16;     // THREAD_PRIORITY_AUDIO
+        case ThreadRole::ENCODE: return -4;
+        case ThreadRole::SEND: return -8;       // THREAD_PRIORITY_URGENT_DISPLAY
+        case ThreadRole::MAIN_LOOP: return 0;
+        default: return 0;
+    }
+}
+
+} // namespace
+
+CpuTopology CpuTopology::read(const std::string& sysfsRoot) {
+    CpuTopology topo;
+
+    DIR* dir = opendir(sysfsRoot.c_str());
+    if (!dir) {
+        LOGW("Cannot open %s - assuming a single symmetric cluster", sysfsRoot.c_str());
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        for (int i = 0; i < std::max(1L, n); i++) {
+            CpuInfo cpu;
+            cpu.id = i;
+            cpu.capacity = 1024;
+            topo.cpus.push_back(cpu);
+            topo.bigCpus.push_back(i);
+        }
+        return topo;
+    }
+
+    while (dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (strncmp(name, "cpu", 3) != 0 || name[3] < '0' || name[3] > '9') continue;
+
+        CpuInfo cpu;
+        cpu.id = atoi(name + 3);
+        std::string base = sysfsRoot + "/" + name;
+
+        int64_t value = 0;
+        if (readInt64(base + "/online", value)) cpu.online = value != 0;  // cpu0 has no file
+        if (readInt64(base + "/cpu_capacity", value)) cpu.capacity = static_cast<int>(value);
+        if (readInt64(base + "/cpufreq/cpuinfo_max_freq", value)) cpu.maxFreqKhz = value;
+        if (readInt64(base + "/topology/cluster_id", value) ||
+            readInt64(base + "/topology/physical_package_id", value)) {
+            cpu.cluster = static_cast<int>(value);
+        }
+        topo.cpus.push_back(cpu);
+    }
+    closedir(dir);
+
+    std::sort(topo.cpus.begin(), topo.cpus.end(),
+              [](const CpuInfo& a, const CpuInfo& b) { return a.id < b.id; });
+
+    // Kernels without cpu_capacity: derive it from the max frequency
+    int64_t maxFreq = 0;
+    for (const auto& cpu : topo.cpus) maxFreq = std::max(maxFreq, cpu.maxFreqKhz);
+    for (auto& cpu : topo.cpus) {
+        if (cpu.capacity == 0) {
+            cpu.capacity = maxFreq > 0 && cpu.maxFreqKhz > 0
+                ? static_cast<int>(cpu.maxFreqKhz * 1024 / maxFreq) : 1024;
+        }
+    }
+
+    int maxCapacity = 0;
+    for (const auto& cpu : topo.cpus) {
+        if (cpu.online) maxCapacity = std::max(maxCapacity, cpu.capacity);
+    }
+    for (const auto& cpu : topo.cpus) {
+        if (!cpu.online) continue;
+        if (cpu.capacity * 10 >= maxCapacity * 8) {
+            topo.bigCpus.push_back(cpu.id);
+        } else {
+            topo.littleCpus.push_back(cpu.id);
+        }
+    }
+    topo.heterogeneous = !topo.littleCpus.empty();
+
+    LOGI("CPU topology: %zu cpus, %zu big, %zu little%s",
+         topo.cpus.size(), topo.bigCpus.size(), topo.littleCpus.size(),
+         topo.heterogeneous ? " (heterogeneous)" : "");
+    return topo;
+}
+
+int CpuTopology::recommendedEncoderThreads() const {
+    int threads;
+    if (heterogeneous) {
+        threads = static_cast<int>(bigCpus.size());
+    } else {
+        threads = static_cast<int>(bigCpus.size()) - 1;  // Leave a core for capture/send
+    }
+    return std::max(1, std::min(threads, 4));
+}
+
+ThreadPlacer::ThreadPlacer() : token(g_nextToken++) {}
+
+void ThreadPlacer::configure(ThreadPolicy newPolicy, const CpuTopology& newTopology) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = newPolicy;
+    topology = newTopology;
+    token = g_nextToken++;
+    registered.clear();
+}
+
+void ThreadPlacer::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    token = g_nextToken++;
+    registered.clear();
+}
+
+const char* ThreadPlacer::roleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::CAPTURE: return "capture";
+        case ThreadRole::AUDIO: return "audio";
+        case ThreadRole::ENCODE: return "encode";
+        case ThreadRole::SEND: return "send";
+        case ThreadRole::MAIN_LOOP: return "main_loop";
+        default: return "unknown";
+    }
+}
+
+void ThreadPlacer::applyOnce(ThreadRole role) {
+    // Racy read of token is fine: worst case the policy is applied twice
+    if (t_appliedToken == token) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    t_appliedToken = token;
+
+    // A thread serving several sessions (the shared main loop) alternates
+    // between their placers' tokens; register it once per placer
+    int tid = currentTid();
+    for (const ThreadCpuTime& existing : registered) {
+        if (existing.tid == tid) return;
+    }
+    ThreadCpuTime entry;
+    entry.tid = tid;
+    entry.role = role;
+    entry.name = readLine("/proc/self/task/" + std::to_string(tid) + "/comm");
+    registered.push_back(entry);
+
+    apply(role, tid);
+}
+
+void ThreadPlacer::apply(ThreadRole role, int tid) {
+    if (policy == ThreadPolicy::SYSTEM) return;
+
+    int nice = niceForRole(role);
+    if (nice != 0 && setpriority(PRIO_PROCESS, tid, nice) != 0) {
+        LOGW("setpriority(%s tid=%d, %d) failed: %s", roleName(role), tid, nice, strerror(errno));
+    }
+
+    if (policy != ThreadPolicy::PIN_BIG || !topology.heterogeneous) {
+        LOGI("Thread %d (%s): nice=%d", tid, roleName(role), nice);
+        return;
+    }
+
+    // Encode owns the big cores; main loop stays on little; the rest may float
+    const std::vector<int>* cpus = nullptr;
+    std::vector<int> all;
+    switch (role) {
+        case ThreadRole::ENCODE:
+            cpus = &topology.bigCpus;
+            break;
+        case ThreadRole::MAIN_LOOP:
+            cpus = &topology.littleCpus;
+            break;
+        default:
+            for (const auto& cpu : topology.cpus) {
+                if (cpu.online) all.push_back(cpu.id);
+            }
+            cpus = &all;
+            break;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : *cpus) CPU_SET(cpu, &set);
+    if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+        LOGW("sched_setaffinity(%s tid=%d) failed: %s", roleName(role), tid, strerror(errno));
+    }
+    LOGI("Thread %d (%s): nice=%d, %zu cpus", tid, roleName(role), nice, cpus->size());
+}
+
+std::vector<ThreadCpuTime> ThreadPlacer::sampleCpuTimes() const {
+    std::vector<ThreadCpuTime> known;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        known = registered;
+    }
+    std::vector<ThreadCpuTime> result;
+    if (known.empty()) return result;
+
+    static const double msPerTick = 1000.0 / sysconf(_SC_CLK_TCK);
+
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) return result;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+        int tid = atoi(entry->d_name);
+        std::string base = std::string("/proc/self/task/") + entry->d_name;
+        std::string comm = readLine(base + "/comm");
+
+        // Registered thread, or a worker that inherited a registered thread's name
+        const ThreadCpuTime* owner = nullptr;
+        for (const auto& k : known) {
+            if (k.tid == tid) { owner = &k; break; }
+        }
+        if (!owner) {
+            for (const auto& k : known) {
+                if (!k.name.empty() && k.name == comm) { owner = &k; break; }
+            }
+        }
+        if (!owner) continue;
+
+        // Fields after "(comm)": state ppid ... utime(14) stime(15)
+        std::string stat = readLine(base + "/stat");
+        size_t paren = stat.rfind(')');
+        if (paren == std::string::npos) continue;
+        unsigned long utime = 0, stime = 0;
+        if (sscanf(stat.c_str() + paren + 2,
+                   "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                   &utime, &stime) != 2) {
+            continue;
+        }
+
+        ThreadCpuTime t;
+        t.tid = tid;
+        t.role = owner->role;
+        t.name = comm;
+        t.cpuMs = (utime + stime) * msPerTick;
+        result.push_back(t);
+    }
+    closedir(dir);
+    return result;
+}
+
+} // namespace orbistream
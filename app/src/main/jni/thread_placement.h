@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace orbistream {
+
+/**
+ * Thread placement policy for the capture, encode and send threads.
+ *
+ * - SYSTEM: leave placement and priority to the kernel
+ * - PRIORITIZE: raise thread priorities, no affinity
+ * - PIN_BIG: raise priorities and pin encoding to the big cores,
+ *   keeping the bus/main loop on the little cores
+ */
+enum class ThreadPolicy {
+    SYSTEM,
+    PRIORITIZE,
+    PIN_BIG
+};
+
+/**
+ * Role of a pipeline thread.
+ */
+enum class ThreadRole {
+    CAPTURE,    // JNI thread pushing camera frames
+    AUDIO,      // JNI thread pushing microphone samples, audio encode
+    ENCODE,     // Video convert/scale/encode streaming thread (encoder workers inherit)
+    SEND,       // Sink streaming thread, pacer thread
+    MAIN_LOOP   // GMainLoop / bus dispatch
+};
+
+/**
+ * One logical CPU as read from sysfs.
+ */
+struct CpuInfo {
+    int id = 0;
+    int capacity = 0;       // cpu_capacity (1024 = biggest), or derived from max freq
+    int64_t maxFreqKhz = 0;
+    int cluster = 0;
+    bool online = true;
+};
+
+/**
+ * CPU topology of the device.
+ */
+struct CpuTopology {
+    std::vector<CpuInfo> cpus;
+    std::vector<int> bigCpus;       // Capacity >= 80% of the maximum
+    std::vector<int> littleCpus;    // Everything else
+    bool heterogeneous = false;     // big.LITTLE / DynamIQ
+
+    /**
+     * Read topology from sysfs. The root can point at a fixture
+     * directory with the same layout for host testing.
+     */
+    static CpuTopology read(const std::string& sysfsRoot = "/sys/devices/system/cpu");
+
+    /**
+     * Encoder thread count suited to this topology: one per big core on
+     * heterogeneous SoCs, all but one core on symmetric ones, capped at 4.
+     */
+    int recommendedEncoderThreads() const;
+};
+
+/**
+ * CPU time consumed by one thread.
+ */
+struct ThreadCpuTime {
+    int tid = 0;
+    ThreadRole role = ThreadRole::CAPTURE;
+    std::string name;       // comm
+    double cpuMs = 0.0;     // utime + stime
+};
+
+/**
+ * ThreadPlacer applies the placement policy to pipeline threads as they
+ * first show up in a role, and accounts their CPU time.
+ *
+ * Threads are registered lazily with applyOnce() from the hot path
+ * (a thread-local check makes repeat calls free). Threads spawned later
+ * by a registered thread - such as x264 worker threads - inherit its
+ * affinity and are attributed to the same role by name.
+ */
+class ThreadPlacer {
+public:
+    ThreadPlacer();
+
+    void configure(ThreadPolicy policy, const CpuTopology& topology);
+
+    /**
+     * Apply the policy for `role` to the calling thread, once per thread.
+     */
+    void applyOnce(ThreadRole role);
+
+    /**
+     * CPU time of registered threads and of threads sharing their names.
+     */
+    std::vector<ThreadCpuTime> sampleCpuTimes() const;
+
+    /**
+     * Forget registered threads (e.g. when the pipeline is rebuilt).
+     */
+    void reset();
+
+    static const char* roleName(ThreadRole role);
+
+private:
+    void apply(ThreadRole role, int tid);
+
+    ThreadPolicy policy = ThreadPolicy::SYSTEM;
+    CpuTopology topology;
+    uint64_t token;         // Distinguishes placers/generations in the thread-local check
+
+    mutable std::mutex mutex;
+    std::vector<ThreadCpuTime> registered;
+};
+
+} // namespace orbistream
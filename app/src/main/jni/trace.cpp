@@ -0,0 +1,267 @@
+#include "trace.h"
+#include "logger.h"
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_TAG "Trace"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+namespace trace {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* step;        // Async step label
+    int64_t tsNs;
+    int64_t durNs;
+    int64_t value;           // Slice/instant/counter value, async id
+    char phase;              // Chrome trace phase: X i C b n e
+};
+
+// One per thread that traced; never freed, so a writer can always touch it.
+// A buffer whose thread exited is handed to a new thread once it is empty.
+struct ThreadBuffer {
+    int tid = 0;
+    char threadName[16] = {};
+    std::unique_ptr<Event[]> events;
+    size_t capacity = 0;
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+    std::atomic<bool> busy{false};     // Writer inside record()
+    std::atomic<bool> owned{false};
+};
+
+std::mutex registryMutex;              // buffers, eventsPerThread
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+size_t eventsPerThread = kDefaultEventsPerThread;
+
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadSlot() {
+        if (buffer) buffer->owned.store(false, std::memory_order_release);
+    }
+};
+thread_local ThreadSlot threadSlot;
+
+ThreadBuffer* claimBuffer() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ThreadBuffer* buffer = nullptr;
+    for (auto& candidate : buffers) {
+        if (!candidate->owned.load(std::memory_order_acquire) &&
+            candidate->count.load(std::memory_order_relaxed) == 0) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+    }
+    if (buffer->capacity != eventsPerThread) {
+        buffer->events = std::make_unique<Event[]>(eventsPerThread);
+        buffer->capacity = eventsPerThread;
+    }
+    buffer->owned.store(true, std::memory_order_relaxed);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+    buffer->tid = static_cast<int>(syscall(SYS_gettid));
+    memset(buffer->threadName, 0, sizeof(buffer->threadName));
+    prctl(PR_GET_NAME, buffer->threadName, 0, 0, 0);
+    return buffer;
+}
+
+void record(char phase, const char* name, const char* step,
+            int64_t tsNs, int64_t durNs, int64_t value) {
+    if (!detail::enabled.load(std::memory_order_relaxed)) return;
+    ThreadBuffer* buffer = threadSlot.buffer;
+    if (!buffer) {
+        buffer = claimBuffer();
+        threadSlot.buffer = buffer;
+    }
+
+    // stop()/start() clear enabled, then wait for busy to drop before
+    // touching buffers; the re-check closes the window in between
+    buffer->busy.store(true, std::memory_order_seq_cst);
+    if (!detail::enabled.load(std::memory_order_seq_cst)) {
+        buffer->busy.store(false, std::memory_order_release);
+        return;
+    }
+    size_t n = buffer->count.load(std::memory_order_relaxed);
+    if (n < buffer->capacity) {
+        buffer->events[n] = Event{name, step, tsNs, durNs, value, phase};
+        buffer->count.store(n + 1, std::memory_order_release);
+    } else {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    buffer->busy.store(false, std::memory_order_release);
+}
+
+// Caller holds registryMutex and has cleared enabled
+void waitForWriters() {
+    for (auto& buffer : buffers) {
+        while (buffer->busy.load(std::memory_order_seq_cst)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void writeEscaped(FILE* file, const char* s) {
+    for (; *s; s++) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') fprintf(file, "\\%c", c);
+        else if (c < 0x20) fprintf(file, "\\u%04x", c);
+        else fputc(c, file);
+    }
+}
+
+} // namespace
+
+int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void start(size_t events) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    detail::enabled.store(false, std::memory_order_seq_cst);
+    waitForWriters();
+    eventsPerThread = events > 0 ? events : kDefaultEventsPerThread;
+    for (auto& buffer : buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        if (buffer->owned.load(std::memory_order_acquire) && buffer->capacity != eventsPerThread) {
+            buffer->events = std::make_unique<Event[]>(eventsPerThread);
+            buffer->capacity = eventsPerThread;
+        }
+    }
+    detail::enabled.store(true, std::memory_order_seq_cst);
+    LOGI("Tracing started (%zu events per thread)", eventsPerThread);
+}
+
+void stop() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!detail::enabled.load(std::memory_order_relaxed)) return;
+    detail::enabled.store(false, std::memory_order_seq_cst);
+    waitForWriters();
+    LOGI("Tracing stopped");
+}
+
+size_t eventCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    size_t total = 0;
+    for (auto& buffer : buffers) total += buffer->count.load(std::memory_order_acquire);
+    return total;
+}
+
+size_t droppedEvents() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    size_t total = 0;
+    for (auto& buffer : buffers) total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+void complete(const char* name, int64_t startNs, int64_t endNs, int64_t value) {
+    record('X', name, nullptr, startNs, endNs - startNs, value);
+}
+
+void instant(const char* name, int64_t value) {
+    record('i', name, nullptr, nowNs(), 0, value);
+}
+
+void counter(const char* name, int64_t value) {
+    record('C', name, nullptr, nowNs(), 0, value);
+}
+
+void asyncBegin(const char* name, uint64_t id) {
+    record('b', name, nullptr, nowNs(), 0, static_cast<int64_t>(id));
+}
+
+void asyncStep(const char* name, uint64_t id, const char* step) {
+    record('n', name, step, nowNs(), 0, static_cast<int64_t>(id));
+}
+
+void asyncEnd(const char* name, uint64_t id) {
+    record('e', name, nullptr, nowNs(), 0, static_cast<int64_t>(id));
+}
+
+// Events below count are immutable until the next start(), so this can run
+// while capture continues
+bool writeChromeJson(const std::string& path) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        LOGE("Cannot write %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    const int pid = static_cast<int>(getpid());
+    size_t written = 0;
+    size_t dropped = 0;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (auto& buffer : buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+        if (count == 0) continue;
+
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+                first ? "" : ",", pid, buffer->tid);
+        writeEscaped(file, buffer->threadName);
+        fprintf(file, "\"}}");
+        first = false;
+
+        for (size_t i = 0; i < count; i++) {
+            const Event& e = buffer->events[i];
+            double tsUs = e.tsNs / 1000.0;
+            fprintf(file, ",\n{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,", e.phase, pid, buffer->tid, tsUs);
+            switch (e.phase) {
+                case 'X':
+                    fprintf(file, "\"name\":\"%s\",\"dur\":%.3f,\"args\":{\"value\":%" PRId64 "}}",
+                            e.name, e.durNs / 1000.0, e.value);
+                    break;
+                case 'i':
+                    fprintf(file, "\"name\":\"%s\",\"s\":\"t\",\"args\":{\"value\":%" PRId64 "}}",
+                            e.name, e.value);
+                    break;
+                case 'C':
+                    fprintf(file, "\"name\":\"%s\",\"args\":{\"value\":%" PRId64 "}}", e.name, e.value);
+                    break;
+                default:
+                    // Async events pair up by category and id; steps are labelled
+                    fprintf(file, "\"name\":\"%s\",\"cat\":\"%s\",\"id\":\"0x%" PRIx64 "\"}",
+                            e.step ? e.step : e.name, e.name, static_cast<uint64_t>(e.value));
+                    break;
+            }
+        }
+        written += count;
+    }
+    fprintf(file, "\n]}\n");
+    bool ok = fclose(file) == 0;
+    if (ok) {
+        LOGI("Wrote %zu trace events (%zu dropped) to %s", written, dropped, path.c_str());
+    } else {
+        LOGE("Short write to %s", path.c_str());
+    }
+    return ok;
+}
+
+} // namespace trace
+} // namespace orbistream
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Build with -DORBISTREAM_TRACING=0 to compile every TRACE_* macro out
+#ifndef ORBISTREAM_TRACING
+#define ORBISTREAM_TRACING 1
+#endif
+
+namespace orbistream {
+namespace trace {
+
+/**
+ * Timeline tracing of pipeline stages, exported as Chrome trace JSON
+ * (chrome://tracing, ui.perfetto.dev).
+ *
+ * Each thread records into its own fixed buffer, allocated the first time it
+ * traces while capture is on; recording is a few relaxed stores and never
+ * takes a lock. A full buffer stops recording for that thread (counted in
+ * droppedEvents()) rather than overwriting, so everything captured since
+ * start() stays readable while capture continues.
+ *
+ * Event names must be string literals (only the pointer is stored).
+ */
+
+constexpr size_t kDefaultEventsPerThread = 32768;
+
+/** Clear all buffers and start capturing. */
+void start(size_t eventsPerThread = kDefaultEventsPerThread);
+
+/** Stop capturing; captured events stay until the next start(). */
+void stop();
+
+/** Write the captured events as Chrome trace JSON. */
+bool writeChromeJson(const std::string& path);
+
+size_t eventCount();
+size_t droppedEvents();
+
+int64_t nowNs();
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+inline bool isEnabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+void complete(const char* name, int64_t startNs, int64_t endNs, int64_t value);
+void instant(const char* name, int64_t value);
+void counter(const char* name, int64_t value);
+// Async slices: one row per id, across threads (e.g. a frame by its PTS)
+void asyncBegin(const char* name, uint64_t id);
+void asyncStep(const char* name, uint64_t id, const char* step);
+void asyncEnd(const char* name, uint64_t id);
+
+/**
+ * Records a complete slice from construction to destruction.
+ */
+class Scope {
+public:
+    explicit Scope(const char* eventName, int64_t eventValue = 0)
+        : name(isEnabled() ? eventName : nullptr), value(eventValue),
+          startNs(name ? nowNs() : 0) {}
+    ~Scope() {
+        if (name) complete(name, startNs, nowNs(), value);
+    }
+    void setValue(int64_t v) { value = v; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    int64_t value;
+    int64_t startNs;
+};
+
+} // namespace trace
+} // namespace orbistream
+
+#define ORBISTREAM_TRACE_CONCAT2(a, b) a##b
+#define ORBISTREAM_TRACE_CONCAT(a, b) ORBISTREAM_TRACE_CONCAT2(a, b)
+
+#if ORBISTREAM_TRACING
+#define TRACE_SCOPE(name) \
+    ::orbistream::trace::Scope ORBISTREAM_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_SCOPE_VALUE(name, value) \
+    ::orbistream::trace::Scope ORBISTREAM_TRACE_CONCAT(traceScope_, __LINE__)(name, value)
+#define TRACE_INSTANT(name, value) \
+    do { if (::orbistream::trace::isEnabled()) ::orbistream::trace::instant(name, value); } while (0)
+#define TRACE_COUNTER(name, value) \
+    do { if (::orbistream::trace::isEnabled()) ::orbistream::trace::counter(name, value); } while (0)
+#define TRACE_ASYNC_BEGIN(name, id) \
+    do { if (::orbistream::trace::isEnabled()) ::orbistream::trace::asyncBegin(name, id); } while (0)
+#define TRACE_ASYNC_STEP(name, id, step) \
+    do { if (::orbistream::trace::isEnabled()) ::orbistream::trace::asyncStep(name, id, step); } while (0)
+#define TRACE_ASYNC_END(name, id) \
+    do { if (::orbistream::trace::isEnabled()) ::orbistream::trace::asyncEnd(name, id); } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_SCOPE_VALUE(name, value) do {} while (0)
+#define TRACE_INSTANT(name, value) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_ASYNC_BEGIN(name, id) do {} while (0)
+#define TRACE_ASYNC_STEP(name, id, step) do {} while (0)
+#define TRACE_ASYNC_END(name, id) do {} while (0)
+#endif
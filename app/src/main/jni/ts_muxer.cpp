@@ -0,0 +1,498 @@
+#include "ts_muxer.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#define LOG_TAG "TsMuxer"
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+
+namespace orbistream {
+
+namespace {
+
+constexpr uint8_t kStreamTypeH264 = 0x1B;
+constexpr uint8_t kStreamTypeH265 = 0x24;
+constexpr uint8_t kStreamTypeAdtsAac = 0x0F;
+constexpr uint8_t kStreamTypePrivatePes = 0x06;  // Opus
+
+constexpr uint8_t kStreamIdVideo = 0xE0;
+constexpr uint8_t kStreamIdAudio = 0xC0;
+constexpr uint8_t kStreamIdPrivate1 = 0xBD;      // Opus
+
+constexpr int64_t kTimestampMask = (int64_t(1) << 33) - 1;
+
+// Access unit delimiters prepended when the encoder did not emit one
+const uint8_t kH264Aud[] = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0};
+const uint8_t kH265Aud[] = {0x00, 0x00, 0x00, 0x01, 0x46, 0x01, 0x50};
+
+// CRC-32/MPEG-2 (poly 0x04C11DB7, no reflection, no final xor)
+struct Crc32Table {
+    uint32_t table[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i << 24;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : (crc << 1);
+            }
+            table[i] = crc;
+        }
+    }
+};
+
+uint32_t crc32Mpeg(const uint8_t* data, size_t size) {
+    static const Crc32Table crcTable;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 8) ^ crcTable.table[((crc >> 24) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+void putCrc(uint8_t* out, size_t sectionSize) {
+    uint32_t crc = crc32Mpeg(out, sectionSize);
+    out[sectionSize + 0] = static_cast<uint8_t>(crc >> 24);
+    out[sectionSize + 1] = static_cast<uint8_t>(crc >> 16);
+    out[sectionSize + 2] = static_cast<uint8_t>(crc >> 8);
+    out[sectionSize + 3] = static_cast<uint8_t>(crc);
+}
+
+// ns -> 90 kHz without overflowing int64 for large running times
+int64_t nsTo90k(int64_t ns) {
+    if (ns < 0) ns = 0;
+    return ((ns / 100000) * 9 + ((ns % 100000) * 9) / 100000) & kTimestampMask;
+}
+
+void putTimestamp(uint8_t* out, uint8_t prefix, int64_t ts) {
+    out[0] = static_cast<uint8_t>(prefix | ((ts >> 29) & 0x0E) | 0x01);
+    out[1] = static_cast<uint8_t>(ts >> 22);
+    out[2] = static_cast<uint8_t>(((ts >> 14) & 0xFE) | 0x01);
+    out[3] = static_cast<uint8_t>(ts >> 7);
+    out[4] = static_cast<uint8_t>(((ts << 1) & 0xFE) | 0x01);
+}
+
+void putPcr(uint8_t* out, int64_t pcr27) {
+    int64_t base = (pcr27 / 300) & kTimestampMask;
+    int64_t ext = pcr27 % 300;
+    out[0] = static_cast<uint8_t>(base >> 25);
+    out[1] = static_cast<uint8_t>(base >> 17);
+    out[2] = static_cast<uint8_t>(base >> 9);
+    out[3] = static_cast<uint8_t>(base >> 1);
+    out[4] = static_cast<uint8_t>(((base & 0x01) << 7) | 0x7E | ((ext >> 8) & 0x01));
+    out[5] = static_cast<uint8_t>(ext);
+}
+
+// Returns the NAL header offset of the first NAL unit, or 0 if no start code
+size_t firstNalOffset(const uint8_t* data, size_t size) {
+    if (size >= 4 && data[0] == 0 && data[1] == 0 && data[2] == 0 && data[3] == 1) return 4;
+    if (size >= 3 && data[0] == 0 && data[1] == 0 && data[2] == 1) return 3;
+    return 0;
+}
+
+bool startsWithAud(VideoCodec codec, const uint8_t* data, size_t size) {
+    size_t hdr = firstNalOffset(data, size);
+    if (hdr == 0 || hdr >= size) return false;
+    if (codec == VideoCodec::H264) {
+        return (data[hdr] & 0x1F) == 9;
+    }
+    return ((data[hdr] >> 1) & 0x3F) == 35;
+}
+
+} // namespace
+
+TsMuxer::TsMuxer(const TsMuxerConfig& config, DatagramCallback callback)
+    : config(config), callback(std::move(callback)) {
+    LOGI("TS muxer: video=%s audio=%s psi=%dms pcr=%dms delay=%dms",
+         config.videoCodec == VideoCodec::H264 ? "h264" : "h265",
+         !config.hasAudio ? "none" : (config.audioCodec == AudioCodec::AAC ? "aac" : "opus"),
+         config.psiIntervalMs, config.pcrIntervalMs, config.pcrDelayMs);
+}
+
+int64_t TsMuxer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t TsMuxer::pcr27MHzAt(int64_t now) const {
+    int64_t ns = anchorDtsNs + (now - anchorWallNs);
+    if (ns < 0) ns = 0;
+    return (ns / 1000) * 27 + ((ns % 1000) * 27) / 1000;
+}
+
+bool TsMuxer::pcrDueLocked(int64_t now) const {
+    return lastPcrNs < 0 ||
+           (now - lastPcrNs) >= static_cast<int64_t>(config.pcrIntervalMs) * 1000000;
+}
+
+void TsMuxer::writeVideo(const uint8_t* data, size_t size,
+                         int64_t ptsNs, int64_t dtsNs, bool keyframe) {
+    if (!data || size == 0) return;
+    if (dtsNs < 0) dtsNs = ptsNs;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t now = nowNs();
+
+    if (!anchored) {
+        anchorDtsNs = dtsNs;
+        anchorWallNs = now;
+        anchored = true;
+    }
+
+    if (keyframe || lastPsiNs < 0 ||
+        (now - lastPsiNs) >= static_cast<int64_t>(config.psiIntervalMs) * 1000000) {
+        writePsiLocked(now);
+    }
+
+    int64_t delayNs = static_cast<int64_t>(config.pcrDelayMs) * 1000000;
+    int64_t pts90k = nsTo90k(ptsNs + delayNs);
+    int64_t dts90k = nsTo90k(dtsNs + delayNs);
+
+    Segment segments[2];
+    size_t segmentCount = 0;
+    if (!startsWithAud(config.videoCodec, data, size)) {
+        if (config.videoCodec == VideoCodec::H264) {
+            segments[segmentCount++] = {kH264Aud, sizeof(kH264Aud)};
+        } else {
+            segments[segmentCount++] = {kH265Aud, sizeof(kH265Aud)};
+        }
+    }
+    segments[segmentCount++] = {data, size};
+
+    size_t payloadSize = 0;
+    for (size_t i = 0; i < segmentCount; i++) payloadSize += segments[i].size;
+
+    uint8_t header[19];
+    // Video PES length is left unbounded (0) - AUs routinely exceed 64 KiB
+    size_t headerSize = buildPesHeader(header, kStreamIdVideo, payloadSize,
+                                       pts90k, dts90k != pts90k ? dts90k : -1, false);
+
+    bool withPcr = keyframe || pcrDueLocked(now);
+    writePesLocked(kVideoPid, videoCc, header, headerSize, segments, segmentCount,
+                   keyframe, withPcr, now);
+    stats.videoAccessUnits++;
+
+    if (config.flushPerAccessUnit) {
+        flushLocked();
+    }
+}
+
+void TsMuxer::writeAudio(const uint8_t* data, size_t size, int64_t ptsNs) {
+    if (!config.hasAudio || !data || size == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t now = nowNs();
+
+    if (!anchored) {
+        anchorDtsNs = ptsNs;
+        anchorWallNs = now;
+        anchored = true;
+    }
+
+    if (lastPsiNs < 0 ||
+        (now - lastPsiNs) >= static_cast<int64_t>(config.psiIntervalMs) * 1000000) {
+        writePsiLocked(now);
+    }
+
+    // Keep PCR flowing on the video PID when video is sparse or stalled
+    if (pcrDueLocked(now)) {
+        writePcrOnlyLocked(now);
+    }
+
+    int64_t pts90k = nsTo90k(ptsNs + static_cast<int64_t>(config.pcrDelayMs) * 1000000);
+
+    Segment segments[2];
+    size_t segmentCount = 0;
+    uint8_t opusHeader[2 + 32];
+    uint8_t streamId = kStreamIdAudio;
+
+    if (config.audioCodec == AudioCodec::OPUS) {
+        // ETSI TS 102 366 style Opus control header: 0x7FE0 + au_size
+        size_t n = 0;
+        opusHeader[n++] = 0x7F;
+        opusHeader[n++] = 0xE0;
+        size_t remaining = size;
+        while (remaining >= 255 && n < sizeof(opusHeader) - 1) {
+            opusHeader[n++] = 0xFF;
+            remaining -= 255;
+        }
+        opusHeader[n++] = static_cast<uint8_t>(remaining);
+        segments[segmentCount++] = {opusHeader, n};
+        streamId = kStreamIdPrivate1;
+    }
+    segments[segmentCount++] = {data, size};
+
+    size_t payloadSize = 0;
+    for (size_t i = 0; i < segmentCount; i++) payloadSize += segments[i].size;
+
+    uint8_t header[19];
+    size_t headerSize = buildPesHeader(header, streamId, payloadSize, pts90k, -1, true);
+
+    writePesLocked(kAudioPid, audioCc, header, headerSize, segments, segmentCount,
+                   false, false, now);
+    stats.audioAccessUnits++;
+
+    if (config.flushPerAccessUnit) {
+        flushLocked();
+    }
+}
+
+void TsMuxer::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+void TsMuxer::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    datagramPackets = 0;
+    patCc = pmtCc = videoCc = audioCc = 0;
+    anchored = false;
+    anchorDtsNs = 0;
+    anchorWallNs = 0;
+    lastPsiNs = -1;
+    lastPcrNs = -1;
+    stats = TsMuxerStats{};
+}
+
+TsMuxerStats TsMuxer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+uint8_t* TsMuxer::nextPacketLocked() {
+    if (datagramPackets == kPacketsPerDatagram) {
+        flushLocked();
+    }
+    uint8_t* pkt = datagram.data() + datagramPackets * kPacketSize;
+    datagramPackets++;
+    stats.tsPackets++;
+    return pkt;
+}
+
+void TsMuxer::flushLocked() {
+    if (datagramPackets == 0) return;
+    if (callback) {
+        callback(datagram.data(), datagramPackets * kPacketSize);
+    }
+    stats.datagrams++;
+    datagramPackets = 0;
+}
+
+size_t TsMuxer::buildPmt(uint8_t* out) const {
+    size_t n = 0;
+    out[n++] = 0x02;                 // table_id: program_map_section
+    out[n++] = 0xB0;                 // section_syntax_indicator + length (patched below)
+    out[n++] = 0x00;
+    out[n++] = 0x00;                 // program_number = 1
+    out[n++] = 0x01;
+    out[n++] = 0xC1;                 // version 0, current_next 1
+    out[n++] = 0x00;                 // section_number
+    out[n++] = 0x00;                 // last_section_number
+    out[n++] = static_cast<uint8_t>(0xE0 | (kVideoPid >> 8));  // PCR PID
+    out[n++] = static_cast<uint8_t>(kVideoPid & 0xFF);
+    out[n++] = 0xF0;                 // program_info_length = 0
+    out[n++] = 0x00;
+
+    out[n++] = config.videoCodec == VideoCodec::H264 ? kStreamTypeH264 : kStreamTypeH265;
+    out[n++] = static_cast<uint8_t>(0xE0 | (kVideoPid >> 8));
+    out[n++] = static_cast<uint8_t>(kVideoPid & 0xFF);
+    out[n++] = 0xF0;                 // ES_info_length = 0
+    out[n++] = 0x00;
+
+    if (config.hasAudio) {
+        if (config.audioCodec == AudioCodec::AAC) {
+            out[n++] = kStreamTypeAdtsAac;
+            out[n++] = static_cast<uint8_t>(0xE0 | (kAudioPid >> 8));
+            out[n++] = static_cast<uint8_t>(kAudioPid & 0xFF);
+            out[n++] = 0xF0;
+            out[n++] = 0x00;
+        } else {
+            out[n++] = kStreamTypePrivatePes;
+            out[n++] = static_cast<uint8_t>(0xE0 | (kAudioPid >> 8));
+            out[n++] = static_cast<uint8_t>(kAudioPid & 0xFF);
+            out[n++] = 0xF0;
+            out[n++] = 10;           // ES_info_length
+            // registration_descriptor 'Opus'
+            out[n++] = 0x05;
+            out[n++] = 0x04;
+            out[n++] = 'O';
+            out[n++] = 'p';
+            out[n++] = 'u';
+            out[n++] = 's';
+            // extension_descriptor: opus_audio_descriptor
+            out[n++] = 0x7F;
+            out[n++] = 0x02;
+            out[n++] = 0x80;
+            out[n++] = static_cast<uint8_t>(std::max(1, std::min(config.audioChannels, 8)));
+        }
+    }
+
+    size_t sectionLength = n - 3 + 4;  // bytes after the length field, including CRC
+    out[1] = static_cast<uint8_t>(0xB0 | ((sectionLength >> 8) & 0x0F));
+    out[2] = static_cast<uint8_t>(sectionLength & 0xFF);
+    putCrc(out, n);
+    return n + 4;
+}
+
+void TsMuxer::writePsiLocked(int64_t now) {
+    uint8_t pat[16];
+    size_t n = 0;
+    pat[n++] = 0x00;                 // table_id: program_association_section
+    pat[n++] = 0xB0;
+    pat[n++] = 13;                   // section_length
+    pat[n++] = 0x00;                 // transport_stream_id = 1
+    pat[n++] = 0x01;
+    pat[n++] = 0xC1;
+    pat[n++] = 0x00;
+    pat[n++] = 0x00;
+    pat[n++] = 0x00;                 // program_number = 1
+    pat[n++] = 0x01;
+    pat[n++] = static_cast<uint8_t>(0xE0 | (kPmtPid >> 8));
+    pat[n++] = static_cast<uint8_t>(kPmtPid & 0xFF);
+    putCrc(pat, n);
+    writeSectionLocked(0x0000, patCc, pat, n + 4);
+
+    uint8_t pmt[64];
+    size_t pmtSize = buildPmt(pmt);
+    writeSectionLocked(kPmtPid, pmtCc, pmt, pmtSize);
+
+    lastPsiNs = now;
+}
+
+void TsMuxer::writeSectionLocked(uint16_t pid, uint8_t& cc, const uint8_t* section, size_t size) {
+    uint8_t* pkt = nextPacketLocked();
+    pkt[0] = 0x47;
+    pkt[1] = static_cast<uint8_t>(0x40 | ((pid >> 8) & 0x1F));  // PUSI
+    pkt[2] = static_cast<uint8_t>(pid & 0xFF);
+    pkt[3] = static_cast<uint8_t>(0x10 | (cc & 0x0F));          // payload only
+    cc = (cc + 1) & 0x0F;
+    pkt[4] = 0x00;                                               // pointer_field
+    memcpy(pkt + 5, section, size);
+    memset(pkt + 5 + size, 0xFF, kPacketSize - 5 - size);
+    stats.psiPackets++;
+}
+
+size_t TsMuxer::buildPesHeader(uint8_t* out, uint8_t streamId, size_t payloadSize,
+                               int64_t pts90k, int64_t dts90k, bool boundedLength) const {
+    bool hasDts = dts90k >= 0;
+    size_t headerDataLength = hasDts ? 10 : 5;
+
+    out[0] = 0x00;
+    out[1] = 0x00;
+    out[2] = 0x01;
+    out[3] = streamId;
+
+    size_t pesLength = 3 + headerDataLength + payloadSize;
+    if (!boundedLength || pesLength > 0xFFFF) pesLength = 0;
+    out[4] = static_cast<uint8_t>(pesLength >> 8);
+    out[5] = static_cast<uint8_t>(pesLength & 0xFF);
+
+    out[6] = 0x84;                           // marker '10', data_alignment_indicator
+    out[7] = hasDts ? 0xC0 : 0x80;           // PTS_DTS_flags
+    out[8] = static_cast<uint8_t>(headerDataLength);
+    putTimestamp(out + 9, hasDts ? 0x30 : 0x20, pts90k);
+    if (hasDts) {
+        putTimestamp(out + 14, 0x10, dts90k);
+    }
+    return 9 + headerDataLength;
+}
+
+void TsMuxer::writePesLocked(uint16_t pid, uint8_t& cc, const uint8_t* header, size_t headerSize,
+                             const Segment* segments, size_t segmentCount,
+                             bool randomAccess, bool withPcr, int64_t now) {
+    size_t total = headerSize;
+    for (size_t i = 0; i < segmentCount; i++) total += segments[i].size;
+
+    // Cursor over [PES header, segments...]
+    size_t part = 0;           // 0 = header, 1.. = segments[part - 1]
+    size_t partOffset = 0;
+    size_t written = 0;
+    bool first = true;
+
+    while (written < total) {
+        uint8_t* pkt = nextPacketLocked();
+        size_t remaining = total - written;
+
+        bool hasAf = false;
+        uint8_t afFlags = 0;
+        size_t afTotal = 0;    // Adaptation field bytes including the length byte
+        if (first && (randomAccess || withPcr)) {
+            hasAf = true;
+            if (randomAccess) afFlags |= 0x40;
+            if (withPcr) afFlags |= 0x10;
+            afTotal = 2 + (withPcr ? 6 : 0);
+        }
+
+        size_t space = kPacketSize - 4 - afTotal;
+        size_t stuffing = 0;
+        if (remaining < space) {
+            size_t need = space - remaining;
+            if (!hasAf) {
+                hasAf = true;
+                afTotal = need;                  // 1 = length byte only
+                stuffing = need >= 2 ? need - 2 : 0;
+            } else {
+                afTotal += need;
+                stuffing = need;
+            }
+            space = remaining;
+            stats.stuffingBytes += need;
+        }
+
+        pkt[0] = 0x47;
+        pkt[1] = static_cast<uint8_t>((first ? 0x40 : 0x00) | ((pid >> 8) & 0x1F));
+        pkt[2] = static_cast<uint8_t>(pid & 0xFF);
+        pkt[3] = static_cast<uint8_t>((hasAf ? 0x30 : 0x10) | (cc & 0x0F));
+        cc = (cc + 1) & 0x0F;
+
+        size_t pos = 4;
+        if (hasAf) {
+            pkt[pos++] = static_cast<uint8_t>(afTotal - 1);
+            if (afTotal > 1) {
+                pkt[pos++] = afFlags;
+                if (afFlags & 0x10) {
+                    putPcr(pkt + pos, pcr27MHzAt(now));
+                    pos += 6;
+                    lastPcrNs = now;
+                    stats.pcrCount++;
+                }
+                memset(pkt + pos, 0xFF, stuffing);
+                pos += stuffing;
+            }
+        }
+
+        size_t toCopy = space;
+        while (toCopy > 0) {
+            const uint8_t* src = part == 0 ? header : segments[part - 1].data;
+            size_t srcSize = part == 0 ? headerSize : segments[part - 1].size;
+            size_t chunk = std::min(toCopy, srcSize - partOffset);
+            memcpy(pkt + pos, src + partOffset, chunk);
+            pos += chunk;
+            partOffset += chunk;
+            toCopy -= chunk;
+            if (partOffset == srcSize) {
+                part++;
+                partOffset = 0;
+            }
+        }
+
+        written += space;
+        first = false;
+    }
+}
+
+void TsMuxer::writePcrOnlyLocked(int64_t now) {
+    uint8_t* pkt = nextPacketLocked();
+    pkt[0] = 0x47;
+    pkt[1] = static_cast<uint8_t>((kVideoPid >> 8) & 0x1F);
+    pkt[2] = static_cast<uint8_t>(kVideoPid & 0xFF);
+    pkt[3] = static_cast<uint8_t>(0x20 | (videoCc & 0x0F));  // adaptation only, CC unchanged
+    pkt[4] = 183;
+    pkt[5] = 0x10;
+    putPcr(pkt + 6, pcr27MHzAt(now));
+    memset(pkt + 12, 0xFF, kPacketSize - 12);
+    lastPcrNs = now;
+    stats.pcrCount++;
+}
+
+} // namespace orbistream
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace orbistream {
+
+/**
+ * Video codec carried by the native TS muxer.
+ */
+enum class VideoCodec {
+    H264,   // stream_type 0x1B
+    H265    // stream_type 0x24
+};
+
+/**
+ * Audio codec carried by the native TS muxer.
+ */
+enum class AudioCodec {
+    AAC,    // ADTS, stream_type 0x0F
+    OPUS    // stream_type 0x06 + 'Opus' registration descriptor
+};
+
+/**
+ * Configuration for TsMuxer.
+ */
+struct TsMuxerConfig {
+    VideoCodec videoCodec = VideoCodec::H264;
+    AudioCodec audioCodec = AudioCodec::AAC;
+    bool hasAudio = true;
+    int audioChannels = 2;       // Only used for the Opus extension descriptor
+
+    int psiIntervalMs = 500;     // PAT/PMT repeat interval (also sent before every keyframe)
+    int pcrIntervalMs = 20;      // Max spacing between PCRs (spec limit is 100 ms)
+    int pcrDelayMs = 80;         // PTS/DTS lead over PCR (decoder buffering allowance)
+    bool flushPerAccessUnit = true;  // Send partial datagrams at the end of each AU
+};
+
+/**
+ * Muxer counters.
+ */
+struct TsMuxerStats {
+    uint64_t datagrams = 0;       // Datagrams handed to the output callback
+    uint64_t tsPackets = 0;       // 188-byte packets written (including PSI)
+    uint64_t psiPackets = 0;      // PAT + PMT packets
+    uint64_t pcrCount = 0;        // PCRs written
+    uint64_t videoAccessUnits = 0;
+    uint64_t audioAccessUnits = 0;
+    uint64_t stuffingBytes = 0;   // Adaptation field stuffing
+};
+
+/**
+ * TsMuxer is a minimal MPEG-TS packetizer for exactly one video and one
+ * audio elementary stream.
+ *
+ * Unlike mpegtsmux it does not interleave or wait for the other stream:
+ * every access unit is turned into a PES and written out immediately.
+ * Packets are packed 7 x 188 bytes into a preallocated datagram buffer
+ * which is handed to the output callback when full, or at the end of each
+ * access unit when flushPerAccessUnit is set.
+ *
+ * PCR is carried on the video PID and follows the wall clock at the time
+ * of writing, anchored to the first video DTS. PTS/DTS are shifted by
+ * pcrDelayMs so that PTS - PCR stays positive at the receiver.
+ *
+ * Thread-safe: video and audio may be written from different streaming
+ * threads. The callback is invoked with the internal lock held and must
+ * not call back into the muxer.
+ */
+class TsMuxer {
+public:
+    static constexpr size_t kPacketSize = 188;
+    static constexpr size_t kPacketsPerDatagram = 7;
+    static constexpr size_t kDatagramSize = kPacketSize * kPacketsPerDatagram;  // 1316
+
+    static constexpr uint16_t kPmtPid = 0x1000;
+    static constexpr uint16_t kVideoPid = 0x0100;
+    static constexpr uint16_t kAudioPid = 0x0101;
+
+    /**
+     * Receives one datagram (a multiple of 188 bytes, at most 1316).
+     * The data pointer is only valid for the duration of the call.
+     */
+    using DatagramCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    TsMuxer(const TsMuxerConfig& config, DatagramCallback callback);
+
+    /**
+     * Write one video access unit (Annex B byte-stream).
+     * @param ptsNs Presentation timestamp in nanoseconds
+     * @param dtsNs Decode timestamp in nanoseconds (-1 to use PTS)
+     * @param keyframe True for IDR/IRAP access units
+     */
+    void writeVideo(const uint8_t* data, size_t size,
+                    int64_t ptsNs, int64_t dtsNs, bool keyframe);
+
+    /**
+     * Write one audio access unit (ADTS frame for AAC, raw packet for Opus).
+     */
+    void writeAudio(const uint8_t* data, size_t size, int64_t ptsNs);
+
+    /**
+     * Send any partially filled datagram.
+     */
+    void flush();
+
+    /**
+     * Reset continuity counters and timing anchors (e.g. on restart).
+     */
+    void reset();
+
+    TsMuxerStats getStats() const;
+
+private:
+    struct Segment {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    void writePsiLocked(int64_t nowNs);
+    void writeSectionLocked(uint16_t pid, uint8_t& cc, const uint8_t* section, size_t size);
+    void writePesLocked(uint16_t pid, uint8_t& cc, const uint8_t* header, size_t headerSize,
+                        const Segment* segments, size_t segmentCount,
+                        bool randomAccess, bool withPcr, int64_t nowNs);
+    void writePcrOnlyLocked(int64_t nowNs);
+    uint8_t* nextPacketLocked();
+    void flushLocked();
+
+    size_t buildPmt(uint8_t* out) const;
+    size_t buildPesHeader(uint8_t* out, uint8_t streamId, size_t payloadSize,
+                          int64_t pts90k, int64_t dts90k, bool boundedLength) const;
+    int64_t pcr27MHzAt(int64_t nowNs) const;
+    bool pcrDueLocked(int64_t nowNs) const;
+
+    static int64_t nowNs();
+
+    TsMuxerConfig config;
+    DatagramCallback callback;
+
+    mutable std::mutex mutex;
+    std::array<uint8_t, kDatagramSize> datagram{};
+    size_t datagramPackets = 0;
+
+    uint8_t patCc = 0;
+    uint8_t pmtCc = 0;
+    uint8_t videoCc = 0;
+    uint8_t audioCc = 0;
+
+    bool anchored = false;
+    int64_t anchorDtsNs = 0;      // First video DTS (or audio PTS if audio arrives first)
+    int64_t anchorWallNs = 0;     // Wall clock when the anchor was taken
+    int64_t lastPsiNs = -1;
+    int64_t lastPcrNs = -1;
+
+    TsMuxerStats stats;
+};
+
+} // namespace orbistream
@@ -0,0 +1,374 @@
+/**
+ * arq_receiver - reference receiver for the app's ArqSender (ARQ_UDP).
+ *
+ * Listens on one UDP port, NAKs gaps in the sequence, waits for the
+ * retransmits up to each datagram's playout deadline and forwards the TS
+ * payload in order to --forward (e.g. a ts_receiver). A datagram is due
+ * --latency ms after it was sent (sender timestamps, offset by the lowest
+ * one-way delay seen); a gap still open at that point is given up on.
+ *
+ * NAKs are repeated every 1.5 RTT while a gap stays open. An ACK every
+ * 50 ms gives the sender its RTT and the recovered / expired counts.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -o arq_receiver tools/arq_receiver.cpp
+ *
+ * Examples:
+ *   arq_receiver --listen 9000 --forward 127.0.0.1:9001 --latency 250
+ *   arq_receiver --listen 9000 --latency 120 --duration 30 --max-expired 0 --json
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Wire format shared with app/src/main/jni/arq_sender.h
+constexpr size_t kHeaderSize = 12;
+constexpr uint8_t kMagic = 0x52;
+constexpr uint8_t kTypeData = 1;
+constexpr uint8_t kTypeRetransmit = 2;
+constexpr uint8_t kTypeNak = 3;
+constexpr uint8_t kTypeAck = 4;
+constexpr size_t kMaxNakRanges = 100;
+
+using Clock = std::chrono::steady_clock;
+
+volatile sig_atomic_t g_stop = 0;
+
+struct Pending {
+    std::vector<uint8_t> payload;    // Empty while missing
+    bool missing = false;
+    bool retransmit = false;
+    int64_t dueUs = 0;               // Local playout deadline
+    int64_t nakUs = 0;               // Last NAK sent for it, 0 = none
+    int64_t firstNakUs = 0;
+};
+
+struct Report {
+    uint64_t received = 0;
+    uint64_t retransmitsReceived = 0;
+    uint64_t delivered = 0;
+    uint64_t gaps = 0;               // Datagrams found missing
+    uint64_t recovered = 0;          // ... filled before their deadline
+    uint64_t expired = 0;            // ... given up on
+    uint64_t duplicates = 0;
+    uint64_t late = 0;               // Past their deadline or already delivered (extra copies)
+    uint64_t naksSent = 0;
+};
+
+uint32_t get32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+bool seqBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+int64_t nowUs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+bool parseHostPort(const std::string& spec, sockaddr_in& addr) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(atoi(spec.c_str() + colon + 1)));
+    return inet_pton(AF_INET, spec.substr(0, colon).c_str(), &addr.sin_addr) == 1;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --listen <port> [options]\n"
+        "  --forward <host:port>  send in-order TS payload here\n"
+        "  --latency <ms>         playout delay; must match the sender (default 250)\n"
+        "  --duration <s>         stop after s seconds\n"
+        "  --max-expired <n>      exit 1 if more datagrams expired\n"
+        "  --json                 print the summary as JSON\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int listenPort = 0;
+    int latencyMs = 250;
+    double durationS = 0.0;
+    long long maxExpired = -1;
+    bool json = false;
+    bool forward = false;
+    sockaddr_in forwardAddr = {};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--listen") listenPort = atoi(next().c_str());
+        else if (arg == "--forward") {
+            forward = parseHostPort(next(), forwardAddr);
+            if (!forward) { usage(argv[0]); return 2; }
+        }
+        else if (arg == "--latency") latencyMs = atoi(next().c_str());
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else if (arg == "--max-expired") maxExpired = atoll(next().c_str());
+        else if (arg == "--json") json = true;
+        else { usage(argv[0]); return 2; }
+    }
+    if (listenPort <= 0 || latencyMs <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in bindAddr = {};
+    bindAddr.sin_family = AF_INET;
+    bindAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    bindAddr.sin_port = htons(static_cast<uint16_t>(listenPort));
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&bindAddr), sizeof(bindAddr)) < 0) {
+        perror("bind");
+        return 2;
+    }
+    int outFd = forward ? socket(AF_INET, SOCK_DGRAM, 0) : -1;
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    const auto start = Clock::now();
+    const int64_t latencyUs = static_cast<int64_t>(latencyMs) * 1000;
+    Report report;
+    std::map<uint32_t, Pending> window;     // From nextSeq up to the highest sequence seen
+    bool started = false;
+    uint32_t nextSeq = 0;                   // Next to deliver
+    uint32_t highestSeq = 0;
+    bool haveOffset = false;
+    int64_t offsetUs = 0;                   // min(arrival - send time): sender clock -> local
+    uint32_t senderLastTs = 0;              // Unwraps the sender's 32-bit timestamps
+    int64_t senderLastUs = 0;
+    int64_t srttUs = 20000;                 // NAK -> retransmit round trip
+    uint32_t lastSendTs = 0;
+    int64_t lastSendTsArrivalUs = 0;
+    sockaddr_in sender = {};
+    bool haveSender = false;
+    int64_t nextAckUs = 0;
+    int64_t nextReportUs = 1000000;
+    Report lastReport;
+
+    auto senderTimeUs = [&](uint32_t ts) {
+        int64_t us = senderLastUs + static_cast<int32_t>(ts - senderLastTs);
+        if (us > senderLastUs) {
+            senderLastUs = us;
+            senderLastTs = ts;
+        }
+        return us;
+    };
+    auto deliver = [&](const std::vector<uint8_t>& payload) {
+        if (outFd >= 0) {
+            sendto(outFd, payload.data(), payload.size(), 0,
+                   reinterpret_cast<sockaddr*>(&forwardAddr), sizeof(forwardAddr));
+        }
+        report.delivered++;
+    };
+
+    uint8_t buf[2048];
+    while (!g_stop) {
+        int64_t now = nowUs(start);
+        if (durationS > 0 && now >= durationS * 1e6) break;
+
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 5) > 0) {
+            sockaddr_in from = {};
+            socklen_t fromLen = sizeof(from);
+            ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+            now = nowUs(start);
+            if (n >= static_cast<ssize_t>(kHeaderSize) && buf[0] == kMagic &&
+                (buf[1] == kTypeData || buf[1] == kTypeRetransmit)) {
+                sender = from;
+                haveSender = true;
+                uint32_t seq = get32(buf + 4);
+                uint32_t sendTs = get32(buf + 8);
+                bool isRetransmit = buf[1] == kTypeRetransmit;
+                report.received++;
+                if (isRetransmit) report.retransmitsReceived++;
+
+                if (!started) {
+                    started = true;
+                    nextSeq = highestSeq = seq;
+                    senderLastTs = sendTs;
+                    window[seq] = Pending();
+                }
+                int64_t sentUs = senderTimeUs(sendTs);
+                if (!isRetransmit && (!haveOffset || now - sentUs < offsetUs)) {
+                    offsetUs = now - sentUs;
+                    haveOffset = true;
+                }
+                int64_t dueUs = sentUs + offsetUs + latencyUs;
+                if (!isRetransmit) {
+                    lastSendTs = sendTs;
+                    lastSendTsArrivalUs = now;
+                }
+
+                if (seqBefore(seq, nextSeq)) {
+                    report.late++;
+                } else {
+                    if (seqBefore(highestSeq, seq)) {
+                        // Everything between the old highest and this one is missing;
+                        // its deadline is at the latest this datagram's
+                        for (uint32_t s = highestSeq + 1; s != seq; s++) {
+                            Pending& gap = window[s];
+                            gap.missing = true;
+                            gap.dueUs = dueUs;
+                            report.gaps++;
+                        }
+                        highestSeq = seq;
+                    }
+                    Pending& entry = window[seq];
+                    if (!entry.payload.empty()) {
+                        report.duplicates++;
+                    } else if (entry.missing && now >= entry.dueUs) {
+                        report.late++;              // Too late to play; expires at the head
+                    } else {
+                        if (entry.missing) {
+                            report.recovered++;     // By a retransmit, or reordered in
+                            if (isRetransmit && entry.firstNakUs > 0) {
+                                srttUs = (srttUs * 7 + (now - entry.firstNakUs)) / 8;
+                            }
+                        }
+                        entry.missing = false;
+                        entry.retransmit = isRetransmit;
+                        entry.dueUs = dueUs;
+                        entry.payload.assign(buf + kHeaderSize, buf + n);
+                    }
+                }
+            }
+        }
+
+        // Deliver in order; a missing head waits until its deadline
+        while (!window.empty()) {
+            auto head = window.begin();
+            if (head->first != nextSeq) break;
+            if (head->second.missing) {
+                if (now < head->second.dueUs || head->second.dueUs == 0) break;
+                report.expired++;
+            } else {
+                deliver(head->second.payload);
+            }
+            window.erase(head);
+            nextSeq++;
+        }
+
+        // NAK open gaps that can still make it, at most every 1.5 RTT
+        if (haveSender) {
+            uint8_t nak[kHeaderSize + kMaxNakRanges * 6];
+            size_t ranges = 0;
+            uint32_t rangeFirst = 0;
+            uint16_t rangeLength = 0;
+            int64_t renakUs = std::max<int64_t>(10000, srttUs * 3 / 2);
+            for (auto& entry : window) {
+                Pending& p = entry.second;
+                if (!p.missing || now >= p.dueUs) continue;
+                if (p.nakUs > 0 && now - p.nakUs < renakUs) continue;
+                if (ranges > 0 && rangeFirst + rangeLength == entry.first && rangeLength < 0xFFFF) {
+                    rangeLength++;
+                } else if (ranges < kMaxNakRanges) {
+                    if (ranges > 0) put16(nak + kHeaderSize + (ranges - 1) * 6 + 4, rangeLength);
+                    put32(nak + kHeaderSize + ranges * 6, entry.first);
+                    rangeFirst = entry.first;
+                    rangeLength = 1;
+                    ranges++;
+                } else {
+                    continue;       // Full: next round
+                }
+                p.nakUs = now;
+                if (p.firstNakUs == 0) p.firstNakUs = now;
+            }
+            if (ranges > 0) {
+                put16(nak + kHeaderSize + (ranges - 1) * 6 + 4, rangeLength);
+                nak[0] = kMagic;
+                nak[1] = kTypeNak;
+                put16(nak + 2, static_cast<uint16_t>(ranges));
+                put32(nak + 4, nextSeq);
+                put32(nak + 8, 0);
+                sendto(fd, nak, kHeaderSize + ranges * 6, 0, reinterpret_cast<sockaddr*>(&sender), sizeof(sender));
+                report.naksSent++;
+            }
+
+            if (now >= nextAckUs) {
+                uint8_t ack[kHeaderSize + 12];
+                ack[0] = kMagic;
+                ack[1] = kTypeAck;
+                put16(ack + 2, 0);
+                put32(ack + 4, nextSeq);
+                put32(ack + 8, lastSendTs);
+                put32(ack + kHeaderSize, static_cast<uint32_t>(now - lastSendTsArrivalUs));
+                put32(ack + kHeaderSize + 4, static_cast<uint32_t>(report.recovered));
+                put32(ack + kHeaderSize + 8, static_cast<uint32_t>(report.expired));
+                sendto(fd, ack, sizeof(ack), 0, reinterpret_cast<sockaddr*>(&sender), sizeof(sender));
+                nextAckUs = now + 50000;
+            }
+        }
+
+        if (now >= nextReportUs) {
+            fprintf(stderr, "[%6.1fs] delivered=%llu (+%llu) gaps=%llu recovered=%llu expired=%llu "
+                    "retrans_rx=%llu naks=%llu late=%llu rtt=%.1fms\n",
+                    now / 1e6, (unsigned long long)report.delivered,
+                    (unsigned long long)(report.delivered - lastReport.delivered),
+                    (unsigned long long)report.gaps, (unsigned long long)report.recovered,
+                    (unsigned long long)report.expired, (unsigned long long)report.retransmitsReceived,
+                    (unsigned long long)report.naksSent, (unsigned long long)report.late, srttUs / 1000.0);
+            lastReport = report;
+            nextReportUs += 1000000;
+        }
+    }
+
+    bool pass = maxExpired < 0 || static_cast<long long>(report.expired) <= maxExpired;
+    double retransmitRatio = report.received > report.retransmitsReceived
+        ? static_cast<double>(report.retransmitsReceived) / (report.received - report.retransmitsReceived) : 0.0;
+    if (json) {
+        printf("{\"delivered\":%llu,\"gaps\":%llu,\"recovered\":%llu,\"expired\":%llu,"
+               "\"retransmits_received\":%llu,\"retransmit_ratio\":%.4f,\"duplicates\":%llu,"
+               "\"late\":%llu,\"naks_sent\":%llu,\"rtt_ms\":%.1f,\"pass\":%s}\n",
+               (unsigned long long)report.delivered, (unsigned long long)report.gaps,
+               (unsigned long long)report.recovered, (unsigned long long)report.expired,
+               (unsigned long long)report.retransmitsReceived, retransmitRatio,
+               (unsigned long long)report.duplicates, (unsigned long long)report.late,
+               (unsigned long long)report.naksSent, srttUs / 1000.0, pass ? "true" : "false");
+    } else {
+        printf("arq_receiver: delivered=%llu gaps=%llu recovered=%llu expired=%llu retransmit_ratio=%.2f%% "
+               "duplicates=%llu late=%llu naks=%llu -> %s\n",
+               (unsigned long long)report.delivered, (unsigned long long)report.gaps,
+               (unsigned long long)report.recovered, (unsigned long long)report.expired,
+               retransmitRatio * 100.0, (unsigned long long)report.duplicates,
+               (unsigned long long)report.late, (unsigned long long)report.naksSent,
+               pass ? "PASS" : "FAIL");
+    }
+    close(fd);
+    if (outFd >= 0) close(outFd);
+    return pass ? 0 : 1;
+}
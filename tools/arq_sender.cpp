@@ -0,0 +1,125 @@
+/**
+ * arq_sender - drives the app's ArqSender on the host.
+ *
+ * Sends a synthetic MPEG-TS stream at a fixed bitrate through ArqSender
+ * and prints its counters once per second: retransmit ratio, NAKed and
+ * skipped resends, RTT, and the recovered / expired counts the receiver
+ * reports back.
+ *
+ * Pair it with `arq_receiver --listen <port> --latency <same ms>`, behind
+ * an impair_relay to create loss (the relay passes NAKs and ACKs back).
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -Itools/host -Iapp/src/main/jni -o arq_sender \
+ *       tools/arq_sender.cpp app/src/main/jni/arq_sender.cpp app/src/main/jni/logger.cpp -lpthread
+ *
+ * Example:
+ *   impair_relay --listen 9100 --target 127.0.0.1:9000 --loss 0.03 --delay 30 --both &
+ *   arq_receiver --listen 9000 --latency 250 --forward 127.0.0.1:9001 &
+ *   arq_sender --target 127.0.0.1:9100 --latency 250 --kbps 4000 --duration 30
+ */
+
+#include "arq_sender.h"
+#include "ts_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace orbistream;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+bool splitHostPort(const std::string& spec, std::string& host, int& port) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = spec.substr(0, colon);
+    port = atoi(spec.c_str() + colon + 1);
+    return !host.empty() && port > 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --target <host:port> [options]\n"
+        "  --latency <ms>    receiver playout delay (default 250)\n"
+        "  --ring <n>        datagrams kept for resend (default 2048)\n"
+        "  --kbps <n>        stream bitrate (default 3000)\n"
+        "  --duration <s>    stop after s seconds\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ArqConfig config;
+    double kbps = 3000.0;
+    double durationS = 0.0;
+    bool haveTarget = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--target") haveTarget = splitHostPort(next(), config.host, config.port);
+        else if (arg == "--latency") config.latencyMs = atoi(next().c_str());
+        else if (arg == "--ring") config.ringSlots = static_cast<size_t>(atol(next().c_str()));
+        else if (arg == "--kbps") kbps = atof(next().c_str());
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else { usage(argv[0]); return 2; }
+    }
+    if (!haveTarget || kbps <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    ArqSender sender(config);
+    if (!sender.start()) return 2;
+
+    TsGenerator generator;
+    uint8_t datagram[TsGenerator::kDatagramSize];
+    const auto interval = std::chrono::nanoseconds(
+        static_cast<int64_t>(sizeof(datagram) * 8 * 1e9 / (kbps * 1000.0)));
+    const auto start = std::chrono::steady_clock::now();
+    auto nextSend = start;
+    auto nextReport = start + std::chrono::seconds(1);
+
+    auto print = [&](double t) {
+        ArqStats st = sender.getStats();
+        fprintf(stderr, "[%6.1fs] sent=%llu retrans=%llu (%.2f%%) naked=%llu skipped=%llu rtt=%.1fms "
+                "recovered=%llu expired=%llu%s\n",
+                t, (unsigned long long)st.packetsSent, (unsigned long long)st.packetsRetransmitted,
+                st.retransmitRatio * 100.0, (unsigned long long)st.packetsNaked,
+                (unsigned long long)st.resendsSkipped, st.rttMs,
+                (unsigned long long)st.recovered, (unsigned long long)st.expired,
+                st.receiverSeen ? "" : " (no receiver)");
+    };
+
+    while (!g_stop) {
+        auto now = std::chrono::steady_clock::now();
+        if (durationS > 0 && now - start >= std::chrono::duration<double>(durationS)) break;
+
+        if (now >= nextSend) {
+            generator.next(datagram);
+            sender.send(datagram, sizeof(datagram));
+            nextSend += interval;
+        }
+        if (now >= nextReport) {
+            print(std::chrono::duration<double>(now - start).count());
+            nextReport += std::chrono::seconds(1);
+        }
+        std::this_thread::sleep_until(std::min(nextSend, nextReport));
+    }
+
+    // Let the last NAKs and ACKs come back
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.latencyMs + 100));
+    print(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    sender.stop();
+    return 0;
+}
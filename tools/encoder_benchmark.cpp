@@ -0,0 +1,295 @@
+/**
+ * encoder_benchmark - the app's encoder backends side by side on one clip.
+ *
+ * Each backend (encoder_backend.cpp) available on the host encodes the same
+ * videotestsrc clip, not live, so the frame rate is what the encoder
+ * sustains. The element description and controls are the ones the app
+ * uses: halfway through the bitrate is halved with setBitrate() (skipped
+ * for encoders without live bitrate changes), and at three quarters a
+ * keyframe is requested with forceKeyframe(). Per backend it prints:
+ *
+ *   fps         frames per second of wall time
+ *   enc_ms      mean and max time per frame inside the encoder (pad probes)
+ *   kbps        encoded bitrate before and after the step, against the target
+ *   key_frames  frames from the keyframe request to the next keyframe
+ *
+ * Build (host, GStreamer 1.x with x264enc; openh264enc if available):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -Itools/host -Iapp/src/main/jni \
+ *       -o encoder_benchmark tools/encoder_benchmark.cpp \
+ *       app/src/main/jni/{encoder_backend,gst_startup,frame_convert,logger}.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-video-1.0) -ldl
+ *
+ * Examples:
+ *   encoder_benchmark
+ *   encoder_benchmark --encoders x264,openh264 --resolution 1080p --frames 900 --bitrate 6000
+ *   encoder_benchmark --encoders x264 --preset veryfast --rate-control cbr
+ */
+
+#include "encoder_backend.h"
+#include "gst_startup.h"
+
+#include <gst/gst.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+struct Options {
+    std::vector<EncoderKind> encoders{EncoderKind::X264, EncoderKind::OPENH264, EncoderKind::MEDIACODEC};
+    int width = 1280;
+    int height = 720;
+    int frameRate = 30;
+    int frames = 600;
+    int bitrateKbps = 4000;
+    EncoderPreset preset = EncoderPreset::ULTRAFAST;
+    RateControl rateControl = RateControl::CAPPED_VBR;
+};
+
+// One encoded frame at the sink
+struct Frame {
+    uint64_t pts = 0;
+    size_t bytes = 0;
+    bool keyframe = false;
+};
+
+struct Capture {
+    std::mutex mutex;
+    std::vector<Frame> frames;
+};
+
+struct Result {
+    uint64_t frames = 0;
+    double fps = 0.0;
+    EncodeTiming timing;
+    double kbpsBefore = 0.0;
+    double kbpsAfter = 0.0;
+    bool bitrateStepped = false;
+    int keyframeFrames = -1;        // -1: no keyframe after the request
+};
+
+void onHandoff(GstElement*, GstBuffer* buf, GstPad*, gpointer userData) {
+    auto* capture = static_cast<Capture*>(userData);
+    Frame frame;
+    frame.pts = GST_BUFFER_PTS(buf);
+    frame.bytes = gst_buffer_get_size(buf);
+    frame.keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    capture->frames.push_back(frame);
+}
+
+size_t frameCount(Capture& capture) {
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    return capture.frames.size();
+}
+
+// Encoded bitrate of frames [begin, end), from their byte count and frame rate
+double kbps(const std::vector<Frame>& frames, size_t begin, size_t end, int frameRate) {
+    if (end <= begin) return 0.0;
+    uint64_t bytes = 0;
+    for (size_t i = begin; i < end; i++) bytes += frames[i].bytes;
+    return bytes * 8.0 * frameRate / (end - begin) / 1000.0;
+}
+
+bool run(EncoderKind kind, const Options& opts, Result& result) {
+    std::unique_ptr<EncoderBackend> backend = EncoderBackend::create(kind);
+    EncoderSettings settings;
+    settings.bitrateKbps = opts.bitrateKbps;
+    settings.frameRate = opts.frameRate;
+    // Long GOP so the forced keyframe is not a scheduled one
+    settings.keyframeFrames = opts.frames * 2;
+    settings.preset = opts.preset;
+    settings.rateControl = opts.rateControl;
+
+    std::stringstream ss;
+    ss << "videotestsrc pattern=ball is-live=false num-buffers=" << opts.frames << " ! "
+       << "video/x-raw,format=I420,width=" << opts.width << ",height=" << opts.height
+       << ",framerate=" << opts.frameRate << "/1 ! videoconvert ! "
+       << backend->build(settings, "enc") << " ! "
+       << "fakesink name=sink sync=false signal-handoffs=true";
+
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(ss.str().c_str(), &error);
+    if (error) {
+        fprintf(stderr, "%s: %s\n", backend->name(), error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return false;
+    }
+    Capture capture;
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    g_signal_connect(sink, "handoff", G_CALLBACK(onHandoff), &capture);
+    gst_object_unref(sink);
+    GstElement* encoder = gst_bin_get_by_name(GST_BIN(pipeline), "enc");
+    backend->attach(encoder);
+
+    const size_t stepAt = opts.frames / 2;
+    const size_t keyAt = opts.frames * 3 / 4;
+    size_t keyRequestedAt = 0;
+    bool ok = true;
+
+    auto begin = std::chrono::steady_clock::now();
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(pipeline);
+    while (true) {
+        // Controls from this thread, as the app's ABR and reconnect paths do
+        size_t seen = frameCount(capture);
+        if (!result.bitrateStepped && seen >= stepAt && backend->capabilities().liveBitrate) {
+            result.bitrateStepped = backend->setBitrate(opts.bitrateKbps / 2);
+        }
+        if (keyRequestedAt == 0 && seen >= keyAt) {
+            keyRequestedAt = backend->forceKeyframe() ? seen : static_cast<size_t>(-1);
+        }
+
+        GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_MSECOND,
+            static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+        if (!msg) continue;
+        if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+            GError* err = nullptr;
+            gst_message_parse_error(msg, &err, nullptr);
+            fprintf(stderr, "%s: %s\n", backend->name(), err ? err->message : "error");
+            if (err) g_error_free(err);
+            ok = false;
+        }
+        gst_message_unref(msg);
+        break;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    gst_object_unref(bus);
+    result.timing = backend->drainTiming();
+    backend->detach();
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(encoder);
+    gst_object_unref(pipeline);
+    if (!ok) return false;
+
+    // Encoders may hold frames back; stepped frames are the ones that left after the request
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    const std::vector<Frame>& frames = capture.frames;
+    result.frames = frames.size();
+    result.fps = seconds > 0 ? frames.size() / seconds : 0.0;
+    size_t settle = std::min<size_t>(opts.frameRate, stepAt / 2);
+    result.kbpsBefore = kbps(frames, settle, std::min(stepAt, frames.size()), opts.frameRate);
+    result.kbpsAfter = kbps(frames, std::min(stepAt + settle, frames.size()),
+                            std::min(keyAt, frames.size()), opts.frameRate);
+    for (size_t i = keyRequestedAt; keyRequestedAt > 0 && i < frames.size(); i++) {
+        if (frames[i].keyframe) {
+            result.keyframeFrames = static_cast<int>(i - keyRequestedAt);
+            break;
+        }
+    }
+    return true;
+}
+
+bool parseEncoders(const std::string& value, std::vector<EncoderKind>& encoders) {
+    encoders.clear();
+    std::stringstream ss(value);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        if (name == "x264") encoders.push_back(EncoderKind::X264);
+        else if (name == "mediacodec") encoders.push_back(EncoderKind::MEDIACODEC);
+        else if (name == "openh264") encoders.push_back(EncoderKind::OPENH264);
+        else return false;
+    }
+    return !encoders.empty();
+}
+
+bool parsePreset(const std::string& value, EncoderPreset& preset) {
+    for (int p = static_cast<int>(EncoderPreset::ULTRAFAST); p <= static_cast<int>(EncoderPreset::VERYSLOW); p++) {
+        if (value == encoderPresetName(static_cast<EncoderPreset>(p))) {
+            preset = static_cast<EncoderPreset>(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseRateControl(const std::string& value, RateControl& rateControl) {
+    if (value == "cbr") rateControl = RateControl::CBR;
+    else if (value == "vbr") rateControl = RateControl::CAPPED_VBR;
+    else if (value == "cq") rateControl = RateControl::CONSTANT_QUALITY;
+    else return false;
+    return true;
+}
+
+bool parseResolution(const std::string& value, int& width, int& height) {
+    if (value == "480p") { width = 854; height = 480; return true; }
+    if (value == "720p") { width = 1280; height = 720; return true; }
+    if (value == "1080p") { width = 1920; height = 1080; return true; }
+    return sscanf(value.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--encoders x264,openh264,mediacodec] [--resolution 480p|720p|1080p|WxH]\n"
+            "          [--fps N] [--frames N] [--bitrate KBPS] [--preset ultrafast..veryslow]\n"
+            "          [--rate-control cbr|vbr|cq]\n",
+            argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--encoders") ok = parseEncoders(next(), opts.encoders);
+        else if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else if (arg == "--fps") opts.frameRate = atoi(next().c_str());
+        else if (arg == "--frames") opts.frames = atoi(next().c_str());
+        else if (arg == "--bitrate") opts.bitrateKbps = atoi(next().c_str());
+        else if (arg == "--preset") ok = parsePreset(next(), opts.preset);
+        else if (arg == "--rate-control") ok = parseRateControl(next(), opts.rateControl);
+        else ok = false;
+        if (!ok || opts.frameRate <= 0 || opts.frames < 40 || opts.bitrateKbps <= 0) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!GstStartup::init("")) {
+        fprintf(stderr, "gst_init failed\n");
+        return 1;
+    }
+
+    printf("# %dx%d@%d, %d frames, %d -> %d kbps at frame %d, keyframe request at frame %d\n",
+           opts.width, opts.height, opts.frameRate, opts.frames, opts.bitrateKbps,
+           opts.bitrateKbps / 2, opts.frames / 2, opts.frames * 3 / 4);
+    printf("%-11s %-22s %-3s %7s %8s %8s %8s %8s %10s\n", "encoder", "factory", "hw",
+           "fps", "enc_mean", "enc_max", "kbps_1", "kbps_2", "key_frames");
+
+    int failed = 0;
+    for (EncoderKind kind : opts.encoders) {
+        const EncoderCapabilities& caps = EncoderBackend::capabilities(kind);
+        if (!caps.available) {
+            printf("%-11s not available\n", encoderKindName(kind));
+            continue;
+        }
+        Result result;
+        if (!run(kind, opts, result)) {
+            failed++;
+            continue;
+        }
+        char after[16] = "-";
+        if (result.bitrateStepped) snprintf(after, sizeof(after), "%.0f", result.kbpsAfter);
+        char key[16] = "none";
+        if (result.keyframeFrames >= 0) snprintf(key, sizeof(key), "%d", result.keyframeFrames);
+        printf("%-11s %-22s %-3s %7.1f %8.2f %8.2f %8.0f %8s %10s\n", encoderKindName(kind),
+               caps.factory.c_str(), caps.hardware ? "yes" : "no", result.fps,
+               result.timing.meanMs, result.timing.maxMs, result.kbpsBefore, after, key);
+    }
+    printf("\n(enc_* in ms; kbps_1 against %d, kbps_2 against %d; '-' = no live bitrate change)\n",
+           opts.bitrateKbps, opts.bitrateKbps / 2);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Host stand-in for the NDK log API, so app sources can be built into host tools
+
+#include <cstdarg>
+#include <cstdio>
+
+enum {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG = 3,
+    ANDROID_LOG_INFO = 4,
+    ANDROID_LOG_WARN = 5,
+    ANDROID_LOG_ERROR = 6
+};
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    static const char kLevels[] = "??VDIWEF";
+    fprintf(stderr, "%c/%s: ", prio >= 0 && prio < 8 ? kLevels[prio] : '?', tag);
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    return n;
+}
+
+inline int __android_log_write(int prio, const char* tag, const char* text) {
+    return __android_log_print(prio, tag, "%s", text);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the bionic property API: every property reads as unset
+
+#define PROP_VALUE_MAX 92
+
+inline int __system_property_get(const char* name, char* value) {
+    (void)name;
+    value[0] = '\0';
+    return 0;
+}
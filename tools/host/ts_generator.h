@@ -0,0 +1,53 @@
+#pragma once
+
+// Synthetic MPEG-TS for the host transport drivers: seven packets per
+// datagram, a PAT every 40th datagram, otherwise payload on one PID with
+// valid continuity counters (what ts_receiver checks)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class TsGenerator {
+public:
+    static constexpr size_t kPacketSize = 188;
+    static constexpr int kPacketsPerDatagram = 7;
+    static constexpr size_t kDatagramSize = kPacketSize * kPacketsPerDatagram;
+    static constexpr uint16_t kPayloadPid = 0x100;
+
+    void next(uint8_t* out) {
+        for (int i = 0; i < kPacketsPerDatagram; i++) {
+            uint8_t* p = out + i * kPacketSize;
+            if (i == 0 && datagrams % 40 == 0) {
+                writePat(p);
+            } else {
+                memset(p, 0xA5, kPacketSize);
+                p[0] = 0x47;
+                p[1] = static_cast<uint8_t>(kPayloadPid >> 8);
+                p[2] = static_cast<uint8_t>(kPayloadPid & 0xFF);
+                p[3] = static_cast<uint8_t>(0x10 | (payloadCc++ & 0x0F));
+            }
+        }
+        datagrams++;
+    }
+
+private:
+    void writePat(uint8_t* p) {
+        memset(p, 0xFF, kPacketSize);
+        p[0] = 0x47;
+        p[1] = 0x40;    // payload_unit_start, PID 0
+        p[2] = 0x00;
+        p[3] = static_cast<uint8_t>(0x10 | (patCc++ & 0x0F));
+        static const uint8_t kSection[] = {
+            0x00,                               // pointer_field
+            0x00, 0xB0, 0x0D, 0x00, 0x01, 0xC1, 0x00, 0x00,
+            0x00, 0x01, 0xF0, 0x00,             // program 1 -> PMT PID 0x1000
+            0x2A, 0xB1, 0x04, 0xB2              // CRC32 (not checked by ts_receiver)
+        };
+        memcpy(p + 4, kSection, sizeof(kSection));
+    }
+
+    uint64_t datagrams = 0;
+    uint8_t payloadCc = 0;
+    uint8_t patCc = 0;
+};
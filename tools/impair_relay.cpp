@@ -0,0 +1,409 @@
+/**
+ * impair_relay - loopback UDP relay that applies scripted network impairments.
+ *
+ * Sits between the streamer and a receiver (ts_receiver, an SRT listener,
+ * ffplay, ...). Datagrams arriving on --listen are forwarded to --target
+ * after loss, delay, jitter, reordering, bandwidth limiting and outages are
+ * applied. Replies from the target are relayed back to the last sender, so
+ * SRT handshakes/ACKs/NAKs work through it (impairments apply to the
+ * forward direction only unless --both is given).
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -o impair_relay tools/impair_relay.cpp
+ *
+ * Examples:
+ *   impair_relay --listen 9000 --target 127.0.0.1:9001 --loss 0.02 --delay 40 --jitter 10
+ *   impair_relay --listen 9000 --target 127.0.0.1:9001 --ge 0.01,0.25,0,0.6 --rate 3000
+ *   impair_relay --listen 9000 --target 127.0.0.1:9001 --script tools/scripts/handover.txt
+ *   impair_relay --listen 9000 --target 127.0.0.1:9001 --trace lte_drive.csv --loop
+ *
+ * Script format (one step per line, '#' comments):
+ *   <time_s> key=value [key=value ...]
+ *   keys: loss, delay, jitter, reorder, rate (kbps, 0 = unlimited), queue (ms),
+ *         ge (pGB,pBG,lossGood,lossBad), outage (seconds)
+ *
+ * Trace format (recorded link trace, CSV or whitespace separated):
+ *   <time_ms> <rate_kbps> <delay_ms> <loss_fraction>
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Impairment {
+    double loss = 0.0;          // Independent random loss probability
+    double delayMs = 0.0;       // Base one-way delay
+    double jitterMs = 0.0;      // Uniform +/- jitter
+    double reorder = 0.0;       // Probability a packet is held back by an extra delay
+    double reorderMs = 20.0;    // Extra hold for reordered packets
+    double rateKbps = 0.0;      // Bottleneck rate (0 = unlimited)
+    double queueMs = 200.0;     // Bottleneck queue size in ms; tail drop beyond
+
+    // Gilbert-Elliott burst loss (enabled when geEnabled)
+    bool geEnabled = false;
+    double gePGoodToBad = 0.0;
+    double gePBadToGood = 1.0;
+    double geLossGood = 0.0;
+    double geLossBad = 1.0;
+
+    double outageUntilS = -1.0; // Drop everything until this script time
+};
+
+struct ScriptStep {
+    double timeS = 0.0;
+    std::vector<std::pair<std::string, std::string>> settings;
+};
+
+struct Scheduled {
+    int64_t dueNs;
+    uint64_t seq;               // Tie-break so equal deadlines keep arrival order
+    bool toTarget;
+    std::vector<uint8_t> data;
+    bool operator>(const Scheduled& other) const {
+        return dueNs != other.dueNs ? dueNs > other.dueNs : seq > other.seq;
+    }
+};
+
+struct Counters {
+    uint64_t received = 0;
+    uint64_t forwarded = 0;
+    uint64_t lostRandom = 0;
+    uint64_t lostBurst = 0;
+    uint64_t lostQueue = 0;
+    uint64_t lostOutage = 0;
+    uint64_t reordered = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+volatile sig_atomic_t g_stop = 0;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool parseHostPort(const std::string& s, sockaddr_in& addr) {
+    size_t colon = s.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : s.substr(0, colon);
+    std::string port = colon == std::string::npos ? s : s.substr(colon + 1);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(atoi(port.c_str())));
+    return inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1;
+}
+
+bool applySetting(Impairment& imp, const std::string& key, const std::string& value, double nowS) {
+    if (key == "loss") imp.loss = atof(value.c_str());
+    else if (key == "delay") imp.delayMs = atof(value.c_str());
+    else if (key == "jitter") imp.jitterMs = atof(value.c_str());
+    else if (key == "reorder") imp.reorder = atof(value.c_str());
+    else if (key == "reorder-ms") imp.reorderMs = atof(value.c_str());
+    else if (key == "rate") imp.rateKbps = atof(value.c_str());
+    else if (key == "queue") imp.queueMs = atof(value.c_str());
+    else if (key == "outage") imp.outageUntilS = nowS + atof(value.c_str());
+    else if (key == "ge") {
+        double v[4] = {0, 1, 0, 1};
+        if (sscanf(value.c_str(), "%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3]) < 2) return false;
+        imp.geEnabled = v[0] > 0.0;
+        imp.gePGoodToBad = v[0];
+        imp.gePBadToGood = v[1];
+        imp.geLossGood = v[2];
+        imp.geLossBad = v[3];
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool loadScript(const std::string& path, std::vector<ScriptStep>& steps) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream ls(line);
+        ScriptStep step;
+        if (!(ls >> step.timeS)) continue;
+        std::string kv;
+        while (ls >> kv) {
+            size_t eq = kv.find('=');
+            if (eq == std::string::npos) continue;
+            step.settings.emplace_back(kv.substr(0, eq), kv.substr(eq + 1));
+        }
+        steps.push_back(step);
+    }
+    std::sort(steps.begin(), steps.end(),
+              [](const ScriptStep& a, const ScriptStep& b) { return a.timeS < b.timeS; });
+    return true;
+}
+
+// Recorded trace rows become script steps setting rate/delay/loss
+bool loadTrace(const std::string& path, std::vector<ScriptStep>& steps) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream ls(line);
+        double tMs, rate, delay, loss;
+        if (!(ls >> tMs >> rate >> delay >> loss)) continue;  // Also skips a header row
+        ScriptStep step;
+        step.timeS = tMs / 1000.0;
+        step.settings = {{"rate", std::to_string(rate)},
+                         {"delay", std::to_string(delay)},
+                         {"loss", std::to_string(loss)}};
+        steps.push_back(step);
+    }
+    return !steps.empty();
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --listen <port> --target <host:port> [options]\n"
+        "  --loss <p>            random loss probability\n"
+        "  --ge <pGB,pBG,kG,kB>  Gilbert-Elliott burst loss\n"
+        "  --delay <ms>          one-way delay\n"
+        "  --jitter <ms>         uniform +/- jitter\n"
+        "  --reorder <p>         probability of holding a packet back (--reorder-ms)\n"
+        "  --rate <kbps>         bottleneck rate, --queue <ms> bottleneck queue\n"
+        "  --script <file>       timed impairment steps\n"
+        "  --trace <file>        recorded link trace (time_ms rate_kbps delay_ms loss)\n"
+        "  --loop                repeat script/trace\n"
+        "  --both                impair the return path as well\n"
+        "  --seed <n>            RNG seed (default 1, deterministic)\n"
+        "  --duration <s>        exit after s seconds\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int listenPort = 0;
+    sockaddr_in target{};
+    bool haveTarget = false;
+    Impairment imp;
+    std::vector<ScriptStep> steps;
+    bool loop = false;
+    bool impairReturn = false;
+    unsigned seed = 1;
+    double durationS = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--listen") listenPort = atoi(next().c_str());
+        else if (arg == "--target") haveTarget = parseHostPort(next(), target);
+        else if (arg == "--script") {
+            if (!loadScript(next(), steps)) { fprintf(stderr, "cannot read script\n"); return 2; }
+        } else if (arg == "--trace") {
+            if (!loadTrace(next(), steps)) { fprintf(stderr, "cannot read trace\n"); return 2; }
+        } else if (arg == "--loop") loop = true;
+        else if (arg == "--both") impairReturn = true;
+        else if (arg == "--seed") seed = static_cast<unsigned>(atoi(next().c_str()));
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else if (arg.rfind("--", 0) == 0 && applySetting(imp, arg.substr(2), next(), 0.0)) {}
+        else { usage(argv[0]); return 2; }
+    }
+    if (!listenPort || !haveTarget) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int out = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = htons(static_cast<uint16_t>(listenPort));
+    if (sock < 0 || out < 0 || bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    int bufSize = 8 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    setsockopt(out, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    std::priority_queue<Scheduled, std::vector<Scheduled>, std::greater<Scheduled>> pending;
+    uint64_t seqCounter = 0;
+    bool geBad = false;
+    int64_t bottleneckFreeNs = 0;   // When the bottleneck link finishes the last packet
+    int64_t lastDueNs = 0;          // Keeps jitter from reordering unless --reorder is set
+    sockaddr_in client{};
+    bool haveClient = false;
+    Counters counters;
+
+    const int64_t startNs = nowNs();
+    size_t nextStep = 0;
+    double loopOffsetS = 0.0;
+    int64_t lastReportNs = startNs;
+    uint64_t lastReportBytes = 0;
+
+    fprintf(stderr, "impair_relay: 127.0.0.1:%d -> %s:%d\n", listenPort,
+            inet_ntoa(target.sin_addr), ntohs(target.sin_port));
+
+    std::vector<uint8_t> buf(65536);
+    while (!g_stop) {
+        int64_t now = nowNs();
+        double elapsedS = (now - startNs) / 1e9;
+        if (durationS > 0 && elapsedS >= durationS) break;
+
+        // Advance the script
+        while (nextStep < steps.size() && steps[nextStep].timeS + loopOffsetS <= elapsedS) {
+            for (auto& kv : steps[nextStep].settings) {
+                applySetting(imp, kv.first, kv.second, elapsedS);
+            }
+            fprintf(stderr, "[%7.2fs] step %zu: loss=%.3f delay=%.0f jitter=%.0f rate=%.0f%s\n",
+                    elapsedS, nextStep, imp.loss, imp.delayMs, imp.jitterMs, imp.rateKbps,
+                    imp.outageUntilS > elapsedS ? " OUTAGE" : "");
+            nextStep++;
+            if (nextStep == steps.size() && loop) {
+                loopOffsetS = elapsedS;
+                nextStep = 0;
+            }
+        }
+
+        // Release due packets
+        while (!pending.empty() && pending.top().dueNs <= now) {
+            const Scheduled& s = pending.top();
+            if (s.toTarget) {
+                sendto(out, s.data.data(), s.data.size(), 0,
+                       reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+                counters.forwarded++;
+                counters.bytesOut += s.data.size();
+            } else if (haveClient) {
+                sendto(sock, s.data.data(), s.data.size(), 0,
+                       reinterpret_cast<const sockaddr*>(&client), sizeof(client));
+            }
+            pending.pop();
+        }
+
+        if (now - lastReportNs >= 1000000000LL) {
+            double secs = (now - lastReportNs) / 1e9;
+            fprintf(stderr, "[%7.2fs] in=%llu out=%llu lost(rand/burst/queue/outage)=%llu/%llu/%llu/%llu "
+                    "reordered=%llu rate=%.0f kbps\n", elapsedS,
+                    (unsigned long long)counters.received, (unsigned long long)counters.forwarded,
+                    (unsigned long long)counters.lostRandom, (unsigned long long)counters.lostBurst,
+                    (unsigned long long)counters.lostQueue, (unsigned long long)counters.lostOutage,
+                    (unsigned long long)counters.reordered,
+                    (counters.bytesOut - lastReportBytes) * 8.0 / 1000.0 / secs);
+            lastReportNs = now;
+            lastReportBytes = counters.bytesOut;
+        }
+
+        int timeoutMs = 100;
+        if (!pending.empty()) {
+            timeoutMs = static_cast<int>(std::max<int64_t>(0, (pending.top().dueNs - now) / 1000000));
+        }
+        pollfd fds[2] = {{sock, POLLIN, 0}, {out, POLLIN, 0}};
+        if (poll(fds, 2, timeoutMs) <= 0) continue;
+
+        now = nowNs();
+        elapsedS = (now - startNs) / 1e9;
+
+        // Forward direction: streamer -> target
+        if (fds[0].revents & POLLIN) {
+            sockaddr_in from{};
+            socklen_t fromLen = sizeof(from);
+            ssize_t n = recvfrom(sock, buf.data(), buf.size(), 0,
+                                 reinterpret_cast<sockaddr*>(&from), &fromLen);
+            if (n > 0) {
+                client = from;
+                haveClient = true;
+                counters.received++;
+                counters.bytesIn += static_cast<uint64_t>(n);
+
+                bool drop = false;
+                if (imp.outageUntilS > elapsedS) {
+                    counters.lostOutage++;
+                    drop = true;
+                } else if (imp.geEnabled) {
+                    geBad = geBad ? uni(rng) >= imp.gePBadToGood : uni(rng) < imp.gePGoodToBad;
+                    if (uni(rng) < (geBad ? imp.geLossBad : imp.geLossGood)) {
+                        counters.lostBurst++;
+                        drop = true;
+                    }
+                }
+                if (!drop && imp.loss > 0 && uni(rng) < imp.loss) {
+                    counters.lostRandom++;
+                    drop = true;
+                }
+
+                int64_t departNs = now;
+                if (!drop && imp.rateKbps > 0) {
+                    int64_t serializeNs = static_cast<int64_t>(n * 8.0 / (imp.rateKbps * 1000.0) * 1e9);
+                    int64_t startTx = std::max(now, bottleneckFreeNs);
+                    if ((startTx - now) / 1e6 > imp.queueMs) {
+                        counters.lostQueue++;
+                        drop = true;
+                    } else {
+                        bottleneckFreeNs = startTx + serializeNs;
+                        departNs = bottleneckFreeNs;
+                    }
+                }
+
+                if (!drop) {
+                    double delayMs = imp.delayMs;
+                    if (imp.jitterMs > 0) delayMs += (uni(rng) * 2.0 - 1.0) * imp.jitterMs;
+                    int64_t due = departNs + static_cast<int64_t>(std::max(0.0, delayMs) * 1e6);
+                    if (imp.reorder > 0 && uni(rng) < imp.reorder) {
+                        due += static_cast<int64_t>(imp.reorderMs * 1e6);
+                        counters.reordered++;
+                    } else {
+                        due = std::max(due, lastDueNs);   // Jitter alone keeps order
+                        lastDueNs = due;
+                    }
+                    pending.push({due, seqCounter++, true,
+                                  std::vector<uint8_t>(buf.begin(), buf.begin() + n)});
+                }
+            }
+        }
+
+        // Return direction: target -> streamer (SRT ACK/NAK, handshakes)
+        if (fds[1].revents & POLLIN) {
+            ssize_t n = recv(out, buf.data(), buf.size(), 0);
+            if (n > 0 && haveClient) {
+                bool drop = impairReturn && imp.outageUntilS > elapsedS;
+                if (!drop && impairReturn && imp.loss > 0 && uni(rng) < imp.loss) drop = true;
+                if (!drop) {
+                    int64_t due = now;
+                    if (impairReturn) due += static_cast<int64_t>(imp.delayMs * 1e6);
+                    pending.push({due, seqCounter++, false,
+                                  std::vector<uint8_t>(buf.begin(), buf.begin() + n)});
+                }
+            }
+        }
+    }
+
+    fprintf(stderr, "impair_relay: received=%llu forwarded=%llu lost=%llu (random %llu, burst %llu, queue %llu, outage %llu)\n",
+            (unsigned long long)counters.received, (unsigned long long)counters.forwarded,
+            (unsigned long long)(counters.lostRandom + counters.lostBurst + counters.lostQueue + counters.lostOutage),
+            (unsigned long long)counters.lostRandom, (unsigned long long)counters.lostBurst,
+            (unsigned long long)counters.lostQueue, (unsigned long long)counters.lostOutage);
+    close(sock);
+    close(out);
+    return 0;
+}
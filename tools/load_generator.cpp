@@ -0,0 +1,662 @@
+/**
+ * load_generator - how many concurrent sessions the app's native core
+ * sustains on this host, and what gives out first.
+ *
+ * Runs SrtStreamer instances (software x264 + AAC, UDP out) fed by
+ * synthetic NV21 frames and a PCM tone at the camera's cadence. Each
+ * session sends to its own loopback port, where a receiver stand-in counts
+ * the delivered TS. Sessions are added --step at a time; once a step has
+ * settled, output fps, encode latency, process CPU and RSS are measured
+ * over --window seconds. The ramp stops at the first step that misses the
+ * fps or latency SLO, or at --max-sessions.
+ *
+ * Prints the capacity curve (one row per step) to stdout, then CPU, memory
+ * and bandwidth per layer (ES to wire) per session at the last passing step,
+ * and the first bottlenecked stage: the pipeline thread role (capture,
+ * audio, encode, send, main_loop) with a saturated thread, or the one using
+ * the most CPU, when the SLO broke. Pipeline logs go to stderr.
+ *
+ * Build (host, GStreamer 1.x with x264enc, voaacenc and mpegtsmux):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -DLIBSRT_AVAILABLE=0 \
+ *       -Itools/host -Iapp/src/main/jni -o load_generator tools/load_generator.cpp \
+ *       app/src/main/jni/{srt_streamer,srt_transport,multilink_sender,arq_sender,ts_muxer,packet_pacer,frame_admission,frame_convert,thread_placement,metrics_history,trace,main_dispatcher,roi,memory_budget,gst_startup,logger,byte_accounting,thermal_governor,encoder_backend}.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0 gstreamer-video-1.0) -lpthread -ldl
+ *
+ * Examples:
+ *   GST_DEBUG=1 load_generator --resolution 1080p --max-sessions 16 2>/dev/null
+ *   load_generator --resolution 720p --preset veryfast --min-fps 29 --max-latency 150 --csv curve.csv
+ */
+
+#include "srt_streamer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace orbistream;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+constexpr size_t kTsPacketSize = 188;
+constexpr int kFramePoolSize = 8;        // Distinct frames cycled by every generator
+constexpr int kAudioChunkMs = 20;
+
+struct Options {
+    int width = 1920;
+    int height = 1080;
+    int fps = 30;
+    int kbps = 4000;
+    EncoderPreset preset = EncoderPreset::ULTRAFAST;
+    RateControl rateControl = RateControl::CAPPED_VBR;
+    MuxerMode muxer = MuxerMode::MPEGTSMUX;
+    bool audio = true;
+    int64_t memoryBudgetBytes = 0;       // Per session
+    int basePort = 9200;
+    int maxSessions = 0;                 // 0 = twice the online CPUs
+    int step = 1;
+    double settleS = 3.0;
+    double windowS = 10.0;
+    double minFpsRatio = 0.95;           // Of --fps, for the slowest session
+    double maxLatencyMs = 200.0;         // p95 encode latency over all sessions
+    std::string csvPath;
+};
+
+double elapsedS(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+double processCpuS() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+double rssMb() {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0.0;
+    long pages = 0;
+    long resident = 0;
+    int n = fscanf(file, "%ld %ld", &pages, &resident);
+    fclose(file);
+    return n == 2 ? resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0) : 0.0;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(std::ceil(p * values.size())) - 1;
+    return values[std::min(index, values.size() - 1)];
+}
+
+// Moving bars over per-pixel noise, so x264 has real work in every frame
+std::vector<std::vector<uint8_t>> makeFramePool(int width, int height) {
+    std::vector<std::vector<uint8_t>> pool(kFramePoolSize);
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    uint32_t seed = 1;
+    for (int f = 0; f < kFramePoolSize; f++) {
+        std::vector<uint8_t>& frame = pool[f];
+        frame.resize(lumaSize * 3 / 2);
+        const int shift = f * width / (kFramePoolSize * 4);
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = frame.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                int bar = (((x + shift) / 64) & 1) ? 160 : 64;
+                row[x] = static_cast<uint8_t>(bar + ((seed >> 24) & 0x1F) + (y * 32) / height);
+            }
+        }
+        // Interleaved VU, a slow colour shift per frame
+        uint8_t* chroma = frame.data() + lumaSize;
+        for (size_t i = 0; i < lumaSize / 2; i += 2) {
+            chroma[i] = static_cast<uint8_t>(128 + f * 4);
+            chroma[i + 1] = static_cast<uint8_t>(128 - f * 4);
+        }
+    }
+    return pool;
+}
+
+std::vector<uint8_t> makeToneChunk(int sampleRate, int channels) {
+    const int samples = sampleRate * kAudioChunkMs / 1000;
+    std::vector<uint8_t> chunk(static_cast<size_t>(samples) * channels * 2);
+    auto* pcm = reinterpret_cast<int16_t*>(chunk.data());
+    for (int i = 0; i < samples; i++) {
+        // 1 kHz: a whole number of cycles per 20 ms chunk, so chunks join cleanly
+        auto v = static_cast<int16_t>(8000 * std::sin(2.0 * M_PI * 1000.0 * i / sampleRate));
+        for (int c = 0; c < channels; c++) pcm[i * channels + c] = v;
+    }
+    return chunk;
+}
+
+/**
+ * Stands in for the remote end of every session: one UDP socket per
+ * session on loopback, read by a single poll() thread.
+ */
+class Receivers {
+public:
+    ~Receivers() { stop(); }
+
+    bool add(int port) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return false;
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            fprintf(stderr, "bind 127.0.0.1:%d: %s\n", port, strerror(errno));
+            close(fd);
+            return false;
+        }
+        stop();
+        fds.push_back(fd);
+        counters.emplace_back(new Counter());
+        running = true;
+        thread = std::thread(&Receivers::run, this);
+        return true;
+    }
+
+    uint64_t bytes(size_t session) const { return counters[session]->bytes.load(std::memory_order_relaxed); }
+    uint64_t syncErrors(size_t session) const { return counters[session]->syncErrors.load(std::memory_order_relaxed); }
+
+    void stop() {
+        running = false;
+        if (thread.joinable()) thread.join();
+    }
+
+    void closeAll() {
+        stop();
+        for (int fd : fds) close(fd);
+        fds.clear();
+    }
+
+private:
+    struct Counter {
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> syncErrors{0};   // Datagrams that aren't whole 0x47-aligned TS packets
+    };
+
+    void run() {
+        std::vector<pollfd> pfds;
+        for (int fd : fds) pfds.push_back({fd, POLLIN, 0});
+        uint8_t buf[65536];
+        while (running) {
+            if (poll(pfds.data(), pfds.size(), 100) <= 0) continue;
+            for (size_t i = 0; i < pfds.size(); i++) {
+                if (!(pfds[i].revents & POLLIN)) continue;
+                ssize_t n;
+                while ((n = recv(pfds[i].fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+                    Counter& counter = *counters[i];
+                    counter.bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+                    bool aligned = n % kTsPacketSize == 0;
+                    for (ssize_t off = 0; aligned && off < n; off += kTsPacketSize) {
+                        aligned = buf[off] == 0x47;
+                    }
+                    if (!aligned) counter.syncErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    std::vector<int> fds;
+    std::vector<std::unique_ptr<Counter>> counters;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+
+/**
+ * One streamer and the thread playing camera and microphone for it.
+ */
+class Session {
+public:
+    Session(int sessionIndex, const Options& options,
+            const std::vector<std::vector<uint8_t>>& framePool, const std::vector<uint8_t>& toneChunk)
+        : index(sessionIndex), opts(options), frames(framePool), tone(toneChunk) {}
+
+    ~Session() {
+        running = false;
+        if (feeder.joinable()) feeder.join();
+        streamer.stop();
+    }
+
+    bool start() {
+        StreamConfig config;
+        config.transport = TransportMode::UDP;
+        config.srtHost = "127.0.0.1";
+        config.srtPort = opts.basePort + index;
+        config.useProxy = false;
+        config.videoWidth = opts.width;
+        config.videoHeight = opts.height;
+        config.videoBitrate = opts.kbps * 1000;
+        config.frameRate = opts.fps;
+        config.preset = opts.preset;
+        config.rateControl = opts.rateControl;
+        config.useHardwareEncoder = false;
+        config.useCalibration = false;
+        config.muxer = opts.muxer;
+        config.autoRecover = false;
+        config.enableGovernor = false;     // Capacity at the requested point, not a degraded one
+        config.memoryBudgetBytes = opts.memoryBudgetBytes;
+
+        if (!streamer.createPipeline(config) || !streamer.start()) {
+            fprintf(stderr, "session %d: pipeline failed to start\n", index);
+            return false;
+        }
+        running = true;
+        feeder = std::thread(&Session::feed, this);
+        return true;
+    }
+
+    StreamStats stats() const { return streamer.getStats(); }
+    uint64_t framesPushed() const { return pushed.load(std::memory_order_relaxed); }
+    uint64_t framesLate() const { return late.load(std::memory_order_relaxed); }
+
+private:
+    void feed() {
+        using clock = std::chrono::steady_clock;
+        const auto frameInterval = std::chrono::nanoseconds(1000000000LL / opts.fps);
+        const auto audioInterval = std::chrono::milliseconds(kAudioChunkMs);
+        const auto start = clock::now();
+        auto nextFrame = start;
+        auto nextAudio = start;
+        int frameIndex = index;    // Sessions start at different frames of the pool
+
+        while (running) {
+            auto now = clock::now();
+            int64_t tsNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+            if (now >= nextFrame) {
+                const std::vector<uint8_t>& frame = frames[frameIndex++ % frames.size()];
+                streamer.pushVideoFrame(frame.data(), frame.size(), opts.width, opts.height, tsNs);
+                pushed.fetch_add(1, std::memory_order_relaxed);
+                nextFrame += frameInterval;
+                // A camera doesn't queue frames it couldn't deliver: skip, don't burst
+                if (clock::now() > nextFrame) {
+                    late.fetch_add(1, std::memory_order_relaxed);
+                    nextFrame = clock::now() + frameInterval;
+                }
+            }
+            if (opts.audio && now >= nextAudio) {
+                streamer.pushAudioSamples(tone.data(), tone.size(), 48000, 2, tsNs);
+                nextAudio += audioInterval;
+            }
+            std::this_thread::sleep_until(opts.audio ? std::min(nextFrame, nextAudio) : nextFrame);
+        }
+    }
+
+    const int index;
+    const Options& opts;
+    const std::vector<std::vector<uint8_t>>& frames;
+    const std::vector<uint8_t>& tone;
+    SrtStreamer streamer;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> late{0};
+    std::thread feeder;
+};
+
+struct RoleLoad {
+    double cores = 0.0;          // CPU of all threads in the role, all sessions
+    double hottestThread = 0.0;  // Busiest single thread, fraction of one core
+};
+
+struct StepResult {
+    int sessions = 0;
+    double minFps = 0.0;
+    double avgFps = 0.0;
+    double p95LatencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+    double cpuCores = 0.0;
+    double rssMb = 0.0;
+    double deliveredMbps = 0.0;
+    double layerMbps[static_cast<size_t>(ByteLayer::COUNT)] = {};   // All sessions, per ByteLayer
+    uint64_t refused = 0;        // Frames refused at ingest during the window
+    uint64_t late = 0;           // Frames the generators couldn't push on time
+    uint64_t syncErrors = 0;
+    std::map<ThreadRole, RoleLoad> roles;
+    bool fpsOk = true;
+    bool latencyOk = true;
+    std::string bottleneck;
+};
+
+// Stage that gave out: a role with a thread pinned at one core is a serial
+// limit; otherwise, if the CPUs are full, the role using most of them
+std::string findBottleneck(const StepResult& r, int onlineCpus) {
+    const std::pair<const ThreadRole, RoleLoad>* hottest = nullptr;
+    const std::pair<const ThreadRole, RoleLoad>* heaviest = nullptr;
+    for (const auto& entry : r.roles) {
+        if (!hottest || entry.second.hottestThread > hottest->second.hottestThread) hottest = &entry;
+        if (!heaviest || entry.second.cores > heaviest->second.cores) heaviest = &entry;
+    }
+    if (!heaviest) return "unknown";
+
+    char text[128];
+    if (hottest->second.hottestThread >= 0.9) {
+        snprintf(text, sizeof(text), "%s (one thread at %.0f%% of a core)",
+                 ThreadPlacer::roleName(hottest->first), hottest->second.hottestThread * 100.0);
+    } else if (r.cpuCores >= 0.9 * onlineCpus) {
+        snprintf(text, sizeof(text), "%s (CPU saturated, %.1f of %d cores in this stage)",
+                 ThreadPlacer::roleName(heaviest->first), heaviest->second.cores, onlineCpus);
+    } else if (r.late > 0) {
+        snprintf(text, sizeof(text), "generator (%llu frames pushed late)", (unsigned long long)r.late);
+    } else {
+        snprintf(text, sizeof(text), "%s (busiest stage, %.1f cores, CPU not saturated)",
+                 ThreadPlacer::roleName(heaviest->first), heaviest->second.cores);
+    }
+    return text;
+}
+
+StepResult measure(const std::vector<std::unique_ptr<Session>>& sessions, const Receivers& receivers,
+                   const Options& opts, int onlineCpus) {
+    StepResult r;
+    r.sessions = static_cast<int>(sessions.size());
+    const size_t n = sessions.size();
+
+    std::vector<uint64_t> refused0(n), late0(n), bytes0(n), sync0(n);
+    std::vector<std::map<int, double>> threadCpu0(n);
+    std::vector<std::vector<LayerBytes>> layers0(n);
+    std::vector<double> fpsSum(n, 0.0);
+    std::vector<int> fpsSamples(n, 0);
+    std::vector<double> latencies;
+
+    for (size_t i = 0; i < n; i++) {
+        StreamStats st = sessions[i]->stats();
+        refused0[i] = st.framesRefused;
+        late0[i] = sessions[i]->framesLate();
+        bytes0[i] = receivers.bytes(i);
+        sync0[i] = receivers.syncErrors(i);
+        for (const auto& t : st.threadCpuTimes) threadCpu0[i][t.tid] = t.cpuMs;
+        layers0[i] = st.byteLayers;
+    }
+    const double cpu0 = processCpuS();
+    const auto windowStart = std::chrono::steady_clock::now();
+
+    // Encode latency is the latest frame's, so sample it often; fps is per second
+    std::vector<StreamStats> last(n);
+    while (!g_stop && elapsedS(windowStart) < opts.windowS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        for (size_t i = 0; i < n; i++) {
+            last[i] = sessions[i]->stats();
+            latencies.push_back(last[i].encodeLatencyMs);
+            fpsSum[i] += last[i].outputFps;
+            fpsSamples[i]++;
+        }
+    }
+    const double windowS = elapsedS(windowStart);
+    r.cpuCores = (processCpuS() - cpu0) / windowS;
+    r.rssMb = rssMb();
+
+    r.minFps = 1e9;
+    uint64_t deliveredBytes = 0;
+    for (size_t i = 0; i < n; i++) {
+        double fps = fpsSamples[i] ? fpsSum[i] / fpsSamples[i] : 0.0;
+        r.minFps = std::min(r.minFps, fps);
+        r.avgFps += fps / n;
+        r.refused += last[i].framesRefused - refused0[i];
+        r.late += sessions[i]->framesLate() - late0[i];
+        deliveredBytes += receivers.bytes(i) - bytes0[i];
+        r.syncErrors += receivers.syncErrors(i) - sync0[i];
+        for (const LayerBytes& layer : last[i].byteLayers) {
+            uint64_t before = 0;
+            for (const LayerBytes& old : layers0[i]) {
+                if (old.layer == layer.layer) before = old.bytes;
+            }
+            r.layerMbps[static_cast<size_t>(layer.layer)] +=
+                (layer.bytes - std::min(before, layer.bytes)) * 8.0 / windowS / 1e6;
+        }
+
+        // Threads are new when they first ran in this window
+        for (const auto& t : last[i].threadCpuTimes) {
+            auto before = threadCpu0[i].find(t.tid);
+            double busy = (t.cpuMs - (before != threadCpu0[i].end() ? before->second : 0.0)) / (windowS * 1000.0);
+            RoleLoad& load = r.roles[t.role];
+            load.cores += busy;
+            load.hottestThread = std::max(load.hottestThread, busy);
+        }
+    }
+    if (n == 0) r.minFps = 0.0;
+    r.deliveredMbps = deliveredBytes * 8.0 / windowS / 1e6;
+    r.p95LatencyMs = percentile(latencies, 0.95);
+    r.maxLatencyMs = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+
+    r.fpsOk = r.minFps >= opts.fps * opts.minFpsRatio;
+    r.latencyOk = r.p95LatencyMs <= opts.maxLatencyMs;
+    r.bottleneck = findBottleneck(r, onlineCpus);
+    return r;
+}
+
+bool parsePreset(const std::string& name, EncoderPreset& preset) {
+    static const std::pair<const char*, EncoderPreset> kPresets[] = {
+        {"ultrafast", EncoderPreset::ULTRAFAST}, {"superfast", EncoderPreset::SUPERFAST},
+        {"veryfast", EncoderPreset::VERYFAST}, {"faster", EncoderPreset::FASTER},
+        {"fast", EncoderPreset::FAST}, {"medium", EncoderPreset::MEDIUM},
+    };
+    for (const auto& p : kPresets) {
+        if (name == p.first) {
+            preset = p.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseResolution(const std::string& spec, int& width, int& height) {
+    if (spec == "1080p") { width = 1920; height = 1080; return true; }
+    if (spec == "720p") { width = 1280; height = 720; return true; }
+    if (spec == "480p") { width = 854; height = 480; return true; }
+    return sscanf(spec.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0 &&
+           width % 2 == 0 && height % 2 == 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --resolution <r>     1080p, 720p, 480p or WxH (default 1080p)\n"
+        "  --fps <n>            frame rate (default 30)\n"
+        "  --kbps <n>           video bitrate per session (default 4000)\n"
+        "  --preset <name>      x264 preset, ultrafast..medium (default ultrafast)\n"
+        "  --rate-control <r>   cbr, vbr (capped) or cq (default vbr)\n"
+        "  --muxer <m>          mpegtsmux or native (default mpegtsmux)\n"
+        "  --no-audio           video only\n"
+        "  --memory-budget <MB> memory budget per session (default none)\n"
+        "  --base-port <port>   session i sends to 127.0.0.1:<port + i> (default 9200)\n"
+        "  --max-sessions <n>   stop the ramp here (default 2x online CPUs)\n"
+        "  --step <n>           sessions added per step (default 1)\n"
+        "  --settle <s>         wait after adding sessions (default 3)\n"
+        "  --window <s>         measurement window per step (default 10)\n"
+        "  --min-fps <n>        fps SLO for the slowest session (default 95%% of --fps)\n"
+        "  --max-latency <ms>   p95 encode latency SLO (default 200)\n"
+        "  --csv <path>         also write the capacity curve as CSV\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    double minFps = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else if (arg == "--fps") opts.fps = atoi(next().c_str());
+        else if (arg == "--kbps") opts.kbps = atoi(next().c_str());
+        else if (arg == "--preset") ok = parsePreset(next(), opts.preset);
+        else if (arg == "--rate-control") {
+            std::string m = next();
+            ok = m == "cbr" || m == "vbr" || m == "cq";
+            opts.rateControl = m == "cbr" ? RateControl::CBR
+                : m == "cq" ? RateControl::CONSTANT_QUALITY : RateControl::CAPPED_VBR;
+        }
+        else if (arg == "--muxer") {
+            std::string m = next();
+            ok = m == "mpegtsmux" || m == "native";
+            opts.muxer = m == "native" ? MuxerMode::NATIVE : MuxerMode::MPEGTSMUX;
+        }
+        else if (arg == "--no-audio") opts.audio = false;
+        else if (arg == "--memory-budget") opts.memoryBudgetBytes = atoll(next().c_str()) * 1024 * 1024;
+        else if (arg == "--base-port") opts.basePort = atoi(next().c_str());
+        else if (arg == "--max-sessions") opts.maxSessions = atoi(next().c_str());
+        else if (arg == "--step") opts.step = atoi(next().c_str());
+        else if (arg == "--settle") opts.settleS = atof(next().c_str());
+        else if (arg == "--window") opts.windowS = atof(next().c_str());
+        else if (arg == "--min-fps") minFps = atof(next().c_str());
+        else if (arg == "--max-latency") opts.maxLatencyMs = atof(next().c_str());
+        else if (arg == "--csv") opts.csvPath = next();
+        else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.fps <= 0 || opts.kbps <= 0 || opts.step <= 0 || opts.windowS <= 0 || opts.basePort <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (minFps > 0) opts.minFpsRatio = minFps / opts.fps;
+
+    const int onlineCpus = static_cast<int>(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+    if (opts.maxSessions <= 0) opts.maxSessions = onlineCpus * 2;
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    FILE* csv = nullptr;
+    if (!opts.csvPath.empty()) {
+        csv = fopen(opts.csvPath.c_str(), "w");
+        if (!csv) {
+            fprintf(stderr, "cannot write %s: %s\n", opts.csvPath.c_str(), strerror(errno));
+            return 2;
+        }
+        fprintf(csv, "sessions,min_fps,avg_fps,p95_latency_ms,max_latency_ms,cpu_cores,"
+                     "cpu_per_session,rss_mb,mem_per_session_mb,delivered_mbps,refused,late,pass\n");
+    }
+
+    SrtStreamer::initGStreamer();
+    const auto framePool = makeFramePool(opts.width, opts.height);
+    const auto toneChunk = makeToneChunk(48000, 2);
+    // Frame pool and GStreamer registry are shared: not part of any session
+    const double baseRssMb = rssMb();
+
+    printf("# %dx%d@%d %d kbps, %d online CPUs, SLO: fps >= %.1f, p95 latency <= %.0f ms\n",
+           opts.width, opts.height, opts.fps, opts.kbps, onlineCpus,
+           opts.fps * opts.minFpsRatio, opts.maxLatencyMs);
+    printf("%8s %8s %8s %9s %9s %7s %9s %8s %9s %9s %8s  %s\n",
+           "sessions", "min_fps", "avg_fps", "p95_lat", "max_lat", "cpu", "cpu/sess",
+           "rss_mb", "mb/sess", "out_mbps", "refused", "result");
+    fflush(stdout);
+
+    Receivers receivers;
+    std::vector<std::unique_ptr<Session>> sessions;
+    StepResult lastPass;
+    StepResult firstFail;
+    bool failed = false;
+
+    while (!g_stop && !failed && static_cast<int>(sessions.size()) < opts.maxSessions) {
+        int target = std::min(opts.maxSessions, static_cast<int>(sessions.size()) + opts.step);
+        bool started = true;
+        while (static_cast<int>(sessions.size()) < target) {
+            int index = static_cast<int>(sessions.size());
+            if (!receivers.add(opts.basePort + index)) {
+                started = false;
+                break;
+            }
+            auto session = std::make_unique<Session>(index, opts, framePool, toneChunk);
+            if (!session->start()) {
+                started = false;
+                break;
+            }
+            sessions.push_back(std::move(session));
+        }
+        if (!started) break;
+
+        auto settleStart = std::chrono::steady_clock::now();
+        while (!g_stop && elapsedS(settleStart) < opts.settleS) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (g_stop) break;
+
+        StepResult r = measure(sessions, receivers, opts, onlineCpus);
+        const double cpuPerSession = r.cpuCores / r.sessions;
+        const double memPerSession = (r.rssMb - baseRssMb) / r.sessions;
+        bool pass = r.fpsOk && r.latencyOk;
+        std::string result = pass ? "pass" : std::string("FAIL ") + (!r.fpsOk ? "fps" : "latency");
+        if (!r.fpsOk && !r.latencyOk) result += "+latency";
+        printf("%8d %8.1f %8.1f %7.0fms %7.0fms %7.2f %8.0f%% %8.0f %9.1f %9.2f %8llu  %s\n",
+               r.sessions, r.minFps, r.avgFps, r.p95LatencyMs, r.maxLatencyMs, r.cpuCores,
+               cpuPerSession * 100.0, r.rssMb, memPerSession, r.deliveredMbps,
+               (unsigned long long)r.refused, result.c_str());
+        fflush(stdout);
+        if (r.syncErrors > 0) {
+            fprintf(stderr, "warning: %llu misaligned TS datagrams at the receivers\n",
+                    (unsigned long long)r.syncErrors);
+        }
+        if (csv) {
+            fprintf(csv, "%d,%.2f,%.2f,%.1f,%.1f,%.3f,%.3f,%.1f,%.2f,%.3f,%llu,%llu,%d\n",
+                    r.sessions, r.minFps, r.avgFps, r.p95LatencyMs, r.maxLatencyMs, r.cpuCores,
+                    cpuPerSession, r.rssMb, memPerSession, r.deliveredMbps,
+                    (unsigned long long)r.refused, (unsigned long long)r.late, pass ? 1 : 0);
+        }
+
+        if (pass) {
+            lastPass = r;
+        } else {
+            firstFail = r;
+            failed = true;
+        }
+    }
+
+    sessions.clear();
+    receivers.closeAll();
+    if (csv) fclose(csv);
+
+    printf("\n");
+    if (lastPass.sessions > 0) {
+        printf("capacity: %d sessions (%.2f per core)\n", lastPass.sessions,
+               lastPass.sessions / static_cast<double>(onlineCpus));
+        printf("cpu per session: %.0f%% of a core\n", lastPass.cpuCores / lastPass.sessions * 100.0);
+        printf("memory per session: %.1f MB (shared baseline %.0f MB)\n",
+               (lastPass.rssMb - baseRssMb) / lastPass.sessions, baseRssMb);
+        printf("stage cpu at capacity:");
+        for (const auto& entry : lastPass.roles) {
+            printf(" %s=%.2f", ThreadPlacer::roleName(entry.first), entry.second.cores);
+        }
+        printf(" cores\n");
+        auto perSession = [&](ByteLayer layer) {
+            return lastPass.layerMbps[static_cast<size_t>(layer)] / lastPass.sessions;
+        };
+        printf("wire per session: %.2f Mbps (video es %.2f, audio es %.2f, ts %.2f, transport %.2f)\n",
+               perSession(ByteLayer::WIRE), perSession(ByteLayer::VIDEO_ES), perSession(ByteLayer::AUDIO_ES),
+               perSession(ByteLayer::TS), perSession(ByteLayer::TRANSPORT));
+    } else {
+        printf("capacity: 0 sessions (one session already misses the SLO)\n");
+    }
+    if (failed) {
+        printf("first bottleneck at %d sessions: %s\n", firstFail.sessions, firstFail.bottleneck.c_str());
+    } else if (!g_stop) {
+        printf("no SLO miss up to %d sessions\n", opts.maxSessions);
+    }
+    return (failed || lastPass.sessions > 0) ? 0 : 1;
+}
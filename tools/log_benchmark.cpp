@@ -0,0 +1,178 @@
+/**
+ * log_benchmark - what native logging costs the thread that logs.
+ *
+ * Runs a hot-path workload shaped like the encoder thread's: per frame one
+ * VERBOSE (buffer probe) and one DEBUG (frame) record, an INFO every 30
+ * frames and a WARN every 300. It times only the log calls, once with the
+ * app's logger (logger.cpp) writing through synchronously, as
+ * __android_log_print did, and once queued to the async flusher. Each runs
+ * at every level threshold from NONE to VERBOSE.
+ *
+ * The sink makes one write(2) per record to /dev/null, the same syscall
+ * pattern as logd. Reported per config: mean and p99 cost per frame, the
+ * worst frame, records written and records dropped (async ring full).
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -Itools/host -Iapp/src/main/jni -o log_benchmark \
+ *       tools/log_benchmark.cpp app/src/main/jni/logger.cpp -lpthread
+ *
+ * Examples:
+ *   log_benchmark
+ *   log_benchmark --threads 4 --fps 0 --frames 20000 --ring 1024
+ */
+
+#include "logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "Encoder"
+#define LOGE(...) ORBI_LOG(ERROR, __VA_ARGS__)
+#define LOGW(...) ORBI_LOG(WARN, __VA_ARGS__)
+#define LOGI(...) ORBI_LOG(INFO, __VA_ARGS__)
+#define LOGD(...) ORBI_LOG(DEBUG, __VA_ARGS__)
+#define LOGV(...) ORBI_LOG(VERBOSE, __VA_ARGS__)
+
+using namespace orbistream;
+
+namespace {
+
+struct Options {
+    int frames = 2000;
+    int fps = 1000;                 // 0 = as fast as possible
+    int threads = 1;
+    size_t ring = logger::kDefaultRecordsPerThread;
+};
+
+struct Result {
+    double meanNs = 0.0;
+    int64_t p99Ns = 0;
+    int64_t maxNs = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+};
+
+int nullFd = -1;
+
+void nullSink(logger::Level, const char* tag, const char* text) {
+    char line[logger::kRecordText + 64];
+    int n = snprintf(line, sizeof(line), "%s: %s\n", tag, text);
+    ssize_t ignored = ::write(nullFd, line, std::min<size_t>(n, sizeof(line) - 1));
+    (void)ignored;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// One producer thread; per-frame log cost in ns
+void produce(const Options& opts, int id, std::vector<int64_t>& costs) {
+    costs.reserve(opts.frames);
+    auto next = std::chrono::steady_clock::now();
+    auto period = opts.fps > 0 ? std::chrono::nanoseconds(1000000000LL / opts.fps)
+                               : std::chrono::nanoseconds(0);
+    for (int frame = 0; frame < opts.frames; frame++) {
+        int64_t pts = frame * 33333333LL;
+        size_t size = 12000 + (frame * 7919) % 40000;
+        int64_t begin = nowNs();
+        LOGV("video_src buffer pts=%lld size=%zu flags=0x%x thread=%d", (long long)pts, size, frame % 30 ? 0x2000 : 0, id);
+        LOGD("Encoded frame %d: %zu bytes, qp %d, %s", frame, size, 20 + frame % 12, frame % 30 ? "P" : "IDR");
+        if (frame % 30 == 0) LOGI("Stats: fps=%.1f bitrate=%.0f kbps queue=%d", 30.0, size * 8 * 30 / 1000.0, frame % 5);
+        if (frame % 300 == 0) LOGW("Encoder behind by %d frames", frame % 7);
+        costs.push_back(nowNs() - begin);
+        if (period.count() > 0) {
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+Result run(const Options& opts, logger::Level threshold, bool async) {
+    logger::setLevel("*", threshold);
+    if (async) logger::start(opts.ring);
+    logger::Stats before = logger::stats();
+
+    std::vector<std::vector<int64_t>> costs(opts.threads);
+    std::vector<std::thread> producers;
+    for (int i = 0; i < opts.threads; i++) {
+        producers.emplace_back(produce, std::cref(opts), i, std::ref(costs[i]));
+    }
+    for (auto& producer : producers) producer.join();
+    if (async) logger::stop();
+
+    std::vector<int64_t> all;
+    for (auto& perThread : costs) all.insert(all.end(), perThread.begin(), perThread.end());
+    std::sort(all.begin(), all.end());
+    Result result;
+    double sum = 0.0;
+    for (int64_t ns : all) sum += ns;
+    result.meanNs = all.empty() ? 0.0 : sum / all.size();
+    result.p99Ns = all.empty() ? 0 : all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    result.maxNs = all.empty() ? 0 : all.back();
+    logger::Stats after = logger::stats();
+    // written includes the flusher's drop notices
+    result.dropped = after.dropped - before.dropped;
+    result.written = after.written - before.written;
+    return result;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--frames N] [--fps N|0] [--threads N] [--ring RECORDS]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--frames") opts.frames = atoi(next().c_str());
+        else if (arg == "--fps") opts.fps = atoi(next().c_str());
+        else if (arg == "--threads") opts.threads = atoi(next().c_str());
+        else if (arg == "--ring") opts.ring = static_cast<size_t>(atol(next().c_str()));
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.frames <= 0 || opts.fps < 0 || opts.threads <= 0 || opts.ring == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    nullFd = open("/dev/null", O_WRONLY);
+    if (nullFd < 0) {
+        perror("/dev/null");
+        return 1;
+    }
+    logger::setSink(&nullSink);
+
+    printf("# %d thread(s) x %d frames at %s, ring %zu records\n", opts.threads, opts.frames,
+           opts.fps > 0 ? (std::to_string(opts.fps) + " fps").c_str() : "full speed", opts.ring);
+    printf("%-8s %-6s %10s %10s %10s %9s %8s\n", "level", "mode", "mean_ns", "p99_ns", "max_ns",
+           "written", "dropped");
+    const logger::Level levels[] = {logger::Level::NONE, logger::Level::ERROR, logger::Level::WARN,
+                                    logger::Level::INFO, logger::Level::DEBUG, logger::Level::VERBOSE};
+    for (logger::Level level : levels) {
+        for (bool async : {false, true}) {
+            Result r = run(opts, level, async);
+            printf("%-8s %-6s %10.0f %10lld %10lld %9llu %8llu\n", logger::levelName(level),
+                   async ? "async" : "sync", r.meanNs, (long long)r.p99Ns, (long long)r.maxNs,
+                   (unsigned long long)r.written, (unsigned long long)r.dropped);
+        }
+    }
+    close(nullFd);
+    return 0;
+}
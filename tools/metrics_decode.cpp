@@ -0,0 +1,171 @@
+/**
+ * metrics_decode - converts a metrics history dump to CSV.
+ *
+ * Reads the file written by SrtStreamer::dumpMetricsHistory() /
+ * NativeStreamer.dumpMetricsHistory() (format in metrics_history.h) and
+ * prints one CSV row per record. Columns come from the file's own field
+ * table, so dumps from newer app versions still decode. A wall_clock_ms
+ * column is added from the header's timestamp of the last record.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -o metrics_decode tools/metrics_decode.cpp
+ *
+ * Examples:
+ *   adb exec-out run-as com.orbistream sh -c 'cat files/metrics/<file>.osmh' > m.osmh
+ *   metrics_decode m.osmh > m.csv
+ *   metrics_decode --summary m.osmh
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kHeaderSize = 28;
+constexpr size_t kNameSize = 24;
+constexpr uint32_t kTypeF32 = 1;
+
+struct Field {
+    std::string name;
+    uint32_t type = 0;
+};
+
+uint64_t getLe(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+float toFloat(uint32_t word) {
+    float f;
+    memcpy(&f, &word, sizeof(f));
+    return f;
+}
+
+bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(file);
+    return true;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [--summary] <dump.osmh>\n"
+        "  --summary   print min/avg/max per column instead of CSV\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool summary = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--summary") summary = true;
+        else if (!path && arg[0] != '-') path = argv[i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    if (data.size() < kHeaderSize || memcmp(data.data(), "OSMH", 4) != 0) {
+        fprintf(stderr, "%s: not a metrics history dump\n", path);
+        return 1;
+    }
+
+    const uint8_t* p = data.data();
+    uint32_t version = static_cast<uint32_t>(getLe(p + 4, 2));
+    size_t fieldCount = static_cast<size_t>(getLe(p + 6, 2));
+    size_t recordSize = static_cast<size_t>(getLe(p + 8, 4));
+    size_t recordCount = static_cast<size_t>(getLe(p + 12, 4));
+    uint32_t intervalMs = static_cast<uint32_t>(getLe(p + 16, 4));
+    uint64_t lastWallMs = getLe(p + 20, 8);
+
+    size_t tableSize = fieldCount * (kNameSize + 4);
+    if (version != 1 || recordSize != fieldCount * 4 ||
+        data.size() < kHeaderSize + tableSize + recordCount * recordSize) {
+        fprintf(stderr, "%s: unsupported version %u or truncated file\n", path, version);
+        return 1;
+    }
+
+    std::vector<Field> fields(fieldCount);
+    size_t timeColumn = fieldCount;
+    for (size_t i = 0; i < fieldCount; i++) {
+        const uint8_t* entry = p + kHeaderSize + i * (kNameSize + 4);
+        fields[i].name.assign(reinterpret_cast<const char*>(entry),
+                              strnlen(reinterpret_cast<const char*>(entry), kNameSize));
+        fields[i].type = static_cast<uint32_t>(getLe(entry + kNameSize, 4));
+        if (fields[i].name == "stream_time_ms") timeColumn = i;
+    }
+
+    const uint8_t* records = p + kHeaderSize + tableSize;
+    auto word = [&](size_t record, size_t field) {
+        return static_cast<uint32_t>(getLe(records + record * recordSize + field * 4, 4));
+    };
+    auto value = [&](size_t record, size_t field) {
+        uint32_t w = word(record, field);
+        return fields[field].type == kTypeF32 ? static_cast<double>(toFloat(w))
+                                              : static_cast<double>(w);
+    };
+
+    if (summary) {
+        uint32_t spanMs = recordCount > 1 && timeColumn < fieldCount
+            ? word(recordCount - 1, timeColumn) - word(0, timeColumn) : 0;
+        printf("%zu records, %u ms interval, %.1f s covered\n",
+               recordCount, intervalMs, spanMs / 1000.0);
+        printf("%-24s %12s %12s %12s\n", "column", "min", "avg", "max");
+        for (size_t f = 0; f < fieldCount; f++) {
+            if (recordCount == 0) break;
+            double lo = value(0, f), hi = lo, sum = 0;
+            for (size_t r = 0; r < recordCount; r++) {
+                double v = value(r, f);
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                sum += v;
+            }
+            printf("%-24s %12.2f %12.2f %12.2f\n", fields[f].name.c_str(), lo, sum / recordCount, hi);
+        }
+        return 0;
+    }
+
+    // Wall clock from the last record's, walking back by stream time
+    bool haveWall = lastWallMs > 0 && timeColumn < fieldCount && recordCount > 0;
+    uint32_t lastStreamMs = haveWall ? word(recordCount - 1, timeColumn) : 0;
+
+    printf("wall_clock_ms");
+    for (const Field& field : fields) {
+        printf(",%s", field.name.c_str());
+    }
+    printf("\n");
+    for (size_t r = 0; r < recordCount; r++) {
+        if (haveWall) {
+            printf("%" PRIu64, lastWallMs - (lastStreamMs - word(r, timeColumn)));
+        }
+        for (size_t f = 0; f < fieldCount; f++) {
+            uint32_t w = word(r, f);
+            if (fields[f].type == kTypeF32) printf(",%.3f", toFloat(w));
+            else printf(",%u", w);
+        }
+        printf("\n");
+    }
+    return 0;
+}
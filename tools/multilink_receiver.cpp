@@ -0,0 +1,267 @@
+/**
+ * multilink_receiver - reference receiver for the app's MultiLinkSender.
+ *
+ * Listens on one UDP port for datagrams from every link, answers probes
+ * with the packet and byte counts received on that link, restores the
+ * global sequence order and forwards the TS payload to --forward (e.g. a
+ * ts_receiver). A gap is held for at most --reorder-ms before the missing
+ * datagrams are declared lost and delivery moves on.
+ *
+ * Prints per-link throughput once per second and a summary on exit:
+ * delivered, lost, duplicates and the deepest reordering seen.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -o multilink_receiver tools/multilink_receiver.cpp
+ *
+ * Examples:
+ *   multilink_receiver --listen 9000 --forward 127.0.0.1:9001 --reorder-ms 80
+ *   multilink_receiver --listen 9000 --duration 30 --max-lost 0
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Wire format shared with app/src/main/jni/multilink_sender.h
+constexpr size_t kHeaderSize = 12;
+constexpr uint8_t kMagic = 0x4F;
+constexpr uint8_t kTypeData = 1;
+constexpr uint8_t kTypeProbe = 2;
+constexpr uint8_t kTypeProbeReply = 3;
+
+using Clock = std::chrono::steady_clock;
+
+volatile sig_atomic_t g_stop = 0;
+
+struct LinkCounters {
+    std::string source;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;         // Whole datagrams, as counted by the sender
+    uint64_t probes = 0;
+    uint64_t intervalBytes = 0;
+};
+
+struct Held {
+    std::vector<uint8_t> payload;
+    Clock::time_point arrived;
+};
+
+uint32_t get32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+// Sequence comparison with 32-bit wraparound
+bool seqBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+bool parseHostPort(const std::string& spec, sockaddr_in& addr) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(atoi(spec.c_str() + colon + 1)));
+    return inet_pton(AF_INET, spec.substr(0, colon).c_str(), &addr.sin_addr) == 1;
+}
+
+std::string addressString(const sockaddr_in& addr) {
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+    return std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --listen <port> [options]\n"
+        "  --forward <host:port>  send reordered TS payload here\n"
+        "  --reorder-ms <n>       how long a gap is waited for (default 100)\n"
+        "  --duration <s>         stop after s seconds\n"
+        "  --max-lost <n>         exit 1 if more datagrams were lost\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int listenPort = 0;
+    int reorderMs = 100;
+    double durationS = 0.0;
+    long long maxLost = -1;
+    bool forward = false;
+    sockaddr_in forwardAddr = {};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--listen") listenPort = atoi(next().c_str());
+        else if (arg == "--forward") {
+            forward = parseHostPort(next(), forwardAddr);
+            if (!forward) { usage(argv[0]); return 2; }
+        }
+        else if (arg == "--reorder-ms") reorderMs = atoi(next().c_str());
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else if (arg == "--max-lost") maxLost = atoll(next().c_str());
+        else { usage(argv[0]); return 2; }
+    }
+    if (listenPort <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in bindAddr = {};
+    bindAddr.sin_family = AF_INET;
+    bindAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    bindAddr.sin_port = htons(static_cast<uint16_t>(listenPort));
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&bindAddr), sizeof(bindAddr)) < 0) {
+        perror("bind");
+        return 2;
+    }
+    int outFd = forward ? socket(AF_INET, SOCK_DGRAM, 0) : -1;
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    std::map<uint8_t, LinkCounters> links;
+    std::map<uint32_t, Held> held;          // Out of order, waiting for the gap to fill
+    bool started = false;
+    uint32_t nextSeq = 0;
+    uint64_t delivered = 0, lost = 0, duplicates = 0, late = 0, intervalDelivered = 0;
+    uint32_t maxReorderDepth = 0;
+
+    auto deliver = [&](const uint8_t* data, size_t size) {
+        if (outFd >= 0) {
+            sendto(outFd, data, size, 0, reinterpret_cast<sockaddr*>(&forwardAddr), sizeof(forwardAddr));
+        }
+        delivered++;
+        intervalDelivered++;
+    };
+    auto drainInOrder = [&]() {
+        for (auto it = held.begin(); it != held.end() && it->first == nextSeq; it = held.begin()) {
+            deliver(it->second.payload.data(), it->second.payload.size());
+            held.erase(it);
+            nextSeq++;
+        }
+    };
+
+    const auto start = Clock::now();
+    auto nextReport = start + std::chrono::seconds(1);
+    uint8_t buf[2048];
+
+    while (!g_stop) {
+        auto now = Clock::now();
+        if (durationS > 0 && now - start >= std::chrono::duration<double>(durationS)) break;
+
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 10) > 0) {
+            sockaddr_in from = {};
+            socklen_t fromLen = sizeof(from);
+            ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+            now = Clock::now();
+            if (n >= static_cast<ssize_t>(kHeaderSize) && buf[0] == kMagic) {
+                uint8_t type = buf[1];
+                LinkCounters& link = links[buf[2]];
+                if (link.source.empty()) link.source = addressString(from);
+                uint32_t seq = get32(buf + 4);
+
+                if (type == kTypeProbe) {
+                    link.probes++;
+                    uint8_t reply[kHeaderSize + 12];
+                    memcpy(reply, buf, kHeaderSize);
+                    reply[1] = kTypeProbeReply;
+                    put32(reply + kHeaderSize, static_cast<uint32_t>(link.packets));
+                    put32(reply + kHeaderSize + 4, static_cast<uint32_t>(link.bytes >> 32));
+                    put32(reply + kHeaderSize + 8, static_cast<uint32_t>(link.bytes));
+                    sendto(fd, reply, sizeof(reply), 0, reinterpret_cast<sockaddr*>(&from), fromLen);
+                } else if (type == kTypeData) {
+                    link.packets++;
+                    link.bytes += n;
+                    link.intervalBytes += n;
+                    if (!started) {
+                        started = true;
+                        nextSeq = seq;
+                    }
+                    if (seqBefore(seq, nextSeq)) {
+                        // Delivery already moved past it (delivered, or declared lost)
+                        late++;
+                    } else if (held.count(seq)) {
+                        duplicates++;
+                    } else if (seq == nextSeq) {
+                        deliver(buf + kHeaderSize, n - kHeaderSize);
+                        nextSeq++;
+                        drainInOrder();
+                    } else {
+                        maxReorderDepth = std::max(maxReorderDepth, seq - nextSeq);
+                        held[seq] = {std::vector<uint8_t>(buf + kHeaderSize, buf + n), now};
+                    }
+                }
+            }
+        }
+
+        // Give up on a gap once the oldest datagram behind it waited reorderMs
+        while (!held.empty()) {
+            auto oldest = held.begin();
+            for (auto it = held.begin(); it != held.end(); ++it) {
+                if (it->second.arrived < oldest->second.arrived) oldest = it;
+            }
+            if (now - oldest->second.arrived < std::chrono::milliseconds(reorderMs)) break;
+            lost += held.begin()->first - nextSeq;
+            nextSeq = held.begin()->first;
+            drainInOrder();
+        }
+
+        if (now >= nextReport) {
+            fprintf(stderr, "[%6.1fs] delivered=%llu (+%llu) lost=%llu dup=%llu late=%llu held=%zu depth=%u\n",
+                    std::chrono::duration<double>(now - start).count(),
+                    (unsigned long long)delivered, (unsigned long long)intervalDelivered,
+                    (unsigned long long)lost, (unsigned long long)duplicates,
+                    (unsigned long long)late, held.size(), maxReorderDepth);
+            for (auto& entry : links) {
+                LinkCounters& link = entry.second;
+                fprintf(stderr, "    link %u %-21s %8.1f kbps  packets=%llu probes=%llu\n",
+                        entry.first, link.source.c_str(), link.intervalBytes * 8 / 1000.0,
+                        (unsigned long long)link.packets, (unsigned long long)link.probes);
+                link.intervalBytes = 0;
+            }
+            intervalDelivered = 0;
+            nextReport += std::chrono::seconds(1);
+        }
+    }
+
+    bool pass = maxLost < 0 || static_cast<long long>(lost) <= maxLost;
+    printf("delivered=%llu lost=%llu duplicates=%llu late=%llu max_reorder_depth=%u pass=%s\n",
+           (unsigned long long)delivered, (unsigned long long)lost,
+           (unsigned long long)duplicates, (unsigned long long)late, maxReorderDepth,
+           pass ? "true" : "false");
+    for (const auto& entry : links) {
+        printf("link %u %s packets=%llu bytes=%llu probes=%llu\n", entry.first,
+               entry.second.source.c_str(), (unsigned long long)entry.second.packets,
+               (unsigned long long)entry.second.bytes, (unsigned long long)entry.second.probes);
+    }
+    close(fd);
+    if (outFd >= 0) close(outFd);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+/**
+ * multilink_sender - drives the app's MultiLinkSender on the host.
+ *
+ * Sends a synthetic MPEG-TS stream (PAT plus one PID with valid continuity
+ * counters) at a fixed bitrate through MultiLinkSender, with one UDP socket
+ * per --link bound to its own local address, the way SocketBinder binds one
+ * socket per Android network. Per-link RTT, loss, share and throughput are
+ * printed once per second.
+ *
+ * Pair it with `multilink_receiver --listen <port> --forward <ts_receiver>`;
+ * put an impair_relay in front of a link (link target override) to degrade
+ * it on its own. tools/scripts/multilink_loopback.sh wires all of this up.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -Itools/host -Iapp/src/main/jni -o multilink_sender \
+ *       tools/multilink_sender.cpp app/src/main/jni/multilink_sender.cpp app/src/main/jni/logger.cpp -lpthread
+ *
+ * Examples:
+ *   multilink_sender --target 127.0.0.1:9000 --link 127.0.0.2 --link 127.0.0.3 --duration 30
+ *   multilink_sender --target 127.0.0.1:9000 --scheduler wrr \
+ *       --link 127.0.0.2 --link 127.0.0.3,target=127.0.0.1:9100
+ */
+
+#include "multilink_sender.h"
+#include "ts_generator.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+bool splitHostPort(const std::string& spec, std::string& host, int& port) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = spec.substr(0, colon);
+    port = atoi(spec.c_str() + colon + 1);
+    return !host.empty() && port > 0;
+}
+
+// <local address>[,target=<host:port>]
+bool parseLink(const std::string& spec, std::string& local, UdpLinkSocket& link) {
+    size_t comma = spec.find(',');
+    local = spec.substr(0, comma);
+    link.name = local;
+    if (comma == std::string::npos) return true;
+    std::string option = spec.substr(comma + 1);
+    if (option.rfind("target=", 0) != 0) return false;
+    return splitHostPort(option.substr(7), link.host, link.port);
+}
+
+int openBoundSocket(const std::string& local) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    if (inet_pton(AF_INET, local.c_str(), &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --target <host:port> --link <addr>[,target=h:p] [--link ...] [options]\n"
+        "  --scheduler edf|wrr   earliest delivery (default) or weighted round-robin\n"
+        "  --probe-ms <n>        probe interval (default 100)\n"
+        "  --kbps <n>            stream bitrate (default 3000)\n"
+        "  --duration <s>        stop after s seconds\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MultiLinkConfig config;
+    std::vector<UdpLinkSocket> sockets;
+    double kbps = 3000.0;
+    double durationS = 0.0;
+    bool haveTarget = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--target") haveTarget = splitHostPort(next(), config.host, config.port);
+        else if (arg == "--link") {
+            std::string local;
+            UdpLinkSocket link;
+            if (!parseLink(next(), local, link)) { usage(argv[0]); return 2; }
+            link.fd = openBoundSocket(local);
+            if (link.fd < 0) {
+                fprintf(stderr, "cannot bind %s: %s\n", local.c_str(), strerror(errno));
+                return 2;
+            }
+            sockets.push_back(link);
+        } else if (arg == "--scheduler") {
+            std::string scheduler = next();
+            if (scheduler == "wrr") config.scheduler = LinkScheduler::WEIGHTED_ROUND_ROBIN;
+            else if (scheduler != "edf") { usage(argv[0]); return 2; }
+        }
+        else if (arg == "--probe-ms") config.probeIntervalMs = atoi(next().c_str());
+        else if (arg == "--kbps") kbps = atof(next().c_str());
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else { usage(argv[0]); return 2; }
+    }
+    if (!haveTarget || sockets.empty() || kbps <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    MultiLinkSender sender(config, sockets);
+    for (const UdpLinkSocket& link : sockets) {
+        close(link.fd);     // The sender holds its own duplicates
+    }
+    if (!sender.start()) {
+        fprintf(stderr, "no usable links\n");
+        return 2;
+    }
+
+    TsGenerator generator;
+    uint8_t datagram[TsGenerator::kDatagramSize];
+    const auto interval = std::chrono::nanoseconds(
+        static_cast<int64_t>(sizeof(datagram) * 8 * 1e9 / (kbps * 1000.0)));
+    const auto start = std::chrono::steady_clock::now();
+    auto nextSend = start;
+    auto nextReport = start + std::chrono::seconds(1);
+    uint64_t offered = 0;
+
+    while (!g_stop) {
+        auto now = std::chrono::steady_clock::now();
+        if (durationS > 0 && now - start >= std::chrono::duration<double>(durationS)) break;
+
+        if (now >= nextSend) {
+            generator.next(datagram);
+            offered++;
+            sender.send(datagram, sizeof(datagram));
+            nextSend += interval;
+        }
+
+        if (now >= nextReport) {
+            fprintf(stderr, "[%6.1fs] sent=%llu bytes refused=%llu/%llu\n",
+                    std::chrono::duration<double>(now - start).count(),
+                    (unsigned long long)sender.bytesSent(),
+                    (unsigned long long)sender.datagramsRefused(), (unsigned long long)offered);
+            for (const UdpLinkStats& link : sender.getLinkStats()) {
+                fprintf(stderr, "    %-15s %-4s rtt=%6.1fms loss=%5.1f%% share=%5.1f%% send=%7.1fkbps acked=%7.1fkbps\n",
+                        link.name.c_str(), link.up ? "up" : "down", link.rttMs,
+                        link.lossRate * 100.0, link.share * 100.0,
+                        link.sendBitrate / 1000.0, link.deliveredBitrate / 1000.0);
+            }
+            nextReport += std::chrono::seconds(1);
+        }
+
+        std::this_thread::sleep_until(std::min(nextSend, nextReport));
+    }
+
+    sender.stop();
+    return 0;
+}
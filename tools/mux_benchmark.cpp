@@ -0,0 +1,412 @@
+/**
+ * mux_benchmark - mpegtsmux against the app's TsMuxer on the same live encode.
+ *
+ * Runs the app's camera chain shape (live videotestsrc ! x264enc
+ * zerolatency ! h264parse, live audiotestsrc ! voaacenc ! aacparse, each
+ * through a queue) once into mpegtsmux and once into
+ * TsMuxer (ts_muxer.cpp) fed from appsinks as SrtStreamer does. For every
+ * video access unit it takes the time it left h264parse and the time the
+ * TS packet starting its PES left the muxer, and prints the distribution
+ * of that mux latency per muxer. The queues do not leak (the app's do), so
+ * every AU is counted and time mpegtsmux holds one back shows up in full.
+ *
+ * With --send the muxed datagrams also go to a UDP address, so ts_receiver
+ * can check them (sync, continuity, PAT/PMT, PCR spacing); its exit status
+ * is the conformance result.
+ *
+ * Build (host, GStreamer 1.x with x264enc, voaacenc and mpegtsmux):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -Itools/host -Iapp/src/main/jni \
+ *       -o mux_benchmark tools/mux_benchmark.cpp app/src/main/jni/ts_muxer.cpp app/src/main/jni/logger.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0) -lpthread -ldl
+ *
+ * Examples:
+ *   mux_benchmark --duration 20
+ *   ts_receiver --udp 9001 --duration 15 --max-cc-errors 0 --conformance &
+ *   mux_benchmark --muxer native --duration 12 --send 127.0.0.1:9001
+ */
+
+#include "ts_muxer.h"
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+struct Options {
+    std::vector<std::string> muxers{"mpegtsmux", "native"};
+    int durationS = 10;
+    int width = 1280;
+    int height = 720;
+    int frameRate = 30;
+    int videoKbps = 3000;
+    std::string sendHost;
+    int sendPort = 0;
+};
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Times the video access units go in and their PES starts come out. Both
+// muxers keep one PES per AU in order, so the n-th start is the n-th AU.
+class Timeline {
+public:
+    void accessUnitIn() {
+        std::lock_guard<std::mutex> lock(mutex);
+        in.push_back(nowNs());
+    }
+
+    // Scan one chunk of muxer output (whole 188-byte packets)
+    void tsOut(const uint8_t* data, size_t size) {
+        int64_t now = nowNs();
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes += size;
+        for (size_t offset = 0; offset + TsMuxer::kPacketSize <= size; offset += TsMuxer::kPacketSize) {
+            const uint8_t* packet = data + offset;
+            if (packet[0] != 0x47) continue;
+            bool start = packet[1] & 0x40;
+            uint16_t pid = ((packet[1] & 0x1F) << 8) | packet[2];
+            if (!start) continue;
+            if (pid == 0) {
+                parsePat(packet);
+            } else if (pid == pmtPid) {
+                parsePmt(packet);
+            } else if (pid == videoPid) {
+                out.push_back(now);
+            }
+        }
+    }
+
+    // Mux latency in ms of every AU after the first skipNs of the run
+    std::vector<double> latenciesMs(int64_t skipNs) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<double> result;
+        size_t count = std::min(in.size(), out.size());
+        for (size_t i = 0; i < count; i++) {
+            if (in[i] - in.front() < skipNs) continue;
+            result.push_back((out[i] - in[i]) / 1e6);
+        }
+        return result;
+    }
+
+    uint64_t tsBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return bytes;
+    }
+
+private:
+    static const uint8_t* payload(const uint8_t* packet) {
+        size_t offset = 4;
+        if (packet[3] & 0x20) offset += 1 + packet[4];
+        if (offset >= TsMuxer::kPacketSize) return nullptr;
+        offset += 1 + packet[offset];   // pointer_field
+        return offset < TsMuxer::kPacketSize ? packet + offset : nullptr;
+    }
+
+    void parsePat(const uint8_t* packet) {
+        const uint8_t* section = payload(packet);
+        if (!section || section[0] != 0x00) return;
+        // First program after the 8-byte header
+        uint16_t program = (section[8] << 8) | section[9];
+        if (program != 0) pmtPid = ((section[10] & 0x1F) << 8) | section[11];
+    }
+
+    void parsePmt(const uint8_t* packet) {
+        const uint8_t* section = payload(packet);
+        if (!section || section[0] != 0x02) return;
+        size_t sectionLength = ((section[1] & 0x0F) << 8) | section[2];
+        size_t infoLength = ((section[10] & 0x0F) << 8) | section[11];
+        // ES loop ends before the CRC; sections here fit one packet
+        const uint8_t* end = std::min(section + 3 + sectionLength - 4, packet + TsMuxer::kPacketSize);
+        for (const uint8_t* es = section + 12 + infoLength; es + 5 <= end;
+             es += 5 + (((es[3] & 0x0F) << 8) | es[4])) {
+            if (es[0] == 0x1B) {
+                videoPid = ((es[1] & 0x1F) << 8) | es[2];
+                return;
+            }
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::vector<int64_t> in;
+    std::vector<int64_t> out;
+    uint64_t bytes = 0;
+    uint16_t pmtPid = 0x1FFF;
+    uint16_t videoPid = 0x1FFF;
+};
+
+// Datagrams to --send, for ts_receiver
+class UdpOut {
+public:
+    UdpOut(const std::string& host, int port) {
+        if (host.empty()) return;
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    }
+    ~UdpOut() {
+        if (fd >= 0) close(fd);
+    }
+
+    void send(const uint8_t* data, size_t size) {
+        if (fd < 0) return;
+        sendto(fd, data, size, 0, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    }
+
+private:
+    int fd = -1;
+    sockaddr_in addr{};
+};
+
+struct Run {
+    Timeline timeline;
+    UdpOut* udp = nullptr;
+    std::unique_ptr<TsMuxer> tsMuxer;
+};
+
+GstPadProbeReturn onAccessUnit(GstPad*, GstPadProbeInfo*, gpointer userData) {
+    static_cast<Run*>(userData)->timeline.accessUnitIn();
+    return GST_PAD_PROBE_OK;
+}
+
+// mpegtsmux output (alignment=7: whole datagrams)
+GstFlowReturn onTsSample(GstAppSink* sink, gpointer userData) {
+    auto* run = static_cast<Run*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        run->timeline.tsOut(map.data, map.size);
+        run->udp->send(map.data, map.size);
+        gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+// Encoded video into TsMuxer, as SrtStreamer::Impl::onVideoEsSample
+GstFlowReturn onVideoEsSample(GstAppSink* sink, gpointer userData) {
+    auto* run = static_cast<Run*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        GstClockTime pts = GST_BUFFER_PTS(buf);
+        GstClockTime dts = GST_BUFFER_DTS(buf);
+        run->tsMuxer->writeVideo(map.data, map.size,
+            GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts) : 0,
+            GST_CLOCK_TIME_IS_VALID(dts) ? static_cast<int64_t>(dts) : -1,
+            !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT));
+        gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+GstFlowReturn onAudioEsSample(GstAppSink* sink, gpointer userData) {
+    auto* run = static_cast<Run*>(userData);
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_EOS;
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        GstClockTime pts = GST_BUFFER_PTS(buf);
+        run->tsMuxer->writeAudio(map.data, map.size,
+            GST_CLOCK_TIME_IS_VALID(pts) ? static_cast<int64_t>(pts) : 0);
+        gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+std::string pipelineString(const Options& opts, bool native) {
+    std::stringstream ss;
+    ss << "videotestsrc is-live=true pattern=ball ! "
+       << "video/x-raw,format=I420,width=" << opts.width << ",height=" << opts.height
+       << ",framerate=" << opts.frameRate << "/1 ! "
+       << "x264enc tune=zerolatency speed-preset=ultrafast bitrate=" << opts.videoKbps
+       << " key-int-max=" << opts.frameRate * 2 << " ! "
+       << "h264parse name=video_parse config-interval=-1 ! "
+       << "video/x-h264,stream-format=byte-stream,alignment=au ! "
+       << "queue ! ";
+    ss << (native ? "appsink name=video_es_sink sync=false async=false " : "mux. ");
+    ss << "audiotestsrc is-live=true ! audio/x-raw,rate=48000,channels=2 ! audioconvert ! "
+       << "voaacenc bitrate=128000 ! aacparse ! ";
+    if (native) {
+        ss << "audio/mpeg,stream-format=adts ! queue ! "
+           << "appsink name=audio_es_sink sync=false async=false";
+    } else {
+        ss << "queue ! mux. "
+           << "mpegtsmux name=mux alignment=7 ! appsink name=ts_sink sync=false async=false";
+    }
+    return ss.str();
+}
+
+void connectSink(GstElement* pipeline, const char* name, GstFlowReturn (*callback)(GstAppSink*, gpointer),
+                 Run* run) {
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    GstAppSinkCallbacks callbacks = {};
+    callbacks.new_sample = callback;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, run, nullptr);
+    gst_object_unref(sink);
+}
+
+bool runMuxer(const std::string& muxer, const Options& opts, UdpOut& udp, Run& run) {
+    bool native = muxer == "native";
+    run.udp = &udp;
+    if (native) {
+        run.tsMuxer = std::make_unique<TsMuxer>(TsMuxerConfig(),
+            [&run](const uint8_t* data, size_t size) {
+                run.timeline.tsOut(data, size);
+                run.udp->send(data, size);
+            });
+    }
+
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipelineString(opts, native).c_str(), &error);
+    if (error) {
+        fprintf(stderr, "%s: %s\n", muxer.c_str(), error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return false;
+    }
+    if (native) {
+        connectSink(pipeline, "video_es_sink", onVideoEsSample, &run);
+        connectSink(pipeline, "audio_es_sink", onAudioEsSample, &run);
+    } else {
+        connectSink(pipeline, "ts_sink", onTsSample, &run);
+    }
+    GstElement* parse = gst_bin_get_by_name(GST_BIN(pipeline), "video_parse");
+    GstPad* pad = gst_element_get_static_pad(parse, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, onAccessUnit, &run, nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(parse);
+
+    bool ok = true;
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(pipeline);
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, static_cast<GstClockTime>(opts.durationS) * GST_SECOND,
+        static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+    if (msg) {
+        if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+            GError* err = nullptr;
+            gst_message_parse_error(msg, &err, nullptr);
+            fprintf(stderr, "%s: %s\n", muxer.c_str(), err ? err->message : "error");
+            if (err) g_error_free(err);
+        }
+        ok = false;
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    if (run.tsMuxer) run.tsMuxer->flush();
+    return ok;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+bool parseResolution(const std::string& value, int& width, int& height) {
+    if (value == "480p") { width = 854; height = 480; return true; }
+    if (value == "720p") { width = 1280; height = 720; return true; }
+    if (value == "1080p") { width = 1920; height = 1080; return true; }
+    return sscanf(value.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+bool parseAddress(const std::string& value, std::string& host, int& port) {
+    size_t colon = value.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = value.substr(0, colon);
+    port = atoi(value.c_str() + colon + 1);
+    return !host.empty() && port > 0 && port < 65536;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--muxer mpegtsmux|native|both] [--duration S] [--resolution 480p|720p|1080p|WxH]\n"
+            "          [--fps N] [--kbps N] [--send HOST:PORT]\n",
+            argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--muxer") {
+            std::string value = next();
+            if (value == "both") opts.muxers = {"mpegtsmux", "native"};
+            else if (value == "mpegtsmux" || value == "native") opts.muxers = {value};
+            else ok = false;
+        }
+        else if (arg == "--duration") opts.durationS = atoi(next().c_str());
+        else if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else if (arg == "--fps") opts.frameRate = atoi(next().c_str());
+        else if (arg == "--kbps") opts.videoKbps = atoi(next().c_str());
+        else if (arg == "--send") ok = parseAddress(next(), opts.sendHost, opts.sendPort);
+        else ok = false;
+        if (!ok || opts.durationS < 3 || opts.frameRate <= 0 || opts.videoKbps <= 0) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    gst_init(&argc, &argv);
+    UdpOut udp(opts.sendHost, opts.sendPort);
+
+    printf("# %dx%d@%d, %d kbps video + 128 kbps AAC, %d s per muxer (first second skipped)\n",
+           opts.width, opts.height, opts.frameRate, opts.videoKbps, opts.durationS);
+    printf("%-10s %6s %8s %8s %8s %8s %8s\n", "muxer", "AUs", "mean", "p50", "p95", "max", "ts_kbps");
+
+    int failed = 0;
+    for (const std::string& muxer : opts.muxers) {
+        Run run;
+        if (!runMuxer(muxer, opts, udp, run)) {
+            failed++;
+            continue;
+        }
+        std::vector<double> latencies = run.timeline.latenciesMs(1000000000LL);
+        if (latencies.empty()) {
+            printf("%-10s no access units out\n", muxer.c_str());
+            failed++;
+            continue;
+        }
+        double mean = 0.0;
+        for (double value : latencies) mean += value;
+        mean /= latencies.size();
+        printf("%-10s %6zu %8.2f %8.2f %8.2f %8.2f %8.0f\n", muxer.c_str(), latencies.size(), mean,
+               percentile(latencies, 0.5), percentile(latencies, 0.95), percentile(latencies, 1.0),
+               run.timeline.tsBytes() * 8.0 / opts.durationS / 1000.0);
+    }
+    printf("\n(ms from h264parse output to the TS packet starting the access unit's PES)\n");
+    return failed ? 1 : 0;
+}
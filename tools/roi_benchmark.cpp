@@ -0,0 +1,293 @@
+/**
+ * roi_benchmark - what region-of-interest encoding buys at a fixed bitrate.
+ *
+ * Encodes the same synthetic clip twice with x264enc as the app configures
+ * it (zerolatency, rate-control profile, AQ on): once uniform, once with the
+ * app's ROI metas (roi.cpp) on a "presenter" rectangle. Both encodes are
+ * decoded again and compared with the source, and each prints its bitrate
+ * and luma PSNR inside the region, outside it and over the whole frame.
+ *
+ * The clip has fine moving detail everywhere, so bits spent on the region
+ * have to come out of the background. Expect the ROI encode to gain PSNR in
+ * the region and lose some outside it at about the same bitrate.
+ *
+ * Build (host, GStreamer 1.x with x264enc and avdec_h264):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -Itools/host -Iapp/src/main/jni \
+ *       -o roi_benchmark tools/roi_benchmark.cpp app/src/main/jni/roi.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0 gstreamer-video-1.0) -lpthread
+ *
+ * Examples:
+ *   roi_benchmark --resolution 720p --kbps 1200 --roi 0.3,0.1,0.4,0.8 --roi-qp -8
+ *   roi_benchmark --resolution 1080p --kbps 2500 --rate-control cbr --frames 600
+ */
+
+#include "roi.h"
+
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+struct Options {
+    int width = 1280;
+    int height = 720;
+    int fps = 30;
+    int frames = 300;
+    int kbps = 1200;
+    std::string preset = "ultrafast";
+    bool cbr = false;                    // Strict CBR (VBV one frame) instead of capped VBR
+    RoiRegion roi{0.3f, 0.1f, 0.4f, 0.8f, -8};
+};
+
+struct Quality {
+    double roiSse = 0.0;
+    uint64_t roiPixels = 0;
+    double outsideSse = 0.0;
+    uint64_t outsidePixels = 0;
+    uint64_t encodedBytes = 0;
+    int decodedFrames = 0;
+};
+
+double psnr(double sse, uint64_t pixels) {
+    if (pixels == 0) return 0.0;
+    double mse = sse / pixels;
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+uint32_t hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+// Luma of frame `index` at (x, y): panning fine noise behind, a textured
+// "presenter" moving slowly inside the region. Pure function of its
+// arguments, so the source can be rebuilt when scoring the decode.
+uint8_t sourceLuma(int index, int x, int y, int left, int top, int right, int bottom) {
+    if (x >= left && x < right && y >= top && y < bottom) {
+        int sx = x + index / 2;
+        int sy = y + static_cast<int>(4.0 * std::sin(index * 0.1));
+        int stripes = ((sx / 6 + sy / 6) & 1) ? 170 : 90;
+        return static_cast<uint8_t>(stripes + (hash(sx * 7919 + sy * 104729) & 0x3F) - 32);
+    }
+    int sx = x + index * 3;
+    int base = 60 + (y * 100) / 1080;
+    return static_cast<uint8_t>(base + (hash(sx * 31337 + y * 7331) & 0x3F));
+}
+
+void renderFrame(int index, const Options& opts, int left, int top, int right, int bottom,
+                 std::vector<uint8_t>& frame) {
+    const size_t lumaSize = static_cast<size_t>(opts.width) * opts.height;
+    frame.resize(lumaSize * 3 / 2);
+    for (int y = 0; y < opts.height; y++) {
+        uint8_t* row = frame.data() + static_cast<size_t>(y) * opts.width;
+        for (int x = 0; x < opts.width; x++) {
+            row[x] = sourceLuma(index, x, y, left, top, right, bottom);
+        }
+    }
+    memset(frame.data() + lumaSize, 128, lumaSize / 2);
+}
+
+// Luma error of one decoded frame against the source, inside and outside the region
+void scoreFrame(GstSample* sample, const Options& opts, int left, int top, int right, int bottom,
+                Quality& quality) {
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    GstVideoInfo info;
+    if (!buffer || !gst_video_info_from_caps(&info, gst_sample_get_caps(sample))) return;
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return;
+
+    const GstClockTime frameDuration = GST_SECOND / opts.fps;
+    int index = static_cast<int>((GST_BUFFER_PTS(buffer) + frameDuration / 2) / frameDuration);
+    const int stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, 0);
+    for (int y = 0; y < opts.height; y++) {
+        const uint8_t* row = map.data + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < opts.width; x++) {
+            double d = static_cast<double>(row[x]) - sourceLuma(index, x, y, left, top, right, bottom);
+            if (x >= left && x < right && y >= top && y < bottom) {
+                quality.roiSse += d * d;
+                quality.roiPixels++;
+            } else {
+                quality.outsideSse += d * d;
+                quality.outsidePixels++;
+            }
+        }
+    }
+    gst_buffer_unmap(buffer, &map);
+    quality.decodedFrames++;
+}
+
+std::string pipelineString(const Options& opts) {
+    int vbvMs = opts.cbr ? std::max(1, 1000 / opts.fps) : 600;
+    std::stringstream ss;
+    ss << "appsrc name=src format=time block=true max-bytes=" << opts.width * opts.height * 6
+       << " caps=\"video/x-raw,format=I420,width=" << opts.width << ",height=" << opts.height
+       << ",framerate=" << opts.fps << "/1\" ! "
+       << "x264enc name=enc tune=zerolatency speed-preset=" << opts.preset
+       << " bitrate=" << opts.kbps << " key-int-max=" << opts.fps * 2 << " bframes=0"
+       << " pass=cbr vbv-buf-capacity=" << vbvMs << " option-string=\"aq-mode=1\" ! "
+       << "h264parse ! avdec_h264 ! videoconvert ! video/x-raw,format=I420 ! "
+       << "appsink name=sink sync=false";
+    return ss.str();
+}
+
+bool encode(const Options& opts, bool withRoi, Quality& quality) {
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipelineString(opts).c_str(), &error);
+    if (error) {
+        fprintf(stderr, "pipeline: %s\n", error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return false;
+    }
+    GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstElement* enc = gst_bin_get_by_name(GST_BIN(pipeline), "enc");
+
+    GstPad* encSrc = gst_element_get_static_pad(enc, "src");
+    gst_pad_add_probe(encSrc, GST_PAD_PROBE_TYPE_BUFFER,
+        [](GstPad*, GstPadProbeInfo* info, gpointer userData) -> GstPadProbeReturn {
+            GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+            if (buf) *static_cast<uint64_t*>(userData) += gst_buffer_get_size(buf);
+            return GST_PAD_PROBE_OK;
+        }, &quality.encodedBytes, nullptr);
+    gst_object_unref(encSrc);
+
+    const int left = static_cast<int>(std::lround(opts.roi.x * opts.width));
+    const int top = static_cast<int>(std::lround(opts.roi.y * opts.height));
+    const int right = static_cast<int>(std::lround((opts.roi.x + opts.roi.width) * opts.width));
+    const int bottom = static_cast<int>(std::lround((opts.roi.y + opts.roi.height) * opts.height));
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    std::thread scorer([&]() {
+        while (GstSample* sample = gst_app_sink_pull_sample(GST_APP_SINK(sink))) {
+            scoreFrame(sample, opts, left, top, right, bottom, quality);
+            gst_sample_unref(sample);
+        }
+    });
+
+    const std::vector<RoiRegion> regions = {opts.roi};
+    std::vector<uint8_t> frame;
+    for (int i = 0; i < opts.frames; i++) {
+        renderFrame(i, opts, left, top, right, bottom, frame);
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, frame.size(), nullptr);
+        gst_buffer_fill(buffer, 0, frame.data(), frame.size());
+        GST_BUFFER_PTS(buffer) = gst_util_uint64_scale(i, GST_SECOND, opts.fps);
+        GST_BUFFER_DURATION(buffer) = GST_SECOND / opts.fps;
+        if (withRoi) attachRoiMetas(buffer, opts.width, opts.height, regions);
+        if (gst_app_src_push_buffer(GST_APP_SRC(src), buffer) != GST_FLOW_OK) break;
+    }
+    gst_app_src_end_of_stream(GST_APP_SRC(src));
+    scorer.join();
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(enc);
+    gst_object_unref(sink);
+    gst_object_unref(src);
+    gst_object_unref(pipeline);
+    return quality.decodedFrames > 0;
+}
+
+void printRow(const char* name, const Quality& q, const Options& opts) {
+    double seconds = static_cast<double>(opts.frames) / opts.fps;
+    printf("%-8s %8.1f %10.2f %10.2f %10.2f %7d\n", name, q.encodedBytes * 8.0 / seconds / 1000.0,
+           psnr(q.roiSse, q.roiPixels), psnr(q.outsideSse, q.outsidePixels),
+           psnr(q.roiSse + q.outsideSse, q.roiPixels + q.outsidePixels), q.decodedFrames);
+}
+
+bool parseRegion(const std::string& spec, RoiRegion& region) {
+    return sscanf(spec.c_str(), "%f,%f,%f,%f", &region.x, &region.y, &region.width, &region.height) == 4 &&
+           region.width > 0 && region.height > 0;
+}
+
+bool parseResolution(const std::string& spec, int& width, int& height) {
+    if (spec == "1080p") { width = 1920; height = 1080; return true; }
+    if (spec == "720p") { width = 1280; height = 720; return true; }
+    if (spec == "480p") { width = 854; height = 480; return true; }
+    return sscanf(spec.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0 &&
+           width % 2 == 0 && height % 2 == 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --resolution <r>     1080p, 720p, 480p or WxH (default 720p)\n"
+        "  --fps <n>            frame rate (default 30)\n"
+        "  --frames <n>         clip length (default 300)\n"
+        "  --kbps <n>           bitrate for both encodes (default 1200)\n"
+        "  --preset <name>      x264 speed preset (default ultrafast)\n"
+        "  --rate-control <r>   cbr or vbr (capped, default)\n"
+        "  --roi <x,y,w,h>      region as fractions of the frame (default 0.3,0.1,0.4,0.8)\n"
+        "  --roi-qp <n>         QP offset inside the region (default -8)\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else if (arg == "--fps") opts.fps = atoi(next().c_str());
+        else if (arg == "--frames") opts.frames = atoi(next().c_str());
+        else if (arg == "--kbps") opts.kbps = atoi(next().c_str());
+        else if (arg == "--preset") opts.preset = next();
+        else if (arg == "--rate-control") {
+            std::string m = next();
+            ok = m == "cbr" || m == "vbr";
+            opts.cbr = m == "cbr";
+        }
+        else if (arg == "--roi") ok = parseRegion(next(), opts.roi);
+        else if (arg == "--roi-qp") opts.roi.qpOffset = atoi(next().c_str());
+        else ok = false;
+        if (!ok) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opts.fps <= 0 || opts.frames <= 0 || opts.kbps <= 0 || opts.roi.qpOffset == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    gst_init(&argc, &argv);
+
+    printf("# %dx%d@%d, %d frames, %d kbps %s, preset %s, ROI %.2f,%.2f %.2fx%.2f qp %+d\n",
+           opts.width, opts.height, opts.fps, opts.frames, opts.kbps, opts.cbr ? "CBR" : "capped VBR",
+           opts.preset.c_str(), opts.roi.x, opts.roi.y, opts.roi.width, opts.roi.height, opts.roi.qpOffset);
+    printf("%-8s %8s %10s %10s %10s %7s\n", "encode", "kbps", "psnr_roi", "psnr_rest", "psnr_all", "frames");
+
+    Quality uniform;
+    Quality roi;
+    if (!encode(opts, false, uniform)) return 1;
+    printRow("uniform", uniform, opts);
+    if (!encode(opts, true, roi)) return 1;
+    printRow("roi", roi, opts);
+
+    printf("\nroi vs uniform: %+.2f dB inside, %+.2f dB outside, %+.1f%% bitrate\n",
+           psnr(roi.roiSse, roi.roiPixels) - psnr(uniform.roiSse, uniform.roiPixels),
+           psnr(roi.outsideSse, roi.outsidePixels) - psnr(uniform.outsideSse, uniform.outsidePixels),
+           uniform.encodedBytes ? (static_cast<double>(roi.encodedBytes) / uniform.encodedBytes - 1.0) * 100.0 : 0.0);
+    return 0;
+}
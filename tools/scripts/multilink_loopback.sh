@@ -0,0 +1,41 @@
+#!/bin/sh
+# Multi-link UDP on loopback: two links from 127.0.0.2 / 127.0.0.3, the first
+# capped by an impair_relay, into multilink_receiver -> ts_receiver.
+#
+# Usage: tools/scripts/multilink_loopback.sh [duration_s] [edf|wrr] [link1 impairments...]
+#   tools/scripts/multilink_loopback.sh 30 edf --delay 10 --rate 2500
+#   tools/scripts/multilink_loopback.sh 60 wrr --script tools/scripts/handover.txt
+#
+# Builds the tools into $BUILD (default /tmp/orbistream-tools). Exits non-zero
+# if ts_receiver sees continuity errors.
+set -e
+
+DURATION=${1:-20}
+SCHEDULER=${2:-edf}
+[ $# -ge 2 ] && shift 2 || shift $#
+IMPAIR=${*:---delay 10 --rate 2500}
+BUILD=${BUILD:-/tmp/orbistream-tools}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+
+mkdir -p "$BUILD"
+CXX=${CXX:-g++}
+$CXX -std=c++17 -O2 -o "$BUILD/ts_receiver" "$ROOT/tools/ts_receiver.cpp"
+$CXX -std=c++17 -O2 -o "$BUILD/impair_relay" "$ROOT/tools/impair_relay.cpp"
+$CXX -std=c++17 -O2 -o "$BUILD/multilink_receiver" "$ROOT/tools/multilink_receiver.cpp"
+$CXX -std=c++17 -O2 -I"$ROOT/tools/host" -I"$ROOT/app/src/main/jni" -o "$BUILD/multilink_sender" \
+    "$ROOT/tools/multilink_sender.cpp" "$ROOT/app/src/main/jni/multilink_sender.cpp" \
+    "$ROOT/app/src/main/jni/logger.cpp" -lpthread
+
+"$BUILD/ts_receiver" --udp 9001 --duration $((DURATION + 3)) --max-cc-errors 0 &
+TS=$!
+"$BUILD/multilink_receiver" --listen 9000 --forward 127.0.0.1:9001 --reorder-ms 200 \
+    --duration $((DURATION + 2)) &
+"$BUILD/impair_relay" --listen 9100 --target 127.0.0.1:9000 $IMPAIR &
+RELAY=$!
+trap 'kill $RELAY 2>/dev/null' EXIT
+sleep 0.5
+
+"$BUILD/multilink_sender" --target 127.0.0.1:9000 --scheduler "$SCHEDULER" \
+    --link 127.0.0.2,target=127.0.0.1:9100 --link 127.0.0.3 --kbps 4000 --duration "$DURATION"
+
+wait $TS
@@ -0,0 +1,53 @@
+#!/bin/sh
+# SrtStreamer (host build of the native core) through an impair_relay into
+# arq_receiver -> ts_receiver, with NAKs and ACKs impaired on the way back.
+#
+# Usage: tools/scripts/streamer_impairment.sh [duration_s] [latency_ms] [impairments...]
+#   tools/scripts/streamer_impairment.sh 30 250 --loss 0.02 --delay 30
+#   tools/scripts/streamer_impairment.sh 60 400 --script tools/scripts/handover.txt
+#
+# Builds the tools into $BUILD (default /tmp/orbistream-tools); needs the host
+# GStreamer (x264enc, voaacenc, mpegtsmux). Exits non-zero unless the streamer
+# saw loss (--min-lost), the receiver reported it recovered (--min-recovered),
+# and no more than $MAX_EXPIRED gaps expired (default 0); with none allowed,
+# ts_receiver must also see no continuity errors.
+set -e
+
+DURATION=${1:-20}
+LATENCY=${2:-250}
+[ $# -ge 2 ] && shift 2 || shift $#
+IMPAIR=${*:---loss 0.02 --delay 30}
+MAX_EXPIRED=${MAX_EXPIRED:-0}
+CC_CHECK=
+[ "$MAX_EXPIRED" = 0 ] && CC_CHECK="--max-cc-errors 0"
+BUILD=${BUILD:-/tmp/orbistream-tools}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+JNI="$ROOT/app/src/main/jni"
+
+mkdir -p "$BUILD"
+CXX=${CXX:-g++}
+$CXX -std=c++17 -O2 -o "$BUILD/ts_receiver" "$ROOT/tools/ts_receiver.cpp"
+$CXX -std=c++17 -O2 -o "$BUILD/impair_relay" "$ROOT/tools/impair_relay.cpp"
+$CXX -std=c++17 -O2 -o "$BUILD/arq_receiver" "$ROOT/tools/arq_receiver.cpp"
+$CXX -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -DLIBSRT_AVAILABLE=0 -I"$ROOT/tools/host" -I"$JNI" \
+    -o "$BUILD/streamer_sender" "$ROOT/tools/streamer_sender.cpp" \
+    "$JNI/srt_streamer.cpp" "$JNI/srt_transport.cpp" "$JNI/multilink_sender.cpp" \
+    "$JNI/arq_sender.cpp" "$JNI/ts_muxer.cpp" "$JNI/packet_pacer.cpp" "$JNI/frame_admission.cpp" \
+    "$JNI/frame_convert.cpp" "$JNI/thread_placement.cpp" "$JNI/metrics_history.cpp" "$JNI/trace.cpp" \
+    "$JNI/main_dispatcher.cpp" "$JNI/roi.cpp" "$JNI/memory_budget.cpp" "$JNI/gst_startup.cpp" \
+    "$JNI/logger.cpp" "$JNI/byte_accounting.cpp" "$JNI/thermal_governor.cpp" "$JNI/encoder_backend.cpp" \
+    $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0 gstreamer-video-1.0) -lpthread -ldl
+
+"$BUILD/ts_receiver" --udp 9001 --duration $((DURATION + 4)) $CC_CHECK &
+TS=$!
+"$BUILD/arq_receiver" --listen 9000 --latency "$LATENCY" --forward 127.0.0.1:9001 \
+    --duration $((DURATION + 3)) &
+"$BUILD/impair_relay" --listen 9100 --target 127.0.0.1:9000 --both $IMPAIR &
+RELAY=$!
+trap 'kill $RELAY 2>/dev/null' EXIT
+sleep 0.5
+
+"$BUILD/streamer_sender" --target 127.0.0.1:9100 --transport arq --latency "$LATENCY" \
+    --duration "$DURATION" --min-lost 1 --min-recovered 1 --max-expired "$MAX_EXPIRED"
+
+wait $TS
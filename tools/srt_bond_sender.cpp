@@ -0,0 +1,182 @@
+/**
+ * srt_bond_sender - drives the app's SrtTransport on the host.
+ *
+ * Sends a synthetic MPEG-TS stream (PAT plus one PID with valid continuity
+ * counters) at a fixed bitrate through SrtTransport, either as a plain
+ * caller or as a bonded group with one member per --link. Each link binds
+ * its own local address, so several loopback addresses stand in for the
+ * phone's interfaces. Link state, RTT and loss are printed once per second.
+ *
+ * Pair it with `ts_receiver --srt <port> --group`; put an impair_relay in
+ * front of a link (link target override) to degrade it on its own.
+ *
+ * Build (host, libsrt with bonding enabled):
+ *   g++ -std=c++17 -O2 -DLIBSRT_AVAILABLE=1 -Itools/host -Iapp/src/main/jni \
+ *       -o srt_bond_sender tools/srt_bond_sender.cpp app/src/main/jni/srt_transport.cpp app/src/main/jni/logger.cpp -lsrt -lpthread
+ *
+ * Examples:
+ *   srt_bond_sender --target 127.0.0.1:9001 --link 127.0.0.2 --link 127.0.0.3 --duration 30
+ *   srt_bond_sender --target 127.0.0.1:9001 --mode backup \
+ *       --link 127.0.0.2,weight=10 --link 127.0.0.3,target=127.0.0.1:9100,weight=5
+ */
+
+#include "srt_transport.h"
+#include "ts_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+bool splitHostPort(const std::string& spec, std::string& host, int& port) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = spec.substr(0, colon);
+    port = atoi(spec.c_str() + colon + 1);
+    return !host.empty() && port > 0;
+}
+
+// <local address>[,weight=<n>][,target=<host:port>]
+bool parseLink(const std::string& spec, SrtLinkConfig& link) {
+    size_t start = 0;
+    bool first = true;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string part = spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        if (first) {
+            link.localAddress = part;
+            first = false;
+        } else if (part.rfind("weight=", 0) == 0) {
+            link.weight = atoi(part.c_str() + 7);
+        } else if (part.rfind("target=", 0) == 0) {
+            if (!splitHostPort(part.substr(7), link.host, link.port)) return false;
+        } else {
+            return false;
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
+const char* linkStateName(SrtLinkState state) {
+    switch (state) {
+        case SrtLinkState::PENDING: return "pending";
+        case SrtLinkState::IDLE: return "idle";
+        case SrtLinkState::ACTIVE: return "active";
+        default: return "broken";
+    }
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --target <host:port> [--link <addr>[,weight=n][,target=h:p]]... [options]\n"
+        "  --mode broadcast|backup  group type when links are given (default broadcast)\n"
+        "  --kbps <n>               stream bitrate (default 3000)\n"
+        "  --latency <ms>           SRTO_LATENCY (default 120)\n"
+        "  --duration <s>           stop after s seconds\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SrtTransportConfig config;
+    config.latencyMs = 120;
+    double kbps = 3000.0;
+    double durationS = 0.0;
+    bool haveTarget = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--target") haveTarget = splitHostPort(next(), config.host, config.port);
+        else if (arg == "--link") {
+            SrtLinkConfig link;
+            if (!parseLink(next(), link)) { usage(argv[0]); return 2; }
+            config.links.push_back(link);
+        } else if (arg == "--mode") {
+            std::string mode = next();
+            if (mode == "backup") config.groupMode = SrtGroupMode::BACKUP;
+            else if (mode != "broadcast") { usage(argv[0]); return 2; }
+        }
+        else if (arg == "--kbps") kbps = atof(next().c_str());
+        else if (arg == "--latency") config.latencyMs = atoi(next().c_str());
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else { usage(argv[0]); return 2; }
+    }
+    if (!haveTarget || kbps <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    config.bonded = !config.links.empty();
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    SrtTransport transport(config, [](SrtConnectionState state, const std::string& reason) {
+        static const char* kNames[] = {"disconnected", "connecting", "connected", "broken"};
+        fprintf(stderr, "connection: %s%s%s\n", kNames[static_cast<int>(state)],
+                reason.empty() ? "" : " - ", reason.c_str());
+    });
+    if (!SrtTransport::isAvailable()) {
+        fprintf(stderr, "built without LIBSRT_AVAILABLE\n");
+        return 2;
+    }
+    transport.start();
+
+    TsGenerator generator;
+    uint8_t datagram[TsGenerator::kDatagramSize];
+    const auto interval = std::chrono::nanoseconds(
+        static_cast<int64_t>(sizeof(datagram) * 8 * 1e9 / (kbps * 1000.0)));
+    const auto start = std::chrono::steady_clock::now();
+    auto nextSend = start;
+    auto nextReport = start + std::chrono::seconds(1);
+    uint64_t offered = 0;
+    uint64_t refused = 0;
+
+    while (!g_stop) {
+        auto now = std::chrono::steady_clock::now();
+        if (durationS > 0 && now - start >= std::chrono::duration<double>(durationS)) break;
+
+        if (now >= nextSend) {
+            generator.next(datagram);
+            offered++;
+            if (!transport.send(datagram, sizeof(datagram))) refused++;
+            nextSend += interval;
+        }
+
+        if (now >= nextReport) {
+            SrtTransportStats st = transport.getStats();
+            fprintf(stderr, "[%6.1fs] sent=%lld lost=%lld retrans=%lld dropped=%lld refused=%llu/%llu rtt=%.1fms bw=%.1fMbps\n",
+                    std::chrono::duration<double>(now - start).count(),
+                    (long long)st.packetsSent, (long long)st.packetsLost,
+                    (long long)st.packetsRetransmitted, (long long)st.packetsDropped,
+                    (unsigned long long)refused, (unsigned long long)offered,
+                    st.rttMs, st.bandwidthMbps);
+            for (const SrtLinkStats& link : st.links) {
+                fprintf(stderr, "    %-15s -> %-21s w=%-3d %-7s rtt=%6.1fms sent=%llu lost=%llu retrans=%llu\n",
+                        link.localAddress.c_str(), link.remoteAddress.c_str(), link.weight,
+                        linkStateName(link.state), link.rttMs,
+                        (unsigned long long)link.packetsSent, (unsigned long long)link.packetsLost,
+                        (unsigned long long)link.packetsRetransmitted);
+            }
+            nextReport += std::chrono::seconds(1);
+        }
+
+        std::this_thread::sleep_until(std::min(nextSend, nextReport));
+    }
+
+    transport.stop();
+    return 0;
+}
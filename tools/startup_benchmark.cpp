@@ -0,0 +1,260 @@
+/**
+ * startup_benchmark - GStreamer cold start to first encoded frame, by phase.
+ *
+ * Each run is a fresh process (forked before GStreamer is touched) that
+ * initialises GStreamer through the app's GstStartup (gst_startup.cpp) with
+ * the registry cache in --cache-dir, probes for the hardware encoder and
+ * then times the app's live encode chain (videoconvert ! videoscale !
+ * x264enc ! h264parse ! mpegtsmux) from parse to the first TS buffer.
+ *
+ * The first run starts without a cache, so it rebuilds the registry as the
+ * first launch after an install or update does; the rest find a valid
+ * cache. --no-cache runs them all against GStreamer's default registry for
+ * comparison.
+ *
+ * Build (host, GStreamer 1.x with x264enc):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -Itools/host -Iapp/src/main/jni \
+ *       -o startup_benchmark tools/startup_benchmark.cpp app/src/main/jni/gst_startup.cpp app/src/main/jni/logger.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0) -ldl
+ *
+ * Examples:
+ *   startup_benchmark --runs 10
+ *   startup_benchmark --runs 5 --no-cache --resolution 1080p
+ */
+
+#include "gst_startup.h"
+
+#include <gst/gst.h>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+constexpr size_t kPhases = static_cast<size_t>(StartupPhase::COUNT);
+
+struct Options {
+    int runs = 5;
+    std::string cacheDir = "/tmp/orbistream-startup";
+    bool useCache = true;
+    int width = 1280;
+    int height = 720;
+};
+
+// One run, as reported by the child
+struct Run {
+    int64_t phaseUs[kPhases] = {};
+    int64_t firstFrameUs = 0;
+    bool cacheHit = false;
+    bool ok = false;
+
+    int64_t totalUs() const {
+        int64_t total = firstFrameUs;
+        for (int64_t us : phaseUs) total += us;
+        return total;
+    }
+};
+
+int64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+void onHandoff(GstElement*, GstBuffer*, GstPad*, gpointer userData) {
+    static_cast<std::atomic<bool>*>(userData)->store(true);
+}
+
+// Parse to first TS buffer out of the muxer; -1 on failure
+int64_t firstFrame(const Options& opts) {
+    std::stringstream ss;
+    ss << "videotestsrc num-buffers=30 is-live=false ! "
+       << "video/x-raw,format=NV21,width=" << opts.width << ",height=" << opts.height << ",framerate=30/1 ! "
+       << "videoconvert ! videoscale ! "
+       << "x264enc tune=zerolatency speed-preset=ultrafast bitrate=2000 key-int-max=60 ! "
+       << "h264parse config-interval=-1 ! mpegtsmux ! "
+       << "fakesink name=sink sync=false signal-handoffs=true";
+
+    auto begin = std::chrono::steady_clock::now();
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(ss.str().c_str(), &error);
+    if (error) {
+        fprintf(stderr, "pipeline: %s\n", error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        return -1;
+    }
+    std::atomic<bool> seen{false};
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    g_signal_connect(sink, "handoff", G_CALLBACK(onHandoff), &seen);
+    gst_object_unref(sink);
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(pipeline);
+    int64_t result = -1;
+    while (elapsedUs(begin) < 10 * 1000 * 1000) {
+        if (seen.load()) {
+            result = elapsedUs(begin);
+            break;
+        }
+        GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_MSECOND,
+            static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+        if (!msg) continue;
+        if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+            GError* err = nullptr;
+            gst_message_parse_error(msg, &err, nullptr);
+            fprintf(stderr, "pipeline: %s\n", err ? err->message : "error");
+            if (err) g_error_free(err);
+        }
+        gst_message_unref(msg);
+        break;
+    }
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return result;
+}
+
+// Runs in the forked child: everything GStreamer happens here
+Run measure(const Options& opts) {
+    Run run;
+    auto begin = std::chrono::steady_clock::now();
+    if (opts.useCache) mkdir(opts.cacheDir.c_str(), 0755);
+    GstStartup::recordPhase(StartupPhase::ENVIRONMENT, elapsedUs(begin));
+
+    if (!GstStartup::init(opts.useCache ? opts.cacheDir : "")) return run;
+    GstStartup::hardwareEncoderAvailable();
+    StartupReport report = GstStartup::report();
+    std::copy(std::begin(report.phaseUs), std::end(report.phaseUs), run.phaseUs);
+    run.cacheHit = report.registryCacheHit;
+    run.firstFrameUs = firstFrame(opts);
+    run.ok = run.firstFrameUs >= 0;
+    return run;
+}
+
+bool runChild(const Options& opts, Run& run) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fds[0]);
+        Run result = measure(opts);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &run, sizeof(run));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == static_cast<ssize_t>(sizeof(run)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void printRow(const char* label, const Run& run) {
+    printf("%-6s %-5s", label, run.cacheHit ? "hit" : "miss");
+    for (int64_t us : run.phaseUs) printf(" %9.1f", us / 1000.0);
+    printf(" %9.1f %9.1f\n", run.firstFrameUs / 1000.0, run.totalUs() / 1000.0);
+}
+
+// Per-column median of the warm runs
+Run median(const std::vector<Run>& runs) {
+    Run result;
+    result.cacheHit = runs.front().cacheHit;
+    auto column = [&](auto get) {
+        std::vector<int64_t> values;
+        for (const Run& run : runs) values.push_back(get(run));
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    };
+    for (size_t p = 0; p < kPhases; p++) {
+        result.phaseUs[p] = column([p](const Run& run) { return run.phaseUs[p]; });
+    }
+    result.firstFrameUs = column([](const Run& run) { return run.firstFrameUs; });
+    return result;
+}
+
+bool parseResolution(const std::string& value, int& width, int& height) {
+    if (value == "480p") { width = 854; height = 480; return true; }
+    if (value == "720p") { width = 1280; height = 720; return true; }
+    if (value == "1080p") { width = 1920; height = 1080; return true; }
+    return sscanf(value.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--runs N] [--cache-dir DIR] [--no-cache] [--resolution 480p|720p|1080p|WxH]\n",
+            argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--runs") opts.runs = atoi(next().c_str());
+        else if (arg == "--cache-dir") opts.cacheDir = next();
+        else if (arg == "--no-cache") opts.useCache = false;
+        else if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else ok = false;
+        if (!ok || opts.runs <= 0 || opts.cacheDir.empty()) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // First run starts cold
+    if (opts.useCache) {
+        unlink((opts.cacheDir + "/gst-registry.bin").c_str());
+        unlink((opts.cacheDir + "/gst-registry.stamp").c_str());
+    }
+
+    printf("# %d runs, registry %s, %dx%d\n", opts.runs,
+           opts.useCache ? opts.cacheDir.c_str() : "default", opts.width, opts.height);
+    printf("%-6s %-5s", "run", "cache");
+    for (size_t p = 0; p < kPhases; p++) printf(" %9.9s", startupPhaseName(static_cast<StartupPhase>(p)));
+    printf(" %9s %9s   (ms)\n", "first_frm", "total");
+
+    std::vector<Run> warm;
+    Run cold;
+    for (int i = 0; i < opts.runs; i++) {
+        Run run;
+        if (!runChild(opts, run) || !run.ok) {
+            fprintf(stderr, "run %d failed\n", i + 1);
+            return 1;
+        }
+        printRow(std::to_string(i + 1).c_str(), run);
+        if (i == 0) {
+            cold = run;
+        } else {
+            warm.push_back(run);
+        }
+    }
+
+    if (!warm.empty()) {
+        Run typical = median(warm);
+        printf("\n");
+        printRow("cold", cold);
+        printRow("warm", typical);
+        printf("\nwarm vs cold: gst_init %.1f -> %.1f ms, first frame after %.1f -> %.1f ms\n",
+               cold.phaseUs[static_cast<size_t>(StartupPhase::GST_INIT)] / 1000.0,
+               typical.phaseUs[static_cast<size_t>(StartupPhase::GST_INIT)] / 1000.0,
+               cold.totalUs() / 1000.0, typical.totalUs() / 1000.0);
+    }
+    return 0;
+}
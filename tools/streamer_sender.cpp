@@ -0,0 +1,220 @@
+/**
+ * streamer_sender - drives one of the app's SrtStreamer sessions on the host.
+ *
+ * Feeds a synthetic NV21 camera and a PCM tone at the camera's cadence into
+ * the full native pipeline (software x264 + AAC, TS mux, the app's transport)
+ * and sends to --target. Prints the transport's loss and recovery counters
+ * once per second and a summary at the end.
+ *
+ * For ARQ_UDP, pair it with `arq_receiver --latency <same ms>` behind an
+ * impair_relay with --both, so NAKs and ACKs cross the impaired link too.
+ *
+ * Exit status: 0 if the final counters pass --min-lost / --min-recovered /
+ * --max-expired, 1 if not, 2 on bad arguments or a pipeline that fails.
+ *
+ * Build (host, GStreamer 1.x with x264enc, voaacenc and mpegtsmux):
+ *   g++ -std=c++17 -O2 -DGSTREAMER_AVAILABLE=1 -DLIBSRT_AVAILABLE=0 \
+ *       -Itools/host -Iapp/src/main/jni -o streamer_sender tools/streamer_sender.cpp \
+ *       app/src/main/jni/{srt_streamer,srt_transport,multilink_sender,arq_sender,ts_muxer,packet_pacer,frame_admission,frame_convert,thread_placement,metrics_history,trace,main_dispatcher,roi,memory_budget,gst_startup,logger,byte_accounting,thermal_governor,encoder_backend}.cpp \
+ *       $(pkg-config --cflags --libs gstreamer-1.0 gstreamer-app-1.0 gstreamer-video-1.0) -lpthread -ldl
+ *
+ * Example:
+ *   impair_relay --listen 9100 --target 127.0.0.1:9000 --loss 0.02 --delay 30 --both &
+ *   arq_receiver --listen 9000 --latency 250 --forward 127.0.0.1:9001 &
+ *   streamer_sender --target 127.0.0.1:9100 --transport arq --duration 30 --min-recovered 1 --max-expired 0
+ */
+
+#include "srt_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+constexpr int kFramePoolSize = 8;
+constexpr int kAudioChunkMs = 20;
+
+bool splitHostPort(const std::string& spec, std::string& host, int& port) {
+    size_t colon = spec.rfind(':');
+    if (colon == std::string::npos) return false;
+    host = spec.substr(0, colon);
+    port = atoi(spec.c_str() + colon + 1);
+    return !host.empty() && port > 0;
+}
+
+bool parseTransport(const std::string& name, TransportMode& mode) {
+    if (name == "udp") mode = TransportMode::UDP;
+    else if (name == "arq") mode = TransportMode::ARQ_UDP;
+    else if (name == "srt") mode = TransportMode::SRT;
+    else return false;
+    return true;
+}
+
+bool parseSize(const std::string& spec, int& width, int& height) {
+    return sscanf(spec.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0 &&
+           width % 2 == 0 && height % 2 == 0;
+}
+
+// Moving bars over noise, so the encoder output keeps its bitrate
+std::vector<std::vector<uint8_t>> makeFramePool(int width, int height) {
+    std::vector<std::vector<uint8_t>> pool(kFramePoolSize);
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    uint32_t seed = 1;
+    for (int f = 0; f < kFramePoolSize; f++) {
+        std::vector<uint8_t>& frame = pool[f];
+        frame.assign(lumaSize * 3 / 2, 128);
+        const int shift = f * width / (kFramePoolSize * 4);
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = frame.data() + static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                seed = seed * 1664525u + 1013904223u;
+                row[x] = static_cast<uint8_t>((((x + shift) / 64) & 1 ? 160 : 64) + ((seed >> 24) & 0x1F));
+            }
+        }
+    }
+    return pool;
+}
+
+std::vector<uint8_t> makeToneChunk() {
+    const int samples = 48000 * kAudioChunkMs / 1000;
+    std::vector<uint8_t> chunk(static_cast<size_t>(samples) * 2 * sizeof(int16_t));
+    int16_t* pcm = reinterpret_cast<int16_t*>(chunk.data());
+    for (int i = 0; i < samples; i++) {
+        int16_t value = static_cast<int16_t>(8000 * std::sin(2.0 * M_PI * 440.0 * i / 48000.0));
+        pcm[i * 2] = value;
+        pcm[i * 2 + 1] = value;
+    }
+    return chunk;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s --target <host:port> [options]\n"
+        "  --transport <t>       udp, arq or srt (default arq)\n"
+        "  --latency <ms>        ARQ / SRT latency (default 250)\n"
+        "  --size <WxH>          video size (default 1280x720)\n"
+        "  --fps <n>             frame rate (default 30)\n"
+        "  --kbps <n>            video bitrate (default 3000)\n"
+        "  --duration <s>        stop after s seconds (default 20)\n"
+        "  --min-lost <n>        fail unless at least n packets were lost (NAKed for ARQ)\n"
+        "  --min-recovered <n>   fail unless the receiver recovered at least n (ARQ)\n"
+        "  --max-expired <n>     fail if the receiver gave up on more than n (ARQ)\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    StreamConfig config;
+    config.transport = TransportMode::ARQ_UDP;
+    config.useProxy = false;
+    config.videoWidth = 1280;
+    config.videoHeight = 720;
+    config.frameRate = 30;
+    config.videoBitrate = 3000 * 1000;
+    config.useHardwareEncoder = false;
+    config.useCalibration = false;
+    config.enableGovernor = false;
+    double durationS = 20.0;
+    long long minLost = -1;
+    long long minRecovered = -1;
+    long long maxExpired = -1;
+    bool haveTarget = false;
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--target") haveTarget = splitHostPort(next(), config.srtHost, config.srtPort);
+        else if (arg == "--transport") ok = parseTransport(next(), config.transport);
+        else if (arg == "--latency") config.arqLatencyMs = config.srtLatencyMs = atoi(next().c_str());
+        else if (arg == "--size") ok = parseSize(next(), config.videoWidth, config.videoHeight);
+        else if (arg == "--fps") config.frameRate = atoi(next().c_str());
+        else if (arg == "--kbps") config.videoBitrate = atoi(next().c_str()) * 1000;
+        else if (arg == "--duration") durationS = atof(next().c_str());
+        else if (arg == "--min-lost") minLost = atoll(next().c_str());
+        else if (arg == "--min-recovered") minRecovered = atoll(next().c_str());
+        else if (arg == "--max-expired") maxExpired = atoll(next().c_str());
+        else ok = false;
+    }
+    if (!ok || !haveTarget || config.frameRate <= 0 || config.videoBitrate <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    SrtStreamer streamer;
+    if (!streamer.createPipeline(config) || !streamer.start()) {
+        fprintf(stderr, "pipeline failed to start\n");
+        return 2;
+    }
+
+    const std::vector<std::vector<uint8_t>> frames = makeFramePool(config.videoWidth, config.videoHeight);
+    const std::vector<uint8_t> tone = makeToneChunk();
+    using clock = std::chrono::steady_clock;
+    const auto frameInterval = std::chrono::nanoseconds(1000000000LL / config.frameRate);
+    const auto audioInterval = std::chrono::milliseconds(kAudioChunkMs);
+    const auto start = clock::now();
+    auto nextFrame = start;
+    auto nextAudio = start;
+    auto nextReport = start + std::chrono::seconds(1);
+    size_t frameIndex = 0;
+
+    auto print = [&](double t) {
+        StreamStats st = streamer.getStats();
+        fprintf(stderr, "[%6.1fs] %.0f kbps sent=%llu lost=%llu retrans=%llu (%.2f%%) "
+                "recovered=%llu expired=%llu rtt=%.1fms\n",
+                t, st.currentBitrate / 1000.0, (unsigned long long)st.packetsSent,
+                (unsigned long long)st.packetsLost, (unsigned long long)st.packetsRetransmitted,
+                st.retransmitRatio * 100.0, (unsigned long long)st.packetsRecovered,
+                (unsigned long long)st.packetsExpired, st.rtt);
+        return st;
+    };
+
+    while (!g_stop) {
+        auto now = clock::now();
+        if (now - start >= std::chrono::duration<double>(durationS)) break;
+
+        int64_t tsNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+        if (now >= nextFrame) {
+            const std::vector<uint8_t>& frame = frames[frameIndex++ % frames.size()];
+            streamer.pushVideoFrame(frame.data(), frame.size(), config.videoWidth, config.videoHeight, tsNs);
+            nextFrame += frameInterval;
+            if (clock::now() > nextFrame) nextFrame = clock::now() + frameInterval;
+        }
+        if (now >= nextAudio) {
+            streamer.pushAudioSamples(tone.data(), tone.size(), 48000, 2, tsNs);
+            nextAudio += audioInterval;
+        }
+        if (now >= nextReport) {
+            print(std::chrono::duration<double>(now - start).count());
+            nextReport += std::chrono::seconds(1);
+        }
+        std::this_thread::sleep_until(std::min({nextFrame, nextAudio, nextReport}));
+    }
+
+    // Let the last NAKs and ACKs (and the receiver's report) come back
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.arqLatencyMs + 100));
+    StreamStats st = print(std::chrono::duration<double>(clock::now() - start).count());
+    streamer.stop();
+
+    bool pass = (minLost < 0 || static_cast<long long>(st.packetsLost) >= minLost) &&
+                (minRecovered < 0 || static_cast<long long>(st.packetsRecovered) >= minRecovered) &&
+                (maxExpired < 0 || static_cast<long long>(st.packetsExpired) <= maxExpired);
+    fprintf(stderr, "%s: lost=%llu recovered=%llu expired=%llu\n", pass ? "PASS" : "FAIL",
+            (unsigned long long)st.packetsLost, (unsigned long long)st.packetsRecovered,
+            (unsigned long long)st.packetsExpired);
+    return pass ? 0 : 1;
+}
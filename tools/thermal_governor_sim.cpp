@@ -0,0 +1,322 @@
+/**
+ * thermal_governor_sim - the app's sustained-performance governor against a
+ * scripted heat-up, or against a live sysfs tree.
+ *
+ * Scripted (--script): writes a fixture sysfs tree (two thermal zones, eight
+ * CPUs with cpufreq) under --fixture, steps simulated time by the governor
+ * interval and runs ThermalMonitor and ThermalGovernor (thermal_governor.cpp)
+ * on it exactly as SrtStreamer does. The big-core zone follows a first-order
+ * model: it settles at ambient + rise x the load of the current operating
+ * point (pixels x fps, 25% less per preset step), with a 60 s time constant,
+ * so stepping down visibly cools the device. Encode headroom shrinks with
+ * the same load and with the big-core frequency cap.
+ *
+ * Script lines are "<time_s> key=value ...", values holding until changed:
+ *   ambient=C  rise=C  trip=C (passive trip of the big-core zone)
+ *   cap=R (scaling_max_freq / cpuinfo_max_freq of the big cores)
+ *   headroom=H (encode headroom at the configured operating point)
+ *
+ * Live (no --script): samples --thermal-root / --cpu-root in real time every
+ * interval with a fixed --headroom, to see what a device or desktop reports.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -Iapp/src/main/jni -o thermal_governor_sim \
+ *       tools/thermal_governor_sim.cpp app/src/main/jni/thermal_governor.cpp
+ *
+ * Examples:
+ *   thermal_governor_sim --script tools/scripts/thermal_soak.txt
+ *   thermal_governor_sim --script tools/scripts/thermal_soak.txt --resolution 720p --preset-room 2
+ *   thermal_governor_sim --duration 120 --headroom 0.5
+ */
+
+#include "thermal_governor.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace orbistream;
+
+namespace {
+
+constexpr int kCpus = 8;
+constexpr int kFirstBigCpu = 4;
+constexpr int64_t kCpuMaxKhz = 2400000;
+constexpr double kTimeConstantS = 60.0;
+
+struct Options {
+    std::string script;
+    std::string fixture = "/tmp/orbistream-thermal";
+    std::string thermalRoot = "/sys/class/thermal";
+    std::string cpuRoot = "/sys/devices/system/cpu";
+    int durationS = 0;              // 0 = script end + 10 min, or 60 s live
+    int width = 1920;
+    int height = 1080;
+    int fps = 30;
+    int presetRoom = 0;             // x264 presets faster than the configured one
+    double headroom = 0.5;          // Live mode
+    GovernorConfig governor;
+};
+
+// One script line: time and the keys it sets
+struct ScriptStep {
+    double timeS = 0.0;
+    std::map<std::string, double> values;
+};
+
+// Simulated device, driven by the script
+struct Device {
+    double ambientC = 30.0;
+    double riseC = 40.0;
+    double tripC = 68.0;
+    double cap = 1.0;
+    double headroom = 0.45;
+    double bigC = 30.0;
+
+    void apply(const std::map<std::string, double>& values) {
+        for (const auto& entry : values) {
+            if (entry.first == "ambient") ambientC = entry.second;
+            else if (entry.first == "rise") riseC = entry.second;
+            else if (entry.first == "trip") tripC = entry.second;
+            else if (entry.first == "cap") cap = entry.second;
+            else if (entry.first == "headroom") headroom = entry.second;
+        }
+    }
+};
+
+bool loadScript(const std::string& path, std::vector<ScriptStep>& steps) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream words(line);
+        ScriptStep step;
+        if (!(words >> step.timeS)) continue;
+        std::string word;
+        while (words >> word) {
+            size_t eq = word.find('=');
+            if (eq == std::string::npos) {
+                fprintf(stderr, "%s:%d: expected key=value, got '%s'\n", path.c_str(), lineNo, word.c_str());
+                return false;
+            }
+            step.values[word.substr(0, eq)] = atof(word.c_str() + eq + 1);
+        }
+        steps.push_back(step);
+    }
+    std::sort(steps.begin(), steps.end(),
+              [](const ScriptStep& a, const ScriptStep& b) { return a.timeS < b.timeS; });
+    return true;
+}
+
+void writeValue(const std::string& path, const std::string& value) {
+    std::ofstream out(path, std::ios::trunc);
+    out << value << "\n";
+}
+
+void makeDirs(const std::string& path) {
+    for (size_t pos = 1; pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        mkdir(path.substr(0, pos).c_str(), 0755);
+    }
+    mkdir(path.c_str(), 0755);
+}
+
+std::string milli(double value) {
+    return std::to_string(static_cast<long long>(value * 1000.0));
+}
+
+// The fixture tree ThermalMonitor reads, laid out like sysfs
+void writeFixture(const Options& opts, const Device& device) {
+    std::string thermal = opts.fixture + "/thermal";
+    std::string big = thermal + "/thermal_zone0";
+    std::string battery = thermal + "/thermal_zone1";
+    makeDirs(big);
+    makeDirs(battery);
+    writeValue(big + "/type", "cpu-big");
+    writeValue(big + "/temp", milli(device.bigC));
+    writeValue(big + "/trip_point_0_type", "passive");
+    writeValue(big + "/trip_point_0_temp", milli(device.tripC));
+    writeValue(big + "/trip_point_1_type", "critical");
+    writeValue(big + "/trip_point_1_temp", milli(device.tripC + 30.0));
+    // The battery lags the SoC and has no passive trip
+    writeValue(battery + "/type", "battery");
+    writeValue(battery + "/temp", milli(device.ambientC + (device.bigC - device.ambientC) * 0.3));
+
+    for (int cpu = 0; cpu < kCpus; cpu++) {
+        std::string dir = opts.fixture + "/cpu/cpu" + std::to_string(cpu) + "/cpufreq";
+        makeDirs(dir);
+        double cap = cpu >= kFirstBigCpu ? device.cap : 1.0;
+        writeValue(dir + "/cpuinfo_max_freq", std::to_string(kCpuMaxKhz));
+        writeValue(dir + "/scaling_max_freq", std::to_string(static_cast<long long>(kCpuMaxKhz * cap)));
+    }
+}
+
+// Encode work of a point relative to the configured one
+double load(const OperatingPoint& point, const OperatingPoint& top) {
+    double pixels = static_cast<double>(point.width) * point.height * point.frameRate /
+                    (static_cast<double>(top.width) * top.height * top.frameRate);
+    for (int i = 0; i < point.presetSteps; i++) pixels *= 0.75;
+    return pixels;
+}
+
+std::string formatPoint(const OperatingPoint& point) {
+    char text[64];
+    snprintf(text, sizeof(text), "%dx%d@%d p+%d", point.width, point.height, point.frameRate,
+             point.presetSteps);
+    return text;
+}
+
+void printDecision(double timeS, const GovernorDecision& decision) {
+    printf("%8.0f  level %d -> %d  %-16s %-20s %6.1f C %6.1f C %5.2f %5.2f\n", timeS,
+           decision.fromLevel, decision.toLevel, governorReasonName(decision.reason),
+           formatPoint(decision.point).c_str(), decision.hottestC, decision.thermalHeadroomC,
+           decision.freqCapRatio, decision.encodeHeadroom);
+}
+
+int runScript(const Options& opts) {
+    std::vector<ScriptStep> steps;
+    if (!loadScript(opts.script, steps) || steps.empty()) {
+        fprintf(stderr, "cannot read script %s\n", opts.script.c_str());
+        return 1;
+    }
+    int durationS = opts.durationS > 0 ? opts.durationS : static_cast<int>(steps.back().timeS) + 600;
+
+    OperatingPoint top{opts.width, opts.height, opts.fps, 0};
+    ThermalGovernor governor;
+    governor.configure(opts.governor, top, opts.presetRoom);
+    ThermalMonitor monitor(opts.fixture + "/thermal", opts.fixture + "/cpu");
+
+    printf("# %s, %d s simulated, fixture %s\n", opts.script.c_str(), durationS, opts.fixture.c_str());
+    printf("# ladder:");
+    for (const OperatingPoint& point : governor.points()) printf(" %s", formatPoint(point).c_str());
+    printf("\n%8s  %-14s  %-16s %-20s %8s %8s %5s %5s\n", "time_s", "change", "reason", "point",
+           "hottest", "to_limit", "cap", "head");
+
+    Device device;
+    size_t nextStep = 0;
+    double stepS = opts.governor.intervalMs / 1000.0;
+    std::vector<double> secondsAtLevel(governor.maxLevel() + 1, 0.0);
+    double maxC = 0.0;
+    int changes = 0;
+    for (double t = 0.0; t <= durationS; t += stepS) {
+        while (nextStep < steps.size() && steps[nextStep].timeS <= t) {
+            device.apply(steps[nextStep++].values);
+        }
+        double work = load(governor.current(), top);
+        double settleC = device.ambientC + device.riseC * work;
+        device.bigC += (settleC - device.bigC) * std::min(1.0, stepS / kTimeConstantS);
+        maxC = std::max(maxC, device.bigC);
+        writeFixture(opts, device);
+
+        ThermalReading reading = monitor.read();
+        double headroom = std::max(0.0, 1.0 - (1.0 - device.headroom) * work / std::max(0.1, device.cap));
+        GovernorDecision decision;
+        if (governor.evaluate(static_cast<int64_t>(t * 1000.0), reading, headroom, decision)) {
+            printDecision(t, decision);
+            changes++;
+        }
+        secondsAtLevel[governor.level()] += stepS;
+    }
+
+    printf("\n%d changes, hottest %.1f C\n", changes, maxC);
+    for (size_t level = 0; level < secondsAtLevel.size(); level++) {
+        if (secondsAtLevel[level] <= 0.0) continue;
+        printf("  level %zu %-20s %6.0f s (%4.1f%%)\n", level, formatPoint(governor.points()[level]).c_str(),
+               secondsAtLevel[level], 100.0 * secondsAtLevel[level] / (durationS + stepS));
+    }
+    return 0;
+}
+
+int runLive(const Options& opts) {
+    int durationS = opts.durationS > 0 ? opts.durationS : 60;
+    OperatingPoint top{opts.width, opts.height, opts.fps, 0};
+    ThermalGovernor governor;
+    governor.configure(opts.governor, top, opts.presetRoom);
+    ThermalMonitor monitor(opts.thermalRoot, opts.cpuRoot);
+
+    ThermalReading first = monitor.read();
+    if (!first.available) {
+        fprintf(stderr, "nothing readable under %s or %s\n", opts.thermalRoot.c_str(), opts.cpuRoot.c_str());
+        return 1;
+    }
+    printf("# live: %s, %s for %d s, encode headroom %.2f\n", opts.thermalRoot.c_str(),
+           opts.cpuRoot.c_str(), durationS, opts.headroom);
+    for (const ThermalZone& zone : first.zones) {
+        printf("#   %-14s %-20s %6.1f C  trip %s\n", zone.name.c_str(), zone.type.c_str(), zone.tempC,
+               zone.tripC > 0.0 ? (std::to_string(static_cast<int>(zone.tripC)) + " C").c_str() : "-");
+    }
+    printf("%8s  %8s %8s %5s %5s  %s\n", "time_s", "hottest", "to_limit", "cap", "capped", "level");
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int64_t elapsedMs = 0; elapsedMs <= durationS * 1000LL;) {
+        ThermalReading reading = monitor.read();
+        GovernorDecision decision;
+        bool changed = governor.evaluate(elapsedMs, reading, opts.headroom, decision);
+        printf("%8.0f  %6.1f C %6.1f C %5.2f %6d  %d %s\n", elapsedMs / 1000.0, reading.hottestC,
+               governor.thermalHeadroomC(reading), reading.freqCapRatio, reading.cappedCpus,
+               governor.level(), changed ? governorReasonName(decision.reason) : "");
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(opts.governor.intervalMs));
+        elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+    }
+    return 0;
+}
+
+bool parseResolution(const std::string& value, int& width, int& height) {
+    if (value == "480p") { width = 854; height = 480; return true; }
+    if (value == "720p") { width = 1280; height = 720; return true; }
+    if (value == "1080p") { width = 1920; height = 1080; return true; }
+    return sscanf(value.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--script FILE [--fixture DIR] | --thermal-root DIR --cpu-root DIR --headroom H]\n"
+            "          [--duration S] [--resolution 480p|720p|1080p|WxH] [--fps N] [--preset-room N]\n"
+            "          [--interval MS] [--down-hold MS] [--up-hold MS] [--trip-margin C] [--recover-margin C]\n",
+            argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        bool ok = true;
+        if (arg == "--script") opts.script = next();
+        else if (arg == "--fixture") opts.fixture = next();
+        else if (arg == "--thermal-root") opts.thermalRoot = next();
+        else if (arg == "--cpu-root") opts.cpuRoot = next();
+        else if (arg == "--duration") opts.durationS = atoi(next().c_str());
+        else if (arg == "--resolution") ok = parseResolution(next(), opts.width, opts.height);
+        else if (arg == "--fps") opts.fps = atoi(next().c_str());
+        else if (arg == "--preset-room") opts.presetRoom = atoi(next().c_str());
+        else if (arg == "--headroom") opts.headroom = atof(next().c_str());
+        else if (arg == "--interval") opts.governor.intervalMs = atoi(next().c_str());
+        else if (arg == "--down-hold") opts.governor.downHoldMs = atoi(next().c_str());
+        else if (arg == "--up-hold") opts.governor.upHoldMs = atoi(next().c_str());
+        else if (arg == "--trip-margin") opts.governor.tripMarginC = atof(next().c_str());
+        else if (arg == "--recover-margin") opts.governor.recoverMarginC = atof(next().c_str());
+        else ok = false;
+        if (!ok || opts.fps <= 0 || opts.governor.intervalMs <= 0 || opts.fixture.empty()) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    return opts.script.empty() ? runLive(opts) : runScript(opts);
+}
@@ -0,0 +1,366 @@
+/**
+ * ts_receiver - local UDP/SRT receiver stand-in that validates MPEG-TS.
+ *
+ * Receives the stream on loopback (directly or behind impair_relay) and
+ * checks TS framing: sync bytes, per-PID continuity counters, PAT/PMT
+ * presence and PCR spacing. Prints delivered bitrate once per second and
+ * a summary on exit; with --json the summary is machine readable.
+ *
+ * Exit status is 1 when a threshold given on the command line is violated
+ * (or, with --conformance, on any sync error, a missing PAT/PMT/PCR or a
+ * PCR gap over the 100 ms the spec allows), so the tool can gate scripted
+ * runs.
+ *
+ * Build (host):
+ *   g++ -std=c++17 -O2 -o ts_receiver tools/ts_receiver.cpp
+ *   g++ -std=c++17 -O2 -DWITH_SRT -o ts_receiver tools/ts_receiver.cpp -lsrt
+ *
+ * Examples:
+ *   ts_receiver --udp 9001 --duration 30 --max-cc-errors 0
+ *   ts_receiver --udp 9001 --duration 15 --max-cc-errors 0 --conformance
+ *   ts_receiver --srt 9001 --latency 120 --duration 60 --min-kbps 1500 --json
+ *   ts_receiver --srt 9001 --group --duration 60    (accepts bonded callers)
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef WITH_SRT
+#include <srt/srt.h>
+#endif
+
+namespace {
+
+constexpr size_t kTsPacketSize = 188;
+
+struct PidState {
+    int lastCc = -1;
+    bool lastWasDuplicate = false;
+    uint64_t packets = 0;
+    uint64_t ccErrors = 0;
+};
+
+struct Report {
+    uint64_t datagrams = 0;
+    uint64_t bytes = 0;
+    uint64_t tsPackets = 0;
+    uint64_t syncErrors = 0;
+    uint64_t ccErrors = 0;
+    uint64_t patCount = 0;
+    uint64_t pmtCount = 0;
+    uint64_t pcrCount = 0;
+    double maxPcrGapMs = 0.0;
+    double minKbps = -1.0;
+    double maxKbps = 0.0;
+    double firstPacketMs = -1.0;
+};
+
+class TsValidator {
+public:
+    void feed(const uint8_t* data, size_t size, int64_t nowNs) {
+        report.datagrams++;
+        report.bytes += size;
+        if (size % kTsPacketSize != 0) report.syncErrors++;
+
+        for (size_t off = 0; off + kTsPacketSize <= size; off += kTsPacketSize) {
+            const uint8_t* p = data + off;
+            report.tsPackets++;
+            if (p[0] != 0x47) {
+                report.syncErrors++;
+                continue;
+            }
+            int pid = ((p[1] & 0x1F) << 8) | p[2];
+            if (pid == 0x1FFF) continue;           // Null packets carry no CC
+            int afc = (p[3] >> 4) & 0x03;
+            int cc = p[3] & 0x0F;
+            bool hasPayload = afc & 0x01;
+            bool discontinuity = (afc & 0x02) && p[4] > 0 && (p[5] & 0x80);
+
+            PidState& st = pids[pid];
+            st.packets++;
+            if (hasPayload && st.lastCc >= 0 && !discontinuity) {
+                if (cc == st.lastCc && !st.lastWasDuplicate) {
+                    st.lastWasDuplicate = true;     // One duplicate is legal
+                } else if (cc != ((st.lastCc + 1) & 0x0F)) {
+                    st.ccErrors++;
+                    report.ccErrors++;
+                    st.lastWasDuplicate = false;
+                } else {
+                    st.lastWasDuplicate = false;
+                }
+            }
+            if (hasPayload) st.lastCc = cc;
+
+            bool pusi = p[1] & 0x40;
+            if (pid == 0 && pusi) report.patCount++;
+            if (pid == pmtPid && pusi) report.pmtCount++;
+            if (pid == 0 && pusi && hasPayload) parsePat(p);
+
+            if ((afc & 0x02) && p[4] >= 7 && (p[5] & 0x10)) {
+                report.pcrCount++;
+                if (lastPcrNs > 0) {
+                    double gapMs = (nowNs - lastPcrNs) / 1e6;
+                    if (gapMs > report.maxPcrGapMs) report.maxPcrGapMs = gapMs;
+                }
+                lastPcrNs = nowNs;
+            }
+        }
+    }
+
+    Report report;
+    std::map<int, PidState> pids;
+
+private:
+    void parsePat(const uint8_t* p) {
+        size_t pos = 4;
+        if ((p[3] >> 4) & 0x02) pos += 1 + p[4];
+        pos += 1 + p[pos];                          // pointer_field
+        if (pos + 12 > kTsPacketSize || p[pos] != 0x00) return;
+        pmtPid = ((p[pos + 10] & 0x1F) << 8) | p[pos + 11];
+    }
+
+    int pmtPid = -1;
+    int64_t lastPcrNs = 0;
+};
+
+volatile sig_atomic_t g_stop = 0;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s (--udp <port> | --srt <port>) [options]\n"
+        "  --latency <ms>          SRT receiver latency (default 120)\n"
+        "  --group                 accept SRT connection groups (bonding)\n"
+        "  --duration <s>          exit after s seconds\n"
+        "  --max-cc-errors <n>     fail if continuity errors exceed n\n"
+        "  --min-kbps <kbps>       fail if average delivered bitrate is below\n"
+        "  --conformance           fail on sync errors, missing PAT/PMT/PCR or a PCR gap over 100 ms\n"
+        "  --json                  print the summary as JSON\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int udpPort = 0;
+    int srtPort = 0;
+    int srtLatencyMs = 120;
+    double durationS = 0.0;
+    long maxCcErrors = -1;
+    double minKbps = -1.0;
+    bool json = false;
+    bool srtGroup = false;
+    bool conformance = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : "0"; };
+        if (arg == "--udp") udpPort = atoi(next());
+        else if (arg == "--srt") srtPort = atoi(next());
+        else if (arg == "--latency") srtLatencyMs = atoi(next());
+        else if (arg == "--duration") durationS = atof(next());
+        else if (arg == "--max-cc-errors") maxCcErrors = atol(next());
+        else if (arg == "--min-kbps") minKbps = atof(next());
+        else if (arg == "--json") json = true;
+        else if (arg == "--group") srtGroup = true;
+        else if (arg == "--conformance") conformance = true;
+        else { usage(argv[0]); return 2; }
+    }
+    if (!udpPort && !srtPort) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, [](int) { g_stop = 1; });
+    signal(SIGTERM, [](int) { g_stop = 1; });
+
+    TsValidator validator;
+    std::vector<uint8_t> buf(65536);
+    const int64_t startNs = nowNs();
+    int64_t lastReportNs = startNs;
+    uint64_t lastReportBytes = 0;
+
+    auto tick = [&](int64_t now) {
+        if (now - lastReportNs < 1000000000LL) return;
+        Report& r = validator.report;
+        double kbps = (r.bytes - lastReportBytes) * 8.0 / 1000.0 / ((now - lastReportNs) / 1e9);
+        if (r.bytes > 0) {
+            if (r.minKbps < 0 || kbps < r.minKbps) r.minKbps = kbps;
+            if (kbps > r.maxKbps) r.maxKbps = kbps;
+        }
+        if (!json) {
+            fprintf(stderr, "[%7.2fs] %.0f kbps, ts=%llu cc_err=%llu sync_err=%llu pcr_gap_max=%.1fms\n",
+                    (now - startNs) / 1e9, kbps, (unsigned long long)r.tsPackets,
+                    (unsigned long long)r.ccErrors, (unsigned long long)r.syncErrors, r.maxPcrGapMs);
+        }
+        lastReportNs = now;
+        lastReportBytes = r.bytes;
+    };
+
+    auto onData = [&](const uint8_t* data, size_t size) {
+        int64_t now = nowNs();
+        if (validator.report.firstPacketMs < 0) {
+            validator.report.firstPacketMs = (now - startNs) / 1e6;
+        }
+        validator.feed(data, size, now);
+    };
+
+    auto expired = [&]() {
+        return g_stop || (durationS > 0 && (nowNs() - startNs) / 1e9 >= durationS);
+    };
+
+    if (udpPort) {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(udpPort));
+        int bufSize = 8 * 1024 * 1024;
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+        if (sock < 0 || bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            perror("bind");
+            return 1;
+        }
+        while (!expired()) {
+            pollfd fd = {sock, POLLIN, 0};
+            if (poll(&fd, 1, 100) > 0) {
+                ssize_t n = recv(sock, buf.data(), buf.size(), 0);
+                if (n > 0) onData(buf.data(), static_cast<size_t>(n));
+            }
+            tick(nowNs());
+        }
+        close(sock);
+    } else {
+#ifdef WITH_SRT
+        srt_startup();
+        SRTSOCKET listener = srt_create_socket();
+        srt_setsockflag(listener, SRTO_RCVLATENCY, &srtLatencyMs, sizeof(srtLatencyMs));
+        if (srtGroup) {
+            // srt_accept then returns the group; members are deduplicated by libsrt
+            int yes = 1;
+            if (srt_setsockflag(listener, SRTO_GROUPCONNECT, &yes, sizeof(yes)) == SRT_ERROR) {
+                fprintf(stderr, "srt group: %s (libsrt built without bonding?)\n",
+                        srt_getlasterror_str());
+                return 1;
+            }
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(srtPort));
+        if (srt_bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SRT_ERROR ||
+            srt_listen(listener, 1) == SRT_ERROR) {
+            fprintf(stderr, "srt listen: %s\n", srt_getlasterror_str());
+            return 1;
+        }
+        int timeoutMs = 100;
+        bool no = false;
+        srt_setsockflag(listener, SRTO_RCVSYN, &no, sizeof(no));
+        SRTSOCKET conn = SRT_INVALID_SOCK;
+        while (!expired() && conn == SRT_INVALID_SOCK) {
+            conn = srt_accept(listener, nullptr, nullptr);
+            if (conn == SRT_INVALID_SOCK) usleep(20000);
+        }
+        if (conn != SRT_INVALID_SOCK) {
+            bool yes = true;
+            srt_setsockflag(conn, SRTO_RCVSYN, &yes, sizeof(yes));
+            srt_setsockflag(conn, SRTO_RCVTIMEO, &timeoutMs, sizeof(timeoutMs));
+            while (!expired()) {
+                int n = srt_recvmsg(conn, reinterpret_cast<char*>(buf.data()), static_cast<int>(buf.size()));
+                if (n > 0) {
+                    onData(buf.data(), static_cast<size_t>(n));
+                } else if (srt_getsockstate(conn) == SRTS_BROKEN || srt_getsockstate(conn) == SRTS_CLOSED) {
+                    fprintf(stderr, "srt: connection closed\n");
+                    break;
+                }
+                tick(nowNs());
+            }
+            SRT_TRACEBSTATS st;
+            if (srtGroup) {
+                // Per-member view: which links delivered, and what each lost
+                SRT_SOCKGROUPDATA members[16];
+                size_t count = 16;
+                if (srt_group_data(conn, members, &count) != SRT_ERROR) {
+                    for (size_t m = 0; m < count && m < 16; m++) {
+                        char host[64] = "?";
+                        const sockaddr_in* peer = reinterpret_cast<const sockaddr_in*>(&members[m].peeraddr);
+                        inet_ntop(AF_INET, &peer->sin_addr, host, sizeof(host));
+                        if (srt_bstats(members[m].id, &st, 0) == 0) {
+                            fprintf(stderr, "srt member %s:%d state=%d recv=%lld loss=%lld drop=%lld rtt=%.1fms\n",
+                                    host, ntohs(peer->sin_port), (int)members[m].memberstate,
+                                    (long long)st.pktRecvTotal, (long long)st.pktRcvLossTotal,
+                                    (long long)st.pktRcvDropTotal, st.msRTT);
+                        }
+                    }
+                }
+            } else if (srt_bstats(conn, &st, 0) == 0) {
+                fprintf(stderr, "srt: recv_loss=%lld recv_drop=%lld rtt=%.1fms\n",
+                        (long long)st.pktRcvLossTotal, (long long)st.pktRcvDropTotal, st.msRTT);
+            }
+            srt_close(conn);
+        }
+        srt_close(listener);
+        srt_cleanup();
+#else
+        (void)srtLatencyMs;
+        (void)srtGroup;
+        fprintf(stderr, "SRT support not compiled in (rebuild with -DWITH_SRT -lsrt)\n");
+        return 2;
+#endif
+    }
+
+    const Report& r = validator.report;
+    double elapsedS = (nowNs() - startNs) / 1e9;
+    double activeS = r.firstPacketMs >= 0 ? elapsedS - r.firstPacketMs / 1000.0 : 0.0;
+    double avgKbps = activeS > 0 ? r.bytes * 8.0 / 1000.0 / activeS : 0.0;
+
+    bool failed = false;
+    if (maxCcErrors >= 0 && r.ccErrors > static_cast<uint64_t>(maxCcErrors)) failed = true;
+    if (minKbps >= 0 && avgKbps < minKbps) failed = true;
+    if (conformance && (r.syncErrors > 0 || r.patCount == 0 || r.pmtCount == 0 ||
+                        r.pcrCount == 0 || r.maxPcrGapMs > 100.0)) {
+        failed = true;
+    }
+
+    if (json) {
+        printf("{\"datagrams\":%llu,\"bytes\":%llu,\"ts_packets\":%llu,\"sync_errors\":%llu,"
+               "\"cc_errors\":%llu,\"pat\":%llu,\"pmt\":%llu,\"pcr\":%llu,\"max_pcr_gap_ms\":%.1f,"
+               "\"avg_kbps\":%.1f,\"min_kbps\":%.1f,\"max_kbps\":%.1f,\"first_packet_ms\":%.1f,"
+               "\"pids\":{",
+               (unsigned long long)r.datagrams, (unsigned long long)r.bytes,
+               (unsigned long long)r.tsPackets, (unsigned long long)r.syncErrors,
+               (unsigned long long)r.ccErrors, (unsigned long long)r.patCount,
+               (unsigned long long)r.pmtCount, (unsigned long long)r.pcrCount, r.maxPcrGapMs,
+               avgKbps, r.minKbps < 0 ? 0.0 : r.minKbps, r.maxKbps, r.firstPacketMs);
+        bool first = true;
+        for (const auto& kv : validator.pids) {
+            printf("%s\"%d\":{\"packets\":%llu,\"cc_errors\":%llu}", first ? "" : ",", kv.first,
+                   (unsigned long long)kv.second.packets, (unsigned long long)kv.second.ccErrors);
+            first = false;
+        }
+        printf("},\"pass\":%s}\n", failed ? "false" : "true");
+    } else {
+        fprintf(stderr, "ts_receiver: %llu datagrams, %llu TS packets, avg %.0f kbps, "
+                "cc_errors=%llu sync_errors=%llu PAT=%llu PMT=%llu PCR=%llu max_pcr_gap=%.1fms -> %s\n",
+                (unsigned long long)r.datagrams, (unsigned long long)r.tsPackets, avgKbps,
+                (unsigned long long)r.ccErrors, (unsigned long long)r.syncErrors,
+                (unsigned long long)r.patCount, (unsigned long long)r.pmtCount,
+                (unsigned long long)r.pcrCount, r.maxPcrGapMs, failed ? "FAIL" : "PASS");
+    }
+    return failed ? 1 : 0;
+}